@@ -26,6 +26,7 @@
 
 
 #include "Std_Types.h"
+#include "osal_startup.h"
 
 /*******************************************************************************
  * Definitions
@@ -49,6 +50,22 @@ typedef struct
     uint32 * ram_end;   /*!< End address of section in RAM */
 } Sys_ZeroLayoutType;
 
+/*!
+ * @brief DWT cycle counter (started by Reset_Handler), used to time every table entry
+ */
+#define SYS_DWT_CYCCNT          (*(volatile uint32 *)0xE0001004UL)
+
+/*!
+ * @brief Bytes moved per LDM/STM burst (8 words)
+ */
+#define SYS_BURST_SIZE          (32U)
+
+/*!
+ * @brief Init table entry flag (bit 0 of ram_start): the ROM range holds an
+ * LZ4 block written by tools/lz4_init.py instead of a raw image
+ */
+#define SYS_INIT_LZ4            (0x1U)
+
 extern uint32 __INIT_TABLE[];
 extern uint32 __ZERO_TABLE[];
 extern uint32 __INDEX_COPY_CORE2[];
@@ -61,10 +78,251 @@ extern uint32 __INDEX_COPY_CORE2[];
 /*******************************************************************************
  * Static Variables
  ******************************************************************************/
+/* Not part of the zero table: filled here, read by the application */
+osal_startup_stats_t osal_startup_stats __attribute__((section(".noinit")));
 
 /*******************************************************************************
  * Code
  ******************************************************************************/
+#define PLATFORM_START_SEC_CODE
+#include "Platform_MemMap.h"
+
+void init_data_bss(void);
+void init_data_bss_core2(void);
+
+/*FUNCTION**********************************************************************
+ *
+ * Function Name : Sys_CopySection
+ * Description   : Copy size bytes from rom to ram (both word aligned).
+ * One word is copied first if needed so the destination is 64-bit aligned; the
+ * bulk is then moved with 8-word LDM/STM bursts, which the M7 issues as full
+ * 64-bit AXI/TCM beats. The remainder is copied by words, then by bytes.
+ *
+ *END**************************************************************************/
+static void Sys_CopySection(uint32 * ram, const uint32 * rom, uint32 size)
+{
+    uint32 bursts;
+    uint8 * ram8;
+    const uint8 * rom8;
+
+    if ((((uint32)ram & 0x4U) != 0U) && (size >= 4U))
+    {
+        *ram++ = *rom++;
+        size -= 4U;
+    }
+
+    bursts = size / SYS_BURST_SIZE;
+    if (bursts != 0U)
+    {
+        /* r7 is left out: it is the frame pointer in unoptimized Thumb builds */
+        __asm volatile (
+            "1:                                       \n"
+            "ldmia %[src]!, {r3-r6, r8-r10, r12}      \n"
+            "stmia %[dst]!, {r3-r6, r8-r10, r12}      \n"
+            "subs  %[cnt], %[cnt], #1                 \n"
+            "bne   1b                                 \n"
+            : [src] "+r" (rom), [dst] "+r" (ram), [cnt] "+r" (bursts)
+            :
+            : "r3", "r4", "r5", "r6", "r8", "r9", "r10", "r12", "cc", "memory");
+        size &= (SYS_BURST_SIZE - 1U);
+    }
+
+    while (size >= 4U)
+    {
+        *ram++ = *rom++;
+        size -= 4U;
+    }
+
+    ram8 = (uint8 *)ram;
+    rom8 = (const uint8 *)rom;
+    while (size != 0U)
+    {
+        *ram8++ = *rom8++;
+        size--;
+    }
+}
+
+/*FUNCTION**********************************************************************
+ *
+ * Function Name : Sys_ZeroSection
+ * Description   : Clear size bytes at ram (word aligned), rounded up to a whole
+ * word as the linker file always pads the sections to 32 bits. Same burst
+ * scheme as Sys_CopySection.
+ *
+ *END**************************************************************************/
+static void Sys_ZeroSection(uint32 * ram, uint32 size)
+{
+    uint32 bursts;
+
+    size = (size + 3U) & ~3U;
+    if ((((uint32)ram & 0x4U) != 0U) && (size >= 4U))
+    {
+        *ram++ = 0U;
+        size -= 4U;
+    }
+
+    bursts = size / SYS_BURST_SIZE;
+    if (bursts != 0U)
+    {
+        __asm volatile (
+            "movs  r3, #0                             \n"
+            "movs  r4, #0                             \n"
+            "movs  r5, #0                             \n"
+            "movs  r6, #0                             \n"
+            "mov   r8, r3                             \n"
+            "mov   r9, r3                             \n"
+            "mov   r10, r3                            \n"
+            "mov   r12, r3                            \n"
+            "1:                                       \n"
+            "stmia %[dst]!, {r3-r6, r8-r10, r12}      \n"
+            "subs  %[cnt], %[cnt], #1                 \n"
+            "bne   1b                                 \n"
+            : [dst] "+r" (ram), [cnt] "+r" (bursts)
+            :
+            : "r3", "r4", "r5", "r6", "r8", "r9", "r10", "r12", "cc", "memory");
+        size &= (SYS_BURST_SIZE - 1U);
+    }
+
+    while (size != 0U)
+    {
+        *ram++ = 0U;
+        size -= 4U;
+    }
+}
+
+/*FUNCTION**********************************************************************
+ *
+ * Function Name : Sys_CopyBytes
+ * Description   : Short copy for the LZ4 decoder. Moves a word at a time while
+ * the ranges are at least 4 bytes apart (the M7 handles unaligned LDR/STR to
+ * normal memory), so overlapping match copies stay byte exact.
+ *
+ *END**************************************************************************/
+static inline uint8 * Sys_CopyBytes(uint8 * dst, const uint8 * src, uint32 len)
+{
+    if (((uint32)dst - (uint32)src) >= 4U)
+    {
+        while (len >= 4U)
+        {
+            uint32 word;
+            __builtin_memcpy(&word, src, 4U);
+            __builtin_memcpy(dst, &word, 4U);
+            dst += 4U;
+            src += 4U;
+            len -= 4U;
+        }
+    }
+    while (len != 0U)
+    {
+        *dst++ = *src++;
+        len--;
+    }
+    return dst;
+}
+
+/*FUNCTION**********************************************************************
+ *
+ * Function Name : Sys_Lz4Decode
+ * Description   : Decode one LZ4 block (no frame header) from [src, src_end)
+ * into dst. Returns the number of bytes written. The block comes from the
+ * post-link tool and is trusted: there are no bounds checks.
+ *
+ *END**************************************************************************/
+static uint32 Sys_Lz4Decode(uint8 * dst, const uint8 * src, const uint8 * src_end)
+{
+    uint8 * out = dst;
+    uint32 token;
+    uint32 len;
+    uint32 b;
+    uint32 offset;
+
+    while (src < src_end)
+    {
+        token = *src++;
+
+        /* Literal run */
+        len = token >> 4U;
+        if (len == 15U)
+        {
+            do
+            {
+                b = *src++;
+                len += b;
+            } while (b == 255U);
+        }
+        out = Sys_CopyBytes(out, src, len);
+        src += len;
+        if (src >= src_end)
+        {
+            break; /* The last sequence carries literals only */
+        }
+
+        /* Match: 16-bit little-endian offset back into the output */
+        offset = (uint32)src[0] | ((uint32)src[1] << 8U);
+        src += 2U;
+        len = (token & 0xFU) + 4U;
+        if ((token & 0xFU) == 15U)
+        {
+            do
+            {
+                b = *src++;
+                len += b;
+            } while (b == 255U);
+        }
+        out = Sys_CopyBytes(out, out - offset, len);
+    }
+
+    return (uint32)out - (uint32)dst;
+}
+
+/*FUNCTION**********************************************************************
+ *
+ * Function Name : Sys_CopyTable
+ * Description   : Copy the init table entries [first, count) and record the
+ * time of each entry in osal_startup_stats.
+ *
+ *END**************************************************************************/
+static void Sys_CopyTable(uint32 first)
+{
+    const uint32 * initTable_Ptr = (uint32 *)__INIT_TABLE;
+    const Sys_CopyLayoutType * copy_layout;
+    uint32 len;
+    uint32 rom_size;
+    uint32 size;
+    uint32 start;
+    uint32 ram;
+    uint32 i;
+
+    len = *initTable_Ptr;
+    initTable_Ptr++;
+    copy_layout = (const Sys_CopyLayoutType *)initTable_Ptr;
+    for (i = first; i < len; i++)
+    {
+        ram = (uint32)copy_layout[i].ram_start;
+        rom_size = (uint32)copy_layout[i].rom_end - (uint32)copy_layout[i].rom_start;
+        start = SYS_DWT_CYCCNT;
+        if ((ram & SYS_INIT_LZ4) != 0U)
+        {
+            ram &= ~SYS_INIT_LZ4;
+            size = Sys_Lz4Decode((uint8 *)ram, (const uint8 *)copy_layout[i].rom_start,
+                                 (const uint8 *)copy_layout[i].rom_end);
+        }
+        else
+        {
+            size = rom_size;
+            Sys_CopySection((uint32 *)ram, copy_layout[i].rom_start, size);
+        }
+        if (i < OSAL_STARTUP_MAX_SECTIONS)
+        {
+            osal_startup_stats.copy[i].addr = ram;
+            osal_startup_stats.copy[i].size = size;
+            osal_startup_stats.copy[i].rom_size = rom_size;
+            osal_startup_stats.copy[i].cycles = SYS_DWT_CYCCNT - start;
+        }
+    }
+    osal_startup_stats.copy_count = len;
+}
+
 /*FUNCTION**********************************************************************
  *
  * Function Name : init_data_bss
@@ -73,6 +331,8 @@ extern uint32 __INDEX_COPY_CORE2[];
  * - Copy initialized data from ROM to RAM.
  * - Copy code that should reside in RAM from ROM
  * - Clear the zero-initialized data section.
+ * The time spent on each table entry is stored in osal_startup_stats, using
+ * the DWT cycle counter started by Reset_Handler.
  *
  * Tool Chains:
  *   __GNUC__           : GNU Compiler Collection
@@ -83,112 +343,48 @@ extern uint32 __INDEX_COPY_CORE2[];
  *
  * Implements    : init_data_bss_Activity
  *END**************************************************************************/
-#define PLATFORM_START_SEC_CODE
-#include "Platform_MemMap.h"
- 
-void init_data_bss(void);
-void init_data_bss_core2(void);
-
 void init_data_bss(void)
 {
-    const Sys_CopyLayoutType * copy_layout;
     const Sys_ZeroLayoutType * zero_layout;
-    const uint32 * rom;
-    const uint8 * rom8;
-    uint32 * ram;
-    uint8 * ram8;
-    uint8 dataPad;
     uint32 len = 0U;
     uint32 size = 0U;
+    uint32 start = 0U;
     uint32 i = 0U;
-    uint32 j = 0U;
 
-    const uint32 * initTable_Ptr = (uint32 *)__INIT_TABLE;
     const uint32 * zeroTable_Ptr = (uint32*)__ZERO_TABLE;
+    const uint32 entry = SYS_DWT_CYCCNT;
+
+    osal_startup_stats.magic = 0U;
 
     /* Copy initialized table */
-    len = *initTable_Ptr;
-    initTable_Ptr++;
-    copy_layout = (const Sys_CopyLayoutType *)initTable_Ptr;
-    for(i = 0; i < len; i++)
-    {
-        rom = copy_layout[i].rom_start;
-        ram = copy_layout[i].ram_start;
-        size = (uint32)copy_layout[i].rom_end - (uint32)copy_layout[i].rom_start;
-        /* Make sure the data area to be copied must be aligned with 4. Then, copy 4 bytes at per one read */
-        dataPad = size & 0x3U;
-        for(j = 0UL; j < ((size - dataPad) >> 2); j++)
-        {
-            ram[j] = rom[j];
-        }
-        /* For the rest of data, copy 1 bytes at per one read */
-        rom8 = (uint8 *)&(rom[j]);
-        ram8 = (uint8 *)&(ram[j]);
-        for (j = 0; j < dataPad; j++)
-        {
-            ram8[j] = rom8[j];
-        }
-    }
-    
+    Sys_CopyTable(0U);
+
     /* Clear zero table */
     len = *zeroTable_Ptr;
     zeroTable_Ptr++;
     zero_layout = (const Sys_ZeroLayoutType *)zeroTable_Ptr;
-    for(i = 0; i < len; i++)
+    for (i = 0; i < len; i++)
     {
-        ram = zero_layout[i].ram_start;
         size = (uint32)zero_layout[i].ram_end - (uint32)zero_layout[i].ram_start;
-
-        for(j = 0UL; j < (size >> 2); j++)
+        start = SYS_DWT_CYCCNT;
+        Sys_ZeroSection(zero_layout[i].ram_start, size);
+        if (i < OSAL_STARTUP_MAX_SECTIONS)
         {
-            ram[j] = 0U;
-        }
-        /* Since the size of the section always aligns with 32bits according to the sample file linker. 
-           Zeroing the last 4 bytes of the section if the data to be used of program does not align with 4.*/
-        if ((size & 0x3U) != 0)
-        {
-            ram[j] = 0;
+            osal_startup_stats.zero[i].addr = (uint32)zero_layout[i].ram_start;
+            osal_startup_stats.zero[i].size = size;
+            osal_startup_stats.zero[i].rom_size = 0U;
+            osal_startup_stats.zero[i].cycles = SYS_DWT_CYCCNT - start;
         }
     }
+    osal_startup_stats.zero_count = len;
+
+    osal_startup_stats.init_cycles = SYS_DWT_CYCCNT - entry;
+    osal_startup_stats.magic = OSAL_STARTUP_STATS_MAGIC;
 }
 
 void init_data_bss_core2(void)
 {
-    const Sys_CopyLayoutType * copy_layout;
-    const uint32 * rom;
-    const uint8 * rom8;
-    uint32 * ram;
-    uint8 * ram8;
-    uint8 dataPad;
-    uint32 len = 0U;
-    uint32 size = 0U;
-    uint32 i = 0U;
-    uint32 j = 0U;
-
-    const uint32 * initTable_Ptr = (uint32 *)__INIT_TABLE;
-
-    /* Copy initialized table */
-    len = *initTable_Ptr;
-    initTable_Ptr++;
-    copy_layout = (const Sys_CopyLayoutType *)initTable_Ptr;
-    for(i = (uint32)__INDEX_COPY_CORE2; i < len; i++)
-    {
-        rom = copy_layout[i].rom_start;
-        ram = copy_layout[i].ram_start;
-        size = (uint32)copy_layout[i].rom_end - (uint32)copy_layout[i].rom_start;
-        /* Make sure the data area to be copied must be aligned with 4. Then, copy 4 bytes at per one read */
-        dataPad = size & 0x3U;
-        for(j = 0UL; j < ((size - dataPad) >> 2); j++)
-        {
-            ram[j] = rom[j];
-        }
-        rom8 = (uint8 *)&(rom[j]);
-        ram8 = (uint8 *)&(ram[j]);
-        for (j = 0; j < dataPad; j++)
-        {
-            ram8[j] = rom8[j];
-        }
-    }
+    Sys_CopyTable((uint32)__INDEX_COPY_CORE2);
 }
 #define PLATFORM_STOP_SEC_CODE
 #include "Platform_MemMap.h"
@@ -61,6 +61,20 @@
 #define CM7_ITCMCR                  0xE000EF90
 #define CM7_DTCMCR                  0xE000EF94
 
+#define CM7_DEMCR                   0xE000EDFC
+#define CM7_DWT_CTRL                0xE0001000
+#define CM7_DWT_CYCCNT              0xE0001004
+#define CM7_DWT_LAR                 0xE0001FB0
+#define CM7_DEMCR_TRCENA            (1 << 24)
+#define CM7_DWT_LAR_KEY             0xC5ACCE55
+
+/* Boot profile record, see include/osal_boot_profile.h (keep in sync) */
+#define BOOT_PROFILE_MAGIC          0x424F4F54
+#define BOOT_PROFILE_STAMPS         4
+#define BOOT_PHASE_DATA_BSS         4
+#define BOOT_PHASE_FPU              5
+#define BOOT_PHASE_SYSTEM_INIT      6
+
 #define SBAF_BOOT_MARKER            (0x5AA55AA5)
 #define CM7_0_ENABLE_SHIFT          (0)
 #define CM7_1_ENABLE_SHIFT          (1)
@@ -174,6 +188,39 @@ _core_loop:
 /************************************************************************/
 .set VTOR_REG, 0xE000ED08
 .thumb
+
+/* Defined only when the application is built with BOOT_PROFILE_ENABLE */
+.weak osal_boot_profile
+
+/* Read the cycle counter into a register (usable before RAM is initialized) */
+.macro BOOT_STAMP_REG reg
+    ldr  \reg, =CM7_DWT_CYCCNT
+    ldr  \reg, [\reg]
+.endm
+
+/* ECC-initialize [start, end) with 64-bit stores (8-byte aligned bounds); clobbers r0-r3 */
+.macro ECC_INIT_RANGE start, end
+    ldr  r2, =\start
+    ldr  r3, =\end
+    movs r0, 0
+    movs r1, 0
+.Lecc_loop\@:
+    cmp  r2, r3
+    bge  .Lecc_done\@
+    strd r0, r1, [r2], #8
+    b    .Lecc_loop\@
+.Lecc_done\@:
+.endm
+
+/* Store the cycle counter as the end of a boot phase; clobbers r0, r1 */
+.macro BOOT_STAMP phase
+    ldr  r1, =osal_boot_profile
+    cbz  r1, .Lboot_stamp_skip\@
+    ldr  r0, =CM7_DWT_CYCCNT
+    ldr  r0, [r0]
+    str  r0, [r1, #(BOOT_PROFILE_STAMPS + 4 * \phase)]
+.Lboot_stamp_skip\@:
+.endm
 .thumb_func
 .globl Reset_Handler
 .globl _start
@@ -184,6 +231,21 @@ Reset_Handler:
 /*****************************************************/
 /* Disable System Interrupts */
  cpsid i
+/* Start the DWT cycle counter from zero: boot phases are timed from here */
+ ldr   r0, =CM7_DEMCR
+ ldr   r1, [r0]
+ orr   r1, r1, #CM7_DEMCR_TRCENA
+ str   r1, [r0]
+ ldr   r0, =CM7_DWT_LAR
+ ldr   r1, =CM7_DWT_LAR_KEY
+ str   r1, [r0]
+ ldr   r0, =CM7_DWT_CYCCNT
+ mov   r1, #0
+ str   r1, [r0]
+ ldr   r0, =CM7_DWT_CTRL
+ ldr   r1, [r0]
+ orr   r1, r1, #1
+ str   r1, [r0]
  /* Initialize GPRs */
  mov   r0, #0
  mov   r1, #0
@@ -193,6 +255,11 @@ Reset_Handler:
  mov   r5, #0
  mov   r6, #0
  mov   r7, #0
+ /* r8-r11 hold the boot phase stamps until SRAM is usable */
+ mov   r8, #0
+ mov   r9, #0
+ mov   r10, #0
+ mov   r11, #0
 
 /************************************************************************/
 /* Delay trap for debugger attachs before touching any peripherals      */
@@ -339,6 +406,9 @@ bic r0, r0, #0x4
 orr r0, r0, #0x1
 str r0, [r1]
 
+/* Boot phase: early platform setup (MSCM clock, watchdog, VTOR, TCM enable) */
+BOOT_STAMP_REG r8
+
 #if defined(MULTIPLE_CORE) && !defined(MULTIPLE_IMAGE)
 /*GetCoreID*/
 ldr r0, =0x40260004
@@ -364,6 +434,15 @@ bne DTCM_Init
 /* the MCU driver services and the caller of these services.      */
 /******************************************************************/
 RamInit:
+    /* Warm reset: no destructive reset since osal_reset_init() last cleared MC_RGM.DES, so
+       every RAM still holds valid ECC and the retained regions (.standby_data, .noinit) their
+       contents. Skip the ECC initialization of all RAMs; init_data_bss still sets up .data
+       and .bss */
+    ldr  r0, =MCRGM_DES
+    ldr  r1, [r0]
+    cmp  r1, 0
+    beq  WARM_RAM_INIT
+
     /* Initialize SRAM ECC */
     ldr  r0, =__RAM_INIT
     cmp  r0, 0
@@ -394,8 +473,14 @@ NO_INIT_STANDBY_REGION:
     ldr r3, =__INT_SRAM_END
 
 ZERO_64B_RAM:
+    /* Partial mode: only the allocated part of int_sram, then the other SRAM areas */
+    ldr r0, =__RAM_INIT_PARTIAL
+    cmp r0, 0
+    beq ZERO_64B_RAM_FULL
+    ldr r3, =__SRAM_USED_END
+ZERO_64B_RAM_FULL:
     cmp r2, r3
-    bge SRAM_LOOP_END
+    bge SRAM_PARTIAL
 
     movs    r0, 0
     movs    r1, 0
@@ -403,7 +488,17 @@ SRAM_LOOP:
     strd    r0, r1, [r2], #8
     cmp     r2, r3
     blt     SRAM_LOOP
+
+SRAM_PARTIAL:
+    ldr r0, =__RAM_INIT_PARTIAL
+    cmp r0, 0
+    beq SRAM_LOOP_END
+    ECC_INIT_RANGE __SRAM_FLS_RSV_START, __SRAM_FLS_RSV_END
+    ECC_INIT_RANGE __SRAM_NC_START, __SRAM_NC_USED_END
+    ECC_INIT_RANGE __SRAM_RESULTS_START, __SRAM_RESULTS_END
+    ECC_INIT_RANGE __SRAM_SH_START, __SRAM_SH_USED_END
 SRAM_LOOP_END:
+    BOOT_STAMP_REG r9
 
 DTCM_Init:
     /* Initialize DTCM ECC */
@@ -415,6 +510,14 @@ DTCM_Init:
     ldr r2, =__INT_DTCM_START
     ldr r3, =__INT_DTCM_END
 
+    /* Partial mode: allocated sections and the stack only */
+    ldr r0, =__RAM_INIT_PARTIAL
+    cmp r0, 0
+    beq DTCM_FULL
+    ECC_INIT_RANGE __Stack_dtcm_end, __Stack_dtcm_start
+    ldr r2, =__INT_DTCM_START
+    ldr r3, =__DTCM_USED_END
+DTCM_FULL:
     cmp r2, r3
     bge DTCM_LOOP_END
 
@@ -425,6 +528,7 @@ DTCM_LOOP:
     cmp     r2, r3
     blt     DTCM_LOOP
 DTCM_LOOP_END:
+    BOOT_STAMP_REG r10
 
 ITCM_Init:
     /* Initialize ITCM ECC */
@@ -436,6 +540,11 @@ ITCM_Init:
     ldr r2, =__INT_ITCM_START
     ldr r3, =__INT_ITCM_END
 
+    ldr r0, =__RAM_INIT_PARTIAL
+    cmp r0, 0
+    beq ITCM_FULL
+    ldr r3, =__ITCM_USED_END
+ITCM_FULL:
     cmp r2, r3
     bge ITCM_LOOP_END
 
@@ -446,6 +555,27 @@ ITCM_LOOP:
     cmp     r2, r3
     blt     ITCM_LOOP
 ITCM_LOOP_END:
+    BOOT_STAMP_REG r11
+    b    RAM_INIT_END
+
+WARM_RAM_INIT:
+    /* The ECC phases take no time */
+    BOOT_STAMP_REG r9
+    mov  r10, r9
+    mov  r11, r9
+
+RAM_INIT_END:
+
+    /* RAM is usable: flush the early stamps to the boot profile record */
+    ldr  r1, =osal_boot_profile
+    cbz  r1, BOOT_PROFILE_FLUSH_END
+    ldr  r0, =BOOT_PROFILE_MAGIC
+    str  r0, [r1]
+    str  r8, [r1, #(BOOT_PROFILE_STAMPS + 0)]
+    str  r9, [r1, #(BOOT_PROFILE_STAMPS + 4)]
+    str  r10, [r1, #(BOOT_PROFILE_STAMPS + 8)]
+    str  r11, [r1, #(BOOT_PROFILE_STAMPS + 12)]
+BOOT_PROFILE_FLUSH_END:
 
 DebuggerHeldCoreLoop:
     ldr  r0, =RESET_CATCH_CORE
@@ -565,6 +695,7 @@ _INIT_DATA_BSS:
   bl init_data_bss
 
 SET_VTOR_TCM:
+  BOOT_STAMP BOOT_PHASE_DATA_BSS
 /* Set VTOR to default vector table */
 ldr  r0, =VTOR_REG
 ldr  r1, =__RAM_INTERRUPT_START
@@ -576,6 +707,7 @@ str  r1,[r0]
 /* instruction which required involvement of FPU co-processor  */
 /***************************************************************/
   bl   Enable_FPU
+  BOOT_STAMP BOOT_PHASE_FPU
 
 /******************************************************************/
 /* Autosar Guidance   - If the MCU supports cache memory for data */
@@ -614,6 +746,7 @@ str  r1,[r0]
 /******************************************************************/
 __SYSTEM_INIT:
   bl SystemInit
+  BOOT_STAMP BOOT_PHASE_SYSTEM_INIT
 
 /******************************************************************/
 /* Autosar Guidance   - The start-up code shall ensure that the   */
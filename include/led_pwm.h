@@ -0,0 +1,79 @@
+#ifndef LED_PWM_H_
+#define LED_PWM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// PIT0 channel dedicated to the PWM engine (PitChannel_1, notification led_pwm_pit_callback)
+#define LED_PWM_PIT_INSTANCE 0U
+#define LED_PWM_PIT_CHANNEL 1U
+// PIT0_CLK from the clock configuration
+#define LED_PWM_PIT_CLOCK_HZ 30000000UL
+// PWM frame rate: every LED completes one 8-bit period per frame
+#define LED_PWM_FRAME_HZ 200UL
+
+typedef enum {
+    LED_PWM_GREEN = 0,
+    LED_PWM_BLUE,
+    LED_PWM_RED,
+    LED_PWM_COUNT
+} led_pwm_led_t;
+
+// CPU overhead of the PWM interrupt per frame (8 interrupts), in core cycles
+typedef struct {
+    uint32_t frames;
+    uint32_t cycles_last;
+    uint32_t cycles_max;
+    uint32_t frame_cycles;  // Core cycles in one PWM frame, for percentage calculations
+} led_pwm_stats_t;
+
+/**
+ * Start software PWM on the three LEDs using PIT0 channel 1.
+ * Uses binary code modulation: one interrupt per duty bit (8 per frame), each slice twice
+ * as long as the previous one, so the CPU cost is constant regardless of the duty values.
+ * While running, the PWM engine owns the LED pins.
+ */
+void led_pwm_start(void);
+
+/**
+ * Stop the PWM engine and switch all LEDs off.
+ */
+void led_pwm_stop(void);
+
+/**
+ * Check whether the PWM engine drives the LEDs.
+ * @return: true between led_pwm_start() and led_pwm_stop().
+ */
+bool led_pwm_running(void);
+
+/**
+ * Set the raw 8-bit duty of one LED. Takes effect at the next frame boundary.
+ * @param led: LED to change.
+ * @param duty: 0 (off) .. 255 (always on).
+ */
+void led_pwm_set_duty(led_pwm_led_t led, uint8_t duty);
+
+/**
+ * Set the perceived brightness of one LED through the gamma 2.2 curve.
+ * @param led: LED to change.
+ * @param level: 0 (off) .. 255 (full brightness).
+ */
+void led_pwm_set_brightness(led_pwm_led_t led, uint8_t level);
+
+/**
+ * PIT0 channel 1 notification; referenced by the generated PIT configuration.
+ */
+void led_pwm_pit_callback(void);
+
+/**
+ * Copy the CPU overhead statistics.
+ * @param stats: Output structure.
+ */
+void led_pwm_get_stats(led_pwm_stats_t *stats);
+
+/**
+ * Log the CPU overhead per PWM period via osal_log_info.
+ */
+void led_pwm_log_stats(void);
+
+#endif /* LED_PWM_H_ */
@@ -0,0 +1,41 @@
+#ifndef OSAL_BOOT_PROFILE_H_
+#define OSAL_BOOT_PROFILE_H_
+
+#include <stdint.h>
+
+// Record layout is shared with startup_cm7.s (BOOT_PROFILE_* constants there)
+#define OSAL_BOOT_PROFILE_MAGIC 0x424F4F54UL
+
+// Reset path phases, in execution order. The stamp of a phase is the DWT cycle count
+// (started from zero at Reset_Handler entry) when the phase ends.
+typedef enum {
+    OSAL_BOOT_PHASE_EARLY = 0,    // Debugger trap, MSCM clock, watchdog, VTOR, TCM enable
+    OSAL_BOOT_PHASE_SRAM_ECC,     // RamInit: SRAM ECC initialization
+    OSAL_BOOT_PHASE_DTCM_ECC,
+    OSAL_BOOT_PHASE_ITCM_ECC,
+    OSAL_BOOT_PHASE_DATA_BSS,     // init_data_bss (see osal_startup.h for the per-section split)
+    OSAL_BOOT_PHASE_FPU,          // Enable_FPU
+    OSAL_BOOT_PHASE_SYSTEM_INIT,  // SystemInit: MPU and caches
+    OSAL_BOOT_PHASE_MAIN,         // startup_go_to_user_mode and C entry, up to osal_boot_profile_mark_main()
+    OSAL_BOOT_PHASE_COUNT
+} osal_boot_phase_t;
+
+// Placed in .noinit; only defined (and filled by the startup code) with BOOT_PROFILE_ENABLE
+typedef struct {
+    uint32_t magic;
+    uint32_t stamps[OSAL_BOOT_PHASE_COUNT];
+} osal_boot_profile_t;
+
+/**
+ * Stamp the end of the reset path. Call first thing in main().
+ * Does nothing unless built with BOOT_PROFILE_ENABLE.
+ */
+void osal_boot_profile_mark_main(void);
+
+/**
+ * Log the duration of every boot phase and the total reset-to-main time via osal_log_info.
+ * Does nothing unless built with BOOT_PROFILE_ENABLE.
+ */
+void osal_boot_profile_log(void);
+
+#endif /* OSAL_BOOT_PROFILE_H_ */
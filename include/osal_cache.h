@@ -0,0 +1,105 @@
+#ifndef OSAL_CACHE_H_
+#define OSAL_CACHE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Cortex-M7 L1 data cache line size
+#define OSAL_CACHE_LINE_SIZE 32U
+// S32K312 L1 data cache size; past this a set/way flush touches fewer lines than a range
+#define OSAL_CACHE_DCACHE_SIZE 8192U
+
+// Align a DMA buffer in cacheable memory to whole cache lines (its size must be a multiple too)
+#define OSAL_CACHE_ALIGNED __attribute__((aligned(OSAL_CACHE_LINE_SIZE)))
+#define OSAL_CACHE_ROUND_UP(size) (((size) + OSAL_CACHE_LINE_SIZE - 1U) & ~(size_t)(OSAL_CACHE_LINE_SIZE - 1U))
+
+// Ownership of a DMA buffer; the cache maintenance needed is done on every transition
+typedef enum {
+    OSAL_DMA_BUF_CPU = 0,         // CPU reads and writes it through the cache
+    OSAL_DMA_BUF_TO_DEVICE,       // Cleaned to memory; a DMA master reads it, CPU must not write
+    OSAL_DMA_BUF_FROM_DEVICE      // Invalidated; a DMA master writes it, CPU must not touch it
+} osal_dma_buf_state_t;
+
+// DMA buffer descriptor. Buffers outside cacheable SRAM skip the maintenance.
+typedef struct {
+    void *addr;
+    size_t size;
+    uint8_t cacheable;
+    uint8_t state;                // osal_dma_buf_state_t
+} osal_dma_buf_t;
+
+/**
+ * Check whether the L1 data cache is enabled (CCR.DC).
+ * @return: 1 if enabled, 0 otherwise.
+ */
+uint32_t osal_cache_dcache_enabled(void);
+
+/**
+ * Write dirty lines covering [addr, addr + size) back to memory (DCCMVAC). Lines stay valid.
+ * Use before a DMA master reads memory the CPU has written.
+ * @param addr: Start address; rounded down to a cache line.
+ * @param size: Size in bytes; the end is rounded up to a cache line.
+ */
+void osal_cache_clean_range(const void *addr, size_t size);
+
+/**
+ * Discard lines covering [addr, addr + size) without writing them back (DCIMVAC).
+ * Use before the CPU reads memory a DMA master has written. Partial lines at either end are
+ * cleaned and invalidated instead, so bytes outside the range are never lost.
+ * @param addr: Start address.
+ * @param size: Size in bytes.
+ */
+void osal_cache_invalidate_range(void *addr, size_t size);
+
+/**
+ * Clean and invalidate lines covering [addr, addr + size) (DCCIMVAC).
+ * @param addr: Start address; rounded down to a cache line.
+ * @param size: Size in bytes; the end is rounded up to a cache line.
+ */
+void osal_cache_flush_range(const void *addr, size_t size);
+
+/**
+ * Clean and invalidate the whole data cache by set/way.
+ */
+void osal_cache_flush_all(void);
+
+/**
+ * Invalidate the whole data cache by set/way, discarding dirty lines.
+ */
+void osal_cache_invalidate_all(void);
+
+/**
+ * Describe a DMA buffer. A buffer in cacheable SRAM must start and end on cache line
+ * boundaries (OSAL_CACHE_ALIGNED, OSAL_CACHE_ROUND_UP) so invalidation cannot hit its neighbours.
+ * The buffer starts owned by the CPU.
+ * @param buf: Descriptor to fill.
+ * @param addr: Buffer start.
+ * @param size: Buffer size in bytes.
+ * @return: 0 on success, -1 on invalid arguments, -2 if a cacheable buffer is not line aligned.
+ */
+int32_t osal_dma_buf_init(osal_dma_buf_t *buf, void *addr, size_t size);
+
+/**
+ * Hand the buffer to a DMA master that reads it (memory to peripheral). Cleans the cache.
+ * @param buf: Buffer owned by the CPU.
+ * @return: 0 on success, -1 if the buffer is not owned by the CPU.
+ */
+int32_t osal_dma_buf_to_device(osal_dma_buf_t *buf);
+
+/**
+ * Hand the buffer to a DMA master that writes it (peripheral to memory). Cleans and invalidates
+ * the cache so no dirty line can be evicted over the incoming data.
+ * @param buf: Buffer owned by the CPU.
+ * @return: 0 on success, -1 if the buffer is not owned by the CPU.
+ */
+int32_t osal_dma_buf_from_device(osal_dma_buf_t *buf);
+
+/**
+ * Take the buffer back once the transfer is complete. After a device-to-memory transfer the
+ * range is invalidated again, dropping lines the core may have fetched speculatively meanwhile.
+ * @param buf: Buffer owned by a DMA master.
+ * @return: 0 on success, -1 if the buffer is already owned by the CPU.
+ */
+int32_t osal_dma_buf_to_cpu(osal_dma_buf_t *buf);
+
+#endif /* OSAL_CACHE_H_ */
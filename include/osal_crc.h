@@ -0,0 +1,105 @@
+#ifndef OSAL_CRC_H_
+#define OSAL_CRC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// eDMA channel that feeds the CRC engine in DMA mode (software started, no DMAMUX source)
+#define OSAL_CRC_DMA_CHANNEL 11U
+// Bytes fed by the CPU per critical section; the engine is shared, so each chunk reloads it
+#define OSAL_CRC_CHUNK 256U
+
+// Protocols of the AUTOSAR Crc library / E2E profiles
+typedef enum {
+    OSAL_CRC_32 = 0,           // IEEE 802.3: poly 0x04C11DB7, reflected, init/xorout 0xFFFFFFFF
+    OSAL_CRC_16_CCITT,         // CCITT-FALSE: poly 0x1021, init 0xFFFF, no xorout (E2E P5/P6)
+    OSAL_CRC_8_SAE_J1850,      // SAE J1850: poly 0x1D, init/xorout 0xFF (E2E P1/P2)
+    OSAL_CRC_PROTOCOL_COUNT
+} osal_crc_protocol_t;
+
+// Running CRC. The engine register is saved here between calls, so several contexts can
+// be interleaved on the single CRC peripheral.
+typedef struct {
+    osal_crc_protocol_t protocol;
+    uint32_t state;            // Engine register (before output reflection and XOR)
+    const uint8_t *tail;       // Bytes the CPU still feeds when a DMA job completes
+    uint32_t tail_len;
+} osal_crc_ctx_t;
+
+/**
+ * Start a CRC.
+ * @param ctx: Context to initialize.
+ * @param protocol: Protocol to compute.
+ * @return: 0 on success, -1 if protocol is invalid.
+ */
+int32_t osal_crc_start(osal_crc_ctx_t *ctx, osal_crc_protocol_t protocol);
+
+/**
+ * Feed data through the CRC engine with the CPU (32-bit writes, bytes at unaligned edges).
+ * @param ctx: Running CRC.
+ * @param data: Input bytes.
+ * @param len: Number of bytes.
+ * @return: 0 on success, -3 if a DMA job owns the engine.
+ */
+int32_t osal_crc_update(osal_crc_ctx_t *ctx, const void *data, size_t len);
+
+/**
+ * Get the CRC of everything fed so far. The context stays usable.
+ * @param ctx: Running CRC.
+ * @return: CRC value (8, 16 or 32 bits wide).
+ */
+uint32_t osal_crc_final(const osal_crc_ctx_t *ctx);
+
+/**
+ * Compute the CRC of one buffer with the CPU-fed engine.
+ * @param protocol: Protocol to compute.
+ * @param data: Input bytes.
+ * @param len: Number of bytes.
+ * @return: CRC value, 0 if protocol is invalid or the engine is busy.
+ */
+uint32_t osal_crc_compute(osal_crc_protocol_t protocol, const void *data, size_t len);
+
+/**
+ * Feed a flash or SRAM range to the engine by DMA and return immediately. The CPU writes the
+ * unaligned head now and the unaligned tail in osal_crc_dma_poll(). Cacheable SRAM is
+ * cleaned first. Only one job runs at a time; osal_crc_update() is refused meanwhile.
+ * @param ctx: Running CRC.
+ * @param data: Input bytes in program/data flash or SRAM (not TCM).
+ * @param len: Number of bytes.
+ * @return: 0 if started, -1 on a NULL argument, -2 if the range is not reachable by DMA,
+ *          -3 if a job is already running.
+ */
+int32_t osal_crc_dma_start(osal_crc_ctx_t *ctx, const void *data, size_t len);
+
+/**
+ * Check a DMA job and finish it once the transfer is done.
+ * @param ctx: Context passed to osal_crc_dma_start().
+ * @return: 1 while running, 0 when done (ctx is up to date), -4 on a DMA error.
+ */
+int32_t osal_crc_dma_poll(osal_crc_ctx_t *ctx);
+
+/**
+ * Bitwise software CRC, the reference for the engine.
+ * @param protocol: Protocol to compute.
+ * @param data: Input bytes.
+ * @param len: Number of bytes.
+ * @return: CRC value, 0 if protocol is invalid.
+ */
+uint32_t osal_crc_reference(osal_crc_protocol_t protocol, const void *data, size_t len);
+
+/**
+ * Cross-check the engine (CPU and DMA fed) against the reference and the standard check
+ * values, and CRC-32 against osal_crc32().
+ * @return: 0 if everything matches, -1 otherwise.
+ */
+int32_t osal_crc_selftest(void);
+
+/**
+ * Measure the throughput of software CRC-32, the CPU-fed and the DMA-fed engine over a
+ * buffer, and log it via osal_log_info.
+ * @param data: Buffer in flash or SRAM.
+ * @param len: Number of bytes.
+ */
+void osal_crc_log_benchmark(const void *data, size_t len);
+
+#endif /* OSAL_CRC_H_ */
@@ -0,0 +1,34 @@
+#ifndef OSAL_CRC32_H_
+#define OSAL_CRC32_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// CRC-32 as used by zlib and Ethernet: reflected polynomial 0x04C11DB7, initial value and
+// final XOR 0xFFFFFFFF. Matches zlib.crc32() on the host.
+#define OSAL_CRC32_POLY_REFLECTED 0xEDB88320UL
+
+/**
+ * Build the slicing-by-8 tables (8 KB in DTCM). Called by the first osal_crc32_update()
+ * if not called before.
+ */
+void osal_crc32_init(void);
+
+/**
+ * Continue a CRC over more data, eight bytes per step.
+ * @param crc: Value returned for the preceding data, 0 to start.
+ * @param data: Input bytes.
+ * @param len: Number of bytes.
+ * @return: CRC of all data so far.
+ */
+uint32_t osal_crc32_update(uint32_t crc, const void *data, size_t len);
+
+/**
+ * Compute the CRC of one buffer.
+ * @param data: Input bytes.
+ * @param len: Number of bytes.
+ * @return: CRC-32 of the buffer.
+ */
+uint32_t osal_crc32(const void *data, size_t len);
+
+#endif /* OSAL_CRC32_H_ */
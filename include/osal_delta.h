@@ -0,0 +1,73 @@
+#ifndef OSAL_DELTA_H_
+#define OSAL_DELTA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Delta patch applier: rebuilds a new image from the old one (read from flash) and a patch
+// produced by tools/delta_patch.py, in bsdiff style. The patch is a sequence of records:
+//   varint diff_len, varint extra_len, zigzag varint seek,
+//   diff:  diff_len bytes, new = old + diff (mod 256) starting at the old position; a zero
+//          diff byte is followed by a varint n and stands for n + 1 zero bytes (copied runs)
+//   extra: extra_len literal bytes
+// after which the old position advances by diff_len + seek. Varints are LEB128.
+// Code moved between slots differs from the old image mostly in a few bytes per pointer, so
+// the diff is dominated by zero runs. State is a few words: the applier needs no buffer
+// beyond the output handed to it, whatever the image size.
+
+typedef enum {
+    OSAL_DELTA_DIFF_LEN,
+    OSAL_DELTA_EXTRA_LEN,
+    OSAL_DELTA_SEEK,
+    OSAL_DELTA_DIFF,
+    OSAL_DELTA_ZERO_RUN,
+    OSAL_DELTA_EXTRA
+} osal_delta_state_t;
+
+typedef struct {
+    uint32_t old_base;            // Flash address of the old image
+    uint32_t old_size;
+    uint32_t new_size;
+    uint32_t old_pos;             // Offset in the old image of the next diff byte
+    uint32_t new_pos;             // Bytes produced
+    uint32_t diff_left;
+    uint32_t extra_left;
+    uint32_t run_left;            // Zero diff bytes still to produce
+    uint32_t next_old;            // old_pos after the record
+    uint32_t varint;
+    uint32_t shift;
+    osal_delta_state_t state;
+} osal_delta_t;
+
+/**
+ * Start applying a patch.
+ * @param d: Applier state.
+ * @param old_base: Flash address of the old image.
+ * @param old_size: Size of the old image.
+ * @param new_size: Size of the image the patch produces.
+ */
+void osal_delta_init(osal_delta_t *d, uint32_t old_base, uint32_t old_size, uint32_t new_size);
+
+/**
+ * Decode patch bytes into new image bytes until the input is used up or the output is full.
+ * Input may be split anywhere.
+ * @param d: Applier state.
+ * @param in: Patch bytes.
+ * @param in_len: Number of patch bytes.
+ * @param consumed: Output, patch bytes used.
+ * @param out: New image bytes, continuing where the last call stopped.
+ * @param out_len: Space in out.
+ * @param produced: Output, bytes written to out.
+ * @return: 0 on success, -1 if the patch is corrupt (a range outside either image).
+ */
+int32_t osal_delta_apply(osal_delta_t *d, const uint8_t *in, uint32_t in_len, uint32_t *consumed,
+                         uint8_t *out, uint32_t out_len, uint32_t *produced);
+
+/**
+ * Check that the whole new image was produced and the patch ended on a record boundary.
+ * @param d: Applier state.
+ * @return: true if complete.
+ */
+bool osal_delta_done(const osal_delta_t *d);
+
+#endif /* OSAL_DELTA_H_ */
@@ -0,0 +1,103 @@
+#ifndef OSAL_DEVINFO_H_
+#define OSAL_DEVINFO_H_
+
+#include <stdint.h>
+#include "osal_fwupd.h"
+#include "osal_heap.h"
+
+// Device info service: on request (UART command 'D') the target answers with one binary frame, framed
+// as in osal_fwupd.h (SOF, type, seq 0, len, payload, CRC-32), so fleet tooling decodes it
+// without parsing text (tools/dev_info.py). Payload, little-endian, fixed offsets:
+//   0x00 u8  format (OSAL_DEVINFO_FORMAT)     0x01 u8  running slot (0xFF: none)
+//   0x02 i8  osal_image_verify() at boot      0x03 i8  osal_secboot_verify() at boot
+//   0x04 app_name[16]  0x14 version[12]  0x20 build timestamp[24] (NUL padded)
+//   0x38 u32 version_code  0x3C sequence  0x40 flash_start  0x44 image_size
+//   0x48 u32 stamped CRC-32  0x4C CRC-32 computed at boot  0x50 sha256[32]
+//   0x70 u32 MBEDTLS_VERSION_NUMBER  0x74 features (OSAL_DEVINFO_FEAT_*)
+//   0x78 u32 MC_RGM.DES  0x7C FES  0x80 time to operational (us)
+//   0x84 u32 main stack used  0x88 main stack size
+//   0x8C u16 key-value keys  0x8E u8 free data flash sectors  0x8F u8 heap regions (n)
+//   0x90 u32 faults recorded
+//   0x94 n x { u32 flags, size, used, used_peak }
+#define OSAL_DEVINFO_FRAME 0x84U
+#define OSAL_DEVINFO_FORMAT 1U
+#define OSAL_DEVINFO_NAME_LEN 16U
+#define OSAL_DEVINFO_VERSION_LEN 12U
+#define OSAL_DEVINFO_BUILD_LEN 24U
+#define OSAL_DEVINFO_FIXED_LEN 0x94U
+#define OSAL_DEVINFO_REGION_LEN 16U
+#define OSAL_DEVINFO_PAYLOAD_MAX (OSAL_DEVINFO_FIXED_LEN + (OSAL_HEAP_MAX_REGIONS * OSAL_DEVINFO_REGION_LEN))
+#define OSAL_DEVINFO_FRAME_MAX (OSAL_FWUPD_HDR_LEN + OSAL_DEVINFO_PAYLOAD_MAX + 4U)
+
+// Features
+#define OSAL_DEVINFO_FEAT_BOOT_PROFILE (1UL << 0)   // Built with BOOT_PROFILE_ENABLE
+#define OSAL_DEVINFO_FEAT_SECBOOT_KEY  (1UL << 1)   // Signature key provisioned
+#define OSAL_DEVINFO_FEAT_WARM_BOOT    (1UL << 2)   // This boot came through a warm reset
+#define OSAL_DEVINFO_FEAT_CLOCKS_KEPT  (1UL << 3)   // ...and reused the clock configuration
+#define OSAL_DEVINFO_FEAT_RAM_PARTIAL  (1UL << 4)   // Linked with __RAM_INIT_PARTIAL
+#define OSAL_DEVINFO_FEAT_FWUPD        (1UL << 5)   // 'U' update receiver, full images
+#define OSAL_DEVINFO_FEAT_FWUPD_DELTA  (1UL << 6)   // ...and delta patches
+#define OSAL_DEVINFO_FEAT_KV           (1UL << 7)   // Key-value store mounted
+#define OSAL_DEVINFO_FEAT_FAULT_LOG    (1UL << 8)   // Fault capture to .noinit and data flash
+
+typedef struct {
+    uint32_t flags;
+    uint32_t size;
+    uint32_t used;
+    uint32_t used_peak;
+} osal_devinfo_region_t;
+
+typedef struct {
+    uint8_t slot;
+    int8_t image_status;
+    int8_t secboot_status;
+    char app_name[OSAL_DEVINFO_NAME_LEN];
+    char version[OSAL_DEVINFO_VERSION_LEN];
+    char build[OSAL_DEVINFO_BUILD_LEN];
+    uint32_t version_code;
+    uint32_t sequence;
+    uint32_t flash_start;
+    uint32_t image_size;
+    uint32_t crc32;
+    uint32_t crc32_computed;
+    uint8_t sha256[32];
+    uint32_t mbedtls_version;
+    uint32_t features;
+    uint32_t reset_des;
+    uint32_t reset_fes;
+    uint32_t operational_us;
+    uint32_t stack_used;
+    uint32_t stack_size;
+    uint16_t kv_keys;
+    uint8_t kv_free_sectors;
+    uint8_t regions;
+    uint32_t faults;
+    osal_devinfo_region_t region[OSAL_HEAP_MAX_REGIONS];
+} osal_devinfo_t;
+
+/**
+ * Encode a device info frame.
+ * @param info: Values to send.
+ * @param frame: Output, OSAL_DEVINFO_FRAME_MAX bytes.
+ * @return: Frame length.
+ */
+uint32_t osal_devinfo_encode(const osal_devinfo_t *info, uint8_t *frame);
+
+#ifndef __linux__
+#include "osal_image.h"
+#include "osal_secboot.h"
+
+/**
+ * Keep the results of the boot-time image checks for the info frame.
+ * @param image: Result of osal_image_verify().
+ * @param secboot: Result of osal_secboot_verify().
+ */
+void osal_devinfo_note_boot(const osal_image_check_t *image, const osal_secboot_report_t *secboot);
+
+/**
+ * Collect the current values and send the info frame on LPUART6.
+ */
+void osal_devinfo_send(void);
+#endif
+
+#endif /* OSAL_DEVINFO_H_ */
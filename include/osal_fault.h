@@ -0,0 +1,89 @@
+#ifndef OSAL_FAULT_H_
+#define OSAL_FAULT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Crash capture. HardFault, MemManage, BusFault and UsageFault switch to a private stack
+// (the faulting one may be the overflowed main stack), snapshot the stacked registers, the
+// fault status registers and the stack above the exception frame into a .noinit record and
+// request a functional reset. Capture is a few hundred cycles, well inside any watchdog
+// window. The record survives every reset but a power-on one, which is the only case where
+// the startup code clears .noinit; other destructive resets keep it as well. Its magic and
+// check word are what reject stale or half-written data. osal_fault_boot_report() logs it
+// and commits it to the key-value store.
+
+// Set in osal_fault_record_t.magic when a capture is complete
+#define OSAL_FAULT_MAGIC 0x544C5546UL   // "FULT"
+// Words of stack kept above the exception frame
+#define OSAL_FAULT_STACK_WORDS 32U
+
+// Key-value store keys: last fault record and the number of faults recorded
+#define OSAL_FAULT_KV_RECORD 0x0F01U
+#define OSAL_FAULT_KV_COUNT 0x0F02U
+
+// osal_fault_record_t.flags
+#define OSAL_FAULT_FLAG_PSP 0x01U       // Faulted in a kernel task (process stack)
+#define OSAL_FAULT_FLAG_FPU 0x02U       // Extended frame with FPU state
+#define OSAL_FAULT_FLAG_NO_FRAME 0x04U  // Stacking failed, registers and stack not captured
+
+typedef struct {
+    uint32_t magic;
+    uint32_t exception;           // IPSR: 3 HardFault, 4 MemManage, 5 BusFault, 6 UsageFault
+    uint32_t flags;
+    uint32_t exc_return;
+    uint32_t sp;                  // Stack pointer before the fault
+    uint32_t r0;
+    uint32_t r1;
+    uint32_t r2;
+    uint32_t r3;
+    uint32_t r12;
+    uint32_t lr;
+    uint32_t pc;
+    uint32_t xpsr;
+    uint32_t cfsr;
+    uint32_t hfsr;
+    uint32_t mmfar;
+    uint32_t bfar;
+    uint32_t afsr;
+    uint32_t cycles;              // DWT cycle counter at the fault
+    uint32_t stack_words;         // Valid words in stack[]
+    uint32_t stack[OSAL_FAULT_STACK_WORDS];
+    uint32_t check;               // Inverted XOR of the words above
+} osal_fault_record_t;
+
+/**
+ * Enable the MemManage, BusFault and UsageFault exceptions, so these faults are reported as
+ * such instead of escalating to HardFault.
+ */
+void osal_fault_init(void);
+
+/**
+ * Whether a complete fault capture is waiting to be reported (magic and check word valid).
+ * Safe to call before board initialization: it only reads the .noinit record.
+ * @return: true if osal_fault_boot_report() has a record to log and store.
+ */
+bool osal_fault_pending(void);
+
+/**
+ * If the last reset was caused by a captured fault, log the record, store it in the
+ * key-value store (OSAL_FAULT_KV_RECORD, OSAL_FAULT_KV_COUNT) and clear it. Call after
+ * osal_kv_init().
+ * @return: 1 if a fault was reported, 0 if none, or a negative osal_kv_set() error (the
+ *          record is kept for the next boot).
+ */
+int32_t osal_fault_boot_report(void);
+
+/**
+ * Number of faults recorded in the key-value store, as read and updated by
+ * osal_fault_boot_report(); no flash access.
+ * @return: Fault count, 0 before osal_fault_boot_report().
+ */
+uint32_t osal_fault_count(void);
+
+/**
+ * Log the fault record stored in the key-value store and the fault count.
+ */
+void osal_fault_log_stored(void);
+
+#endif /* OSAL_FAULT_H_ */
@@ -0,0 +1,134 @@
+#ifndef OSAL_FLASH_H_
+#define OSAL_FLASH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// C40 flash geometry: 8 KB erase sectors, programmed in 8-byte double words (one ECC word)
+// up to one 128-byte page per operation. Program flash is two 1 MB blocks; the C40 cannot
+// read a block while it erases or programs it, so code must not run from the block it writes.
+#define OSAL_FLASH_SECTOR_SIZE 0x2000UL
+#define OSAL_FLASH_PAGE_SIZE 128U
+#define OSAL_FLASH_WRITE_UNIT 8U
+#define OSAL_FLASH_BLOCK_SIZE 0x00100000UL
+
+// Writable ranges: the application area of program flash (not the bootloader below nor the
+// HSE firmware above it) and the whole data flash
+#define OSAL_FLASH_PFLASH_START 0x00440000UL
+#define OSAL_FLASH_PFLASH_END   0x005D4000UL
+#define OSAL_FLASH_DFLASH_START 0x10000000UL
+#define OSAL_FLASH_DFLASH_END   0x10020000UL
+
+// Operation counters since boot
+typedef struct {
+    uint32_t erases;
+    uint32_t programs;            // Page operations
+    uint32_t errors;              // Failed operations (PEG clear or a protection/sequence error)
+} osal_flash_stats_t;
+
+/**
+ * Start erasing one sector and return without waiting: the CPU keeps running (from another
+ * block, TCM or RAM) while the C40 erases. Complete it with osal_flash_poll().
+ * @param addr: Sector start address.
+ * @return: 0 if started, -1 if the address is not a writable sector start, -2 if busy.
+ */
+int32_t osal_flash_erase_start(uint32_t addr);
+
+/**
+ * Start programming up to one page without waiting.
+ * @param addr: Destination, 8-byte aligned.
+ * @param data: Source bytes (copied into the controller before this returns).
+ * @param len: Multiple of 8, the range must not cross a 128-byte page.
+ * @return: 0 if started, -1 on a bad address or length, -2 if busy.
+ */
+int32_t osal_flash_program_start(uint32_t addr, const void *data, uint32_t len);
+
+/**
+ * Check the operation in progress; on completion the cache lines of the range are
+ * invalidated so reads see the new content.
+ * @return: 1 while busy, 0 when done (or idle), -1 if the operation failed.
+ */
+int32_t osal_flash_poll(void);
+
+/**
+ * Wait for the operation in progress.
+ * @return: 0 on success, -1 if it failed.
+ */
+int32_t osal_flash_wait(void);
+
+/**
+ * Erase one sector and wait.
+ * @param addr: Sector start address.
+ * @return: 0 on success, -1 on a bad address or failure, -2 if busy.
+ */
+int32_t osal_flash_erase(uint32_t addr);
+
+/**
+ * Program a range page by page and wait.
+ * @param addr: Destination, 8-byte aligned.
+ * @param data: Source bytes.
+ * @param len: Multiple of 8.
+ * @return: 0 on success, -1 on a bad range or failure, -2 if busy.
+ */
+int32_t osal_flash_program(uint32_t addr, const void *data, uint32_t len);
+
+/**
+ * Read flash into a buffer (through the host model on a host build).
+ * @param addr: Source address.
+ * @param buf: Destination.
+ * @param len: Number of bytes.
+ */
+void osal_flash_read(uint32_t addr, void *buf, uint32_t len);
+
+/**
+ * Read flash like osal_flash_read(), but report an uncorrectable ECC error instead of taking
+ * a bus fault. A double word whose program or erase was cut short by a reset holds a mix of
+ * old and new bits that fails its ECC; scans of flash written in the field use this.
+ * @param addr: Source address.
+ * @param buf: Destination (undefined after an error).
+ * @param len: Number of bytes.
+ * @return: 0 on success, -1 if a double word of the range has an ECC error.
+ */
+int32_t osal_flash_read_checked(uint32_t addr, void *buf, uint32_t len);
+
+/**
+ * Check that a range reads as erased (all 0xFF); a range with an ECC error is not.
+ * @param addr: Start address.
+ * @param len: Number of bytes.
+ * @return: true if erased.
+ */
+bool osal_flash_is_erased(uint32_t addr, uint32_t len);
+
+/**
+ * Operation counters.
+ * @param stats: Output.
+ */
+void osal_flash_get_stats(osal_flash_stats_t *stats);
+
+#ifdef __linux__
+/**
+ * Host model: flash contents backing an address range, e.g. for osal_slot_flash_image().
+ * @param addr: Start of the range (the program or data flash start).
+ * @param size: Output size of the modelled range.
+ * @return: Model memory for addr, NULL if addr is not modelled.
+ */
+uint8_t *osal_flash_model(uint32_t addr, uint32_t *size);
+
+/**
+ * Host model: number of osal_flash_poll() calls an erase and a page program stay busy.
+ * @param erase_polls: Polls per sector erase.
+ * @param program_polls: Polls per page program.
+ */
+void osal_flash_model_timing(uint32_t erase_polls, uint32_t program_polls);
+
+/**
+ * Host model: cut a program short, as a reset would. Once bytes more bytes have been
+ * programmed, the page program in progress stops and fails: the double word at the cut gets
+ * only part of its bits and fails its ECC. osal_flash_read_checked() reports it, a plain
+ * osal_flash_read() of it aborts (a bus fault on the target), and erasing its sector clears it.
+ * @param bytes: Bytes programmed before the cut, UINT32_MAX for none.
+ */
+void osal_flash_model_cut(uint32_t bytes);
+#endif
+
+#endif /* OSAL_FLASH_H_ */
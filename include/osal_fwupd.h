@@ -0,0 +1,113 @@
+#ifndef OSAL_FWUPD_H_
+#define OSAL_FWUPD_H_
+
+#include <stdint.h>
+#include "osal_slot.h"
+
+// Firmware update receiver: streams an image into the inactive slot (osal_slot.h).
+//
+// Frame: SOF, type, seq (u16 LE), len (u16 LE), payload[len], CRC-32 (LE) over type..payload.
+//   host -> target  START  payload: slot base, image size, image CRC-32 (u32 LE each); for a
+//                          delta update also the patch size and the CRC-32 of the running image
+//                   DATA   seq = chunk index, payload = bytes at seq * OSAL_FWUPD_CHUNK of the
+//                          image, or of the patch (osal_delta.h) against the running slot
+//                   END    payload = the slot's metadata block (APP_METADATA_SIZE bytes)
+//                   ABORT
+//   target -> host  ACK    seq = next chunk expected (cumulative, sent once a chunk is consumed)
+//                   NAK    seq = next chunk expected, payload: reason; the host goes back to seq
+//                   DONE   payload: result (int8, 0 = image verified and committed)
+// The host keeps up to OSAL_FWUPD_WINDOW chunks unacknowledged, so it never waits a round trip
+// per chunk. The receiver erases the slot's metadata first, erases one sector ahead of the
+// chunk being written while the next chunks are on the wire, and programs the metadata only
+// after the whole image arrived with a matching CRC: an interrupted update leaves an empty slot.
+#define OSAL_FWUPD_SOF 0xA5U
+#define OSAL_FWUPD_CHUNK 256U
+#define OSAL_FWUPD_WINDOW 8U
+#define OSAL_FWUPD_HDR_LEN 6U
+#define OSAL_FWUPD_FRAME_MAX (OSAL_FWUPD_HDR_LEN + OSAL_FWUPD_CHUNK + 4U)
+// Receive ring: holds a full window while the flash is busy
+#define OSAL_FWUPD_RING_SIZE 4096U
+
+#define OSAL_FWUPD_START 0x01U
+#define OSAL_FWUPD_DATA 0x02U
+#define OSAL_FWUPD_END 0x03U
+#define OSAL_FWUPD_ABORT 0x04U
+#define OSAL_FWUPD_ACK 0x81U
+#define OSAL_FWUPD_NAK 0x82U
+#define OSAL_FWUPD_DONE 0x83U
+
+// NAK reasons
+#define OSAL_FWUPD_NAK_CRC 1U
+#define OSAL_FWUPD_NAK_SEQUENCE 2U
+
+// Give up when nothing arrives for this long (UART receiver)
+#define OSAL_FWUPD_IDLE_TIMEOUT_MS 10000U
+
+// Send bytes to the host
+typedef void (*osal_fwupd_send_t)(const uint8_t *data, uint32_t len);
+
+typedef struct {
+    int32_t status;               // Last osal_fwupd_poll() result
+    uint32_t slot;
+    uint32_t image_size;
+    uint32_t stream_size;         // Bytes sent in DATA frames: image_size, or the patch size
+    uint32_t bytes;               // Image bytes written
+    uint32_t frames;              // Valid frames received
+    uint32_t crc_errors;          // Frames dropped on a CRC error
+    uint32_t naks;
+    uint32_t overruns;            // Bytes lost to a full receive ring
+    uint32_t erases;
+    uint32_t erase_overlaps;      // Erases started while chunks were still on the wire
+    uint32_t programs;            // Page program operations
+    uint32_t cycles;              // Duration, set by the UART receiver
+    uint32_t apply_cycles;        // Spent in the patch applier (delta; 0 on the host)
+} osal_fwupd_stats_t;
+
+/**
+ * Start a session: wait for START, then receive into a slot.
+ * @param slot: Slot to write, must not be the running one.
+ * @param flash: Backend used for the final check of the written slot.
+ * @param send: Transmit function for ACK/NAK/DONE frames.
+ */
+void osal_fwupd_begin(uint32_t slot, const osal_slot_flash_t *flash, osal_fwupd_send_t send);
+
+/**
+ * Queue received bytes; safe to call from the receive interrupt while osal_fwupd_poll() runs.
+ * @param data: Received bytes.
+ * @param len: Number of bytes.
+ */
+void osal_fwupd_receive(const uint8_t *data, uint32_t len);
+
+/**
+ * Run the receiver: parse queued frames, advance the erase/program pipeline and answer.
+ * Never waits for the flash.
+ * @return: 1 while in progress, 0 when the image is written and verified, -1 if the host
+ *          aborted, -2 on a bad START, -3 on a flash error, -4 on an image CRC mismatch,
+ *          -5 if the committed slot fails verification, -6 on a timeout, -7 if the patch
+ *          of a delta update is corrupt.
+ */
+int32_t osal_fwupd_poll(void);
+
+/**
+ * Statistics of the current or last session.
+ * @param stats: Output.
+ */
+void osal_fwupd_get_stats(osal_fwupd_stats_t *stats);
+
+#ifndef __linux__
+/**
+ * Receive an update over LPUART6 into the inactive slot. Takes over the LPUART6 receive
+ * interrupt (the RTD handler stays chained for transmission) until the session ends or
+ * nothing arrives for OSAL_FWUPD_IDLE_TIMEOUT_MS. The new slot boots on the next reset if
+ * its sequence number is higher.
+ * @return: Result as osal_fwupd_poll().
+ */
+int32_t osal_fwupd_run_uart(void);
+
+/**
+ * Log the last session (result, throughput, errors, flash operations) via osal_log_info.
+ */
+void osal_fwupd_log(void);
+#endif
+
+#endif /* OSAL_FWUPD_H_ */
@@ -0,0 +1,95 @@
+#ifndef OSAL_HEAP_H_
+#define OSAL_HEAP_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Maximum number of memory regions managed by the heap
+#define OSAL_HEAP_MAX_REGIONS 4U
+// Alignment of every returned pointer
+#define OSAL_HEAP_ALIGN 8U
+
+// Region affinity: each region has exactly one, a request accepts any of the given ones
+#define OSAL_HEAP_SRAM    (1UL << 0)   // Cacheable SRAM: general purpose
+#define OSAL_HEAP_DTCM    (1UL << 1)   // DTCM: zero wait state, CPU only
+#define OSAL_HEAP_NC      (1UL << 2)   // Non-cacheable SRAM: DMA buffers without cache maintenance
+// What malloc() and friends use: cacheable SRAM first, then DTCM
+#define OSAL_HEAP_DEFAULT (OSAL_HEAP_SRAM | OSAL_HEAP_DTCM)
+
+// Per-region statistics (bytes include the 8-byte block headers)
+typedef struct {
+    uint32_t start;
+    uint32_t size;
+    uint32_t flags;
+    uint32_t used;            // Bytes in allocated blocks
+    uint32_t used_peak;       // Highest value of used
+    uint32_t free;            // Bytes in free blocks
+    uint32_t largest_free;    // Biggest allocation sure to succeed: floor of the top size class
+    uint32_t alloc_count;     // Allocated blocks
+    uint32_t free_count;      // Free blocks
+    uint32_t failures;        // Requests this region could not serve
+    uint32_t fragmentation;   // 100 * (1 - largest_free / free), in percent
+} osal_heap_stats_t;
+
+/**
+ * Hand the spare RAM pools (cacheable SRAM, DTCM, non-cacheable SRAM) and the linker .heap
+ * section to the heap. Called on the first allocation if not called before.
+ * The pools are ECC-initialized here in __RAM_INIT_PARTIAL mode.
+ */
+void osal_heap_init(void);
+
+/**
+ * Add a memory region. Blocks never span two regions.
+ * @param start: Region start (aligned up to OSAL_HEAP_ALIGN).
+ * @param size: Region size in bytes (capped at 128 KB).
+ * @param flags: One OSAL_HEAP_* affinity flag.
+ * @return: 0 on success, -1 if flags is invalid, -2 if the region is too small, -3 if all slots are used.
+ */
+int32_t osal_heap_add_region(void *start, size_t size, uint32_t flags);
+
+/**
+ * Allocate in O(1) from the first region (in order of addition) that matches flags.
+ * Interrupt-safe: runs with interrupts masked for a bounded number of steps.
+ * @param size: Bytes requested.
+ * @param flags: Accepted OSAL_HEAP_* regions.
+ * @return: OSAL_HEAP_ALIGN aligned pointer, or NULL if no matching region has a big enough block.
+ */
+void *osal_heap_alloc(size_t size, uint32_t flags);
+
+/**
+ * Return a block to its region in O(1), merging it with free neighbours.
+ * @param ptr: Pointer from osal_heap_alloc/osal_heap_realloc, or NULL.
+ */
+void osal_heap_free(void *ptr);
+
+/**
+ * Resize a block, in place if the next block is free, otherwise by moving it within the
+ * same kind of region.
+ * @param ptr: Block to resize, or NULL to allocate.
+ * @param size: New size; 0 frees the block.
+ * @return: New pointer, or NULL on failure (the old block is then left untouched).
+ */
+void *osal_heap_realloc(void *ptr, size_t size);
+
+/**
+ * Get the usable size of a block.
+ * @param ptr: Allocated block.
+ * @return: Payload size in bytes (at least the size requested).
+ */
+size_t osal_heap_usable_size(const void *ptr);
+
+/**
+ * Copy the statistics of one region. The counters are kept by every allocation and release,
+ * so this is O(1) with interrupts masked only for the copy.
+ * @param region: Region index, in order of addition.
+ * @param stats: Output structure.
+ * @return: 0 on success, -1 if the region does not exist.
+ */
+int32_t osal_heap_get_stats(uint32_t region, osal_heap_stats_t *stats);
+
+/**
+ * Log the statistics of every region via osal_log_info.
+ */
+void osal_heap_log(void);
+
+#endif /* OSAL_HEAP_H_ */
@@ -0,0 +1,69 @@
+#ifndef OSAL_IMAGE_H_
+#define OSAL_IMAGE_H_
+
+#include <stdint.h>
+
+#define APP_METADATA_MAGIC 0xAABBCCDDU
+#define APP_NAME_MAX_LEN 16U
+#define APP_VERSION_MAX_LEN 12U
+#define APP_DIGEST_LEN 32U
+#define APP_SIGNATURE_LEN 64U
+
+// Numeric version for app_metadata.version_code
+#define APP_VERSION_CODE(major, minor, patch) \
+    (((uint32_t)(major) << 16) | ((uint32_t)(minor) << 8) | (uint32_t)(patch))
+
+// Program flash window an image may cover
+#define OSAL_IMAGE_PFLASH_START 0x00400000UL
+#define OSAL_IMAGE_PFLASH_END   0x00600000UL
+
+// Application metadata structure, at a fixed address per slot (.app_metadata, see osal_slot.h)
+// for the bootloader. Field offsets are part of the contract with tools/crc_stamp.py,
+// tools/sign_image.py and the slot selector, which decodes them by offset.
+typedef struct {
+    uint32_t magic;                         // 0x00: Identifier
+    char     app_name[APP_NAME_MAX_LEN];    // 0x04: Null-terminated app name
+    char     version[APP_VERSION_MAX_LEN];  // 0x14: Null-terminated version
+    char    *build_timestamp;               // 0x20: Null-terminated build date and time string
+    uint32_t flash_start_addr;              // 0x24: App binary flash base address
+    uint32_t image_size;                    // 0x28: Size in bytes for CRC coverage
+    uint32_t crc32;                         // 0x2C: CRC32 over image (excluding metadata)
+    uint32_t sequence;                      // 0x30: Update counter, the newest valid slot boots
+    uint32_t version_code;                  // 0x34: APP_VERSION_CODE() of the version string
+    uint8_t  sha256[APP_DIGEST_LEN];        // 0x38: SHA-256 over the same range
+    uint8_t  signature[APP_SIGNATURE_LEN];  // 0x58: ECDSA P-256 r || s (big-endian) over SHA-256 of 0x00..0x57
+} app_metadata_t;
+
+// Bytes of the metadata covered by the signature, and the whole block as stored in flash
+#define APP_METADATA_SIGNED_LEN 0x58U
+#define APP_METADATA_SIZE 0x98U
+
+// Metadata of the running image, defined by the application
+extern const app_metadata_t app_metadata;
+
+// Result of an image check
+typedef struct {
+    int32_t status;           // Value returned by osal_image_verify()
+    uint32_t crc;             // CRC computed over the image
+    uint32_t bytes;           // Bytes covered
+    uint32_t cycles;          // Time taken in core cycles
+} osal_image_check_t;
+
+/**
+ * Recompute the CRC-32 of the image described by a metadata block and compare it with the
+ * stamped value. If the metadata lies inside the range, its bytes are skipped.
+ * @param meta: Metadata of the image to check.
+ * @param check: Output details, may be NULL.
+ * @return: 0 if the CRC matches, -1 on a bad magic, -2 if the range is outside program flash,
+ *          -3 if the image is not stamped (crc32 is 0), -4 on a CRC mismatch.
+ */
+int32_t osal_image_verify(const app_metadata_t *meta, osal_image_check_t *check);
+
+/**
+ * Log an image check via osal_log_info.
+ * @param meta: Metadata that was checked.
+ * @param check: Result from osal_image_verify().
+ */
+void osal_image_log(const app_metadata_t *meta, const osal_image_check_t *check);
+
+#endif /* OSAL_IMAGE_H_ */
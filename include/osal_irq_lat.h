@@ -0,0 +1,60 @@
+#ifndef OSAL_IRQ_LAT_H_
+#define OSAL_IRQ_LAT_H_
+
+#include <stdint.h>
+
+// Rounds per software-triggered measurement
+#define OSAL_IRQ_LAT_ROUNDS 64U
+// PIT functional clock (same PIT instance as led_pwm)
+#define OSAL_IRQ_LAT_PIT_CLOCK_HZ 30000000UL
+
+typedef enum {
+    OSAL_IRQ_LAT_PIT0 = 0,
+    OSAL_IRQ_LAT_LPUART6,
+    OSAL_IRQ_LAT_COUNT
+} osal_irq_lat_source_t;
+
+// Entry latency in core cycles: from the request to the first instruction of the handler
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+} osal_irq_lat_stats_t;
+
+typedef struct {
+    uint32_t handler;             // Address of the first-level handler (ITCM if below 0x8000)
+    osal_irq_lat_stats_t warm;    // Software trigger, caches warm
+    osal_irq_lat_stats_t cold;    // Software trigger right after an I-cache invalidate
+    osal_irq_lat_stats_t hw;      // Real PIT0 channel 0 expiries, derived from the PIT counter
+    uint32_t hw_shared;           // Expiries not sampled: the PWM channel had the shared interrupt enabled
+} osal_irq_lat_report_t;
+
+/**
+ * Put a timestamping entry stub in front of the PIT0 and LPUART6 handlers installed by
+ * IntCtrl_Ip_Init(). Call after IntCtrl_Ip_Init() and osal_utils_cycles_init().
+ */
+void osal_irq_lat_init(void);
+
+/**
+ * Measure the entry latency of each source by pending it from software (NVIC STIR),
+ * OSAL_IRQ_LAT_ROUNDS times with warm caches and as many after an I-cache invalidate.
+ * The handlers run with no status flag set, so the drivers ignore them. The PWM channel, which
+ * shares PIT0_IRQn, has its interrupt masked meanwhile (the LEDs hold their level for the
+ * few milliseconds this takes). Interrupts must be enabled.
+ */
+void osal_irq_lat_measure(void);
+
+/**
+ * Copy the results of one source.
+ * @param source: Source to inspect.
+ * @param report: Output structure.
+ */
+void osal_irq_lat_get(osal_irq_lat_source_t source, osal_irq_lat_report_t *report);
+
+/**
+ * Log min/avg/max entry latency of each source via osal_log_info.
+ */
+void osal_irq_lat_log(void);
+
+#endif /* OSAL_IRQ_LAT_H_ */
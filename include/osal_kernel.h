@@ -0,0 +1,158 @@
+#ifndef OSAL_KERNEL_H_
+#define OSAL_KERNEL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "osal_mpu.h"
+
+// Number of priority levels; one task per level, higher number = higher priority.
+// Level 0 is reserved for the idle task.
+#define OSAL_KERNEL_PRIO_COUNT 32U
+#define OSAL_KERNEL_PRIO_IDLE  0U
+
+// Kernel tick rate driven by SysTick
+#define OSAL_KERNEL_TICK_HZ 1000U
+
+// Task stacks are carved out of this pool in int_dtcm (must be a multiple of 32). Each stack is
+// painted for high-water-mark tracking and starts with an OSAL_STACK_GUARD_SIZE no-access guard.
+#define OSAL_KERNEL_STACK_POOL_SIZE 0x3000U
+#define OSAL_KERNEL_IDLE_STACK_SIZE 256U
+#define OSAL_KERNEL_MIN_STACK_SIZE  256U
+
+typedef void (*osal_task_fn_t)(void *arg);
+
+typedef enum {
+    OSAL_TASK_READY = 0,
+    OSAL_TASK_DELAYED,
+    OSAL_TASK_WAITING,
+    OSAL_TASK_DORMANT
+} osal_task_state_t;
+
+// Task control block. Storage is provided by the caller (no heap use).
+typedef struct osal_task {
+    uint32_t *sp;                 // Saved process stack pointer; must stay the first member (used by PendSV)
+    uint32_t *stack_base;         // Lowest address of the task stack
+    size_t stack_size;            // Stack size in bytes
+    const char *name;
+    uint32_t wake_tick;           // Tick at which a delayed task becomes ready
+    uint32_t notify_cycles;       // CYCCNT when the task was notified from an ISR
+    const osal_mpu_region_t *mpu_region; // Loaded into OSAL_MPU_REGION_TASK while the task runs
+    osal_mpu_region_t stack_guard; // Default task region: no access to the bottom of the stack
+    volatile uint32_t notified;   // Pending notification count
+    volatile uint8_t notify_timed; // notify_cycles holds an ISR timestamp not yet accounted
+    uint8_t prio;
+    volatile uint8_t state;       // osal_task_state_t
+} osal_task_t;
+
+// Timing statistics gathered with the DWT cycle counter (values in core cycles)
+typedef struct {
+    uint32_t switch_count;        // Number of completed context switches
+    uint32_t switch_cycles_last;  // PendSV entry to exception return
+    uint32_t switch_cycles_min;
+    uint32_t switch_cycles_max;
+    uint32_t latency_count;       // Number of ISR-to-task wakeups measured
+    uint32_t latency_cycles_last; // osal_kernel_notify_from_isr() to osal_kernel_wait() return
+    uint32_t latency_cycles_min;
+    uint32_t latency_cycles_max;
+} osal_kernel_stats_t;
+
+/**
+ * Initialize the kernel: enables the cycle counter, lazy FPU stacking,
+ * sets PendSV to the lowest priority and starts the SysTick tick.
+ * The tick runs even before osal_kernel_start(), so superloop code can use
+ * osal_kernel_get_tick() and the tick hook.
+ */
+void osal_kernel_init(void);
+
+/**
+ * Create a task. The stack is carved from the DTCM stack pool.
+ * @param task: Caller-provided task control block.
+ * @param name: Task name for reports.
+ * @param fn: Task entry function; returning from it makes the task dormant.
+ * @param arg: Argument passed to fn.
+ * @param prio: Priority 1..OSAL_KERNEL_PRIO_COUNT-1, unique per task.
+ * @param stack_size: Stack size in bytes including the guard (rounded up to 32).
+ * @return: 0 on success, -1 on invalid arguments, -2 if the priority is taken, -3 if the pool is exhausted.
+ */
+int32_t osal_kernel_task_create(osal_task_t *task, const char *name, osal_task_fn_t fn, void *arg,
+                                uint8_t prio, size_t stack_size);
+
+/**
+ * Give a task its own MPU region instead of its stack guard, loaded on every switch to it.
+ * Takes effect at the next switch.
+ * @param task: Task created with osal_kernel_task_create().
+ * @param region: Region (must stay valid), or NULL to restore the stack guard.
+ */
+void osal_kernel_task_set_mpu_region(osal_task_t *task, const osal_mpu_region_t *region);
+
+/**
+ * Start scheduling. Switches to the highest priority ready task and never returns.
+ */
+void osal_kernel_start(void) __attribute__((noreturn));
+
+/**
+ * Block the calling task for a number of ticks. 0 yields to equal or higher priority work.
+ * @param ticks: Number of kernel ticks to sleep.
+ */
+void osal_kernel_delay(uint32_t ticks);
+
+/**
+ * Block the calling task until it is notified. Returns immediately if a notification is pending.
+ */
+void osal_kernel_wait(void);
+
+/**
+ * Notify a task from thread context.
+ * @param task: Task to make ready.
+ */
+void osal_kernel_notify(osal_task_t *task);
+
+/**
+ * Notify a task from an ISR. Timestamps the request so the interrupt-to-task latency is measured,
+ * and pends a context switch if the task outranks the running one.
+ * @param task: Task to make ready.
+ */
+void osal_kernel_notify_from_isr(osal_task_t *task);
+
+/**
+ * Get the number of ticks since osal_kernel_init().
+ * @return: Tick count.
+ */
+uint32_t osal_kernel_get_tick(void);
+
+/**
+ * Get the running task.
+ * @return: Current task, or NULL before osal_kernel_start().
+ */
+osal_task_t *osal_kernel_current(void);
+
+/**
+ * Hook called from the SysTick handler on every tick. Weak default does nothing.
+ * Keep it short: it runs in interrupt context.
+ */
+void osal_kernel_tick_hook(void);
+
+/**
+ * Copy the context-switch and latency statistics.
+ * @param stats: Output structure.
+ */
+void osal_kernel_get_stats(osal_kernel_stats_t *stats);
+
+/**
+ * Log the context-switch and latency statistics via osal_log_info.
+ */
+void osal_kernel_log_stats(void);
+
+/**
+ * Get the stack high-water mark of a task.
+ * @param task: Task created with osal_kernel_task_create().
+ * @return: Bytes used at the deepest point so far, guard excluded.
+ */
+size_t osal_kernel_task_stack_used(const osal_task_t *task);
+
+/**
+ * Log the stack high-water mark of every task via osal_log_info.
+ */
+void osal_kernel_log_stacks(void);
+
+#endif /* OSAL_KERNEL_H_ */
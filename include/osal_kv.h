@@ -0,0 +1,121 @@
+#ifndef OSAL_KV_H_
+#define OSAL_KV_H_
+
+#include <stdint.h>
+#include "osal_flash.h"
+
+// Key-value store in data flash (int_dflash, 16 sectors of 8 KB), for configuration, SecOC
+// freshness counters and calibration values.
+//
+// The store is a log: records are appended to the active sector and a write never modifies
+// flash in place. Sectors are used in ring order and the oldest one is reclaimed (live
+// records copied to the head, then erased), so every sector sees the same number of erases.
+// A RAM index maps each key to its newest record; it is rebuilt at boot by one scan of the
+// sectors in sequence order.
+//
+// Sector: header { magic, sequence } { obsolete mark }, then records.
+// Record: { key u16, len u16, CRC-32 over key, len and value }, value, padded to 8 bytes.
+// A record is written header first; one cut short by a reset fails its CRC, or the ECC of
+// the double word being programmed, at the next scan (which reads with ECC errors reported,
+// not faulting), keeps the records before it and closes the sector for appends. A sector being
+// reclaimed is marked obsolete before its erase, so an interrupted erase is finished at boot.
+#define OSAL_KV_BASE OSAL_FLASH_DFLASH_START
+#define OSAL_KV_SECTORS 16U
+#define OSAL_KV_SECTOR_SIZE OSAL_FLASH_SECTOR_SIZE
+#define OSAL_KV_SECTOR_HEADER 16U
+#define OSAL_KV_RECORD_HEADER 8U
+#define OSAL_KV_MAGIC 0x3153564BUL   // "KVS1"
+
+#define OSAL_KV_VALUE_MAX 256U
+// Index slots (power of two) and the number of keys they may hold
+#define OSAL_KV_INDEX_SIZE 256U
+#define OSAL_KV_MAX_KEYS 192U
+// Keys are 1..0xFFFE; 0xFFFF reads as erased flash
+#define OSAL_KV_KEY_ERASED 0xFFFFU
+// len of a record deleting its key
+#define OSAL_KV_TOMBSTONE 0x8000U
+
+// Background reclaim starts below this many erased sectors; one erased sector is always kept
+// for the live records of the sector being reclaimed
+#define OSAL_KV_GC_THRESHOLD 3U
+
+typedef struct {
+    uint32_t keys;
+    uint32_t sectors_used;
+    uint32_t sectors_free;
+    uint32_t sectors_dirty;       // Waiting for an erase (obsolete or unreadable header)
+    uint32_t records_scanned;     // By the last mount
+    uint32_t bytes_scanned;
+    uint32_t torn;                // Records cut short found by the last mount
+    uint32_t scan_cycles;         // Duration of the last mount (target only)
+    uint32_t sequence;            // Sectors opened so far (sequence of the next one)
+    uint32_t writes;
+    uint32_t reclaims;
+    uint32_t copied;              // Live records moved by reclaims
+    uint32_t erases;
+} osal_kv_stats_t;
+
+/**
+ * Mount the store: scan all sectors in sequence order and build the index.
+ * @return: Number of keys, or -4 on a flash error.
+ */
+int32_t osal_kv_init(void);
+
+/**
+ * Read a value; O(1) through the index (waits for a background erase of data flash to end,
+ * as the C40 cannot read a block it erases).
+ * @param key: Key.
+ * @param buf: Destination.
+ * @param size: Size of buf.
+ * @param len: Output, length of the value.
+ * @return: 0 on success, -1 if the key is not set, -2 if buf is too small.
+ */
+int32_t osal_kv_get(uint16_t key, void *buf, uint32_t size, uint32_t *len);
+
+/**
+ * Write a value: append a record and update the index. Reclaims a sector first if the log
+ * is full. Not reentrant; call from one context.
+ * @param key: Key, 1..0xFFFE.
+ * @param data: Value.
+ * @param len: Length, at most OSAL_KV_VALUE_MAX (0 is allowed).
+ * @return: 0 on success, -1 on a bad key or length, -2 if the index is full, -3 if the log
+ *          is full of live records, -4 on a flash error.
+ */
+int32_t osal_kv_set(uint16_t key, const void *data, uint32_t len);
+
+/**
+ * Delete a key (appends a tombstone record).
+ * @param key: Key.
+ * @return: 0 on success, -1 if the key is not set, -3 or -4 as osal_kv_set().
+ */
+int32_t osal_kv_delete(uint16_t key);
+
+/**
+ * Run one step of the background reclaim: copy one live record, or start or complete a
+ * sector erase. Never waits for the flash; call from the main loop.
+ */
+void osal_kv_poll(void);
+
+/**
+ * Store statistics, from RAM: no flash access and no wait for a background erase.
+ * @param stats: Output.
+ */
+void osal_kv_get_stats(osal_kv_stats_t *stats);
+
+#ifndef __linux__
+/**
+ * Log the store state and the last mount via osal_log_info.
+ */
+void osal_kv_log(void);
+
+#ifdef OSAL_KV_BENCHMARK_ENABLE
+/**
+ * Fill the log with throwaway records up to the reclaim threshold, time a full mount, then
+ * delete them again; logs the result. Only built with OSAL_KV_BENCHMARK_ENABLE: it costs
+ * data flash erase cycles and a mount of a full partition.
+ */
+void osal_kv_benchmark(void);
+#endif
+#endif
+
+#endif /* OSAL_KV_H_ */
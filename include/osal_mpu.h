@@ -0,0 +1,113 @@
+#ifndef OSAL_MPU_H_
+#define OSAL_MPU_H_
+
+#include <stdint.h>
+
+/*
+ * MPU region manager. SystemInit() programs the static layout (regions 0..12 on S32K312, from
+ * its rbar[]/rasr[] tables); the regions above are free for runtime use. Higher region numbers
+ * win where regions overlap, so a runtime region can override the attributes of part of SRAM.
+ */
+#define OSAL_MPU_REGION_COUNT  16U
+#define OSAL_MPU_REGION_USER        13U  // Free for application use
+#define OSAL_MPU_REGION_STACK_GUARD 14U  // Guard at the bottom of the main stack (osal_stack)
+#define OSAL_MPU_REGION_TASK        15U  // Reloaded on every context switch (osal_kernel)
+
+// RASR fields (ARMv7-M)
+#define OSAL_MPU_RASR_ENABLE   (1UL << 0)
+#define OSAL_MPU_RASR_XN       (1UL << 28)
+#define OSAL_MPU_RASR_S        (1UL << 18)
+#define OSAL_MPU_RASR_AP(ap)   ((uint32_t)(ap) << 24)
+#define OSAL_MPU_RASR_SRD(m)   ((uint32_t)(m) << 8)
+
+// Memory type and cache policy: TEX[21:19], C[17], B[16]
+#define OSAL_MPU_MEM_STRONGLY_ORDERED  0x00000000UL
+#define OSAL_MPU_MEM_DEVICE            0x00010000UL  // TEX 0, C 0, B 1
+#define OSAL_MPU_MEM_NORMAL_NC         0x00080000UL  // TEX 1, C 0, B 0
+#define OSAL_MPU_MEM_WT_NOALLOC        0x00020000UL  // TEX 0, C 1, B 0: write-through, no write allocate
+#define OSAL_MPU_MEM_WB_NOALLOC        0x00030000UL  // TEX 0, C 1, B 1: write-back, no write allocate
+#define OSAL_MPU_MEM_WB_ALLOC          0x000B0000UL  // TEX 1, C 1, B 1: write-back, read/write allocate
+
+// Access permissions (AP field)
+#define OSAL_MPU_AP_NONE       0U
+#define OSAL_MPU_AP_PRIV_RW    1U
+#define OSAL_MPU_AP_RW_USER_RO 2U
+#define OSAL_MPU_AP_RW         3U
+#define OSAL_MPU_AP_PRIV_RO    5U
+#define OSAL_MPU_AP_RO         6U
+
+// Typical attribute sets (RASR without SIZE and ENABLE)
+#define OSAL_MPU_ATTR_SRAM          (OSAL_MPU_MEM_WB_ALLOC | OSAL_MPU_RASR_AP(OSAL_MPU_AP_RW))
+#define OSAL_MPU_ATTR_SRAM_STREAM   (OSAL_MPU_MEM_WT_NOALLOC | OSAL_MPU_RASR_AP(OSAL_MPU_AP_RW) | OSAL_MPU_RASR_XN)
+#define OSAL_MPU_ATTR_SRAM_NC       (OSAL_MPU_MEM_NORMAL_NC | OSAL_MPU_RASR_S | OSAL_MPU_RASR_AP(OSAL_MPU_AP_RW) | OSAL_MPU_RASR_XN)
+#define OSAL_MPU_ATTR_NO_ACCESS     (OSAL_MPU_MEM_NORMAL_NC | OSAL_MPU_RASR_AP(OSAL_MPU_AP_NONE) | OSAL_MPU_RASR_XN)
+
+// Size checks usable in constant expressions: a power of two from 32 bytes to 4 GB
+#define OSAL_MPU_SIZE_VALID(size) (((size) >= 32UL) && (((size) & ((size) - 1UL)) == 0UL))
+#define OSAL_MPU_BASE_VALID(base, size) (((base) & ((size) - 1UL)) == 0UL)
+#define OSAL_MPU_RASR_SIZE(size) (((uint32_t)__builtin_ctzl(size) - 1UL) << 1)
+
+/**
+ * Define a region with a constant base: rejected at compile time if the size is not a power
+ * of two of at least 32 bytes or the base is not aligned to it.
+ */
+#define OSAL_MPU_STATIC_REGION(name, base, size, attr)                                          \
+    _Static_assert(OSAL_MPU_SIZE_VALID(size), #name ": MPU region size must be a power of two >= 32"); \
+    _Static_assert(OSAL_MPU_BASE_VALID(base, size), #name ": MPU region base must be size aligned");  \
+    static const osal_mpu_region_t name = {                                                     \
+        (uint32_t)(base), (uint32_t)(attr) | OSAL_MPU_RASR_SIZE(size) | OSAL_MPU_RASR_ENABLE    \
+    }
+
+// Precomputed register values, cheap to load on a context switch
+typedef struct {
+    uint32_t rbar;
+    uint32_t rasr;
+} osal_mpu_region_t;
+
+/**
+ * Build a region at run time, e.g. from linker symbols.
+ * @param region: Output.
+ * @param base: Start address, aligned to size.
+ * @param size: Power of two, at least 32 bytes.
+ * @param attr: RASR attributes (OSAL_MPU_MEM_*, OSAL_MPU_RASR_AP(), XN, S, SRD).
+ * @return: 0 on success, -1 on invalid size, -2 on misaligned base.
+ */
+int32_t osal_mpu_region_init(osal_mpu_region_t *region, uint32_t base, uint32_t size, uint32_t attr);
+
+/**
+ * Program an MPU region. Cached lines of the range are written back and invalidated first, so a
+ * policy change (e.g. to write-through) never leaves stale dirty data behind.
+ * @param num: Region number below OSAL_MPU_REGION_COUNT.
+ * @param region: Region to load.
+ * @return: 0 on success, -1 if num is invalid.
+ */
+int32_t osal_mpu_set_region(uint8_t num, const osal_mpu_region_t *region);
+
+/**
+ * Disable an MPU region.
+ * @param num: Region number below OSAL_MPU_REGION_COUNT.
+ * @return: 0 on success, -1 if num is invalid.
+ */
+int32_t osal_mpu_clear_region(uint8_t num);
+
+/**
+ * Read back an MPU region.
+ * @param num: Region number below OSAL_MPU_REGION_COUNT.
+ * @param region: Output.
+ * @return: 0 on success, -1 if num is invalid.
+ */
+int32_t osal_mpu_get_region(uint8_t num, osal_mpu_region_t *region);
+
+/**
+ * Load the per-task region (OSAL_MPU_REGION_TASK) from the context switch.
+ * Skips the register writes if the same region is already loaded.
+ * @param region: Region of the incoming task, or NULL to disable it.
+ */
+void osal_mpu_load_task_region(const osal_mpu_region_t *region);
+
+/**
+ * Log the enabled regions with their decoded attributes via osal_log_info.
+ */
+void osal_mpu_log(void);
+
+#endif /* OSAL_MPU_H_ */
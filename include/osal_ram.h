@@ -0,0 +1,49 @@
+#ifndef OSAL_RAM_H_
+#define OSAL_RAM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Spare RAM left after the linker placed all sections (see __*_USED_END / __*_SPARE_END)
+typedef enum {
+    OSAL_RAM_POOL_SRAM = 0,       // Cacheable SRAM after the heap
+    OSAL_RAM_POOL_SRAM_NC,        // Non-cacheable SRAM
+    OSAL_RAM_POOL_SRAM_SH,        // Shareable SRAM
+    OSAL_RAM_POOL_DTCM,           // DTCM between the allocated sections and the stack
+    OSAL_RAM_POOL_ITCM,           // ITCM after the TCM code
+    OSAL_RAM_POOL_COUNT
+} osal_ram_pool_t;
+
+typedef struct {
+    uint32_t start;
+    uint32_t size;
+    uint32_t init_cycles;         // Cost of the on-demand ECC initialization or zeroing (0 if done at boot)
+    uint8_t ready;                // ECC initialized (or zeroed after a warm reset) and usable
+} osal_ram_pool_info_t;
+
+/**
+ * Get a spare RAM pool, ECC-initializing it first if the startup code left it untouched
+ * (__RAM_INIT_PARTIAL mode), or zeroing it after a warm reset, where startup skips the RAM
+ * initialization and the pool keeps the previous boot's data. The memory reads as zero after
+ * the first call. osal_reset_init() must have run.
+ * The pool is handed out as a whole; the caller manages it.
+ * @param pool: Pool to get.
+ * @param start: Output start address (8-byte aligned).
+ * @param size: Output size in bytes.
+ * @return: 0 on success, -1 if pool is invalid, -2 if the pool is empty.
+ */
+int32_t osal_ram_pool_get(osal_ram_pool_t pool, void **start, size_t *size);
+
+/**
+ * Copy the state of a pool without initializing it.
+ * @param pool: Pool to inspect.
+ * @param info: Output structure.
+ */
+void osal_ram_pool_info(osal_ram_pool_t pool, osal_ram_pool_info_t *info);
+
+/**
+ * Log the ECC initialization mode, the bytes initialized at boot and the pools via osal_log_info.
+ */
+void osal_ram_log(void);
+
+#endif /* OSAL_RAM_H_ */
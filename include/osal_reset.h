@@ -0,0 +1,106 @@
+#ifndef OSAL_RESET_H_
+#define OSAL_RESET_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Reset reason and the warm restart path.
+//
+// A warm reset is one with no destructive event recorded in MC_RGM.DES since the last boot
+// cleared it: a functional reset (software, watchdog, external pin, fault capture). RAM
+// keeps its contents and ECC through it, so the startup code skips the RAM ECC
+// initialization, and board_level_init() keeps the clock tree when the PLL is still locked
+// and the core clock selector, its dividers and the MC_ME peripheral clock gates read back
+// as the last full Clock_Ip_Init() left them (osal_reset_clocks_t, in .noinit). A pending
+// fault capture always takes the full clock initialization, so a fault in the kept clock
+// state cannot loop. A cold reset (power-on or any destructive event) takes the full path.
+//
+// Time to operational (Reset_Handler entry to the end of board_level_init()) is measured
+// on every boot; the last cold and warm figures are kept in .noinit and reported together.
+
+// Clock the reset path runs on until Clock_Ip_Init() (FIRC)
+#define OSAL_RESET_FIRC_MHZ 48U
+
+// Set in osal_reset_times_t.magic when the record is valid
+#define OSAL_RESET_TIMES_MAGIC 0x524D4954UL
+
+// Set in osal_reset_clocks_t.magic when the record is valid
+#define OSAL_RESET_CLOCKS_MAGIC 0x4B4C4352UL
+
+typedef struct {
+    uint32_t des;                 // MC_RGM.DES and FES at boot
+    uint32_t fes;
+    bool warm;
+    bool clock_kept;
+    uint32_t clock_cycles;        // DWT at the clock switch
+    uint32_t operational_us;      // This boot, to the end of board_level_init()
+} osal_reset_info_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t cold_us;             // Last cold boot to operational
+    uint32_t warm_us;             // Last warm boot to operational
+    uint32_t cold_boots;
+    uint32_t warm_boots;
+    uint32_t check;               // Inverted XOR of the words above
+} osal_reset_times_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t mux0_css;            // MC_CGM_0 MUX_0_CSS: core clock source
+    uint32_t mux0_dc[7];          // MC_CGM_0 MUX_0_DC_0..6: core, AIPS and HSE dividers
+    uint32_t cofb_stat[6];        // MC_ME PRTN1_COFB0..3_STAT, PRTN2_COFB0..1_STAT: clock gates
+    uint32_t check;               // Inverted XOR of the words above
+} osal_reset_clocks_t;
+
+/**
+ * Read and clear the reset reason (MC_RGM.DES and FES). Clearing DES is what lets the next
+ * functional reset take the warm path. Call first thing in main().
+ */
+void osal_reset_init(void);
+
+/**
+ * Whether this boot came through a warm reset.
+ * @return: true for a functional reset with no destructive event.
+ */
+bool osal_reset_is_warm(void);
+
+/**
+ * Whether the clock configuration survived: warm reset, no pending fault capture, PLL
+ * locked and selected as the core clock, and the MUX_0 dividers and peripheral clock gates
+ * equal to the snapshot taken after the last Clock_Ip_Init(). board_level_init() skips
+ * Clock_Ip_Init() in that case.
+ * @return: true if the clocks can be reused.
+ */
+bool osal_reset_clock_kept(void);
+
+/**
+ * Stamp the clock switch (end of Clock_Ip_Init(), or where it would have run): cycles
+ * before it ran on FIRC. After a full Clock_Ip_Init(), also snapshot the clock registers
+ * osal_reset_clock_kept() compares on the next warm boot.
+ */
+void osal_reset_mark_clock(void);
+
+/**
+ * Stamp the end of board initialization and update the cold or warm time to operational.
+ */
+void osal_reset_mark_operational(void);
+
+/**
+ * Reset reason and timing of this boot.
+ * @param info: Output.
+ */
+void osal_reset_get_info(osal_reset_info_t *info);
+
+/**
+ * Log the reset reason, the path taken and the cold and warm times to operational via
+ * osal_log_info.
+ */
+void osal_reset_log(void);
+
+/**
+ * Request a functional reset through MC_ME. RAM is kept and the next boot is warm.
+ */
+__attribute__((noreturn)) void osal_reset_functional(void);
+
+#endif /* OSAL_RESET_H_ */
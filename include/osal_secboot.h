@@ -0,0 +1,39 @@
+#ifndef OSAL_SECBOOT_H_
+#define OSAL_SECBOOT_H_
+
+#include <stdint.h>
+#include "osal_image.h"
+
+// Bytes hashed per SHA-256 update: a multiple of the 64-byte SHA block so mbedtls hashes
+// straight from flash without staging copies, and long enough to stream through the flash
+// prefetch buffer and D-cache line fills
+#define OSAL_SECBOOT_HASH_CHUNK 4096U
+
+// Boot-time cost of one check, in core cycles
+typedef struct {
+    int32_t status;               // Value returned by osal_secboot_verify()
+    uint32_t bytes;               // Image bytes hashed
+    uint32_t hash_cycles;         // SHA-256 over the image
+    uint32_t key_cycles;          // Curve and public key setup (first call only)
+    uint32_t verify_cycles;       // Metadata hash and ECDSA verification
+} osal_secboot_report_t;
+
+/**
+ * Check the SHA-256 digest of the image described by a metadata block and the ECDSA P-256
+ * signature of the metadata against the built-in public key (osal_secboot_key.h).
+ * The curve, its cached generator table and the decoded public key are kept for later calls.
+ * @param meta: Metadata of the image to check.
+ * @param report: Output timing and status, may be NULL.
+ * @return: 0 if digest and signature are valid, -1 on a bad magic or range, -2 on a digest
+ *          mismatch, -3 on an invalid signature, -4 if no public key is provisioned,
+ *          -5 on a crypto library error (e.g. out of heap).
+ */
+int32_t osal_secboot_verify(const app_metadata_t *meta, osal_secboot_report_t *report);
+
+/**
+ * Log a check and its cost split into hash and verify via osal_log_info.
+ * @param report: Result from osal_secboot_verify().
+ */
+void osal_secboot_log(const osal_secboot_report_t *report);
+
+#endif /* OSAL_SECBOOT_H_ */
@@ -0,0 +1,14 @@
+#ifndef OSAL_SECBOOT_KEY_H_
+#define OSAL_SECBOOT_KEY_H_
+
+#include <stdint.h>
+
+// Public key that app_metadata signatures are checked against (uncompressed SEC1 point).
+// Generated by tools/sign_image.py --genkey/--export-pubkey; no key is provisioned yet.
+#define OSAL_SECBOOT_KEY_PROVISIONED 0
+
+static const uint8_t osal_secboot_pubkey[65] = {
+    0x04,
+};
+
+#endif /* OSAL_SECBOOT_KEY_H_ */
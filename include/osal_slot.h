@@ -0,0 +1,175 @@
+#ifndef OSAL_SLOT_H_
+#define OSAL_SLOT_H_
+
+#include <stdint.h>
+#include "osal_image.h"
+
+// A/B application slots in program flash. Each slot is linked for its own address
+// (linker_flash_s32k312.ld, __slot_b__) and has its metadata block in a separate sector at
+// its end, so the selector compares both slots by reading 2 x APP_METADATA_SIZE bytes.
+// A slot and its metadata lie in one 1 MB flash block: the running image never reads the
+// block an update erases.
+#define OSAL_SLOT_COUNT 2U
+#define OSAL_SLOT_SIZE 0x000BE000UL
+#define OSAL_SLOT_A_BASE 0x00440000UL
+#define OSAL_SLOT_B_BASE 0x00500000UL
+#define OSAL_SLOT_A_METADATA (OSAL_SLOT_A_BASE + OSAL_SLOT_SIZE)
+#define OSAL_SLOT_B_METADATA (OSAL_SLOT_B_BASE + OSAL_SLOT_SIZE)
+#define OSAL_SLOT_METADATA_SECTOR 0x2000UL
+// Image vector table at the start of each slot (startup_cm7.s .boot_header)
+#define OSAL_SLOT_IVT_MARKER 0x5AA55AA5UL
+#define OSAL_SLOT_IVT_CM7_0_VTOR 0x0CU
+
+// Per-slot state after a selection
+#define OSAL_SLOT_UNCHECKED 1     // Header valid, image not verified (a newer slot was chosen)
+#define OSAL_SLOT_VALID 0         // Image verified, now or by an earlier boot (cache)
+#define OSAL_SLOT_EMPTY (-1)      // No metadata (erased or bad magic)
+#define OSAL_SLOT_BAD_HEADER (-2) // Range outside the slot or image not stamped
+#define OSAL_SLOT_BAD_IMAGE (-3)  // Verification failed
+
+// Set in osal_slot_cache_t.magic when the record is valid
+#define OSAL_SLOT_CACHE_MAGIC 0x534C4F54UL
+
+// Metadata fields the selector uses, decoded by offset so the logic runs on any host
+typedef struct {
+    uint32_t magic;
+    uint32_t flash_start_addr;
+    uint32_t image_size;
+    uint32_t crc32;
+    uint32_t sequence;
+    uint32_t version_code;
+} osal_slot_header_t;
+
+// Flash access for the selector. The target uses memory-mapped flash; a host or an update
+// client can run the same logic on a flash dump with osal_slot_flash_image().
+typedef struct {
+    // Copy len bytes at flash address addr to buf, return 0 or -1 if out of range
+    int32_t (*read)(void *ctx, uint32_t addr, void *buf, uint32_t len);
+    // Full check of the image in a slot whose header is valid, return 0 if it may boot
+    int32_t (*verify)(void *ctx, uint32_t slot, const osal_slot_header_t *hdr);
+    void *ctx;
+} osal_slot_flash_t;
+
+// Flash dump backend state for osal_slot_flash_image()
+typedef struct {
+    const uint8_t *data;
+    uint32_t base;                // Flash address of data[0]
+    uint32_t size;
+} osal_slot_image_t;
+
+// Verification verdicts of earlier selections, keyed by the identity of each slot's image
+// (sequence, CRC and size). Kept in .noinit RAM on target so a warm reset does not hash
+// an image again; a cold boot verifies the chosen slot once.
+typedef struct {
+    uint32_t sequence;
+    uint32_t crc32;
+    uint32_t image_size;
+    int32_t status;               // OSAL_SLOT_VALID or OSAL_SLOT_BAD_IMAGE, else no entry
+} osal_slot_verdict_t;
+
+typedef struct {
+    uint32_t magic;
+    osal_slot_verdict_t slot[OSAL_SLOT_COUNT];
+    uint32_t check;               // ~(xor of the words above)
+} osal_slot_cache_t;
+
+// Result of osal_slot_select()
+typedef struct {
+    int32_t selected;                         // Slot to boot, -1 if none is valid
+    int32_t status[OSAL_SLOT_COUNT];          // OSAL_SLOT_* per slot
+    osal_slot_header_t hdr[OSAL_SLOT_COUNT];
+    uint32_t verified;                        // Images hashed by this selection
+    uint32_t cached;                          // Bit n: verdict of slot n taken from the cache
+    uint32_t cycles;                          // Time taken in core cycles (target only)
+} osal_slot_selection_t;
+
+// Base address of each slot's image and of its metadata block
+typedef struct {
+    uint32_t base;
+    uint32_t metadata;
+} osal_slot_layout_t;
+
+extern const osal_slot_layout_t osal_slot_layout[OSAL_SLOT_COUNT];
+
+/**
+ * Pick the slot to boot: read both metadata headers, order the valid ones by sequence
+ * (newest first, wrap-safe) and verify candidates in that order until one passes, so a
+ * failed newest image falls back to the older slot. Verdicts found in the cache are reused
+ * and new ones are recorded; with both images unchanged no image is hashed.
+ * @param flash: Flash access and verification.
+ * @param cache: Verdict cache, may be NULL. An invalid record is reset.
+ * @param sel: Output selection.
+ * @return: Selected slot, or -1 if no slot holds a valid image.
+ */
+int32_t osal_slot_select(const osal_slot_flash_t *flash, osal_slot_cache_t *cache, osal_slot_selection_t *sel);
+
+/**
+ * Decode and check the metadata header of a slot.
+ * @param flash: Flash access.
+ * @param slot: Slot index.
+ * @param hdr: Output header.
+ * @return: OSAL_SLOT_UNCHECKED if the header is usable, OSAL_SLOT_EMPTY or OSAL_SLOT_BAD_HEADER.
+ */
+int32_t osal_slot_read_header(const osal_slot_flash_t *flash, uint32_t slot, osal_slot_header_t *hdr);
+
+/**
+ * Set up a backend over a flash dump held in memory. Verification recomputes the CRC-32
+ * of the slot's image; signatures are left to the caller.
+ * @param flash: Backend to fill.
+ * @param image: Dump description, must outlive the backend.
+ */
+void osal_slot_flash_image(osal_slot_flash_t *flash, osal_slot_image_t *image);
+
+/**
+ * Record a verdict for a slot, e.g. after the running image has checked itself at boot.
+ * @param cache: Verdict cache.
+ * @param slot: Slot index.
+ * @param hdr: Header of the image the verdict is for.
+ * @param status: OSAL_SLOT_VALID or OSAL_SLOT_BAD_IMAGE.
+ */
+void osal_slot_cache_store(osal_slot_cache_t *cache, uint32_t slot, const osal_slot_header_t *hdr, int32_t status);
+
+/**
+ * Slot holding an address, e.g. of the running app_metadata.
+ * @param addr: Flash address.
+ * @return: Slot index, or -1 if the address is in neither slot nor metadata sector.
+ */
+int32_t osal_slot_of(uint32_t addr);
+
+#ifndef __linux__
+// Verdict cache in .noinit RAM
+extern osal_slot_cache_t osal_slot_cache;
+
+/**
+ * Memory-mapped flash backend: verification is osal_image_verify() and, with a provisioned
+ * key, osal_secboot_verify().
+ */
+extern const osal_slot_flash_t osal_slot_flash;
+
+/**
+ * Record the boot-time check of the running image in the cache, so the selection does not
+ * hash it again.
+ * @param status: 0 if the running image passed its checks.
+ */
+void osal_slot_note_running(int32_t status);
+
+/**
+ * Run the selection over the on-chip flash with the .noinit cache and log both slots and
+ * the choice via osal_log_info.
+ * @return: Selected slot, or -1.
+ */
+int32_t osal_slot_boot_select(void);
+
+/**
+ * Start the image in another slot as a reset into it would: interrupts masked and cleared,
+ * SysTick and MPU off, D-cache flushed, then VTOR, MSP and the reset handler taken from the
+ * slot's vector table. RAM, clocks and the cleared reset status are kept, so that image
+ * boots on the warm path and finds the verdict cache. Call from main() before the kernel
+ * starts; a bootloader in front of the slots would run osal_slot_select() and this the same way.
+ * @param slot: Slot to start.
+ * @return: -1 if the slot has no usable vector table; does not return otherwise.
+ */
+int32_t osal_slot_jump(uint32_t slot);
+#endif
+
+#endif /* OSAL_SLOT_H_ */
@@ -0,0 +1,54 @@
+#ifndef OSAL_STACK_H_
+#define OSAL_STACK_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Fill value of unused stack; the first overwritten word marks the high-water mark
+#define OSAL_STACK_PAINT 0xA5A5A5A5UL
+// No-access MPU region at the bottom of each stack (Cortex-M7 has no MSPLIM/PSPLIM).
+// Overflowing into it raises a MemManage fault instead of corrupting the memory below.
+#define OSAL_STACK_GUARD_SIZE 32U
+// Left unpainted below the stack pointer captured by osal_stack_init(), for the frame of
+// osal_stack_paint() and anything the compiler spills below it
+#define OSAL_STACK_PAINT_MARGIN 64U
+
+/**
+ * Paint the unused part of the main stack (int_stack_dtcm, below the current stack pointer) and
+ * arm its guard region (OSAL_MPU_REGION_STACK_GUARD). Call first thing in main().
+ */
+void osal_stack_init(void);
+
+/**
+ * Fill a stack area with OSAL_STACK_PAINT.
+ * @param base: Lowest address, 4-byte aligned.
+ * @param size: Size in bytes.
+ */
+void osal_stack_paint(uint32_t *base, size_t size);
+
+/**
+ * Get the deepest use of a painted stack, scanning up from its bottom to the first overwritten word.
+ * @param base: Lowest address of the stack, above its guard region.
+ * @param size: Size in bytes.
+ * @return: Bytes used at the high-water mark.
+ */
+size_t osal_stack_used(const uint32_t *base, size_t size);
+
+/**
+ * Get the high-water mark of the main stack (MSP: main, startup and all interrupts).
+ * @return: Bytes used above the guard.
+ */
+size_t osal_stack_main_used(void);
+
+/**
+ * Get the size of the main stack.
+ * @return: Size in bytes, guard included.
+ */
+size_t osal_stack_main_size(void);
+
+/**
+ * Log the main stack high-water mark via osal_log_info.
+ */
+void osal_stack_log(void);
+
+#endif /* OSAL_STACK_H_ */
@@ -0,0 +1,36 @@
+#ifndef OSAL_STARTUP_H_
+#define OSAL_STARTUP_H_
+
+#include <stdint.h>
+
+// Init/zero table entries recorded by init_data_bss()
+#define OSAL_STARTUP_MAX_SECTIONS 8U
+// Set in osal_startup_stats.magic once init_data_bss() has filled the record for this boot
+#define OSAL_STARTUP_STATS_MAGIC 0x53545254UL
+
+typedef struct {
+    uint32_t addr;                // RAM start of the section
+    uint32_t size;                // Size in bytes
+    uint32_t rom_size;            // Bytes read from flash (smaller than size for LZ4 images, 0 for zeroing)
+    uint32_t cycles;              // Core cycles spent copying or zeroing it
+} osal_startup_section_t;
+
+// Startup timing, written by init_data_bss() with the DWT cycle counter.
+// Lives in .noinit so the C runtime initialization does not clear it.
+typedef struct {
+    uint32_t magic;
+    uint32_t copy_count;
+    uint32_t zero_count;
+    osal_startup_section_t copy[OSAL_STARTUP_MAX_SECTIONS];
+    osal_startup_section_t zero[OSAL_STARTUP_MAX_SECTIONS];
+    uint32_t init_cycles;         // Whole init_data_bss()
+} osal_startup_stats_t;
+
+extern osal_startup_stats_t osal_startup_stats;
+
+/**
+ * Log the per-section copy/zero times via osal_log_info.
+ */
+void osal_startup_log_stats(void);
+
+#endif /* OSAL_STARTUP_H_ */
@@ -7,6 +7,25 @@
 #include <stdlib.h>
 #include <stdbool.h>
 
+// Define core clock frequency (Hz)
+// Adjust based on your S32K312 clock configuration (e.g., 120000000 for 120 MHz, 30000000 for 30 MHz)
+#define CORE_CLOCK_HZ 120000000UL // Default: 120 MHz, change to 30000000UL if confirmed 30 MHz
+
+// Placement in the tightly coupled memories, copied from flash by the startup init table.
+// ITCM code runs with zero wait states whatever the I-cache holds: use it for interrupt
+// handlers and inner loops. DTCM is not cached and single-cycle; zero-initialized data marked
+// OSAL_FAST_DATA is copied as zeros. tools/fast_sections.py moves more code by profile.
+#define OSAL_FAST_CODE __attribute__((section(".itcm_text")))
+#define OSAL_FAST_DATA __attribute__((section(".dtcm_data")))
+
+// Cortex-M7 debug registers used for cycle counting
+#define OSAL_UTILS_DEMCR       (*(volatile uint32_t *)0xE000EDFCUL)
+#define OSAL_UTILS_DWT_CTRL    (*(volatile uint32_t *)0xE0001000UL)
+#define OSAL_UTILS_DWT_CYCCNT  (*(volatile uint32_t *)0xE0001004UL)
+#define OSAL_UTILS_DWT_LAR     (*(volatile uint32_t *)0xE0001FB0UL)
+#define OSAL_UTILS_DEMCR_TRCENA        (1UL << 24)
+#define OSAL_UTILS_DWT_CTRL_CYCCNTENA  (1UL << 0)
+
 /**
  * Convert a uint8_t array to a hexadecimal string.
  * Each byte is formatted as two uppercase hex digits with a space after each.
@@ -33,4 +52,30 @@ void osal_utils_delay_us(size_t us);
  */
 void osal_utils_delay_ms(size_t ms);
 
+/**
+ * Enable the DWT cycle counter (CYCCNT).
+ * Safe to call more than once; the counter is not reset if it is already running.
+ */
+void osal_utils_cycles_init(void);
+
+/**
+ * Read the DWT cycle counter.
+ * Wraps every 2^32 cycles (about 35 s at 120 MHz); use unsigned subtraction for deltas.
+ * @return: Current core cycle count.
+ */
+static inline uint32_t osal_utils_cycles(void)
+{
+    return OSAL_UTILS_DWT_CYCCNT;
+}
+
+/**
+ * Convert a cycle count to microseconds at CORE_CLOCK_HZ.
+ * @param cycles: Number of core cycles.
+ * @return: Duration in microseconds (truncated).
+ */
+static inline uint32_t osal_utils_cycles_to_us(uint32_t cycles)
+{
+    return cycles / (uint32_t)(CORE_CLOCK_HZ / 1000000UL);
+}
+
 #endif /* OSAL_UTILS_H_ */
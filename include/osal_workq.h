@@ -0,0 +1,103 @@
+#ifndef OSAL_WORKQ_H_
+#define OSAL_WORKQ_H_
+
+#include <stdint.h>
+
+// Entries per priority queue (power of two)
+#define OSAL_WORKQ_DEPTH 16U
+// Number of ISR sources tracked for execution time statistics
+#define OSAL_WORKQ_MAX_SOURCES 8U
+
+// Software interrupt used to drain the queues (CPU-to-CPU interrupt 0, unused on single core)
+#define OSAL_WORKQ_IRQ INT0_IRQn
+// NVIC priority of the drain interrupt (0..15): below every device ISR, above SysTick/PendSV
+#define OSAL_WORKQ_IRQ_PRIORITY 13U
+
+typedef void (*osal_work_fn_t)(void *arg);
+
+typedef enum {
+    OSAL_WORKQ_PRIO_LOW = 0,
+    OSAL_WORKQ_PRIO_HIGH,
+    OSAL_WORKQ_PRIO_COUNT
+} osal_workq_prio_t;
+
+// Per-priority queue statistics (latency in core cycles)
+typedef struct {
+    uint32_t posted;          // Items accepted
+    uint32_t executed;        // Items run
+    uint32_t dropped;         // Items rejected because the queue was full
+    uint32_t depth_max;       // Highest number of pending items observed
+    uint32_t latency_max;     // Longest time from post to start of execution
+} osal_workq_queue_stats_t;
+
+// Per-ISR statistics (execution time in core cycles)
+typedef struct {
+    const char *name;
+    uint32_t count;
+    uint32_t cycles_last;
+    uint32_t cycles_max;
+} osal_workq_source_stats_t;
+
+/**
+ * Initialize the work queues and install the drain handler on OSAL_WORKQ_IRQ.
+ * Must be called before any ISR posts work.
+ */
+void osal_workq_init(void);
+
+/**
+ * Queue a work item and pend the drain interrupt. Lock-free; safe from any ISR priority.
+ * The item runs in the drain interrupt, after the posting ISR returns (tail-chained).
+ * @param prio: Queue to use; high priority items are drained first.
+ * @param fn: Function to run.
+ * @param arg: Argument passed to fn.
+ * @return: 0 on success, -1 if fn is NULL or prio is invalid, -2 if the queue is full.
+ */
+int32_t osal_workq_post(osal_workq_prio_t prio, osal_work_fn_t fn, void *arg);
+
+/**
+ * Name an ISR source for the statistics report.
+ * @param source: Source index below OSAL_WORKQ_MAX_SOURCES.
+ * @param name: Static string.
+ */
+void osal_workq_set_source_name(uint8_t source, const char *name);
+
+/**
+ * Timestamp the start of an ISR. Pair with osal_workq_isr_exit().
+ * @return: Cycle counter value to pass to osal_workq_isr_exit().
+ */
+uint32_t osal_workq_isr_enter(void);
+
+/**
+ * Account the execution time of an ISR.
+ * @param source: Source index below OSAL_WORKQ_MAX_SOURCES.
+ * @param enter_cycles: Value returned by osal_workq_isr_enter().
+ */
+void osal_workq_isr_exit(uint8_t source, uint32_t enter_cycles);
+
+/**
+ * Get the number of items waiting in a queue.
+ * @param prio: Queue to inspect.
+ * @return: Current depth.
+ */
+uint32_t osal_workq_depth(osal_workq_prio_t prio);
+
+/**
+ * Copy the statistics of one queue.
+ * @param prio: Queue to inspect.
+ * @param stats: Output structure.
+ */
+void osal_workq_get_queue_stats(osal_workq_prio_t prio, osal_workq_queue_stats_t *stats);
+
+/**
+ * Copy the statistics of one ISR source.
+ * @param source: Source index below OSAL_WORKQ_MAX_SOURCES.
+ * @param stats: Output structure.
+ */
+void osal_workq_get_source_stats(uint8_t source, osal_workq_source_stats_t *stats);
+
+/**
+ * Log queue and ISR statistics via osal_log_info.
+ */
+void osal_workq_log_stats(void);
+
+#endif /* OSAL_WORKQ_H_ */
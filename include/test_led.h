@@ -1,6 +1,51 @@
 #ifndef TEST_LED_H_
 #define TEST_LED_H_
 
+#include <stdbool.h>
+#include <stdint.h>
+
+// Patterns that can be loaded at runtime (e.g. over UART)
+#define TEST_LED_RAM_SLOTS 2U
+#define TEST_LED_RAM_MAX_STEPS 16U
+
+/**
+ * Queue a demo run of random LED patterns if the pattern engine is idle.
+ * Never blocks: the patterns are played back by test_led_tick().
+ */
 void test_led(void);
 
+/**
+ * Advance the LED pattern engine by one millisecond.
+ * Call from a 1 ms timer event (interrupt context); pattern steps are
+ * applied from the low priority work queue.
+ */
+void test_led_tick(void);
+
+/**
+ * Check whether the pattern engine still has patterns to play.
+ * @return: true while a demo run is in progress.
+ */
+bool test_led_busy(void);
+
+/**
+ * Load a pattern into a RAM slot; it joins the random selection of the next demo run.
+ * Each step is 4 bytes: op_mask (bits 0-2 LED mask G/B/R, bits 6-7 opcode 0=set 1=toggle 2=random),
+ * value (LED levels for set), hold time in ms (16-bit little-endian).
+ * @param slot: Slot index below TEST_LED_RAM_SLOTS.
+ * @param data: Packed steps.
+ * @param len: Length in bytes (multiple of 4, at most TEST_LED_RAM_MAX_STEPS steps).
+ * @return: 0 on success, -1 on invalid size or slot, -2 on an unknown opcode.
+ */
+int32_t test_led_load_pattern(uint8_t slot, const uint8_t *data, uint32_t len);
+
+/**
+ * Append steps to a pattern loaded with test_led_load_pattern(), for patterns longer than
+ * one UART command carries.
+ * @param slot: Slot index below TEST_LED_RAM_SLOTS, holding a pattern.
+ * @param data: Packed steps, as for test_led_load_pattern().
+ * @param len: Length in bytes (multiple of 4; the slot holds at most TEST_LED_RAM_MAX_STEPS steps).
+ * @return: 0 on success, -1 on invalid size, slot or an empty slot, -2 on an unknown opcode.
+ */
+int32_t test_led_append_pattern(uint8_t slot, const uint8_t *data, uint32_t len);
+
 #endif /* TEST_LED_H_ */
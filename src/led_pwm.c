@@ -0,0 +1,194 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "Siul2_Dio_Ip.h"
+#include "Pit_Ip.h"
+#include "S32K312_PIT.h"
+#include "osal_log.h"
+#include "osal_utils.h"
+#include "led_pwm.h"
+
+#define LED_PWM_BITS 8U
+// Length of the shortest (LSB) slice: one frame is 255 of these
+#define LED_PWM_BASE_TICKS (LED_PWM_PIT_CLOCK_HZ / (LED_PWM_FRAME_HZ * 255UL))
+#define LED_PWM_FRAME_CYCLES (CORE_CLOCK_HZ / LED_PWM_FRAME_HZ)
+
+// All three LEDs share one SIUL2 port
+#define LED_PWM_PORT_MASK (uint16_t)((1U << LED_GREEN_PIN) | (1U << LED_BLUE_PIN) | (1U << LED_RED_PIN))
+
+// Gamma 2.2 curve: perceived brightness level -> duty
+static const uint8_t led_pwm_gamma[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2,
+    3, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6,
+    6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10, 11, 11, 11, 12,
+    12, 13, 13, 13, 14, 14, 15, 15, 16, 16, 17, 17, 18, 18, 19, 19,
+    20, 20, 21, 22, 22, 23, 23, 24, 25, 25, 26, 26, 27, 28, 28, 29,
+    30, 30, 31, 32, 33, 33, 34, 35, 35, 36, 37, 38, 39, 39, 40, 41,
+    42, 43, 43, 44, 45, 46, 47, 48, 49, 49, 50, 51, 52, 53, 54, 55,
+    56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71,
+    73, 74, 75, 76, 77, 78, 79, 81, 82, 83, 84, 85, 87, 88, 89, 90,
+    91, 93, 94, 95, 97, 98, 99, 100, 102, 103, 105, 106, 107, 109, 110, 111,
+    113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+    137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161,
+    163, 165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190,
+    192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+    223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253, 255,
+};
+
+static const uint16_t led_pwm_pins[LED_PWM_COUNT] = {
+    (uint16_t)(1U << LED_GREEN_PIN), (uint16_t)(1U << LED_BLUE_PIN), (uint16_t)(1U << LED_RED_PIN),
+};
+
+/*
+ * Binary code modulation: slice k lasts (BASE << k) and drives the LEDs whose duty has bit k set,
+ * so each LED is on for exactly duty/255 of the frame. The waveform is precomputed as one port
+ * value per slice; the ISR only does a table read, a masked port write and a reload preload.
+ * Two tables: the ISR plays the active one, updates go to the other and are swapped in at the
+ * start of a frame so a frame never mixes old and new duties.
+ */
+static uint16_t led_pwm_planes[2][LED_PWM_BITS] OSAL_FAST_DATA;
+static volatile uint8_t led_pwm_active OSAL_FAST_DATA;
+static volatile bool led_pwm_swap_pending OSAL_FAST_DATA;
+static uint8_t led_pwm_duty[LED_PWM_COUNT];
+static uint8_t led_pwm_slice OSAL_FAST_DATA; // Slice the PIT is counting when the next interrupt fires
+static volatile bool led_pwm_enabled OSAL_FAST_DATA;
+
+static uint32_t led_pwm_frame_acc OSAL_FAST_DATA;
+static led_pwm_stats_t led_pwm_stats;
+
+// Rebuild the inactive table from the duty values and hand it to the ISR (thread context)
+static void led_pwm_commit(void)
+{
+    // Keep the ISR from swapping while the back table is written
+    led_pwm_swap_pending = false;
+    uint16_t *planes = led_pwm_planes[led_pwm_active ^ 1U];
+
+    for (uint32_t bit = 0U; bit < LED_PWM_BITS; bit++) {
+        uint16_t value = 0U;
+        for (uint32_t led = 0U; led < (uint32_t)LED_PWM_COUNT; led++) {
+            if ((led_pwm_duty[led] & (1U << bit)) != 0U) {
+                value |= led_pwm_pins[led];
+            }
+        }
+        planes[bit] = value;
+    }
+
+    if (led_pwm_enabled) {
+        led_pwm_swap_pending = true;
+    } else {
+        // Not running: nothing reads the tables, take it over directly
+        led_pwm_active ^= 1U;
+    }
+}
+
+OSAL_FAST_CODE void led_pwm_pit_callback(void)
+{
+    uint32_t enter = osal_utils_cycles();
+    uint8_t slice = led_pwm_slice;
+
+    // The PIT has just reloaded with the length of this slice (preloaded by the previous interrupt)
+    if ((slice == 0U) && led_pwm_swap_pending) {
+        led_pwm_active ^= 1U;
+        led_pwm_swap_pending = false;
+    }
+    Siul2_Dio_Ip_MaskedWritePins(LED_GREEN_PORT, led_pwm_planes[led_pwm_active][slice], LED_PWM_PORT_MASK);
+
+    // LDVAL only takes effect at the next reload, so the running slice keeps its length
+    uint8_t next = (uint8_t)((slice + 1U) & (LED_PWM_BITS - 1U));
+    IP_PIT_0->TIMER[LED_PWM_PIT_CHANNEL].LDVAL = LED_PWM_BASE_TICKS << next;
+    led_pwm_slice = next;
+
+    // Exception entry and the RTD dispatcher are not included; they add a fixed cost per slice
+    led_pwm_frame_acc += osal_utils_cycles() - enter;
+    if (next == 0U) {
+        led_pwm_stats.frames++;
+        led_pwm_stats.cycles_last = led_pwm_frame_acc;
+        if (led_pwm_frame_acc > led_pwm_stats.cycles_max) {
+            led_pwm_stats.cycles_max = led_pwm_frame_acc;
+        }
+        led_pwm_frame_acc = 0U;
+    }
+}
+
+void led_pwm_start(void)
+{
+    if (led_pwm_enabled) {
+        return;
+    }
+
+    osal_utils_cycles_init();
+    led_pwm_stats.frame_cycles = LED_PWM_FRAME_CYCLES;
+    led_pwm_frame_acc = 0U;
+    led_pwm_swap_pending = false;
+
+    // Output slice 0 now; the first interrupt marks its end
+    led_pwm_slice = 1U;
+    Siul2_Dio_Ip_MaskedWritePins(LED_GREEN_PORT, led_pwm_planes[led_pwm_active][0], LED_PWM_PORT_MASK);
+    led_pwm_enabled = true;
+
+    Pit_Ip_InitChannel(LED_PWM_PIT_INSTANCE, PIT_0_CH_1);
+    Pit_Ip_EnableChannelInterrupt(LED_PWM_PIT_INSTANCE, LED_PWM_PIT_CHANNEL);
+    Pit_Ip_StartChannel(LED_PWM_PIT_INSTANCE, LED_PWM_PIT_CHANNEL, LED_PWM_BASE_TICKS);
+    IP_PIT_0->TIMER[LED_PWM_PIT_CHANNEL].LDVAL = LED_PWM_BASE_TICKS << 1U;
+}
+
+void led_pwm_stop(void)
+{
+    if (!led_pwm_enabled) {
+        return;
+    }
+
+    Pit_Ip_StopChannel(LED_PWM_PIT_INSTANCE, LED_PWM_PIT_CHANNEL);
+    led_pwm_enabled = false;
+    if (led_pwm_swap_pending) {
+        led_pwm_active ^= 1U;
+        led_pwm_swap_pending = false;
+    }
+    Siul2_Dio_Ip_MaskedWritePins(LED_GREEN_PORT, 0U, LED_PWM_PORT_MASK);
+}
+
+bool led_pwm_running(void)
+{
+    return led_pwm_enabled;
+}
+
+void led_pwm_set_duty(led_pwm_led_t led, uint8_t duty)
+{
+    if ((uint32_t)led >= (uint32_t)LED_PWM_COUNT) {
+        return;
+    }
+    led_pwm_duty[led] = duty;
+    led_pwm_commit();
+}
+
+void led_pwm_set_brightness(led_pwm_led_t led, uint8_t level)
+{
+    led_pwm_set_duty(led, led_pwm_gamma[level]);
+}
+
+void led_pwm_get_stats(led_pwm_stats_t *stats)
+{
+    *stats = led_pwm_stats;
+}
+
+void led_pwm_log_stats(void)
+{
+    char log_buffer[LOG_BUFFER_SIZE];
+    led_pwm_stats_t stats;
+
+    led_pwm_get_stats(&stats);
+    if (stats.frame_cycles == 0U) {
+        return;
+    }
+    // Hundredths of a percent of the frame spent in the PWM interrupt
+    uint32_t last = (uint32_t)(((uint64_t)stats.cycles_last * 10000U) / stats.frame_cycles);
+    uint32_t max = (uint32_t)(((uint64_t)stats.cycles_max * 10000U) / stats.frame_cycles);
+    snprintf(log_buffer, LOG_BUFFER_SIZE,
+             "PWM %lu frames: %lu cycles/frame (%lu.%02lu%%), max %lu (%lu.%02lu%%)\r\n",
+             (unsigned long)stats.frames, (unsigned long)stats.cycles_last,
+             (unsigned long)(last / 100U), (unsigned long)(last % 100U), (unsigned long)stats.cycles_max,
+             (unsigned long)(max / 100U), (unsigned long)(max % 100U));
+    osal_log_info(log_buffer);
+}
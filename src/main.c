@@ -38,25 +38,33 @@
 #include "Clock_Ip.h"
 #include "IntCtrl_Ip.h"
 #include "Pit_Ip.h"
+#include "osal_boot_profile.h"
+#include "osal_crc.h"
+#include "osal_devinfo.h"
+#include "osal_fault.h"
+#include "osal_fwupd.h"
+#include "osal_heap.h"
+#include "osal_image.h"
+#include "osal_irq_lat.h"
+#include "osal_kernel.h"
+#include "osal_kv.h"
 #include "osal_log.h"
+#include "osal_mpu.h"
+#include "osal_ram.h"
+#include "osal_reset.h"
+#include "osal_secboot.h"
+#include "osal_slot.h"
+#include "osal_stack.h"
+#include "osal_startup.h"
 #include "osal_utils.h"
+#include "osal_workq.h"
 #include "test_cmac.h"
 #include "test_led.h"
+#include "led_pwm.h"
 
-#define APP_METADATA_MAGIC 0xAABBCCDDU
-#define APP_NAME_MAX_LEN 16U
-#define APP_VERSION_MAX_LEN 12U
-
-// Application metadata structure
-typedef struct {
-    uint32_t magic;                         // 0x00: Identifier
-    char     app_name[APP_NAME_MAX_LEN];    // 0x04: Null-terminated app name
-    char     version[APP_VERSION_MAX_LEN];  // 0x14: Null-terminated version
-    char    *build_timestamp;               // 0x24: Null-terminated build date and time string
-    uint32_t flash_start_addr;              // 0x28: App binary flash base address
-    uint32_t image_size;                    // 0x2C: Size in bytes for CRC coverage
-    uint32_t crc32;                         // 0x30: CRC32 over image (excluding metadata)
-} app_metadata_t;
+// Slot base and size of the flash image, from the linker script (only the symbol addresses are meaningful)
+extern uint8_t __app_image_start[];
+extern uint8_t __app_image_size[];
 
 // Static string for build timestamp
 static const char build_timestamp[] = __DATE__ " " __TIME__;
@@ -68,9 +76,11 @@ const app_metadata_t app_metadata __attribute__((section(".app_metadata"))) =
     .app_name = "MainApp",
     .version = "v1.2.3",
     .build_timestamp = (char *)build_timestamp, // Reference to static timestamp string
-    .flash_start_addr = 0x00440000U,  // Example Flash base address
-    .image_size = 0x00190000U,        // Example image size
-    .crc32 = 0U                       // To be filled by post-build script
+    .flash_start_addr = (uint32_t)__app_image_start,  // Start of the slot (int_pflash)
+    .image_size = (uint32_t)__app_image_size,  // Code and RAM init images, up to __app_image_end
+    .crc32 = 0U,                      // Filled by tools/crc_stamp.py
+    .sequence = 0U,                   // Filled by tools/crc_stamp.py --sequence
+    .version_code = APP_VERSION_CODE(1, 2, 3)
 };
 // Buffer for log messages
 volatile int exit_code = 0;
@@ -84,21 +94,123 @@ volatile int exit_code = 0;
 // PIT time-out period - equivalent to 1s
 #define PIT_PERIOD 40000000
 
+// UART command: 'P' <slot> <step count> <steps...> loads an LED pattern (see test_led.h).
+// One command carries up to 11 steps; longer patterns (up to TEST_LED_RAM_MAX_STEPS) send
+// the rest in further commands with CMD_LOAD_PATTERN_APPEND set in the slot byte.
+#define CMD_LOAD_PATTERN 'P'
+#define CMD_LOAD_PATTERN_HDR 3U
+#define CMD_LOAD_PATTERN_APPEND 0x80U
+// UART command: 'B' <green> <blue> <red> sets PWM brightness levels; all zero returns to the pattern demo
+#define CMD_BRIGHTNESS 'B'
+// UART command: 'I' measures and reports the interrupt entry latency
+#define CMD_IRQ_LATENCY 'I'
+// UART command: 'S' reports the stack high-water marks
+#define CMD_STACKS 'S'
+// UART command: 'H' reports the heap regions and fragmentation
+#define CMD_HEAP 'H'
+// UART command: 'C' runs the CRC engine selftest and throughput benchmark
+#define CMD_CRC 'C'
+// UART command: 'U' receives a firmware update into the inactive slot (tools/fw_send.py)
+#define CMD_UPDATE 'U'
+// UART command: 'K' reports the key-value store (and, with OSAL_KV_BENCHMARK_ENABLE, benchmarks a
+// mount of a full partition)
+#define CMD_KV 'K'
+// UART command: 'F' reports the last fault stored in data flash and the fault count
+#define CMD_FAULT 'F'
+// UART command: 'D' answers with one binary device info frame (osal_devinfo.h, tools/dev_info.py)
+#define CMD_DEVINFO 'D'
+// UART command: 'W' reports the work queue and ISR statistics
+#define CMD_WORKQ 'W'
+// UART command: 'T' wakes the probe task from interrupt context and reports the kernel timing
+#define CMD_KERNEL 'T'
+// UART command: 'R' performs a functional (warm) reset
+#define CMD_RESET 'R'
+// Bytes of the application image used by the CRC benchmark
+#define CRC_BENCH_SIZE 0x10000U
+
+// ISR sources tracked by the work queue statistics
+#define ISR_SOURCE_PIT0 0U
+
+// Kernel tasks: the UART command loop runs at the lowest application priority, the probe
+// task above it is woken from interrupt context to measure switch time and wakeup latency
+#define TASK_APP_PRIO 1U
+#define TASK_APP_STACK 4096U
+#define TASK_PROBE_PRIO 2U
+#define TASK_PROBE_STACK 512U
+// Wakeups per 'T' command
+#define KERNEL_PROBE_ROUNDS 100U
+
 // Global buffers
 uint8_t rxBuffer[BUFFER_SIZE];
 uint8_t txBuffer[BUFFER_SIZE];
-volatile uint8_t toggleLed = 0U;
+
+// Deferred part of the PIT notification: runs in the work queue interrupt
+static void toggle_red_led_work(void *arg)
+{
+    (void)arg;
+    if (led_pwm_running()) {
+        return; // The PWM engine owns the LED pins
+    }
+    Siul2_Dio_Ip_TogglePins(LED_RED_PORT, (1 << LED_RED_PIN));
+}
 
 // Pit notification called by the configured channel periodically
 void pit0_callback_handler(void)
 {
-	toggleLed = 1U;
+    uint32_t enter = osal_workq_isr_enter();
+    (void)osal_workq_post(OSAL_WORKQ_PRIO_HIGH, toggle_red_led_work, NULL);
+    osal_workq_isr_exit(ISR_SOURCE_PIT0, enter);
+}
+
+static osal_task_t app_task;
+static osal_task_t probe_task;
+static volatile uint32_t probe_wakeups;
+
+// Runs in the work queue interrupt: an ISR-to-task wakeup
+static void probe_notify_work(void *arg)
+{
+    osal_kernel_notify_from_isr((osal_task_t *)arg);
+}
+
+static void probe_task_fn(void *arg)
+{
+    (void)arg;
+    while (1) {
+        osal_kernel_wait();
+        probe_wakeups++;
+    }
+}
+
+// Wake the probe task from interrupt context; each round switches to it and back
+static void kernel_probe(void)
+{
+    for (uint32_t i = 0U; i < KERNEL_PROBE_ROUNDS; i++) {
+        uint32_t expected = probe_wakeups + 1U;
+        if (osal_workq_post(OSAL_WORKQ_PRIO_LOW, probe_notify_work, &probe_task) != 0) {
+            break;
+        }
+        while (probe_wakeups != expected) {
+            ; // The probe task outranks this one: it has run once the work item has
+        }
+    }
+    osal_kernel_log_stats();
+}
+
+// Kernel tick (1 ms): drives the LED pattern engine (paused while PWM dimming is active)
+void osal_kernel_tick_hook(void)
+{
+    if (!led_pwm_running()) {
+        test_led_tick();
+    }
 }
 
 void board_level_init(void)
 {
-    // 1. Initialize clock
-    Clock_Ip_Init(&Clock_Ip_aClockConfig[0]);
+    // 1. Initialize clock, unless a warm reset left the whole clock tree as the last full init did
+    if (!osal_reset_clock_kept()) {
+        Clock_Ip_Init(&Clock_Ip_aClockConfig[0]);
+    }
+    osal_reset_mark_clock();
 
     // 2. Initialize ports
     Siul2_Port_Ip_Init(NUM_OF_CONFIGURED_PINS_PortContainer_0_BOARD_InitPeripherals,
@@ -106,6 +218,10 @@ void board_level_init(void)
     OsIf_Init(NULL);
     // 3. Initialize interrupt controller
     IntCtrl_Ip_Init(&IntCtrlConfig_0);
+    osal_workq_init();
+    osal_workq_set_source_name(ISR_SOURCE_PIT0, "PIT0");
+    osal_kernel_init();
+    osal_irq_lat_init();
 
     // 4. Initialize LPUART6
     Lpuart_Uart_Ip_Init(LPUART_INSTANCE, &Lpuart_Uart_Ip_xHwConfigPB_6);
@@ -117,23 +233,16 @@ void board_level_init(void)
     Pit_Ip_StartChannel(PIT_INST_0, CH_0, PIT_PERIOD);
 }
 
-int main(void)
+// UART command loop
+static void app_task_fn(void *arg)
 {
-
-	board_level_init();
-
-    // Send welcome message
-	osal_log_info((const char *)WELCOME_MSG);
-
-    test_mbedtls_cmac();
-    // Wait for transmission to complete
     uint32_t bytesRemaining;
-    while (Lpuart_Uart_Ip_GetTransmitStatus(LPUART_INSTANCE, &bytesRemaining) == LPUART_UART_IP_STATUS_BUSY);
+
+    (void)arg;
 
     // Start asynchronous receive
     Lpuart_Uart_Ip_AsyncReceive(LPUART_INSTANCE, rxBuffer, BUFFER_SIZE);
 
-
     // Main loop
     while (1)
     {
@@ -142,6 +251,112 @@ int main(void)
 
         if (rxStatus == LPUART_UART_IP_STATUS_SUCCESS)
         {
+            if (rxBuffer[0] == (uint8_t)CMD_LOAD_PATTERN)
+            {
+                // Load an LED pattern, reply with the status instead of the echo
+                uint32_t len = (uint32_t)rxBuffer[2] * 4U;
+                int32_t ret = -1;
+                uint8_t slot = rxBuffer[1] & (uint8_t)~CMD_LOAD_PATTERN_APPEND;
+                if (len > (BUFFER_SIZE - CMD_LOAD_PATTERN_HDR)) {
+                    // More steps than one command holds: use CMD_LOAD_PATTERN_APPEND
+                } else if ((rxBuffer[1] & CMD_LOAD_PATTERN_APPEND) != 0U) {
+                    ret = test_led_append_pattern(slot, &rxBuffer[CMD_LOAD_PATTERN_HDR], len);
+                } else {
+                    ret = test_led_load_pattern(slot, &rxBuffer[CMD_LOAD_PATTERN_HDR], len);
+                }
+                osal_log_info((ret == 0) ? "PATTERN OK\r\n" : "PATTERN ERR\r\n");
+                Lpuart_Uart_Ip_AsyncReceive(LPUART_INSTANCE, rxBuffer, BUFFER_SIZE);
+                continue;
+            }
+            if (rxBuffer[0] == (uint8_t)CMD_BRIGHTNESS)
+            {
+                if ((rxBuffer[1] | rxBuffer[2] | rxBuffer[3]) == 0U) {
+                    led_pwm_stop();
+                } else {
+                    led_pwm_set_brightness(LED_PWM_GREEN, rxBuffer[1]);
+                    led_pwm_set_brightness(LED_PWM_BLUE, rxBuffer[2]);
+                    led_pwm_set_brightness(LED_PWM_RED, rxBuffer[3]);
+                    led_pwm_start();
+                }
+                led_pwm_log_stats();
+                Lpuart_Uart_Ip_AsyncReceive(LPUART_INSTANCE, rxBuffer, BUFFER_SIZE);
+                continue;
+            }
+            if (rxBuffer[0] == (uint8_t)CMD_IRQ_LATENCY)
+            {
+                osal_irq_lat_measure();
+                osal_irq_lat_log();
+                Lpuart_Uart_Ip_AsyncReceive(LPUART_INSTANCE, rxBuffer, BUFFER_SIZE);
+                continue;
+            }
+            if (rxBuffer[0] == (uint8_t)CMD_STACKS)
+            {
+                osal_stack_log();
+                osal_kernel_log_stacks();
+                Lpuart_Uart_Ip_AsyncReceive(LPUART_INSTANCE, rxBuffer, BUFFER_SIZE);
+                continue;
+            }
+            if (rxBuffer[0] == (uint8_t)CMD_HEAP)
+            {
+                osal_heap_log();
+                Lpuart_Uart_Ip_AsyncReceive(LPUART_INSTANCE, rxBuffer, BUFFER_SIZE);
+                continue;
+            }
+            if (rxBuffer[0] == (uint8_t)CMD_CRC)
+            {
+                uint32_t bench_size = (app_metadata.image_size < CRC_BENCH_SIZE) ? app_metadata.image_size : CRC_BENCH_SIZE;
+                (void)osal_crc_selftest();
+                osal_crc_log_benchmark((const void *)app_metadata.flash_start_addr, bench_size);
+                Lpuart_Uart_Ip_AsyncReceive(LPUART_INSTANCE, rxBuffer, BUFFER_SIZE);
+                continue;
+            }
+            if (rxBuffer[0] == (uint8_t)CMD_UPDATE)
+            {
+                (void)osal_fwupd_run_uart();
+                osal_fwupd_log();
+                Lpuart_Uart_Ip_AsyncReceive(LPUART_INSTANCE, rxBuffer, BUFFER_SIZE);
+                continue;
+            }
+            if (rxBuffer[0] == (uint8_t)CMD_KV)
+            {
+#ifdef OSAL_KV_BENCHMARK_ENABLE
+                osal_kv_benchmark();
+#endif
+                osal_kv_log();
+                Lpuart_Uart_Ip_AsyncReceive(LPUART_INSTANCE, rxBuffer, BUFFER_SIZE);
+                continue;
+            }
+            if (rxBuffer[0] == (uint8_t)CMD_DEVINFO)
+            {
+                osal_devinfo_send();
+                Lpuart_Uart_Ip_AsyncReceive(LPUART_INSTANCE, rxBuffer, BUFFER_SIZE);
+                continue;
+            }
+            if (rxBuffer[0] == (uint8_t)CMD_WORKQ)
+            {
+                osal_workq_log_stats();
+                Lpuart_Uart_Ip_AsyncReceive(LPUART_INSTANCE, rxBuffer, BUFFER_SIZE);
+                continue;
+            }
+            if (rxBuffer[0] == (uint8_t)CMD_KERNEL)
+            {
+                kernel_probe();
+                Lpuart_Uart_Ip_AsyncReceive(LPUART_INSTANCE, rxBuffer, BUFFER_SIZE);
+                continue;
+            }
+            if (rxBuffer[0] == (uint8_t)CMD_RESET)
+            {
+                osal_log_info("Warm reset\r\n");
+                while (Lpuart_Uart_Ip_GetTransmitStatus(LPUART_INSTANCE, &bytesRemaining) == LPUART_UART_IP_STATUS_BUSY);
+                osal_reset_functional();
+            }
+            if (rxBuffer[0] == (uint8_t)CMD_FAULT)
+            {
+                osal_fault_log_stored();
+                Lpuart_Uart_Ip_AsyncReceive(LPUART_INSTANCE, rxBuffer, BUFFER_SIZE);
+                continue;
+            }
+
             // Echo received data
             memcpy(txBuffer, rxBuffer, bytesRemaining);
             Lpuart_Uart_Ip_SyncSend(LPUART_INSTANCE, txBuffer, bytesRemaining, 5000);
@@ -159,15 +374,74 @@ int main(void)
             Lpuart_Uart_Ip_AsyncReceive(LPUART_INSTANCE, rxBuffer, BUFFER_SIZE);
         }
 
-        // Toggle the Red LED when the pit notification is called
-        if (toggleLed == 1U) {
-        	Siul2_Dio_Ip_TogglePins(LED_RED_PORT, (1 << LED_RED_PIN));
-        	toggleLed = 0U;
+        // Reclaim key-value store sectors in the background
+        osal_kv_poll();
+
+        // Blink LEDs to indicate running state (queues a new demo run when idle, never blocks)
+        if (!led_pwm_running()) {
+            test_led();
         }
+    }
+}
 
-        // Blink LEDs to indicate running state
-        test_led();
+int main(void)
+{
+    osal_boot_profile_mark_main();
+    osal_reset_init();
+    osal_stack_init();
+    osal_fault_init();
+    osal_heap_init();
+
+	board_level_init();
+    osal_reset_mark_operational();
+
+    // Send welcome message
+	osal_log_info((const char *)WELCOME_MSG);
+    osal_boot_profile_log();
+    osal_reset_log();
+    osal_startup_log_stats();
+    osal_ram_log();
+    osal_mpu_log();
+
+    osal_image_check_t image_check;
+    (void)osal_image_verify(&app_metadata, &image_check);
+    osal_image_log(&app_metadata, &image_check);
+    (void)osal_crc_selftest();
+
+    osal_secboot_report_t secboot;
+    (void)osal_secboot_verify(&app_metadata, &secboot);
+    osal_secboot_log(&secboot);
+    osal_devinfo_note_boot(&image_check, &secboot);
+    osal_slot_note_running(((image_check.status == 0) && ((secboot.status == 0) || (secboot.status == -4))) ? 0 : -1);
+    // Fall back to (or move on to) the slot the selection chose; the chosen image runs the
+    // same selection, finds the cached verdicts and stays
+    int32_t boot_slot = osal_slot_boot_select();
+    if ((boot_slot >= 0) && (boot_slot != osal_slot_of((uint32_t)(uintptr_t)&app_metadata))) {
+        uint32_t pending;
+        osal_log_info("Starting the selected slot\r\n");
+        while (Lpuart_Uart_Ip_GetTransmitStatus(LPUART_INSTANCE, &pending) == LPUART_UART_IP_STATUS_BUSY);
+        (void)osal_slot_jump((uint32_t)boot_slot);
+        osal_log_info("Slot jump refused: no vector table, staying in this slot\r\n");
     }
+    (void)osal_kv_init();
+    osal_kv_log();
+    (void)osal_fault_boot_report();
+
+    test_mbedtls_cmac();
+    // Wait for transmission to complete
+    uint32_t bytesRemaining;
+    while (Lpuart_Uart_Ip_GetTransmitStatus(LPUART_INSTANCE, &bytesRemaining) == LPUART_UART_IP_STATUS_BUSY);
+
+    osal_irq_lat_measure();
+    osal_irq_lat_log();
+    osal_stack_log();
+    osal_heap_log();
+
+    // The command loop continues as the lowest application task
+    (void)osal_kernel_task_create(&probe_task, "probe", probe_task_fn, NULL, TASK_PROBE_PRIO, TASK_PROBE_STACK);
+    (void)osal_kernel_task_create(&app_task, "app", app_task_fn, NULL, TASK_APP_PRIO, TASK_APP_STACK);
+    osal_kernel_log_stacks();
+    osal_kernel_start();
 
     return exit_code;
 }
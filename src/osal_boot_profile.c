@@ -0,0 +1,65 @@
+#include "osal_boot_profile.h"
+#include "osal_log.h"
+#include "osal_utils.h"
+#include <stdio.h>
+
+#ifdef BOOT_PROFILE_ENABLE
+
+// Filled by Reset_Handler before the C runtime is set up; startup_cm7.s only writes it
+// when this symbol is linked in (weak reference)
+osal_boot_profile_t osal_boot_profile __attribute__((section(".noinit")));
+
+static const char *const osal_boot_phase_names[OSAL_BOOT_PHASE_COUNT] = {
+    "early", "sram ecc", "dtcm ecc", "itcm ecc", "data/bss", "fpu", "system init", "to main",
+};
+
+void osal_boot_profile_mark_main(void)
+{
+    osal_boot_profile.stamps[OSAL_BOOT_PHASE_MAIN] = osal_utils_cycles();
+}
+
+void osal_boot_profile_log(void)
+{
+    char log_buffer[LOG_BUFFER_SIZE];
+    uint32_t prev = 0U;
+    uint32_t longest = 0U;
+    uint32_t longest_cycles = 0U;
+
+    if (osal_boot_profile.magic != OSAL_BOOT_PROFILE_MAGIC) {
+        osal_log_info("Boot profile not recorded\r\n");
+        return;
+    }
+
+    // The reset path runs from the reset clock (Clock_Ip_Init comes later in main), so only
+    // cycle counts are reported
+    for (uint32_t i = 0U; i < (uint32_t)OSAL_BOOT_PHASE_COUNT; i++) {
+        uint32_t cycles = osal_boot_profile.stamps[i] - prev;
+        prev = osal_boot_profile.stamps[i];
+        if (cycles > longest_cycles) {
+            longest_cycles = cycles;
+            longest = i;
+        }
+        snprintf(log_buffer, LOG_BUFFER_SIZE, "Boot %-12s %8lu cycles\r\n", osal_boot_phase_names[i],
+                 (unsigned long)cycles);
+        osal_log_info(log_buffer);
+    }
+    snprintf(log_buffer, LOG_BUFFER_SIZE, "Boot total %lu cycles, longest phase: %s (%lu%%)\r\n",
+             (unsigned long)prev, osal_boot_phase_names[longest],
+             (unsigned long)((prev != 0U) ? (uint32_t)(((uint64_t)longest_cycles * 100U) / prev) : 0U));
+    osal_log_info(log_buffer);
+
+    // Invalidate so a later boot that does not record is not reported with stale data
+    osal_boot_profile.magic = 0U;
+}
+
+#else
+
+void osal_boot_profile_mark_main(void)
+{
+}
+
+void osal_boot_profile_log(void)
+{
+}
+
+#endif /* BOOT_PROFILE_ENABLE */
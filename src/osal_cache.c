@@ -0,0 +1,166 @@
+#include "osal_cache.h"
+
+// Cortex-M7 cache maintenance registers
+#define SCB_CCR      (*(volatile uint32_t *)0xE000ED14UL)
+#define SCB_CCSIDR   (*(volatile uint32_t *)0xE000ED80UL)
+#define SCB_CSSELR   (*(volatile uint32_t *)0xE000ED84UL)
+#define SCB_DCIMVAC  (*(volatile uint32_t *)0xE000EF5CUL)
+#define SCB_DCISW    (*(volatile uint32_t *)0xE000EF60UL)
+#define SCB_DCCMVAC  (*(volatile uint32_t *)0xE000EF68UL)
+#define SCB_DCCIMVAC (*(volatile uint32_t *)0xE000EF70UL)
+#define SCB_DCCISW   (*(volatile uint32_t *)0xE000EF74UL)
+
+#define SCB_CCR_DC   (1UL << 16)
+
+#define OSAL_CACHE_LINE_MASK ((uintptr_t)OSAL_CACHE_LINE_SIZE - 1U)
+
+// Write-back/allocate SRAM (MPU region 6); the non-cacheable window starts right after it
+extern uint8_t __INT_SRAM_START[];
+extern uint8_t __SRAM_NC_START[];
+
+static inline void osal_cache_dsb(void)
+{
+    __asm volatile ("dsb" ::: "memory");
+}
+
+uint32_t osal_cache_dcache_enabled(void)
+{
+    return ((SCB_CCR & SCB_CCR_DC) != 0U) ? 1U : 0U;
+}
+
+// Apply a by-address operation to every line overlapping [start, end)
+static void osal_cache_op_lines(volatile uint32_t *op, uintptr_t start, uintptr_t end)
+{
+    for (uintptr_t line = start & ~OSAL_CACHE_LINE_MASK; line < end; line += OSAL_CACHE_LINE_SIZE) {
+        *op = (uint32_t)line;
+    }
+}
+
+void osal_cache_clean_range(const void *addr, size_t size)
+{
+    if ((size == 0U) || (osal_cache_dcache_enabled() == 0U)) {
+        return;
+    }
+    osal_cache_dsb();
+    osal_cache_op_lines(&SCB_DCCMVAC, (uintptr_t)addr, (uintptr_t)addr + size);
+    osal_cache_dsb();
+}
+
+void osal_cache_invalidate_range(void *addr, size_t size)
+{
+    if ((size == 0U) || (osal_cache_dcache_enabled() == 0U)) {
+        return;
+    }
+
+    uintptr_t start = (uintptr_t)addr;
+    uintptr_t end = start + size;
+
+    osal_cache_dsb();
+    // Partial lines are shared with other data: write them back before dropping them
+    if ((start & OSAL_CACHE_LINE_MASK) != 0U) {
+        SCB_DCCIMVAC = (uint32_t)(start & ~OSAL_CACHE_LINE_MASK);
+        start = (start & ~OSAL_CACHE_LINE_MASK) + OSAL_CACHE_LINE_SIZE;
+    }
+    if (((end & OSAL_CACHE_LINE_MASK) != 0U) && (end > start)) {
+        SCB_DCCIMVAC = (uint32_t)(end & ~OSAL_CACHE_LINE_MASK);
+        end &= ~OSAL_CACHE_LINE_MASK;
+    }
+    if (end > start) {
+        osal_cache_op_lines(&SCB_DCIMVAC, start, end);
+    }
+    osal_cache_dsb();
+    __asm volatile ("isb" ::: "memory");
+}
+
+void osal_cache_flush_range(const void *addr, size_t size)
+{
+    if ((size == 0U) || (osal_cache_dcache_enabled() == 0U)) {
+        return;
+    }
+    osal_cache_dsb();
+    osal_cache_op_lines(&SCB_DCCIMVAC, (uintptr_t)addr, (uintptr_t)addr + size);
+    osal_cache_dsb();
+    __asm volatile ("isb" ::: "memory");
+}
+
+static void osal_cache_op_set_way(volatile uint32_t *op)
+{
+    SCB_CSSELR = 0U; // L1 data cache
+    osal_cache_dsb();
+    uint32_t ccsidr = SCB_CCSIDR;
+    uint32_t sets = ((ccsidr >> 13) & 0x7FFFU) + 1U;
+    uint32_t ways = ((ccsidr >> 3) & 0x3FFU) + 1U;
+    uint32_t line_shift = (ccsidr & 0x7U) + 4U;
+    uint32_t way_shift = (ways > 1U) ? (uint32_t)__builtin_clz(ways - 1U) : 0U;
+
+    for (uint32_t set = 0U; set < sets; set++) {
+        for (uint32_t way = 0U; way < ways; way++) {
+            *op = (set << line_shift) | (way << way_shift);
+        }
+    }
+    osal_cache_dsb();
+    __asm volatile ("isb" ::: "memory");
+}
+
+void osal_cache_flush_all(void)
+{
+    osal_cache_op_set_way(&SCB_DCCISW);
+}
+
+void osal_cache_invalidate_all(void)
+{
+    osal_cache_op_set_way(&SCB_DCISW);
+}
+
+int32_t osal_dma_buf_init(osal_dma_buf_t *buf, void *addr, size_t size)
+{
+    if ((buf == NULL) || (addr == NULL) || (size == 0U)) {
+        return -1;
+    }
+
+    uintptr_t start = (uintptr_t)addr;
+    buf->cacheable = ((start < (uintptr_t)__SRAM_NC_START) && ((start + size) > (uintptr_t)__INT_SRAM_START)) ? 1U : 0U;
+    if ((buf->cacheable != 0U) && (((start | size) & OSAL_CACHE_LINE_MASK) != 0U)) {
+        return -2;
+    }
+    buf->addr = addr;
+    buf->size = size;
+    buf->state = (uint8_t)OSAL_DMA_BUF_CPU;
+    return 0;
+}
+
+int32_t osal_dma_buf_to_device(osal_dma_buf_t *buf)
+{
+    if (buf->state != (uint8_t)OSAL_DMA_BUF_CPU) {
+        return -1;
+    }
+    if (buf->cacheable != 0U) {
+        osal_cache_clean_range(buf->addr, buf->size);
+    }
+    buf->state = (uint8_t)OSAL_DMA_BUF_TO_DEVICE;
+    return 0;
+}
+
+int32_t osal_dma_buf_from_device(osal_dma_buf_t *buf)
+{
+    if (buf->state != (uint8_t)OSAL_DMA_BUF_CPU) {
+        return -1;
+    }
+    if (buf->cacheable != 0U) {
+        osal_cache_flush_range(buf->addr, buf->size);
+    }
+    buf->state = (uint8_t)OSAL_DMA_BUF_FROM_DEVICE;
+    return 0;
+}
+
+int32_t osal_dma_buf_to_cpu(osal_dma_buf_t *buf)
+{
+    if (buf->state == (uint8_t)OSAL_DMA_BUF_CPU) {
+        return -1;
+    }
+    if ((buf->state == (uint8_t)OSAL_DMA_BUF_FROM_DEVICE) && (buf->cacheable != 0U)) {
+        osal_cache_invalidate_range(buf->addr, buf->size);
+    }
+    buf->state = (uint8_t)OSAL_DMA_BUF_CPU;
+    return 0;
+}
@@ -0,0 +1,570 @@
+#include "osal_crc.h"
+#include "osal_cache.h"
+#include "osal_crc32.h"
+#include "osal_log.h"
+#include "osal_utils.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+// The engine computes a non-reflected CRC of width 16 or 32, MSB first. Reflected protocols
+// use the write transposition (bits and bytes) so little-endian words enter LSB first, and
+// the output reflection is done in software from the raw register. An 8-bit CRC runs in the
+// 16-bit engine with the polynomial and seed shifted up by 8: the low byte stays zero and
+// the high byte is the 8-bit register.
+#define OSAL_CRC_TOT_NONE        0UL
+#define OSAL_CRC_TOT_BITS        1UL   // Bits within each byte
+#define OSAL_CRC_TOT_BITS_BYTES  2UL   // Bits and bytes (full 32-bit reversal)
+#define OSAL_CRC_TOT_BYTES       3UL   // Bytes only
+
+typedef struct {
+    uint8_t width;
+    bool reflect;
+    uint32_t poly;
+    uint32_t init;
+    uint32_t xorout;
+} osal_crc_param_t;
+
+static const osal_crc_param_t osal_crc_params[OSAL_CRC_PROTOCOL_COUNT] = {
+    [OSAL_CRC_32]          = { 32U, true,  0x04C11DB7UL, 0xFFFFFFFFUL, 0xFFFFFFFFUL },
+    [OSAL_CRC_16_CCITT]    = { 16U, false, 0x1021UL,     0xFFFFUL,     0x0000UL },
+    [OSAL_CRC_8_SAE_J1850] = { 8U,  false, 0x1DUL,       0xFFUL,       0xFFUL },
+};
+
+#ifdef __linux__
+// Host build: a register-level model of the CRC engine, bit-exact to the hardware
+// programming used below, so the driver logic runs and is cross-checked off target
+#include <time.h>
+
+#define CRC_CTRL_TCRC_MASK  0x01000000UL
+#define CRC_CTRL_WAS_MASK   0x02000000UL
+#define CRC_CTRL_TOT_SHIFT  30U
+
+static struct {
+    uint32_t data;
+    uint32_t gpoly;
+    uint32_t ctrl;
+} osal_crc_model;
+
+static uint8_t osal_crc_reverse8(uint8_t b);
+
+static void osal_crc_model_shift(uint32_t value, uint32_t bits)
+{
+    bool wide = (osal_crc_model.ctrl & CRC_CTRL_TCRC_MASK) != 0U;
+    uint32_t top = wide ? 0x80000000UL : 0x8000UL;
+    uint32_t mask = wide ? 0xFFFFFFFFUL : 0xFFFFUL;
+    uint32_t reg = osal_crc_model.data & mask;
+
+    for (int32_t i = (int32_t)bits - 1; i >= 0; i--) {
+        bool feedback = ((reg & top) != 0U) != (((value >> i) & 1U) != 0U);
+        reg = (reg << 1) & mask;
+        if (feedback) {
+            reg ^= osal_crc_model.gpoly & mask;
+        }
+    }
+    osal_crc_model.data = reg;
+}
+
+static uint32_t osal_crc_model_transpose(uint32_t value, uint32_t bytes)
+{
+    uint32_t tot = osal_crc_model.ctrl >> CRC_CTRL_TOT_SHIFT;
+    uint32_t out = 0U;
+
+    for (uint32_t i = 0U; i < bytes; i++) {
+        uint8_t b = (uint8_t)(value >> (8U * i));
+        if ((tot == OSAL_CRC_TOT_BITS) || (tot == OSAL_CRC_TOT_BITS_BYTES)) {
+            b = osal_crc_reverse8(b);
+        }
+        uint32_t lane = ((tot == OSAL_CRC_TOT_BITS_BYTES) || (tot == OSAL_CRC_TOT_BYTES)) ? (bytes - 1U - i) : i;
+        out |= (uint32_t)b << (8U * lane);
+    }
+    return out;
+}
+
+static inline void osal_crc_hw_ctrl(uint32_t ctrl)
+{
+    osal_crc_model.ctrl = ctrl;
+}
+
+static inline void osal_crc_hw_poly(uint32_t poly)
+{
+    osal_crc_model.gpoly = poly;
+}
+
+static inline void osal_crc_hw_write32(uint32_t value)
+{
+    if ((osal_crc_model.ctrl & CRC_CTRL_WAS_MASK) != 0U) {
+        osal_crc_model.data = value;    // Seed (written with no transposition)
+    } else {
+        osal_crc_model_shift(osal_crc_model_transpose(value, 4U), 32U);
+    }
+}
+
+static inline void osal_crc_hw_write8(uint8_t value)
+{
+    osal_crc_model_shift(osal_crc_model_transpose(value, 1U), 8U);
+}
+
+static inline uint32_t osal_crc_hw_read(void)
+{
+    return osal_crc_model.data;
+}
+
+static inline uintptr_t osal_crc_hw_data_addr(void)
+{
+    return (uintptr_t)&osal_crc_model.data;
+}
+
+static void osal_crc_clock_init(void)
+{
+}
+
+static uint32_t osal_crc_clock(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    // Host nanoseconds expressed as cycles at CORE_CLOCK_HZ, so the report reads the same
+    return (uint32_t)(((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec) *
+                      (CORE_CLOCK_HZ / 1000000UL) / 1000U);
+}
+#else
+#include "S32K312_CRC.h"
+
+// eDMA3 transfer control descriptor of one channel (4 KB page per channel)
+#define OSAL_CRC_TCD_BASE       (0x40210000UL + (OSAL_CRC_DMA_CHANNEL * 0x1000UL))
+#define OSAL_CRC_DMA_CH_CSR     (*(volatile uint32_t *)(OSAL_CRC_TCD_BASE + 0x00UL))
+#define OSAL_CRC_DMA_CH_ES      (*(volatile uint32_t *)(OSAL_CRC_TCD_BASE + 0x04UL))
+#define OSAL_CRC_DMA_SADDR      (*(volatile uint32_t *)(OSAL_CRC_TCD_BASE + 0x20UL))
+#define OSAL_CRC_DMA_SOFF       (*(volatile uint16_t *)(OSAL_CRC_TCD_BASE + 0x24UL))
+#define OSAL_CRC_DMA_ATTR       (*(volatile uint16_t *)(OSAL_CRC_TCD_BASE + 0x26UL))
+#define OSAL_CRC_DMA_NBYTES     (*(volatile uint32_t *)(OSAL_CRC_TCD_BASE + 0x28UL))
+#define OSAL_CRC_DMA_SLAST      (*(volatile uint32_t *)(OSAL_CRC_TCD_BASE + 0x2CUL))
+#define OSAL_CRC_DMA_DADDR      (*(volatile uint32_t *)(OSAL_CRC_TCD_BASE + 0x30UL))
+#define OSAL_CRC_DMA_DOFF       (*(volatile uint16_t *)(OSAL_CRC_TCD_BASE + 0x34UL))
+#define OSAL_CRC_DMA_CITER      (*(volatile uint16_t *)(OSAL_CRC_TCD_BASE + 0x36UL))
+#define OSAL_CRC_DMA_DLAST_SGA  (*(volatile uint32_t *)(OSAL_CRC_TCD_BASE + 0x38UL))
+#define OSAL_CRC_DMA_CSR        (*(volatile uint16_t *)(OSAL_CRC_TCD_BASE + 0x3CUL))
+#define OSAL_CRC_DMA_BITER      (*(volatile uint16_t *)(OSAL_CRC_TCD_BASE + 0x3EUL))
+#define OSAL_CRC_DMA_CH_DONE    (1UL << 30)
+#define OSAL_CRC_DMA_CH_ES_ERR  (1UL << 31)
+#define OSAL_CRC_DMA_ATTR_32BIT 0x0202U      // SSIZE = DSIZE = 32-bit
+#define OSAL_CRC_DMA_CSR_START  0x0001U
+
+static inline void osal_crc_hw_ctrl(uint32_t ctrl)
+{
+    IP_CRC->CTRL = ctrl;
+}
+
+static inline void osal_crc_hw_poly(uint32_t poly)
+{
+    IP_CRC->GPOLY = poly;
+}
+
+static inline void osal_crc_hw_write32(uint32_t value)
+{
+    IP_CRC->DATAu.DATA = value;
+}
+
+static inline void osal_crc_hw_write8(uint8_t value)
+{
+    IP_CRC->DATAu.DATA_8.LL = value;
+}
+
+static inline uint32_t osal_crc_hw_read(void)
+{
+    return IP_CRC->DATAu.DATA;
+}
+
+static inline uintptr_t osal_crc_hw_data_addr(void)
+{
+    return (uintptr_t)&IP_CRC->DATAu.DATA;
+}
+
+static void osal_crc_clock_init(void)
+{
+    osal_utils_cycles_init();
+}
+
+static uint32_t osal_crc_clock(void)
+{
+    return osal_utils_cycles();
+}
+#endif /* __linux__ */
+
+// Set while a DMA job owns the engine, and while its transfer is in flight
+static volatile bool osal_crc_dma_busy;
+#ifndef __linux__
+static bool osal_crc_dma_running;
+#endif
+
+static inline uint32_t osal_crc_irq_save(void)
+{
+#ifdef __linux__
+    return 0U;
+#else
+    uint32_t primask;
+    __asm volatile ("mrs %0, primask\n cpsid i" : "=r" (primask) :: "memory");
+    return primask;
+#endif
+}
+
+static inline void osal_crc_irq_restore(uint32_t primask)
+{
+#ifdef __linux__
+    (void)primask;
+#else
+    __asm volatile ("msr primask, %0" :: "r" (primask) : "memory");
+#endif
+}
+
+static uint8_t osal_crc_reverse8(uint8_t b)
+{
+    b = (uint8_t)(((b & 0xF0U) >> 4) | ((b & 0x0FU) << 4));
+    b = (uint8_t)(((b & 0xCCU) >> 2) | ((b & 0x33U) << 2));
+    return (uint8_t)(((b & 0xAAU) >> 1) | ((b & 0x55U) << 1));
+}
+
+static inline uint32_t osal_crc_reverse32(uint32_t x)
+{
+#if defined(__arm__)
+    __asm ("rbit %0, %1" : "=r" (x) : "r" (x));
+    return x;
+#else
+    x = ((x >> 1) & 0x55555555UL) | ((x & 0x55555555UL) << 1);
+    x = ((x >> 2) & 0x33333333UL) | ((x & 0x33333333UL) << 2);
+    x = ((x >> 4) & 0x0F0F0F0FUL) | ((x & 0x0F0F0F0FUL) << 4);
+    return __builtin_bswap32(x);
+#endif
+}
+
+static inline uint32_t osal_crc_mask(const osal_crc_param_t *p)
+{
+    return (p->width == 32U) ? 0xFFFFFFFFUL : ((1UL << p->width) - 1U);
+}
+
+// Sub-16-bit CRCs sit in the upper bits of the 16-bit engine
+static inline uint32_t osal_crc_shift(const osal_crc_param_t *p)
+{
+    return (p->width < 16U) ? (16U - p->width) : 0U;
+}
+
+// Load the protocol and a saved register into the engine
+static void osal_crc_load(const osal_crc_ctx_t *ctx)
+{
+    const osal_crc_param_t *p = &osal_crc_params[ctx->protocol];
+    uint32_t tcrc = (p->width == 32U) ? CRC_CTRL_TCRC_MASK : 0U;
+    uint32_t tot = p->reflect ? OSAL_CRC_TOT_BITS_BYTES : OSAL_CRC_TOT_BYTES;
+
+    osal_crc_hw_ctrl(tcrc | CRC_CTRL_WAS_MASK);
+    osal_crc_hw_poly(p->poly << osal_crc_shift(p));
+    osal_crc_hw_write32(ctx->state);
+    osal_crc_hw_ctrl(tcrc | (tot << CRC_CTRL_TOT_SHIFT));
+}
+
+static void osal_crc_feed(const uint8_t *p, size_t len)
+{
+    while ((len != 0U) && (((uintptr_t)p & 3U) != 0U)) {
+        osal_crc_hw_write8(*p++);
+        len--;
+    }
+    while (len >= 4U) {
+        osal_crc_hw_write32(*(const uint32_t *)p);
+        p += 4;
+        len -= 4U;
+    }
+    while (len != 0U) {
+        osal_crc_hw_write8(*p++);
+        len--;
+    }
+}
+
+int32_t osal_crc_start(osal_crc_ctx_t *ctx, osal_crc_protocol_t protocol)
+{
+    if ((uint32_t)protocol >= (uint32_t)OSAL_CRC_PROTOCOL_COUNT) {
+        return -1;
+    }
+    const osal_crc_param_t *p = &osal_crc_params[protocol];
+    ctx->protocol = protocol;
+    ctx->state = p->init << osal_crc_shift(p);
+    ctx->tail = NULL;
+    ctx->tail_len = 0U;
+    return 0;
+}
+
+int32_t osal_crc_update(osal_crc_ctx_t *ctx, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+
+    while (len != 0U) {
+        size_t n = (len > OSAL_CRC_CHUNK) ? OSAL_CRC_CHUNK : len;
+        uint32_t primask = osal_crc_irq_save();
+        if (osal_crc_dma_busy) {
+            osal_crc_irq_restore(primask);
+            return -3;
+        }
+        osal_crc_load(ctx);
+        osal_crc_feed(p, n);
+        ctx->state = osal_crc_hw_read();
+        osal_crc_irq_restore(primask);
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+uint32_t osal_crc_final(const osal_crc_ctx_t *ctx)
+{
+    const osal_crc_param_t *p = &osal_crc_params[ctx->protocol];
+    uint32_t value = (ctx->state >> osal_crc_shift(p)) & osal_crc_mask(p);
+
+    if (p->reflect) {
+        value = osal_crc_reverse32(value) >> (32U - p->width);
+    }
+    return (value ^ p->xorout) & osal_crc_mask(p);
+}
+
+uint32_t osal_crc_compute(osal_crc_protocol_t protocol, const void *data, size_t len)
+{
+    osal_crc_ctx_t ctx;
+
+    if ((osal_crc_start(&ctx, protocol) != 0) || (osal_crc_update(&ctx, data, len) != 0)) {
+        return 0U;
+    }
+    return osal_crc_final(&ctx);
+}
+
+// Ranges the eDMA master can read: program flash, data flash, SRAM
+static bool osal_crc_dma_reachable(uintptr_t start, size_t len)
+{
+#ifdef __linux__
+    (void)start;
+    (void)len;
+    return true;
+#else
+    static const uintptr_t ranges[][2] = {
+        { 0x00400000UL, 0x00600000UL },
+        { 0x10000000UL, 0x10020000UL },
+        { 0x20400000UL, 0x20418000UL },
+    };
+    for (uint32_t i = 0U; i < (sizeof(ranges) / sizeof(ranges[0])); i++) {
+        if ((start >= ranges[i][0]) && (start <= ranges[i][1]) && (len <= (ranges[i][1] - start))) {
+            return true;
+        }
+    }
+    return false;
+#endif
+}
+
+int32_t osal_crc_dma_start(osal_crc_ctx_t *ctx, const void *data, size_t len)
+{
+    if ((ctx == NULL) || (data == NULL)) {
+        return -1;
+    }
+    uintptr_t start = (uintptr_t)data;
+    if (!osal_crc_dma_reachable(start, len)) {
+        return -2;
+    }
+
+    uint32_t primask = osal_crc_irq_save();
+    if (osal_crc_dma_busy) {
+        osal_crc_irq_restore(primask);
+        return -3;
+    }
+    osal_crc_dma_busy = true;
+    osal_crc_irq_restore(primask);
+
+    // Unaligned head by the CPU, whole words by DMA, the tail when the transfer is done
+    const uint8_t *p = (const uint8_t *)data;
+    size_t head = (size_t)((4U - (start & 3U)) & 3U);
+    if (head > len) {
+        head = len;
+    }
+    size_t words = (len - head) & ~(size_t)3U;
+    ctx->tail = p + head + words;
+    ctx->tail_len = (uint32_t)(len - head - words);
+
+    osal_crc_load(ctx);
+    osal_crc_feed(p, head);
+    if (words == 0U) {
+        return 0;
+    }
+    p += head;
+
+#ifdef __linux__
+    osal_crc_feed(p, words);
+#else
+    osal_cache_clean_range(p, words);
+
+    OSAL_CRC_DMA_CH_CSR = OSAL_CRC_DMA_CH_DONE;        // Clear DONE, no hardware requests
+    OSAL_CRC_DMA_CH_ES = OSAL_CRC_DMA_CH_ES_ERR;
+    OSAL_CRC_DMA_SADDR = (uint32_t)(uintptr_t)p;
+    OSAL_CRC_DMA_SOFF = 4U;
+    OSAL_CRC_DMA_ATTR = OSAL_CRC_DMA_ATTR_32BIT;
+    OSAL_CRC_DMA_NBYTES = (uint32_t)words;             // Whole range in one minor loop
+    OSAL_CRC_DMA_SLAST = 0U;
+    OSAL_CRC_DMA_DADDR = (uint32_t)osal_crc_hw_data_addr();
+    OSAL_CRC_DMA_DOFF = 0U;
+    OSAL_CRC_DMA_CITER = 1U;
+    OSAL_CRC_DMA_BITER = 1U;
+    OSAL_CRC_DMA_DLAST_SGA = 0U;
+    __asm volatile ("dsb" ::: "memory");
+    osal_crc_dma_running = true;
+    OSAL_CRC_DMA_CSR = OSAL_CRC_DMA_CSR_START;
+#endif
+    return 0;
+}
+
+int32_t osal_crc_dma_poll(osal_crc_ctx_t *ctx)
+{
+    if (!osal_crc_dma_busy) {
+        return 0;
+    }
+#ifndef __linux__
+    if (osal_crc_dma_running) {
+        if ((OSAL_CRC_DMA_CH_ES & OSAL_CRC_DMA_CH_ES_ERR) != 0U) {
+            OSAL_CRC_DMA_CH_ES = OSAL_CRC_DMA_CH_ES_ERR;
+            osal_crc_dma_running = false;
+            osal_crc_dma_busy = false;
+            return -4;
+        }
+        if ((OSAL_CRC_DMA_CH_CSR & OSAL_CRC_DMA_CH_DONE) == 0U) {
+            return 1;
+        }
+        OSAL_CRC_DMA_CH_CSR = OSAL_CRC_DMA_CH_DONE;
+        osal_crc_dma_running = false;
+    }
+#endif
+    osal_crc_feed(ctx->tail, ctx->tail_len);
+    ctx->state = osal_crc_hw_read();
+    ctx->tail = NULL;
+    ctx->tail_len = 0U;
+    osal_crc_dma_busy = false;
+    return 0;
+}
+
+uint32_t osal_crc_reference(osal_crc_protocol_t protocol, const void *data, size_t len)
+{
+    if ((uint32_t)protocol >= (uint32_t)OSAL_CRC_PROTOCOL_COUNT) {
+        return 0U;
+    }
+    const osal_crc_param_t *p = &osal_crc_params[protocol];
+    const uint8_t *in = (const uint8_t *)data;
+    uint32_t mask = osal_crc_mask(p);
+    uint32_t top = 1UL << (p->width - 1U);
+    uint32_t reg = p->init;
+
+    for (size_t i = 0U; i < len; i++) {
+        uint8_t b = p->reflect ? osal_crc_reverse8(in[i]) : in[i];
+        for (int32_t bit = 7; bit >= 0; bit--) {
+            bool feedback = ((reg & top) != 0U) != (((b >> bit) & 1U) != 0U);
+            reg = (reg << 1) & mask;
+            if (feedback) {
+                reg ^= p->poly;
+            }
+        }
+    }
+    if (p->reflect) {
+        reg = osal_crc_reverse32(reg) >> (32U - p->width);
+    }
+    return (reg ^ p->xorout) & mask;
+}
+
+// Check values over "123456789" (CRC catalogue)
+static const uint32_t osal_crc_check[OSAL_CRC_PROTOCOL_COUNT] = {
+    [OSAL_CRC_32]          = 0xCBF43926UL,
+    [OSAL_CRC_16_CCITT]    = 0x29B1UL,
+    [OSAL_CRC_8_SAE_J1850] = 0x4BUL,
+};
+
+// In SRAM (not the DTCM stack) so the DMA-fed path can read it
+static uint8_t osal_crc_test_buf[300];
+
+static uint32_t osal_crc_dma_compute(osal_crc_protocol_t protocol, const void *data, size_t len)
+{
+    osal_crc_ctx_t ctx;
+    int32_t ret;
+
+    (void)osal_crc_start(&ctx, protocol);
+    if (osal_crc_dma_start(&ctx, data, len) != 0) {
+        return 0U;
+    }
+    do {
+        ret = osal_crc_dma_poll(&ctx);
+    } while (ret > 0);
+    return (ret == 0) ? osal_crc_final(&ctx) : 0U;
+}
+
+int32_t osal_crc_selftest(void)
+{
+    static const char check[] = "123456789";
+    char log_buffer[LOG_BUFFER_SIZE];
+    int32_t result = 0;
+    uint32_t seed = 0x12345678UL;
+
+    for (uint32_t i = 0U; i < sizeof(osal_crc_test_buf); i++) {
+        seed = seed * 1664525UL + 1013904223UL;
+        osal_crc_test_buf[i] = (uint8_t)(seed >> 24);
+    }
+
+    for (uint32_t proto = 0U; proto < (uint32_t)OSAL_CRC_PROTOCOL_COUNT; proto++) {
+        osal_crc_protocol_t p = (osal_crc_protocol_t)proto;
+        // Odd start and length exercise the byte paths on both edges
+        const uint8_t *data = &osal_crc_test_buf[1];
+        size_t len = sizeof(osal_crc_test_buf) - 4U;
+        uint32_t ref = osal_crc_reference(p, data, len);
+
+        osal_crc_ctx_t ctx;
+        (void)osal_crc_start(&ctx, p);
+        (void)osal_crc_update(&ctx, data, 37U);
+        (void)osal_crc_update(&ctx, data + 37U, len - 37U);
+
+        bool ok = (osal_crc_reference(p, check, 9U) == osal_crc_check[p]) &&
+                  (osal_crc_compute(p, check, 9U) == osal_crc_check[p]) &&
+                  (osal_crc_compute(p, data, len) == ref) &&
+                  (osal_crc_final(&ctx) == ref) &&
+                  (osal_crc_dma_compute(p, data, len) == ref);
+        if ((p == OSAL_CRC_32) && (osal_crc32(data, len) != ref)) {
+            ok = false;
+        }
+        if (!ok) {
+            result = -1;
+        }
+        snprintf(log_buffer, LOG_BUFFER_SIZE, "CRC selftest %s: %s (reference 0x%08lx)\r\n",
+                 (p == OSAL_CRC_32) ? "crc32" : ((p == OSAL_CRC_16_CCITT) ? "crc16-ccitt" : "crc8-j1850"),
+                 ok ? "ok" : "FAILED", (unsigned long)ref);
+        osal_log_info(log_buffer);
+    }
+    return result;
+}
+
+static void osal_crc_log_rate(const char *name, size_t len, uint32_t cycles, uint32_t crc)
+{
+    char log_buffer[LOG_BUFFER_SIZE];
+    // MB/s with two decimals
+    uint32_t rate = (cycles != 0U) ? (uint32_t)(((uint64_t)len * CORE_CLOCK_HZ / 10000UL) / cycles) : 0U;
+
+    snprintf(log_buffer, LOG_BUFFER_SIZE, "CRC %-10s %lu bytes: %lu cycles, %lu.%02lu MB/s, crc 0x%08lx\r\n",
+             name, (unsigned long)len, (unsigned long)cycles, (unsigned long)(rate / 100U),
+             (unsigned long)(rate % 100U), (unsigned long)crc);
+    osal_log_info(log_buffer);
+}
+
+void osal_crc_log_benchmark(const void *data, size_t len)
+{
+    uint32_t enter, crc;
+
+    osal_crc_clock_init();
+    (void)osal_crc32(data, 0U);     // Build the tables outside the measurement
+
+    enter = osal_crc_clock();
+    crc = osal_crc32(data, len);
+    osal_crc_log_rate("software", len, osal_crc_clock() - enter, crc);
+
+    enter = osal_crc_clock();
+    crc = osal_crc_compute(OSAL_CRC_32, data, len);
+    osal_crc_log_rate("engine cpu", len, osal_crc_clock() - enter, crc);
+
+    enter = osal_crc_clock();
+    crc = osal_crc_dma_compute(OSAL_CRC_32, data, len);
+    osal_crc_log_rate("engine dma", len, osal_crc_clock() - enter, crc);
+}
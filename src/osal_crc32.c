@@ -0,0 +1,70 @@
+#include "osal_crc32.h"
+#include "osal_utils.h"
+#include <stdbool.h>
+
+// Slicing-by-8: table[k][b] is the CRC contribution of byte b followed by k zero bytes, so
+// eight input bytes are folded with eight independent lookups per step instead of eight
+// dependent ones. The tables live in DTCM: single-cycle and never evicted by the image data
+// streaming through the D-cache.
+static uint32_t osal_crc32_table[8][256] __attribute__((section(".dtcm_bss")));
+static bool osal_crc32_ready;
+
+void osal_crc32_init(void)
+{
+    for (uint32_t i = 0U; i < 256U; i++) {
+        uint32_t c = i;
+        for (uint32_t bit = 0U; bit < 8U; bit++) {
+            c = ((c & 1U) != 0U) ? ((c >> 1) ^ OSAL_CRC32_POLY_REFLECTED) : (c >> 1);
+        }
+        osal_crc32_table[0][i] = c;
+    }
+    for (uint32_t i = 0U; i < 256U; i++) {
+        for (uint32_t k = 1U; k < 8U; k++) {
+            uint32_t prev = osal_crc32_table[k - 1U][i];
+            osal_crc32_table[k][i] = (prev >> 8) ^ osal_crc32_table[0][prev & 0xFFU];
+        }
+    }
+    osal_crc32_ready = true;
+}
+
+OSAL_FAST_CODE uint32_t osal_crc32_update(uint32_t crc, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t c = ~crc;
+
+    if (!osal_crc32_ready) {
+        osal_crc32_init();
+    }
+
+    // Bytewise up to a word boundary
+    while ((len != 0U) && (((uintptr_t)p & 3U) != 0U)) {
+        c = (c >> 8) ^ osal_crc32_table[0][(c ^ *p++) & 0xFFU];
+        len--;
+    }
+
+    while (len >= 8U) {
+        uint32_t one = *(const uint32_t *)p ^ c;
+        uint32_t two = *(const uint32_t *)(p + 4);
+        c = osal_crc32_table[7][one & 0xFFU] ^
+            osal_crc32_table[6][(one >> 8) & 0xFFU] ^
+            osal_crc32_table[5][(one >> 16) & 0xFFU] ^
+            osal_crc32_table[4][one >> 24] ^
+            osal_crc32_table[3][two & 0xFFU] ^
+            osal_crc32_table[2][(two >> 8) & 0xFFU] ^
+            osal_crc32_table[1][(two >> 16) & 0xFFU] ^
+            osal_crc32_table[0][two >> 24];
+        p += 8;
+        len -= 8U;
+    }
+
+    while (len != 0U) {
+        c = (c >> 8) ^ osal_crc32_table[0][(c ^ *p++) & 0xFFU];
+        len--;
+    }
+    return ~c;
+}
+
+uint32_t osal_crc32(const void *data, size_t len)
+{
+    return osal_crc32_update(0U, data, len);
+}
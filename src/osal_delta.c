@@ -0,0 +1,161 @@
+#include "osal_delta.h"
+#include "osal_flash.h"
+#include <string.h>
+
+void osal_delta_init(osal_delta_t *d, uint32_t old_base, uint32_t old_size, uint32_t new_size)
+{
+    memset(d, 0, sizeof(*d));
+    d->old_base = old_base;
+    d->old_size = old_size;
+    d->new_size = new_size;
+    d->state = OSAL_DELTA_DIFF_LEN;
+}
+
+// Add one LEB128 byte; returns 1 when the value is complete (in d->varint), -1 if it overflows
+static int32_t osal_delta_varint(osal_delta_t *d, uint8_t b)
+{
+    if ((d->shift > 28U) || ((d->shift == 28U) && ((b & 0x70U) != 0U))) {
+        return -1;
+    }
+    d->varint |= (uint32_t)(b & 0x7FU) << d->shift;
+    if ((b & 0x80U) != 0U) {
+        d->shift += 7U;
+        return 0;
+    }
+    d->shift = 0U;
+    return 1;
+}
+
+static uint32_t osal_delta_take(osal_delta_t *d)
+{
+    uint32_t v = d->varint;
+
+    d->varint = 0U;
+    return v;
+}
+
+// Move on once the diff bytes of a record are done
+static void osal_delta_diff_done(osal_delta_t *d)
+{
+    if (d->extra_left > 0U) {
+        d->state = OSAL_DELTA_EXTRA;
+    } else {
+        d->old_pos = d->next_old;
+        d->state = OSAL_DELTA_DIFF_LEN;
+    }
+}
+
+// Check a record header against both images and start it
+static int32_t osal_delta_record(osal_delta_t *d, uint32_t zigzag)
+{
+    int32_t seek = (int32_t)((zigzag >> 1) ^ (0U - (zigzag & 1U)));
+    int64_t next = (int64_t)d->old_pos + d->diff_left + seek;
+
+    if ((d->diff_left > (d->old_size - d->old_pos)) || (d->diff_left > (d->new_size - d->new_pos)) ||
+        (d->extra_left > (d->new_size - d->new_pos - d->diff_left)) || (next < 0) || (next > (int64_t)d->old_size)) {
+        return -1;
+    }
+    d->next_old = (uint32_t)next;
+    if (d->diff_left > 0U) {
+        d->state = OSAL_DELTA_DIFF;
+    } else {
+        osal_delta_diff_done(d);
+    }
+    return 0;
+}
+
+int32_t osal_delta_apply(osal_delta_t *d, const uint8_t *in, uint32_t in_len, uint32_t *consumed,
+                         uint8_t *out, uint32_t out_len, uint32_t *produced)
+{
+    uint32_t i = 0U;
+    uint32_t o = 0U;
+    int32_t ret = 0;
+
+    while ((ret == 0) && (o < out_len)) {
+        // A run of zero diff bytes is a straight copy from the old image
+        if (d->run_left > 0U) {
+            uint32_t n = ((out_len - o) < d->run_left) ? (out_len - o) : d->run_left;
+            osal_flash_read(d->old_base + d->old_pos, &out[o], n);
+            o += n;
+            d->old_pos += n;
+            d->new_pos += n;
+            d->run_left -= n;
+            d->diff_left -= n;
+            if (d->diff_left == 0U) {
+                osal_delta_diff_done(d);
+            }
+            continue;
+        }
+        if (i == in_len) {
+            break;
+        }
+
+        uint8_t b = in[i++];
+        switch (d->state) {
+        case OSAL_DELTA_DIFF_LEN:
+            ret = osal_delta_varint(d, b);
+            if (ret == 1) {
+                d->diff_left = osal_delta_take(d);
+                d->state = OSAL_DELTA_EXTRA_LEN;
+                ret = 0;
+            }
+            break;
+        case OSAL_DELTA_EXTRA_LEN:
+            ret = osal_delta_varint(d, b);
+            if (ret == 1) {
+                d->extra_left = osal_delta_take(d);
+                d->state = OSAL_DELTA_SEEK;
+                ret = 0;
+            }
+            break;
+        case OSAL_DELTA_SEEK:
+            ret = osal_delta_varint(d, b);
+            if (ret == 1) {
+                ret = osal_delta_record(d, osal_delta_take(d));
+            }
+            break;
+        case OSAL_DELTA_DIFF:
+            if (b == 0U) {
+                d->state = OSAL_DELTA_ZERO_RUN;
+            } else {
+                uint8_t old;
+                osal_flash_read(d->old_base + d->old_pos, &old, 1U);
+                out[o++] = (uint8_t)(old + b);
+                d->old_pos++;
+                d->new_pos++;
+                if (--d->diff_left == 0U) {
+                    osal_delta_diff_done(d);
+                }
+            }
+            break;
+        case OSAL_DELTA_ZERO_RUN:
+            ret = osal_delta_varint(d, b);
+            if (ret == 1) {
+                uint32_t n = osal_delta_take(d);
+                ret = (n < d->diff_left) ? 0 : -1;
+                d->run_left = n + 1U;
+                d->state = OSAL_DELTA_DIFF;
+            }
+            break;
+        case OSAL_DELTA_EXTRA:
+            out[o++] = b;
+            d->new_pos++;
+            if (--d->extra_left == 0U) {
+                d->old_pos = d->next_old;
+                d->state = OSAL_DELTA_DIFF_LEN;
+            }
+            break;
+        default:
+            ret = -1;
+            break;
+        }
+    }
+    *consumed = i;
+    *produced = o;
+    return ret;
+}
+
+bool osal_delta_done(const osal_delta_t *d)
+{
+    return (d->state == OSAL_DELTA_DIFF_LEN) && (d->shift == 0U) && (d->varint == 0U) && (d->new_pos == d->new_size);
+}
@@ -0,0 +1,199 @@
+#include "osal_devinfo.h"
+#include "osal_crc32.h"
+#include <string.h>
+#ifndef __linux__
+#include "osal_fault.h"
+#include "osal_kv.h"
+#include "osal_log.h"
+#include "osal_reset.h"
+#include "osal_slot.h"
+#include "osal_stack.h"
+#include "Lpuart_Uart_Ip.h"
+#include "mbedtls/build_info.h"
+#endif
+
+_Static_assert(OSAL_DEVINFO_PAYLOAD_MAX <= 0xFFFFU, "payload length is 16 bits");
+
+static uint8_t *osal_devinfo_put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return &p[2];
+}
+
+static uint8_t *osal_devinfo_put32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+    return &p[4];
+}
+
+static uint8_t *osal_devinfo_put(uint8_t *p, const void *data, uint32_t len)
+{
+    memcpy(p, data, len);
+    return &p[len];
+}
+
+uint32_t osal_devinfo_encode(const osal_devinfo_t *info, uint8_t *frame)
+{
+    uint8_t *p = &frame[OSAL_FWUPD_HDR_LEN];
+    uint32_t regions = (info->regions < OSAL_HEAP_MAX_REGIONS) ? info->regions : OSAL_HEAP_MAX_REGIONS;
+    uint32_t len;
+
+    *p++ = OSAL_DEVINFO_FORMAT;
+    *p++ = info->slot;
+    *p++ = (uint8_t)info->image_status;
+    *p++ = (uint8_t)info->secboot_status;
+    p = osal_devinfo_put(p, info->app_name, OSAL_DEVINFO_NAME_LEN);
+    p = osal_devinfo_put(p, info->version, OSAL_DEVINFO_VERSION_LEN);
+    p = osal_devinfo_put(p, info->build, OSAL_DEVINFO_BUILD_LEN);
+    p = osal_devinfo_put32(p, info->version_code);
+    p = osal_devinfo_put32(p, info->sequence);
+    p = osal_devinfo_put32(p, info->flash_start);
+    p = osal_devinfo_put32(p, info->image_size);
+    p = osal_devinfo_put32(p, info->crc32);
+    p = osal_devinfo_put32(p, info->crc32_computed);
+    p = osal_devinfo_put(p, info->sha256, sizeof(info->sha256));
+    p = osal_devinfo_put32(p, info->mbedtls_version);
+    p = osal_devinfo_put32(p, info->features);
+    p = osal_devinfo_put32(p, info->reset_des);
+    p = osal_devinfo_put32(p, info->reset_fes);
+    p = osal_devinfo_put32(p, info->operational_us);
+    p = osal_devinfo_put32(p, info->stack_used);
+    p = osal_devinfo_put32(p, info->stack_size);
+    p = osal_devinfo_put16(p, info->kv_keys);
+    *p++ = info->kv_free_sectors;
+    *p++ = (uint8_t)regions;
+    p = osal_devinfo_put32(p, info->faults);
+    for (uint32_t i = 0U; i < regions; i++) {
+        p = osal_devinfo_put32(p, info->region[i].flags);
+        p = osal_devinfo_put32(p, info->region[i].size);
+        p = osal_devinfo_put32(p, info->region[i].used);
+        p = osal_devinfo_put32(p, info->region[i].used_peak);
+    }
+    len = (uint32_t)(p - &frame[OSAL_FWUPD_HDR_LEN]);
+
+    frame[0] = OSAL_FWUPD_SOF;
+    frame[1] = OSAL_DEVINFO_FRAME;
+    frame[2] = 0U;
+    frame[3] = 0U;
+    frame[4] = (uint8_t)len;
+    frame[5] = (uint8_t)(len >> 8);
+    (void)osal_devinfo_put32(p, osal_crc32(&frame[1], OSAL_FWUPD_HDR_LEN - 1U + len));
+    return OSAL_FWUPD_HDR_LEN + len + 4U;
+}
+
+#ifndef __linux__
+extern uint8_t __RAM_INIT_PARTIAL[];
+
+// Boot-time checks: the image is not hashed again on every request
+static struct {
+    int8_t image_status;
+    int8_t secboot_status;
+    uint32_t crc32_computed;
+} osal_devinfo_boot = { -1, -1, 0U };
+
+void osal_devinfo_note_boot(const osal_image_check_t *image, const osal_secboot_report_t *secboot)
+{
+    osal_devinfo_boot.image_status = (int8_t)image->status;
+    osal_devinfo_boot.secboot_status = (int8_t)secboot->status;
+    osal_devinfo_boot.crc32_computed = image->crc;
+}
+
+// Copy a string into a fixed field, NUL padded; may be left unterminated when it fills the field
+static void osal_devinfo_copy(char *dst, const char *src, uint32_t size)
+{
+    uint32_t i = 0U;
+
+    if (src != NULL) {
+        for (; (i < size) && (src[i] != '\0'); i++) {
+            dst[i] = src[i];
+        }
+    }
+    for (; i < size; i++) {
+        dst[i] = '\0';
+    }
+}
+
+// Only counters kept up to date by their modules are read: no flash access (a key-value read
+// would wait for a background data flash erase) and no heap walk
+static void osal_devinfo_collect(osal_devinfo_t *info)
+{
+    const app_metadata_t *meta = &app_metadata;
+    int32_t slot = osal_slot_of((uint32_t)meta);
+    osal_reset_info_t reset;
+    osal_kv_stats_t kv;
+    osal_heap_stats_t heap;
+
+    info->slot = (slot < 0) ? 0xFFU : (uint8_t)slot;
+    info->image_status = osal_devinfo_boot.image_status;
+    info->secboot_status = osal_devinfo_boot.secboot_status;
+    osal_devinfo_copy(info->app_name, meta->app_name, OSAL_DEVINFO_NAME_LEN);
+    osal_devinfo_copy(info->version, meta->version, OSAL_DEVINFO_VERSION_LEN);
+    osal_devinfo_copy(info->build, meta->build_timestamp, OSAL_DEVINFO_BUILD_LEN);
+    info->version_code = meta->version_code;
+    info->sequence = meta->sequence;
+    info->flash_start = meta->flash_start_addr;
+    info->image_size = meta->image_size;
+    info->crc32 = meta->crc32;
+    info->crc32_computed = osal_devinfo_boot.crc32_computed;
+    memcpy(info->sha256, meta->sha256, sizeof(info->sha256));
+    info->mbedtls_version = MBEDTLS_VERSION_NUMBER;
+
+    osal_reset_get_info(&reset);
+    osal_kv_get_stats(&kv);
+    info->features = OSAL_DEVINFO_FEAT_FWUPD | OSAL_DEVINFO_FEAT_FWUPD_DELTA | OSAL_DEVINFO_FEAT_FAULT_LOG;
+#ifdef BOOT_PROFILE_ENABLE
+    info->features |= OSAL_DEVINFO_FEAT_BOOT_PROFILE;
+#endif
+    if (info->secboot_status != -4) {
+        info->features |= OSAL_DEVINFO_FEAT_SECBOOT_KEY;
+    }
+    if (reset.warm) {
+        info->features |= OSAL_DEVINFO_FEAT_WARM_BOOT;
+    }
+    if (reset.clock_kept) {
+        info->features |= OSAL_DEVINFO_FEAT_CLOCKS_KEPT;
+    }
+    if ((uint32_t)__RAM_INIT_PARTIAL != 0U) {
+        info->features |= OSAL_DEVINFO_FEAT_RAM_PARTIAL;
+    }
+    if (kv.sectors_used > 0U) {
+        info->features |= OSAL_DEVINFO_FEAT_KV;
+    }
+    info->reset_des = reset.des;
+    info->reset_fes = reset.fes;
+    info->operational_us = reset.operational_us;
+
+    info->stack_used = (uint32_t)osal_stack_main_used();
+    info->stack_size = (uint32_t)osal_stack_main_size();
+    info->kv_keys = (uint16_t)kv.keys;
+    info->kv_free_sectors = (uint8_t)kv.sectors_free;
+    info->faults = osal_fault_count();
+
+    info->regions = 0U;
+    for (uint32_t i = 0U; i < OSAL_HEAP_MAX_REGIONS; i++) {
+        if (osal_heap_get_stats(i, &heap) != 0) {
+            break;
+        }
+        info->region[i].flags = heap.flags;
+        info->region[i].size = heap.size;
+        info->region[i].used = heap.used;
+        info->region[i].used_peak = heap.used_peak;
+        info->regions++;
+    }
+}
+
+void osal_devinfo_send(void)
+{
+    static uint8_t frame[OSAL_DEVINFO_FRAME_MAX];
+    osal_devinfo_t info;
+    uint32_t len;
+
+    osal_devinfo_collect(&info);
+    len = osal_devinfo_encode(&info, frame);
+    (void)Lpuart_Uart_Ip_SyncSend(LPUART_INSTANCE, frame, len, 5000U);
+}
+#endif
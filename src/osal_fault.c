@@ -0,0 +1,272 @@
+#include "osal_fault.h"
+#include "osal_kv.h"
+#include "osal_log.h"
+#include "osal_reset.h"
+#include "osal_utils.h"
+#include <stddef.h>
+#include <stdio.h>
+
+_Static_assert(sizeof(osal_fault_record_t) <= OSAL_KV_VALUE_MAX, "fault record must fit one key-value record");
+
+// Cortex-M7 system control block: fault status
+#define SCB_SHCSR  (*(volatile uint32_t *)0xE000ED24UL)
+#define SCB_CFSR   (*(volatile uint32_t *)0xE000ED28UL)
+#define SCB_HFSR   (*(volatile uint32_t *)0xE000ED2CUL)
+#define SCB_MMFAR  (*(volatile uint32_t *)0xE000ED34UL)
+#define SCB_BFAR   (*(volatile uint32_t *)0xE000ED38UL)
+#define SCB_AFSR   (*(volatile uint32_t *)0xE000ED3CUL)
+#define DWT_CYCCNT (*(volatile uint32_t *)0xE0001004UL)
+
+#define SCB_SHCSR_FAULTS_ENA   0x00070000UL   // MEMFAULTENA | BUSFAULTENA | USGFAULTENA
+#define CFSR_MMARVALID         (1UL << 7)
+#define CFSR_BFARVALID         (1UL << 15)
+#define CFSR_STACKING          ((1UL << 4) | (1UL << 12))   // MSTKERR | STKERR
+
+// Private stack of the capture: the faulting stack may be the overflowed main stack
+#define OSAL_FAULT_STACK_SIZE 512
+#define OSAL_FAULT_STR(x) #x
+#define OSAL_FAULT_XSTR(x) OSAL_FAULT_STR(x)
+
+// RAM the exception frame may be read from
+extern uint32_t __INT_DTCM_START[];
+extern uint32_t __INT_DTCM_END[];
+extern uint32_t __INT_SRAM_START[];
+extern uint32_t __INT_SRAM_END[];
+
+osal_fault_record_t osal_fault_record __attribute__((section(".noinit")));
+// OSAL_FAULT_KV_COUNT as read and updated by osal_fault_boot_report()
+static uint32_t osal_fault_stored_count;
+static uint64_t osal_fault_stack[OSAL_FAULT_STACK_SIZE / sizeof(uint64_t)] __attribute__((used));
+
+OSAL_FAST_CODE static uint32_t osal_fault_check(const osal_fault_record_t *r)
+{
+    const uint32_t *words = (const uint32_t *)r;
+    uint32_t sum = 0U;
+
+    for (size_t i = 0; i < (offsetof(osal_fault_record_t, check) / sizeof(uint32_t)); i++) {
+        sum ^= words[i];
+    }
+    return ~sum;
+}
+
+// End of the RAM holding [addr, addr + len), or 0 if it is not all in DTCM or SRAM
+OSAL_FAST_CODE static uint32_t osal_fault_ram_end(uint32_t addr, uint32_t len)
+{
+    if ((addr >= (uint32_t)__INT_DTCM_START) && (addr < (uint32_t)__INT_DTCM_END) &&
+        (len <= ((uint32_t)__INT_DTCM_END - addr))) {
+        return (uint32_t)__INT_DTCM_END;
+    }
+    if ((addr >= (uint32_t)__INT_SRAM_START) && (addr < (uint32_t)__INT_SRAM_END) &&
+        (len <= ((uint32_t)__INT_SRAM_END - addr))) {
+        return (uint32_t)__INT_SRAM_END;
+    }
+    return 0U;
+}
+
+// Runs on osal_fault_stack, never returns: fill the record and reset
+OSAL_FAST_CODE __attribute__((noreturn, used)) void osal_fault_capture(const uint32_t *frame, uint32_t exc_return)
+{
+    osal_fault_record_t *r = &osal_fault_record;
+    volatile uint32_t *words = (volatile uint32_t *)r;
+    uint32_t cfsr = SCB_CFSR;
+    uint32_t addr = (uint32_t)frame;
+    uint32_t ipsr;
+
+    __asm volatile ("mrs %0, ipsr" : "=r" (ipsr));
+    // No library calls (the volatile keeps the loops from becoming memset/memcpy): the
+    // capture runs from ITCM and must not depend on flash
+    for (uint32_t i = 0U; i < (sizeof(*r) / sizeof(uint32_t)); i++) {
+        words[i] = 0U;
+    }
+    r->exception = ipsr & 0x1FFU;
+    r->exc_return = exc_return;
+    r->flags = (((exc_return & 0x4U) != 0U) ? OSAL_FAULT_FLAG_PSP : 0U) |
+               (((exc_return & 0x10U) == 0U) ? OSAL_FAULT_FLAG_FPU : 0U);
+    r->cfsr = cfsr;
+    r->hfsr = SCB_HFSR;
+    r->mmfar = SCB_MMFAR;
+    r->bfar = SCB_BFAR;
+    r->afsr = SCB_AFSR;
+    r->cycles = DWT_CYCCNT;
+    r->sp = addr;
+
+    if (((cfsr & CFSR_STACKING) != 0U) || (osal_fault_ram_end(addr, 32U) == 0U)) {
+        r->flags |= OSAL_FAULT_FLAG_NO_FRAME;
+    } else {
+        uint32_t end;
+        r->r0 = frame[0];
+        r->r1 = frame[1];
+        r->r2 = frame[2];
+        r->r3 = frame[3];
+        r->r12 = frame[4];
+        r->lr = frame[5];
+        r->pc = frame[6];
+        r->xpsr = frame[7];
+        // Basic or extended (FPU) frame, plus the alignment word flagged in xPSR bit 9
+        addr += ((r->flags & OSAL_FAULT_FLAG_FPU) != 0U) ? 0x68U : 0x20U;
+        addr += ((r->xpsr & (1UL << 9)) != 0U) ? 4U : 0U;
+        r->sp = addr;
+        end = osal_fault_ram_end(addr, 4U);
+        if (end != 0U) {
+            uint32_t n = (end - addr) / sizeof(uint32_t);
+            r->stack_words = (n < OSAL_FAULT_STACK_WORDS) ? n : OSAL_FAULT_STACK_WORDS;
+            for (uint32_t i = 0U; i < r->stack_words; i++) {
+                ((volatile uint32_t *)r->stack)[i] = ((const uint32_t *)addr)[i];
+            }
+        }
+    }
+    r->magic = OSAL_FAULT_MAGIC;
+    r->check = osal_fault_check(r);
+
+    // Functional reset: .noinit (standby RAM) is kept
+    __asm volatile ("dsb" ::: "memory");
+    osal_reset_functional();
+}
+
+/**
+ * Common entry of the fault handlers: pass the frame (on MSP or PSP, per EXC_RETURN) and
+ * EXC_RETURN to osal_fault_capture() on the private stack.
+ */
+OSAL_FAST_CODE __attribute__((naked)) void HardFault_Handler(void)
+{
+    __asm volatile (
+        "tst     lr, #4                   \n"
+        "ite     eq                       \n"
+        "mrseq   r0, msp                  \n"
+        "mrsne   r0, psp                  \n"
+        "mov     r1, lr                   \n"
+        "ldr     r2, =osal_fault_stack    \n"
+        "add     r2, r2, #" OSAL_FAULT_XSTR(OSAL_FAULT_STACK_SIZE) " \n"
+        "msr     msp, r2                  \n"
+        "b       osal_fault_capture       \n"
+        ".ltorg                           \n"
+    );
+}
+
+void MemManage_Handler(void) __attribute__((alias("HardFault_Handler")));
+void BusFault_Handler(void) __attribute__((alias("HardFault_Handler")));
+void UsageFault_Handler(void) __attribute__((alias("HardFault_Handler")));
+
+void osal_fault_init(void)
+{
+    SCB_SHCSR |= SCB_SHCSR_FAULTS_ENA;
+    __asm volatile ("dsb\n isb" ::: "memory");
+}
+
+// Names of the CFSR and HFSR bits set, comma separated
+static void osal_fault_reasons(const osal_fault_record_t *r, char *buf, size_t size)
+{
+    static const char *const cfsr_names[32] = {
+        "IACCVIOL", "DACCVIOL", NULL, "MUNSTKERR", "MSTKERR", "MLSPERR", NULL, NULL,
+        "IBUSERR", "PRECISERR", "IMPRECISERR", "UNSTKERR", "STKERR", "LSPERR", NULL, NULL,
+        "UNDEFINSTR", "INVSTATE", "INVPC", "NOCP", NULL, NULL, NULL, NULL,
+        "UNALIGNED", "DIVBYZERO", NULL, NULL, NULL, NULL, NULL, NULL
+    };
+    size_t len = 0U;
+
+    buf[0] = '\0';
+    for (uint32_t i = 0U; (i < 32U) && (len < size); i++) {
+        if (((r->cfsr & (1UL << i)) != 0U) && (cfsr_names[i] != NULL)) {
+            len += (size_t)snprintf(&buf[len], size - len, "%s%s", (len > 0U) ? "," : "", cfsr_names[i]);
+        }
+    }
+    if (((r->hfsr & (1UL << 30)) != 0U) && (len < size)) {
+        len += (size_t)snprintf(&buf[len], size - len, "%sFORCED", (len > 0U) ? "," : "");
+    }
+    if (((r->hfsr & (1UL << 1)) != 0U) && (len < size)) {
+        (void)snprintf(&buf[len], size - len, "%sVECTTBL", (len > 0U) ? "," : "");
+    }
+}
+
+static void osal_fault_log(const osal_fault_record_t *r, const char *title)
+{
+    static const char *const names[] = { "HardFault", "MemManage", "BusFault", "UsageFault" };
+    char log_buffer[LOG_BUFFER_SIZE];
+    char reasons[96];
+    int len;
+
+    snprintf(log_buffer, LOG_BUFFER_SIZE, "%s: %s in %s, PC 0x%08lx LR 0x%08lx SP 0x%08lx xPSR 0x%08lx%s\r\n",
+             title, ((r->exception >= 3U) && (r->exception <= 6U)) ? names[r->exception - 3U] : "exception",
+             ((r->flags & OSAL_FAULT_FLAG_PSP) != 0U) ? "task" : "handler/main",
+             (unsigned long)r->pc, (unsigned long)r->lr, (unsigned long)r->sp, (unsigned long)r->xpsr,
+             ((r->flags & OSAL_FAULT_FLAG_NO_FRAME) != 0U) ? " (no frame: stacking failed)" : "");
+    osal_log_info(log_buffer);
+    osal_fault_reasons(r, reasons, sizeof(reasons));
+    len = snprintf(log_buffer, LOG_BUFFER_SIZE, "  CFSR 0x%08lx HFSR 0x%08lx",
+                   (unsigned long)r->cfsr, (unsigned long)r->hfsr);
+    // The fault addresses only mean something when flagged valid
+    if ((r->cfsr & CFSR_MMARVALID) != 0U) {
+        len += snprintf(&log_buffer[len], LOG_BUFFER_SIZE - (size_t)len, " MMFAR 0x%08lx", (unsigned long)r->mmfar);
+    }
+    if ((r->cfsr & CFSR_BFARVALID) != 0U) {
+        len += snprintf(&log_buffer[len], LOG_BUFFER_SIZE - (size_t)len, " BFAR 0x%08lx", (unsigned long)r->bfar);
+    }
+    snprintf(&log_buffer[len], LOG_BUFFER_SIZE - (size_t)len, ": %s\r\n", (reasons[0] != '\0') ? reasons : "-");
+    osal_log_info(log_buffer);
+    snprintf(log_buffer, LOG_BUFFER_SIZE, "  r0 0x%08lx r1 0x%08lx r2 0x%08lx r3 0x%08lx r12 0x%08lx\r\n",
+             (unsigned long)r->r0, (unsigned long)r->r1, (unsigned long)r->r2, (unsigned long)r->r3,
+             (unsigned long)r->r12);
+    osal_log_info(log_buffer);
+    for (uint32_t i = 0U; i < r->stack_words; i += 4U) {
+        len = snprintf(log_buffer, LOG_BUFFER_SIZE, "  [sp+0x%02lx]", (unsigned long)(i * 4U));
+        for (uint32_t j = i; (j < (i + 4U)) && (j < r->stack_words); j++) {
+            len += snprintf(&log_buffer[len], LOG_BUFFER_SIZE - (size_t)len, " %08lx", (unsigned long)r->stack[j]);
+        }
+        snprintf(&log_buffer[len], LOG_BUFFER_SIZE - (size_t)len, "\r\n");
+        osal_log_info(log_buffer);
+    }
+}
+
+bool osal_fault_pending(void)
+{
+    const osal_fault_record_t *r = &osal_fault_record;
+
+    return (r->magic == OSAL_FAULT_MAGIC) && (r->check == osal_fault_check(r));
+}
+
+int32_t osal_fault_boot_report(void)
+{
+    osal_fault_record_t *r = &osal_fault_record;
+    uint32_t count = 0U;
+    uint32_t len;
+    int32_t ret;
+
+    if ((osal_kv_get(OSAL_FAULT_KV_COUNT, &count, sizeof(count), &len) != 0) || (len != sizeof(count))) {
+        count = 0U;
+    }
+    osal_fault_stored_count = count;
+    if (!osal_fault_pending()) {
+        return 0;
+    }
+    osal_fault_log(r, "Fault before reset");
+    count++;
+    ret = osal_kv_set(OSAL_FAULT_KV_RECORD, r, sizeof(*r));
+    if (ret == 0) {
+        ret = osal_kv_set(OSAL_FAULT_KV_COUNT, &count, sizeof(count));
+    }
+    if (ret != 0) {
+        osal_log_info("  not stored, kept for the next boot\r\n");
+        return ret;
+    }
+    osal_fault_stored_count = count;
+    r->magic = 0U;
+    return 1;
+}
+
+uint32_t osal_fault_count(void)
+{
+    return osal_fault_stored_count;
+}
+
+void osal_fault_log_stored(void)
+{
+    osal_fault_record_t r;
+    char log_buffer[LOG_BUFFER_SIZE];
+    uint32_t len;
+
+    snprintf(log_buffer, LOG_BUFFER_SIZE, "Faults recorded: %lu\r\n", (unsigned long)osal_fault_stored_count);
+    osal_log_info(log_buffer);
+    if ((osal_kv_get(OSAL_FAULT_KV_RECORD, &r, sizeof(r), &len) == 0) && (len == sizeof(r))) {
+        osal_fault_log(&r, "Last fault");
+    }
+}
@@ -0,0 +1,395 @@
+#include "osal_flash.h"
+#include <string.h>
+#ifdef __linux__
+#include <stdio.h>
+#include <stdlib.h>
+#else
+#include "osal_cache.h"
+#include "S32K312_FLASH.h"
+#include "S32K312_PFLASH.h"
+#endif
+
+typedef enum {
+    OSAL_FLASH_IDLE,
+    OSAL_FLASH_ERASING,
+    OSAL_FLASH_PROGRAMMING
+} osal_flash_op_t;
+
+static osal_flash_op_t osal_flash_op;
+static uint32_t osal_flash_op_addr;
+static uint32_t osal_flash_op_len;
+static osal_flash_stats_t osal_flash_stats;
+
+static bool osal_flash_range_ok(uint32_t addr, uint32_t len)
+{
+    if ((addr >= OSAL_FLASH_PFLASH_START) && (addr < OSAL_FLASH_PFLASH_END)) {
+        return len <= (OSAL_FLASH_PFLASH_END - addr);
+    }
+    if ((addr >= OSAL_FLASH_DFLASH_START) && (addr < OSAL_FLASH_DFLASH_END)) {
+        return len <= (OSAL_FLASH_DFLASH_END - addr);
+    }
+    return false;
+}
+
+#ifndef __linux__
+// Data flash is block 4 of the lock registers
+#define OSAL_FLASH_DFLASH_BLOCK 4U
+// The first 256 KB of a block lock per 8 KB sector (SSPELOCK), the rest per 32 KB super sector
+#define OSAL_FLASH_SMALL_LOCK_SPAN 0x40000UL
+#define OSAL_FLASH_SUPER_SECTOR 0x8000UL
+
+// Sector locks reset to locked: clear the one covering addr before each operation
+static void osal_flash_unlock(uint32_t addr)
+{
+    uint32_t block;
+    uint32_t offset;
+
+    if (addr >= OSAL_FLASH_DFLASH_START) {
+        block = OSAL_FLASH_DFLASH_BLOCK;
+        offset = addr - OSAL_FLASH_DFLASH_START;
+    } else {
+        block = (addr - 0x00400000UL) / OSAL_FLASH_BLOCK_SIZE;
+        offset = (addr - 0x00400000UL) % OSAL_FLASH_BLOCK_SIZE;
+    }
+    if (offset < OSAL_FLASH_SMALL_LOCK_SPAN) {
+        IP_PFLASH->PFCBLK_SSPELOCK[block] &= ~(1UL << (offset / OSAL_FLASH_SECTOR_SIZE));
+    } else {
+        IP_PFLASH->PFCBLK_SPELOCK[block] &= ~(1UL << (offset / OSAL_FLASH_SUPER_SECTOR));
+    }
+}
+
+static void osal_flash_hw_erase(uint32_t addr)
+{
+    osal_flash_unlock(addr);
+    IP_FLASH->MCR = FLASH_MCR_ERS_MASK;
+    IP_PFLASH->PFCPGM_PEADR_L = addr;
+    IP_FLASH->DATA[0] = 0U;          // Interlock write, selects the sector
+    IP_FLASH->MCR = FLASH_MCR_ERS_MASK | FLASH_MCR_EHV_MASK;
+}
+
+static void osal_flash_hw_program(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    osal_flash_unlock(addr);
+    IP_FLASH->MCR = FLASH_MCR_PGM_MASK;
+    IP_PFLASH->PFCPGM_PEADR_L = addr;
+    for (uint32_t i = 0U; i < (len / 4U); i++) {
+        uint32_t word;
+        memcpy(&word, &data[4U * i], sizeof(word));
+        IP_FLASH->DATA[i] = word;
+    }
+    IP_FLASH->MCR = FLASH_MCR_PGM_MASK | FLASH_MCR_EHV_MASK;
+}
+
+// 1 while busy, else 0 or -1 with the high voltage sequence closed
+static int32_t osal_flash_hw_poll(void)
+{
+    uint32_t mcrs = IP_FLASH->MCRS;
+
+    if ((mcrs & FLASH_MCRS_DONE_MASK) == 0U) {
+        return 1;
+    }
+    IP_FLASH->MCR &= ~FLASH_MCR_EHV_MASK;
+    IP_FLASH->MCR = 0U;
+    osal_cache_invalidate_range((void *)(uintptr_t)osal_flash_op_addr, osal_flash_op_len);
+    return (((mcrs & FLASH_MCRS_PEG_MASK) != 0U) &&
+            ((mcrs & (FLASH_MCRS_PES_MASK | FLASH_MCRS_PEP_MASK)) == 0U)) ? 0 : -1;
+}
+
+void osal_flash_read(uint32_t addr, void *buf, uint32_t len)
+{
+    memcpy(buf, (const void *)(uintptr_t)addr, len);
+}
+
+// An uncorrectable ECC error answers the load with a bus error. With FAULTMASK set and
+// CCR.BFHFNMIGN, the core ignores bus errors of loads instead of faulting; BFSR still
+// records them.
+#define SCB_CCR             (*(volatile uint32_t *)0xE000ED14UL)
+#define SCB_CFSR            (*(volatile uint32_t *)0xE000ED28UL)
+#define SCB_CCR_BFHFNMIGN   (1UL << 8)
+#define SCB_CFSR_BFSR       0x0000FF00UL
+#define SCB_CFSR_BUS_ERRORS ((1UL << 9) | (1UL << 10))   // PRECISERR | IMPRECISERR
+
+int32_t osal_flash_read_checked(uint32_t addr, void *buf, uint32_t len)
+{
+    uint32_t cfsr;
+
+    SCB_CFSR = SCB_CFSR_BFSR;
+    __asm volatile ("cpsid f" ::: "memory");
+    SCB_CCR |= SCB_CCR_BFHFNMIGN;
+    __asm volatile ("dsb\n isb" ::: "memory");
+    memcpy(buf, (const void *)(uintptr_t)addr, len);
+    __asm volatile ("dsb" ::: "memory");
+    SCB_CCR &= ~SCB_CCR_BFHFNMIGN;
+    __asm volatile ("isb" ::: "memory");
+    cfsr = SCB_CFSR;
+    SCB_CFSR = cfsr & SCB_CFSR_BFSR;
+    __asm volatile ("cpsie f" ::: "memory");
+    return ((cfsr & SCB_CFSR_BUS_ERRORS) != 0U) ? -1 : 0;
+}
+#else
+// Host build: RAM model of the application area and the data flash. Erased bytes read 0xFF
+// and programming can only clear bits, as on the real array.
+static uint8_t osal_flash_model_pflash[OSAL_FLASH_PFLASH_END - OSAL_FLASH_PFLASH_START];
+static uint8_t osal_flash_model_dflash[OSAL_FLASH_DFLASH_END - OSAL_FLASH_DFLASH_START];
+static bool osal_flash_model_ready;
+static uint32_t osal_flash_model_erase_polls = 4U;
+static uint32_t osal_flash_model_program_polls = 1U;
+static uint32_t osal_flash_model_busy;
+static uint8_t osal_flash_model_page[OSAL_FLASH_PAGE_SIZE];
+// Double words failing their ECC, one bit each (program flash, then data flash)
+static uint8_t osal_flash_model_ecc[(sizeof(osal_flash_model_pflash) + sizeof(osal_flash_model_dflash)) /
+                                    (8U * OSAL_FLASH_WRITE_UNIT)];
+static uint32_t osal_flash_model_cut_left = UINT32_MAX;
+
+static uint8_t *osal_flash_model_at(uint32_t addr)
+{
+    if (!osal_flash_model_ready) {
+        memset(osal_flash_model_pflash, 0xFF, sizeof(osal_flash_model_pflash));
+        memset(osal_flash_model_dflash, 0xFF, sizeof(osal_flash_model_dflash));
+        osal_flash_model_ready = true;
+    }
+    if (addr >= OSAL_FLASH_DFLASH_START) {
+        return &osal_flash_model_dflash[addr - OSAL_FLASH_DFLASH_START];
+    }
+    return &osal_flash_model_pflash[addr - OSAL_FLASH_PFLASH_START];
+}
+
+uint8_t *osal_flash_model(uint32_t addr, uint32_t *size)
+{
+    if (addr == OSAL_FLASH_PFLASH_START) {
+        *size = (uint32_t)sizeof(osal_flash_model_pflash);
+    } else if (addr == OSAL_FLASH_DFLASH_START) {
+        *size = (uint32_t)sizeof(osal_flash_model_dflash);
+    } else {
+        return NULL;
+    }
+    return osal_flash_model_at(addr);
+}
+
+void osal_flash_model_timing(uint32_t erase_polls, uint32_t program_polls)
+{
+    osal_flash_model_erase_polls = erase_polls;
+    osal_flash_model_program_polls = program_polls;
+}
+
+void osal_flash_model_cut(uint32_t bytes)
+{
+    osal_flash_model_cut_left = bytes;
+}
+
+// Double word index of addr in osal_flash_model_ecc
+static uint32_t osal_flash_model_unit(uint32_t addr)
+{
+    if (addr >= OSAL_FLASH_DFLASH_START) {
+        return ((uint32_t)sizeof(osal_flash_model_pflash) + (addr - OSAL_FLASH_DFLASH_START)) / OSAL_FLASH_WRITE_UNIT;
+    }
+    return (addr - OSAL_FLASH_PFLASH_START) / OSAL_FLASH_WRITE_UNIT;
+}
+
+static bool osal_flash_model_ecc_error(uint32_t addr, uint32_t len)
+{
+    for (uint32_t a = addr & ~(OSAL_FLASH_WRITE_UNIT - 1U); a < (addr + len); a += OSAL_FLASH_WRITE_UNIT) {
+        uint32_t u = osal_flash_model_unit(a);
+        if ((osal_flash_model_ecc[u / 8U] & (1U << (u % 8U))) != 0U) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void osal_flash_model_ecc_set(uint32_t addr, bool error)
+{
+    uint32_t u = osal_flash_model_unit(addr);
+
+    if (error) {
+        osal_flash_model_ecc[u / 8U] |= (uint8_t)(1U << (u % 8U));
+    } else {
+        osal_flash_model_ecc[u / 8U] &= (uint8_t)~(1U << (u % 8U));
+    }
+}
+
+static void osal_flash_hw_erase(uint32_t addr)
+{
+    (void)addr;
+    osal_flash_model_busy = osal_flash_model_erase_polls;
+}
+
+static void osal_flash_hw_program(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    (void)addr;
+    memcpy(osal_flash_model_page, data, len);
+    osal_flash_model_busy = osal_flash_model_program_polls;
+}
+
+static int32_t osal_flash_hw_poll(void)
+{
+    uint8_t *p = osal_flash_model_at(osal_flash_op_addr);
+
+    if (osal_flash_model_busy > 0U) {
+        osal_flash_model_busy--;
+        return 1;
+    }
+    if (osal_flash_op == OSAL_FLASH_ERASING) {
+        memset(p, 0xFF, osal_flash_op_len);
+        for (uint32_t i = 0U; i < osal_flash_op_len; i += OSAL_FLASH_WRITE_UNIT) {
+            osal_flash_model_ecc_set(osal_flash_op_addr + i, false);
+        }
+        return 0;
+    }
+    if (osal_flash_model_cut_left < osal_flash_op_len) {
+        // Cut short: the double word at the cut gets every other byte, the rest nothing
+        uint32_t cut = osal_flash_model_cut_left & ~(OSAL_FLASH_WRITE_UNIT - 1U);
+
+        for (uint32_t i = 0U; i < cut; i++) {
+            p[i] &= osal_flash_model_page[i];
+        }
+        for (uint32_t i = cut; i < (cut + OSAL_FLASH_WRITE_UNIT); i += 2U) {
+            p[i] &= osal_flash_model_page[i];
+        }
+        osal_flash_model_ecc_set(osal_flash_op_addr + cut, true);
+        osal_flash_model_cut_left = UINT32_MAX;
+        return -1;
+    }
+    if (osal_flash_model_cut_left != UINT32_MAX) {
+        osal_flash_model_cut_left -= osal_flash_op_len;
+    }
+    for (uint32_t i = 0U; i < osal_flash_op_len; i++) {
+        p[i] &= osal_flash_model_page[i];
+    }
+    return 0;
+}
+
+void osal_flash_read(uint32_t addr, void *buf, uint32_t len)
+{
+    if (osal_flash_model_ecc_error(addr, len)) {
+        // A bus fault on the target
+        fprintf(stderr, "osal_flash_read: ECC error in 0x%08lx + %lu\n", (unsigned long)addr, (unsigned long)len);
+        abort();
+    }
+    memcpy(buf, osal_flash_model_at(addr), len);
+}
+
+int32_t osal_flash_read_checked(uint32_t addr, void *buf, uint32_t len)
+{
+    memcpy(buf, osal_flash_model_at(addr), len);
+    return osal_flash_model_ecc_error(addr, len) ? -1 : 0;
+}
+#endif /* __linux__ */
+
+int32_t osal_flash_erase_start(uint32_t addr)
+{
+    if (((addr % OSAL_FLASH_SECTOR_SIZE) != 0U) || !osal_flash_range_ok(addr, OSAL_FLASH_SECTOR_SIZE)) {
+        return -1;
+    }
+    if (osal_flash_op != OSAL_FLASH_IDLE) {
+        return -2;
+    }
+    osal_flash_op = OSAL_FLASH_ERASING;
+    osal_flash_op_addr = addr;
+    osal_flash_op_len = OSAL_FLASH_SECTOR_SIZE;
+    osal_flash_stats.erases++;
+    osal_flash_hw_erase(addr);
+    return 0;
+}
+
+int32_t osal_flash_program_start(uint32_t addr, const void *data, uint32_t len)
+{
+    if ((len == 0U) || ((addr % OSAL_FLASH_WRITE_UNIT) != 0U) || ((len % OSAL_FLASH_WRITE_UNIT) != 0U) ||
+        (((addr % OSAL_FLASH_PAGE_SIZE) + len) > OSAL_FLASH_PAGE_SIZE) || !osal_flash_range_ok(addr, len)) {
+        return -1;
+    }
+    if (osal_flash_op != OSAL_FLASH_IDLE) {
+        return -2;
+    }
+    osal_flash_op = OSAL_FLASH_PROGRAMMING;
+    osal_flash_op_addr = addr;
+    osal_flash_op_len = len;
+    osal_flash_stats.programs++;
+    osal_flash_hw_program(addr, (const uint8_t *)data, len);
+    return 0;
+}
+
+int32_t osal_flash_poll(void)
+{
+    int32_t ret;
+
+    if (osal_flash_op == OSAL_FLASH_IDLE) {
+        return 0;
+    }
+    ret = osal_flash_hw_poll();
+    if (ret <= 0) {
+        osal_flash_op = OSAL_FLASH_IDLE;
+        if (ret < 0) {
+            osal_flash_stats.errors++;
+        }
+    }
+    return ret;
+}
+
+int32_t osal_flash_wait(void)
+{
+    int32_t ret;
+
+    do {
+        ret = osal_flash_poll();
+    } while (ret > 0);
+    return ret;
+}
+
+int32_t osal_flash_erase(uint32_t addr)
+{
+    int32_t ret = osal_flash_erase_start(addr);
+
+    return (ret == 0) ? osal_flash_wait() : ret;
+}
+
+int32_t osal_flash_program(uint32_t addr, const void *data, uint32_t len)
+{
+    const uint8_t *src = (const uint8_t *)data;
+
+    if (((len % OSAL_FLASH_WRITE_UNIT) != 0U) || !osal_flash_range_ok(addr, len)) {
+        return -1;
+    }
+    while (len > 0U) {
+        uint32_t n = OSAL_FLASH_PAGE_SIZE - (addr % OSAL_FLASH_PAGE_SIZE);
+        int32_t ret;
+
+        n = (n < len) ? n : len;
+        ret = osal_flash_program_start(addr, src, n);
+        if (ret == 0) {
+            ret = osal_flash_wait();
+        }
+        if (ret != 0) {
+            return ret;
+        }
+        addr += n;
+        src += n;
+        len -= n;
+    }
+    return 0;
+}
+
+bool osal_flash_is_erased(uint32_t addr, uint32_t len)
+{
+    uint8_t buf[32];
+
+    while (len > 0U) {
+        uint32_t n = (len < sizeof(buf)) ? len : (uint32_t)sizeof(buf);
+        if (osal_flash_read_checked(addr, buf, n) != 0) {
+            return false;
+        }
+        for (uint32_t i = 0U; i < n; i++) {
+            if (buf[i] != 0xFFU) {
+                return false;
+            }
+        }
+        addr += n;
+        len -= n;
+    }
+    return true;
+}
+
+void osal_flash_get_stats(osal_flash_stats_t *stats)
+{
+    *stats = osal_flash_stats;
+}
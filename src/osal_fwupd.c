@@ -0,0 +1,619 @@
+#include "osal_fwupd.h"
+#include "osal_crc32.h"
+#include "osal_delta.h"
+#include "osal_flash.h"
+#include <stdbool.h>
+#include <string.h>
+#ifndef __linux__
+#include "osal_log.h"
+#include "osal_utils.h"
+#include "IntCtrl_Ip.h"
+#include "Lpuart_Uart_Ip.h"
+#include "S32K312_LPUART.h"
+#include <stdio.h>
+#endif
+
+_Static_assert(OSAL_FWUPD_RING_SIZE >= (OSAL_FWUPD_WINDOW * OSAL_FWUPD_FRAME_MAX), "ring must hold a window");
+_Static_assert((OSAL_FWUPD_RING_SIZE & (OSAL_FWUPD_RING_SIZE - 1U)) == 0U, "ring size must be a power of 2");
+_Static_assert(APP_METADATA_SIZE <= OSAL_FWUPD_CHUNK, "metadata must fit one frame");
+
+typedef enum {
+    FWUPD_WAIT_START,
+    FWUPD_RECEIVING,
+    FWUPD_FINISHED
+} osal_fwupd_state_t;
+
+// What the flash is doing for the receiver
+typedef enum {
+    FWUPD_FLASH_IDLE,
+    FWUPD_FLASH_ERASE_META,
+    FWUPD_FLASH_ERASE,
+    FWUPD_FLASH_PROGRAM,
+    FWUPD_FLASH_PROGRAM_META
+} osal_fwupd_flash_op_t;
+
+static struct {
+    osal_fwupd_state_t state;
+    osal_fwupd_flash_op_t flash_op;
+    uint32_t slot;
+    uint32_t base;
+    uint32_t size;
+    uint32_t image_crc;
+    uint32_t crc;                 // Running CRC-32 of the image bytes in flash
+    uint32_t next_seq;
+    uint32_t chunks;
+    uint32_t stream_size;         // Bytes carried by DATA frames: the image, or the patch
+    uint32_t erased_end;          // [base, erased_end) is erased
+    bool nak_sent;                // One NAK per gap: frames in flight behind a bad one are dropped silently
+    bool delta;                   // DATA frames carry a patch against the running slot
+    osal_delta_t patch;
+    const osal_slot_flash_t *flash;
+    osal_fwupd_send_t send;
+    osal_fwupd_stats_t stats;
+
+    // Ring filled by osal_fwupd_receive(), drained by the parser
+    uint8_t ring[OSAL_FWUPD_RING_SIZE];
+    volatile uint32_t ring_head;
+    volatile uint32_t ring_tail;
+
+    // Frame being parsed, then held until it is consumed
+    uint8_t frame[OSAL_FWUPD_FRAME_MAX];
+    uint32_t frame_pos;
+    bool pending;                 // frame holds a checked frame
+    uint32_t frame_off;           // Payload bytes of the pending frame consumed
+
+    // Image bytes are collected into page and programmed a page at a time
+    uint8_t page[OSAL_FLASH_PAGE_SIZE];
+    uint32_t page_addr;           // Flash address of page[0]
+    uint32_t page_fill;
+    uint32_t meta_off;            // Metadata bytes programmed
+} osal_fwupd;
+
+static uint16_t osal_fwupd_get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+static uint32_t osal_fwupd_get32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void osal_fwupd_put32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static void osal_fwupd_reply(uint8_t type, uint32_t seq, const uint8_t *payload, uint32_t len)
+{
+    uint8_t out[OSAL_FWUPD_HDR_LEN + 4U + 4U];
+
+    out[0] = OSAL_FWUPD_SOF;
+    out[1] = type;
+    out[2] = (uint8_t)seq;
+    out[3] = (uint8_t)(seq >> 8);
+    out[4] = (uint8_t)len;
+    out[5] = 0U;
+    if (len > 0U) {
+        memcpy(&out[OSAL_FWUPD_HDR_LEN], payload, len);
+    }
+    osal_fwupd_put32(&out[OSAL_FWUPD_HDR_LEN + len], osal_crc32(&out[1], OSAL_FWUPD_HDR_LEN - 1U + len));
+    osal_fwupd.send(out, OSAL_FWUPD_HDR_LEN + len + 4U);
+}
+
+static void osal_fwupd_nak(uint8_t reason)
+{
+    if (!osal_fwupd.nak_sent) {
+        osal_fwupd.nak_sent = true;
+        osal_fwupd.stats.naks++;
+        osal_fwupd_reply(OSAL_FWUPD_NAK, osal_fwupd.next_seq, &reason, 1U);
+    }
+}
+
+static int32_t osal_fwupd_finish(int32_t status)
+{
+    uint8_t result = (uint8_t)(int8_t)status;
+
+    // Leave the controller idle; nothing more is written this session
+    (void)osal_flash_wait();
+    osal_fwupd.flash_op = FWUPD_FLASH_IDLE;
+    osal_fwupd.pending = false;
+    osal_fwupd.state = FWUPD_FINISHED;
+    osal_fwupd.stats.status = status;
+    osal_fwupd_reply(OSAL_FWUPD_DONE, osal_fwupd.next_seq, &result, 1U);
+    return status;
+}
+
+void osal_fwupd_begin(uint32_t slot, const osal_slot_flash_t *flash, osal_fwupd_send_t send)
+{
+    memset(&osal_fwupd.stats, 0, sizeof(osal_fwupd.stats));
+    osal_fwupd.state = FWUPD_WAIT_START;
+    osal_fwupd.flash_op = FWUPD_FLASH_IDLE;
+    osal_fwupd.slot = slot;
+    osal_fwupd.flash = flash;
+    osal_fwupd.send = send;
+    osal_fwupd.ring_head = 0U;
+    osal_fwupd.ring_tail = 0U;
+    osal_fwupd.frame_pos = 0U;
+    osal_fwupd.pending = false;
+    osal_fwupd.stats.status = 1;
+    osal_fwupd.stats.slot = slot;
+}
+
+void osal_fwupd_receive(const uint8_t *data, uint32_t len)
+{
+    uint32_t head = osal_fwupd.ring_head;
+
+    for (uint32_t i = 0U; i < len; i++) {
+        if ((head - osal_fwupd.ring_tail) >= OSAL_FWUPD_RING_SIZE) {
+            osal_fwupd.stats.overruns++;
+            continue;
+        }
+        osal_fwupd.ring[head & (OSAL_FWUPD_RING_SIZE - 1U)] = data[i];
+        head++;
+    }
+    osal_fwupd.ring_head = head;
+}
+
+// Assemble one frame from the ring. Returns true with a CRC-checked frame in osal_fwupd.frame.
+static bool osal_fwupd_parse(void)
+{
+    uint8_t *f = osal_fwupd.frame;
+
+    while (osal_fwupd.ring_tail != osal_fwupd.ring_head) {
+        uint8_t b = osal_fwupd.ring[osal_fwupd.ring_tail & (OSAL_FWUPD_RING_SIZE - 1U)];
+        osal_fwupd.ring_tail++;
+
+        if ((osal_fwupd.frame_pos == 0U) && (b != OSAL_FWUPD_SOF)) {
+            continue;
+        }
+        f[osal_fwupd.frame_pos++] = b;
+        if (osal_fwupd.frame_pos < OSAL_FWUPD_HDR_LEN) {
+            continue;
+        }
+        uint32_t len = osal_fwupd_get16(&f[4]);
+        if (len > OSAL_FWUPD_CHUNK) {
+            // Not a header: resynchronize on the next SOF
+            osal_fwupd.frame_pos = 0U;
+            continue;
+        }
+        if (osal_fwupd.frame_pos < (OSAL_FWUPD_HDR_LEN + len + 4U)) {
+            continue;
+        }
+        osal_fwupd.frame_pos = 0U;
+        if (osal_crc32(&f[1], OSAL_FWUPD_HDR_LEN - 1U + len) != osal_fwupd_get32(&f[OSAL_FWUPD_HDR_LEN + len])) {
+            osal_fwupd.stats.crc_errors++;
+            osal_fwupd_nak(OSAL_FWUPD_NAK_CRC);
+            continue;
+        }
+        osal_fwupd.stats.frames++;
+        return true;
+    }
+    return false;
+}
+
+// START of a delta session: the patch must have been made against the image in the running
+// (other) slot, identified by its CRC
+static int32_t osal_fwupd_start_delta(const uint8_t *payload)
+{
+    uint32_t old_slot = osal_fwupd.slot ^ 1U;
+    osal_slot_header_t old;
+
+    osal_fwupd.stream_size = osal_fwupd_get32(&payload[12]);
+    if ((osal_fwupd.stream_size == 0U) ||
+        (osal_slot_read_header(osal_fwupd.flash, old_slot, &old) != OSAL_SLOT_UNCHECKED) ||
+        (old.crc32 != osal_fwupd_get32(&payload[16]))) {
+        return -1;
+    }
+    osal_delta_init(&osal_fwupd.patch, osal_slot_layout[old_slot].base, old.image_size, osal_fwupd.size);
+    osal_fwupd.delta = true;
+    return 0;
+}
+
+// Check a new frame; returns 1 to hold it, 0 to drop it, or a final status
+static int32_t osal_fwupd_accept(void)
+{
+    const uint8_t *f = osal_fwupd.frame;
+    uint32_t seq = osal_fwupd_get16(&f[2]);
+    uint32_t len = osal_fwupd_get16(&f[4]);
+    const uint8_t *payload = &f[OSAL_FWUPD_HDR_LEN];
+
+    switch (f[1]) {
+    case OSAL_FWUPD_START:
+        if (osal_fwupd.state != FWUPD_WAIT_START) {
+            // START retransmitted because our ACK was lost: answer again
+            osal_fwupd_reply(OSAL_FWUPD_ACK, osal_fwupd.next_seq, NULL, 0U);
+            return 0;
+        }
+        if ((len != 12U) && (len != 20U)) {
+            return 0;
+        }
+        osal_fwupd.base = osal_fwupd_get32(&payload[0]);
+        osal_fwupd.size = osal_fwupd_get32(&payload[4]);
+        osal_fwupd.image_crc = osal_fwupd_get32(&payload[8]);
+        osal_fwupd.stream_size = osal_fwupd.size;
+        osal_fwupd.delta = false;
+        if ((osal_fwupd.base != osal_slot_layout[osal_fwupd.slot].base) || (osal_fwupd.size == 0U) ||
+            (osal_fwupd.size > OSAL_SLOT_SIZE) || ((len == 20U) && (osal_fwupd_start_delta(payload) != 0))) {
+            return osal_fwupd_finish(-2);
+        }
+        osal_fwupd.stats.image_size = osal_fwupd.size;
+        osal_fwupd.stats.stream_size = osal_fwupd.stream_size;
+        osal_fwupd.chunks = (osal_fwupd.stream_size + OSAL_FWUPD_CHUNK - 1U) / OSAL_FWUPD_CHUNK;
+        osal_fwupd.next_seq = 0U;
+        osal_fwupd.crc = 0U;
+        osal_fwupd.erased_end = osal_fwupd.base;
+        osal_fwupd.page_addr = osal_fwupd.base;
+        osal_fwupd.page_fill = 0U;
+        osal_fwupd.meta_off = 0U;
+        osal_fwupd.nak_sent = false;
+        return 1;
+    case OSAL_FWUPD_DATA:
+        if (osal_fwupd.state != FWUPD_RECEIVING) {
+            return 0;
+        }
+        if ((seq != (osal_fwupd.next_seq & 0xFFFFU)) || (osal_fwupd.next_seq >= osal_fwupd.chunks)) {
+            osal_fwupd_nak(OSAL_FWUPD_NAK_SEQUENCE);
+            return 0;
+        }
+        // Every chunk is full except the last
+        if (((osal_fwupd.next_seq + 1U) < osal_fwupd.chunks) ? (len != OSAL_FWUPD_CHUNK) :
+            (len != (osal_fwupd.stream_size - (osal_fwupd.next_seq * OSAL_FWUPD_CHUNK)))) {
+            return osal_fwupd_finish(-2);
+        }
+        osal_fwupd.nak_sent = false;
+        return 1;
+    case OSAL_FWUPD_END:
+        if (osal_fwupd.state != FWUPD_RECEIVING) {
+            return 0;
+        }
+        if (osal_fwupd.next_seq != osal_fwupd.chunks) {
+            osal_fwupd_nak(OSAL_FWUPD_NAK_SEQUENCE);
+            return 0;
+        }
+        if (len != APP_METADATA_SIZE) {
+            return osal_fwupd_finish(-2);
+        }
+        return 1;
+    case OSAL_FWUPD_ABORT:
+        return osal_fwupd_finish(-1);
+    default:
+        return 0;
+    }
+}
+
+#ifndef __linux__
+static inline uint32_t osal_fwupd_clock(void)
+{
+    return osal_utils_cycles();
+}
+#else
+static inline uint32_t osal_fwupd_clock(void)
+{
+    return 0U;
+}
+#endif
+
+// Image bytes produced so far, in flash or in page
+static uint32_t osal_fwupd_produced(void)
+{
+    return osal_fwupd.stats.bytes + osal_fwupd.page_fill;
+}
+
+// Move payload bytes of the pending DATA frame into page: a copy, or the patch applier.
+// Sets frame_done once the frame is used up; -7 if the patch is corrupt.
+static int32_t osal_fwupd_fill(bool *frame_done)
+{
+    uint32_t len = osal_fwupd_get16(&osal_fwupd.frame[4]);
+    const uint8_t *in = &osal_fwupd.frame[OSAL_FWUPD_HDR_LEN + osal_fwupd.frame_off];
+    uint32_t space = OSAL_FLASH_PAGE_SIZE - osal_fwupd.page_fill;
+    uint32_t used;
+    uint32_t made;
+
+    if (osal_fwupd.delta) {
+        uint32_t start = osal_fwupd_clock();
+        int32_t ret = osal_delta_apply(&osal_fwupd.patch, in, len - osal_fwupd.frame_off, &used,
+                                       &osal_fwupd.page[osal_fwupd.page_fill], space, &made);
+
+        osal_fwupd.stats.apply_cycles += osal_fwupd_clock() - start;
+        if (ret != 0) {
+            return -7;
+        }
+    } else {
+        used = ((len - osal_fwupd.frame_off) < space) ? (len - osal_fwupd.frame_off) : space;
+        memcpy(&osal_fwupd.page[osal_fwupd.page_fill], in, used);
+        made = used;
+    }
+    osal_fwupd.frame_off += used;
+    osal_fwupd.page_fill += made;
+    // A zero run at the end of a patch chunk may still have bytes to produce
+    *frame_done = (osal_fwupd.frame_off == len) && (!osal_fwupd.delta || (osal_fwupd.patch.run_left == 0U));
+    return 0;
+}
+
+static bool osal_fwupd_page_ready(void)
+{
+    return (osal_fwupd.page_fill == OSAL_FLASH_PAGE_SIZE) ||
+           ((osal_fwupd.page_fill > 0U) && (osal_fwupd_produced() >= osal_fwupd.size));
+}
+
+// Start programming len bytes; the tail up to the next write unit is padded with 0xFF
+static int32_t osal_fwupd_program(uint32_t addr, const uint8_t *data, uint32_t len, osal_fwupd_flash_op_t op)
+{
+    uint8_t buf[OSAL_FLASH_PAGE_SIZE];
+    uint32_t n = (len + OSAL_FLASH_WRITE_UNIT - 1U) & ~(OSAL_FLASH_WRITE_UNIT - 1U);
+
+    memset(buf, 0xFF, sizeof(buf));
+    memcpy(buf, data, len);
+    if (osal_flash_program_start(addr, buf, n) != 0) {
+        return -3;
+    }
+    osal_fwupd.flash_op = op;
+    osal_fwupd.stats.programs++;
+    return 0;
+}
+
+// Size of the next metadata piece: up to the end of its page
+static uint32_t osal_fwupd_meta_piece(void)
+{
+    uint32_t addr = osal_slot_layout[osal_fwupd.slot].metadata + osal_fwupd.meta_off;
+    uint32_t n = OSAL_FLASH_PAGE_SIZE - (addr % OSAL_FLASH_PAGE_SIZE);
+
+    return ((APP_METADATA_SIZE - osal_fwupd.meta_off) < n) ? (APP_METADATA_SIZE - osal_fwupd.meta_off) : n;
+}
+
+// A program operation finished: check it and account for it
+static int32_t osal_fwupd_programmed(osal_fwupd_flash_op_t op)
+{
+    uint8_t readback[OSAL_FLASH_PAGE_SIZE];
+
+    if (op == FWUPD_FLASH_PROGRAM) {
+        osal_flash_read(osal_fwupd.page_addr, readback, osal_fwupd.page_fill);
+        if (memcmp(readback, osal_fwupd.page, osal_fwupd.page_fill) != 0) {
+            return osal_fwupd_finish(-3);
+        }
+        osal_fwupd.crc = osal_crc32_update(osal_fwupd.crc, osal_fwupd.page, osal_fwupd.page_fill);
+        osal_fwupd.stats.bytes += osal_fwupd.page_fill;
+        osal_fwupd.page_addr += OSAL_FLASH_PAGE_SIZE;
+        osal_fwupd.page_fill = 0U;
+        return 1;
+    }
+
+    uint32_t addr = osal_slot_layout[osal_fwupd.slot].metadata + osal_fwupd.meta_off;
+    uint32_t n = osal_fwupd_meta_piece();
+    osal_flash_read(addr, readback, n);
+    if (memcmp(readback, &osal_fwupd.frame[OSAL_FWUPD_HDR_LEN + osal_fwupd.meta_off], n) != 0) {
+        return osal_fwupd_finish(-3);
+    }
+    osal_fwupd.meta_off += n;
+    if (osal_fwupd.meta_off < APP_METADATA_SIZE) {
+        return 1;
+    }
+
+    osal_slot_header_t hdr;
+    if ((osal_slot_read_header(osal_fwupd.flash, osal_fwupd.slot, &hdr) != OSAL_SLOT_UNCHECKED) ||
+        (hdr.image_size != osal_fwupd.size) || (hdr.crc32 != osal_fwupd.image_crc) ||
+        (osal_fwupd.flash->verify(osal_fwupd.flash->ctx, osal_fwupd.slot, &hdr) != 0)) {
+        return osal_fwupd_finish(-5);
+    }
+    return osal_fwupd_finish(0);
+}
+
+// Start an erase of the next sector not erased yet
+static int32_t osal_fwupd_erase_next(bool overlapped)
+{
+    if (osal_flash_erase_start(osal_fwupd.erased_end) != 0) {
+        return osal_fwupd_finish(-3);
+    }
+    osal_fwupd.flash_op = FWUPD_FLASH_ERASE;
+    osal_fwupd.stats.erases++;
+    if (overlapped) {
+        osal_fwupd.stats.erase_overlaps++;
+    }
+    return 1;
+}
+
+// With the flash idle: consume the pending frame and start the next flash operation. A full
+// page is programmed once its sector is erased; otherwise, while waiting for frames, erase
+// ahead of the write position (up to the end of the sector after the current one).
+static int32_t osal_fwupd_flash_next(void)
+{
+    uint32_t end = (osal_fwupd.base + osal_fwupd.size + OSAL_FLASH_SECTOR_SIZE - 1U) & ~(OSAL_FLASH_SECTOR_SIZE - 1U);
+    uint32_t ahead = (osal_fwupd.page_addr & ~(OSAL_FLASH_SECTOR_SIZE - 1U)) + (2U * OSAL_FLASH_SECTOR_SIZE);
+
+    if (osal_fwupd.pending && (osal_fwupd.frame[1] == OSAL_FWUPD_START)) {
+        if (osal_flash_erase_start(osal_slot_layout[osal_fwupd.slot].metadata) != 0) {
+            return osal_fwupd_finish(-3);
+        }
+        osal_fwupd.flash_op = FWUPD_FLASH_ERASE_META;
+        osal_fwupd.stats.erases++;
+        return 1;
+    }
+
+    while (osal_fwupd.pending && (osal_fwupd.frame[1] == OSAL_FWUPD_DATA) && !osal_fwupd_page_ready()) {
+        bool frame_done;
+        if (osal_fwupd_fill(&frame_done) != 0) {
+            return osal_fwupd_finish(-7);
+        }
+        if (frame_done) {
+            osal_fwupd.pending = false;
+            osal_fwupd.next_seq++;
+            osal_fwupd_reply(OSAL_FWUPD_ACK, osal_fwupd.next_seq, NULL, 0U);
+        }
+    }
+
+    if (osal_fwupd_page_ready()) {
+        if (osal_fwupd.page_addr < osal_fwupd.erased_end) {
+            return (osal_fwupd_program(osal_fwupd.page_addr, osal_fwupd.page, osal_fwupd.page_fill,
+                                       FWUPD_FLASH_PROGRAM) == 0) ? 1 : osal_fwupd_finish(-3);
+        }
+        return osal_fwupd_erase_next(false);
+    }
+
+    if (osal_fwupd.pending && (osal_fwupd.frame[1] == OSAL_FWUPD_END)) {
+        if (osal_fwupd.meta_off == 0U) {
+            if ((osal_fwupd_produced() != osal_fwupd.size) || (osal_fwupd.delta && !osal_delta_done(&osal_fwupd.patch)) ||
+                (osal_fwupd.crc != osal_fwupd.image_crc)) {
+                return osal_fwupd_finish(-4);
+            }
+        }
+        return (osal_fwupd_program(osal_slot_layout[osal_fwupd.slot].metadata + osal_fwupd.meta_off,
+                                   &osal_fwupd.frame[OSAL_FWUPD_HDR_LEN + osal_fwupd.meta_off],
+                                   osal_fwupd_meta_piece(), FWUPD_FLASH_PROGRAM_META) == 0) ? 1 : osal_fwupd_finish(-3);
+    }
+
+    if ((osal_fwupd.state == FWUPD_RECEIVING) && (osal_fwupd.erased_end < end) && (osal_fwupd.erased_end < ahead)) {
+        return osal_fwupd_erase_next(!osal_fwupd.pending);
+    }
+    return 1;
+}
+
+int32_t osal_fwupd_poll(void)
+{
+    int32_t ret = 1;
+
+    if (osal_fwupd.state == FWUPD_FINISHED) {
+        return osal_fwupd.stats.status;
+    }
+
+    if (osal_fwupd.flash_op != FWUPD_FLASH_IDLE) {
+        int32_t flash = osal_flash_poll();
+        if (flash < 0) {
+            return osal_fwupd_finish(-3);
+        }
+        if (flash == 0) {
+            osal_fwupd_flash_op_t op = osal_fwupd.flash_op;
+            osal_fwupd.flash_op = FWUPD_FLASH_IDLE;
+            if (op == FWUPD_FLASH_ERASE_META) {
+                osal_fwupd.pending = false;
+                osal_fwupd.state = FWUPD_RECEIVING;
+                osal_fwupd_reply(OSAL_FWUPD_ACK, 0U, NULL, 0U);
+            } else if (op == FWUPD_FLASH_ERASE) {
+                osal_fwupd.erased_end += OSAL_FLASH_SECTOR_SIZE;
+            } else {
+                ret = osal_fwupd_programmed(op);
+            }
+        }
+    }
+
+    if ((ret == 1) && !osal_fwupd.pending && osal_fwupd_parse()) {
+        ret = osal_fwupd_accept();
+        osal_fwupd.pending = (ret == 1);
+        osal_fwupd.frame_off = 0U;
+        ret = (ret == 0) ? 1 : ret;
+    }
+
+    if ((ret == 1) && (osal_fwupd.flash_op == FWUPD_FLASH_IDLE)) {
+        ret = osal_fwupd_flash_next();
+    }
+    osal_fwupd.stats.status = ret;
+    return ret;
+}
+
+void osal_fwupd_get_stats(osal_fwupd_stats_t *stats)
+{
+    *stats = osal_fwupd.stats;
+}
+
+#ifndef __linux__
+static IntCtrl_Ip_IrqHandlerType osal_fwupd_lpuart_next;
+
+// Write-one-to-clear flags of LPUART STAT; written as zero to leave them alone
+#define OSAL_FWUPD_STAT_W1C 0xC01FC000UL
+
+// Receive entry in front of the RTD LPUART6 handler: drain the receiver into the ring, then
+// let the driver handle transmission
+static void osal_fwupd_lpuart_entry(void)
+{
+    uint32_t stat = IP_LPUART_6->STAT;
+
+    while ((stat & LPUART_STAT_RDRF_MASK) != 0U) {
+        uint8_t b = (uint8_t)IP_LPUART_6->DATA;
+        osal_fwupd_receive(&b, 1U);
+        stat = IP_LPUART_6->STAT;
+    }
+    if ((stat & LPUART_STAT_OR_MASK) != 0U) {
+        osal_fwupd.stats.overruns++;
+        IP_LPUART_6->STAT = (stat & ~OSAL_FWUPD_STAT_W1C) | LPUART_STAT_OR_MASK;
+    }
+    osal_fwupd_lpuart_next();
+}
+
+static void osal_fwupd_uart_send(const uint8_t *data, uint32_t len)
+{
+    (void)Lpuart_Uart_Ip_SyncSend(LPUART_INSTANCE, data, len, 5000U);
+}
+
+int32_t osal_fwupd_run_uart(void)
+{
+    int32_t running = osal_slot_of((uint32_t)(uintptr_t)&app_metadata);
+    uint32_t idle_limit = OSAL_FWUPD_IDLE_TIMEOUT_MS * (uint32_t)(CORE_CLOCK_HZ / 1000UL);
+    uint32_t enter;
+    uint32_t last;
+    uint32_t seen = 0U;
+    int32_t ret;
+
+    if (running < 0) {
+        osal_log_info("FW update: not running from a slot\r\n");
+        return -2;
+    }
+    // A background erase of the key-value store would refuse the first erase of the slot
+    (void)osal_flash_wait();
+    osal_fwupd_begin((uint32_t)running ^ 1U, &osal_slot_flash, osal_fwupd_uart_send);
+    osal_utils_cycles_init();
+    enter = osal_utils_cycles();
+    last = enter;
+
+    IntCtrl_Ip_InstallHandler(LPUART6_IRQn, osal_fwupd_lpuart_entry, &osal_fwupd_lpuart_next);
+    IP_LPUART_6->CTRL |= LPUART_CTRL_RIE_MASK;
+    do {
+        uint32_t now = osal_utils_cycles();
+        ret = osal_fwupd_poll();
+        if (osal_fwupd.ring_head != seen) {
+            seen = osal_fwupd.ring_head;
+            last = now;
+        } else if ((ret == 1) && ((now - last) > idle_limit)) {
+            ret = osal_fwupd_finish(-6);
+        }
+    } while (ret == 1);
+    IP_LPUART_6->CTRL &= ~LPUART_CTRL_RIE_MASK;
+    IntCtrl_Ip_InstallHandler(LPUART6_IRQn, osal_fwupd_lpuart_next, NULL);
+
+    osal_fwupd.stats.cycles = osal_utils_cycles() - enter;
+    return ret;
+}
+
+void osal_fwupd_log(void)
+{
+    static const char *const results[] = {
+        "ok", "aborted", "bad start", "flash error", "image CRC mismatch", "verification failed", "timeout",
+        "bad patch"
+    };
+    const osal_fwupd_stats_t *s = &osal_fwupd.stats;
+    char log_buffer[LOG_BUFFER_SIZE];
+    uint32_t ms = osal_utils_cycles_to_us(s->cycles) / 1000U;
+    uint32_t index = (s->status < 0) ? (uint32_t)(-s->status) : 0U;
+
+    snprintf(log_buffer, LOG_BUFFER_SIZE,
+             "FW update slot %c: %s, %lu/%lu bytes in %lu ms (%lu B/s)\r\n", (int)('A' + s->slot),
+             (index < 8U) ? results[index] : "?", (unsigned long)s->bytes, (unsigned long)s->image_size,
+             (unsigned long)ms, (unsigned long)((ms > 0U) ? (((uint64_t)s->bytes * 1000U) / ms) : 0U));
+    osal_log_info(log_buffer);
+    if (s->stream_size != s->image_size) {
+        snprintf(log_buffer, LOG_BUFFER_SIZE, "  delta: %lu patch bytes (%lu%% of the image), applied in %lu us\r\n",
+                 (unsigned long)s->stream_size,
+                 (unsigned long)(((uint64_t)s->stream_size * 100U) / ((s->image_size > 0U) ? s->image_size : 1U)),
+                 (unsigned long)osal_utils_cycles_to_us(s->apply_cycles));
+        osal_log_info(log_buffer);
+    }
+    snprintf(log_buffer, LOG_BUFFER_SIZE,
+             "  frames %lu, CRC errors %lu, NAKs %lu, overruns %lu, erases %lu (%lu overlapped), page programs %lu\r\n",
+             (unsigned long)s->frames, (unsigned long)s->crc_errors, (unsigned long)s->naks,
+             (unsigned long)s->overruns, (unsigned long)s->erases, (unsigned long)s->erase_overlaps,
+             (unsigned long)s->programs);
+    osal_log_info(log_buffer);
+}
+#endif
@@ -0,0 +1,568 @@
+#include "osal_heap.h"
+#include "osal_log.h"
+#include "osal_ram.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef __linux__
+// Linker .heap section
+extern uint8_t _heap_start[], _heap_end[];
+#endif
+
+// Two-level segregated fit (TLSF). Free blocks are kept in lists indexed by size class: the
+// first level is the power of two of the size, the second level splits each power of two
+// into OSAL_HEAP_SL_COUNT linear steps. One bitmap bit per non-empty list lets malloc find a
+// big enough list with two count-leading-zeros instructions, so allocation and release take a
+// constant number of steps whatever the heap state.
+#define OSAL_HEAP_ALIGN_LOG2 3U
+#define OSAL_HEAP_SL_LOG2    3U
+#define OSAL_HEAP_SL_COUNT   (1U << OSAL_HEAP_SL_LOG2)
+#define OSAL_HEAP_FL_SHIFT   (OSAL_HEAP_SL_LOG2 + OSAL_HEAP_ALIGN_LOG2)
+#define OSAL_HEAP_SMALL      (1U << OSAL_HEAP_FL_SHIFT)      // Below this the classes are linear
+#define OSAL_HEAP_FL_MAX     17U                              // Blocks below 128 KB
+#define OSAL_HEAP_FL_COUNT   (OSAL_HEAP_FL_MAX - OSAL_HEAP_FL_SHIFT + 1U)
+#define OSAL_HEAP_BLOCK_MAX  ((1UL << OSAL_HEAP_FL_MAX) - OSAL_HEAP_ALIGN)
+
+// Block header. The payload follows the first two words; the free list links live in the
+// payload, so they cost nothing while the block is allocated.
+typedef struct osal_heap_block {
+    struct osal_heap_block *prev_phys;   // Physically previous block, NULL for the first one
+    uint32_t size;                       // Payload bytes | OSAL_HEAP_BLOCK_FREE
+    struct osal_heap_block *next_free;
+    struct osal_heap_block *prev_free;
+} osal_heap_block_t;
+
+// 8 bytes on the target; the host build (tools/host_test) has 64-bit pointers
+#define OSAL_HEAP_HEADER      ((uint32_t)(2U * sizeof(void *)))
+#define OSAL_HEAP_MIN_PAYLOAD ((uint32_t)(2U * sizeof(void *)))   // Room for the free list links
+#define OSAL_HEAP_BLOCK_FREE  1UL
+#define OSAL_HEAP_SIZE_MASK   (~(uint32_t)(OSAL_HEAP_ALIGN - 1U))
+
+_Static_assert(OSAL_HEAP_HEADER == offsetof(osal_heap_block_t, next_free), "payload follows the header");
+_Static_assert(OSAL_HEAP_HEADER + OSAL_HEAP_MIN_PAYLOAD == sizeof(osal_heap_block_t), "free links fit");
+_Static_assert((OSAL_HEAP_HEADER % OSAL_HEAP_ALIGN) == 0U, "payload alignment");
+
+typedef struct {
+    uint8_t *start;
+    uint8_t *end;                        // Address of the zero-size end marker block
+    uint32_t flags;
+    uint32_t fl_bitmap;
+    uint8_t sl_bitmap[OSAL_HEAP_FL_COUNT];
+    osal_heap_block_t *lists[OSAL_HEAP_FL_COUNT][OSAL_HEAP_SL_COUNT];
+    uint32_t used;
+    uint32_t used_peak;
+    uint32_t alloc_count;
+    uint32_t free;                       // Kept by the list insert/remove
+    uint32_t free_count;
+    uint32_t failures;
+} osal_heap_region_t;
+
+static osal_heap_region_t osal_heap_regions[OSAL_HEAP_MAX_REGIONS];
+static uint32_t osal_heap_region_count;
+static volatile bool osal_heap_ready;
+
+static inline uint32_t osal_heap_irq_save(void)
+{
+#ifdef __linux__
+    return 0U;
+#else
+    uint32_t primask;
+    __asm volatile ("mrs %0, primask\n cpsid i" : "=r" (primask) :: "memory");
+    return primask;
+#endif
+}
+
+static inline void osal_heap_irq_restore(uint32_t primask)
+{
+#ifdef __linux__
+    (void)primask;
+#else
+    __asm volatile ("msr primask, %0" :: "r" (primask) : "memory");
+#endif
+}
+
+// Index of the most / least significant set bit (x != 0)
+static inline uint32_t osal_heap_fls(uint32_t x)
+{
+    return 31U - (uint32_t)__builtin_clz(x);
+}
+
+static inline uint32_t osal_heap_ffs(uint32_t x)
+{
+    return (uint32_t)__builtin_ctz(x);
+}
+
+static inline uint32_t osal_heap_block_size(const osal_heap_block_t *b)
+{
+    return b->size & OSAL_HEAP_SIZE_MASK;
+}
+
+static inline bool osal_heap_block_is_free(const osal_heap_block_t *b)
+{
+    return (b->size & OSAL_HEAP_BLOCK_FREE) != 0U;
+}
+
+static inline void *osal_heap_block_ptr(osal_heap_block_t *b)
+{
+    return (uint8_t *)b + OSAL_HEAP_HEADER;
+}
+
+static inline osal_heap_block_t *osal_heap_ptr_block(const void *ptr)
+{
+    return (osal_heap_block_t *)((uint8_t *)ptr - OSAL_HEAP_HEADER);
+}
+
+static inline osal_heap_block_t *osal_heap_block_next(osal_heap_block_t *b)
+{
+    return (osal_heap_block_t *)((uint8_t *)b + OSAL_HEAP_HEADER + osal_heap_block_size(b));
+}
+
+// Size class of a block of exactly this size
+static void osal_heap_mapping(uint32_t size, uint32_t *fl, uint32_t *sl)
+{
+    if (size < OSAL_HEAP_SMALL) {
+        *fl = 0U;
+        *sl = size / (OSAL_HEAP_SMALL / OSAL_HEAP_SL_COUNT);
+    } else {
+        uint32_t msb = osal_heap_fls(size);
+        *sl = (size >> (msb - OSAL_HEAP_SL_LOG2)) ^ OSAL_HEAP_SL_COUNT;
+        *fl = msb - (OSAL_HEAP_FL_SHIFT - 1U);
+    }
+}
+
+// Size class whose every block is at least this size: round up to the next class first, so
+// the head of any list at or above it fits without walking the list
+static void osal_heap_mapping_search(uint32_t size, uint32_t *fl, uint32_t *sl)
+{
+    if (size >= OSAL_HEAP_SMALL) {
+        size += (1UL << (osal_heap_fls(size) - OSAL_HEAP_SL_LOG2)) - 1U;
+    }
+    osal_heap_mapping(size, fl, sl);
+}
+
+static void osal_heap_list_insert(osal_heap_region_t *r, osal_heap_block_t *b)
+{
+    uint32_t fl, sl;
+    osal_heap_mapping(osal_heap_block_size(b), &fl, &sl);
+
+    osal_heap_block_t *head = r->lists[fl][sl];
+    b->next_free = head;
+    b->prev_free = NULL;
+    if (head != NULL) {
+        head->prev_free = b;
+    }
+    r->lists[fl][sl] = b;
+    r->fl_bitmap |= 1UL << fl;
+    r->sl_bitmap[fl] |= (uint8_t)(1U << sl);
+    r->free += osal_heap_block_size(b) + OSAL_HEAP_HEADER;
+    r->free_count++;
+}
+
+static void osal_heap_list_remove(osal_heap_region_t *r, osal_heap_block_t *b)
+{
+    uint32_t fl, sl;
+    osal_heap_mapping(osal_heap_block_size(b), &fl, &sl);
+
+    if (b->prev_free != NULL) {
+        b->prev_free->next_free = b->next_free;
+    } else {
+        r->lists[fl][sl] = b->next_free;
+        if (b->next_free == NULL) {
+            r->sl_bitmap[fl] &= (uint8_t)~(1U << sl);
+            if (r->sl_bitmap[fl] == 0U) {
+                r->fl_bitmap &= ~(1UL << fl);
+            }
+        }
+    }
+    if (b->next_free != NULL) {
+        b->next_free->prev_free = b->prev_free;
+    }
+    r->free -= osal_heap_block_size(b) + OSAL_HEAP_HEADER;
+    r->free_count--;
+}
+
+// Head of the first non-empty list at or above (fl, sl)
+static osal_heap_block_t *osal_heap_find(const osal_heap_region_t *r, uint32_t fl, uint32_t sl)
+{
+    if (fl >= OSAL_HEAP_FL_COUNT) {
+        return NULL;
+    }
+    uint32_t sl_map = r->sl_bitmap[fl] & (~0UL << sl);
+    if (sl_map == 0U) {
+        uint32_t fl_map = (fl + 1U < 32U) ? (r->fl_bitmap & (~0UL << (fl + 1U))) : 0U;
+        if (fl_map == 0U) {
+            return NULL;
+        }
+        fl = osal_heap_ffs(fl_map);
+        sl_map = r->sl_bitmap[fl];
+    }
+    return r->lists[fl][osal_heap_ffs(sl_map)];
+}
+
+// Cut the tail of a block into a new free block if it is big enough to hold one
+static void osal_heap_split(osal_heap_region_t *r, osal_heap_block_t *b, uint32_t size)
+{
+    uint32_t total = osal_heap_block_size(b);
+    if (total < size + OSAL_HEAP_HEADER + OSAL_HEAP_MIN_PAYLOAD) {
+        return;
+    }
+
+    osal_heap_block_t *rest = (osal_heap_block_t *)((uint8_t *)b + OSAL_HEAP_HEADER + size);
+    rest->prev_phys = b;
+    rest->size = (total - size - OSAL_HEAP_HEADER) | OSAL_HEAP_BLOCK_FREE;
+    b->size = size | (b->size & OSAL_HEAP_BLOCK_FREE);
+
+    osal_heap_block_t *next = osal_heap_block_next(rest);
+    if (osal_heap_block_is_free(next)) {
+        // Only on realloc shrink: keep free blocks coalesced
+        osal_heap_list_remove(r, next);
+        rest->size += OSAL_HEAP_HEADER + osal_heap_block_size(next);
+        next = osal_heap_block_next(rest);
+    }
+    next->prev_phys = rest;
+    osal_heap_list_insert(r, rest);
+}
+
+static uint32_t osal_heap_adjust(size_t size)
+{
+    if (size > OSAL_HEAP_BLOCK_MAX) {
+        return 0U;
+    }
+    uint32_t adjusted = ((uint32_t)size + OSAL_HEAP_ALIGN - 1U) & OSAL_HEAP_SIZE_MASK;
+    return (adjusted < OSAL_HEAP_MIN_PAYLOAD) ? OSAL_HEAP_MIN_PAYLOAD : adjusted;
+}
+
+static osal_heap_region_t *osal_heap_region_of(const void *ptr)
+{
+    for (uint32_t i = 0U; i < osal_heap_region_count; i++) {
+        osal_heap_region_t *r = &osal_heap_regions[i];
+        if (((const uint8_t *)ptr >= r->start) && ((const uint8_t *)ptr < r->end)) {
+            return r;
+        }
+    }
+    return NULL;
+}
+
+static void osal_heap_account(osal_heap_region_t *r, int32_t bytes, int32_t blocks)
+{
+    r->used = (uint32_t)((int32_t)r->used + bytes);
+    r->alloc_count = (uint32_t)((int32_t)r->alloc_count + blocks);
+    if (r->used > r->used_peak) {
+        r->used_peak = r->used;
+    }
+}
+
+int32_t osal_heap_add_region(void *start, size_t size, uint32_t flags)
+{
+    if ((flags == 0U) || ((flags & (flags - 1U)) != 0U) ||
+        ((flags & ~(OSAL_HEAP_SRAM | OSAL_HEAP_DTCM | OSAL_HEAP_NC)) != 0U)) {
+        return -1;
+    }
+
+    uintptr_t first = ((uintptr_t)start + OSAL_HEAP_ALIGN - 1U) & ~(uintptr_t)(OSAL_HEAP_ALIGN - 1U);
+    uintptr_t last = ((uintptr_t)start + size) & ~(uintptr_t)(OSAL_HEAP_ALIGN - 1U);
+    if ((last <= first) || ((last - first) < (2U * OSAL_HEAP_HEADER + OSAL_HEAP_MIN_PAYLOAD))) {
+        return -2;
+    }
+    if ((last - first) > (OSAL_HEAP_BLOCK_MAX + 2U * OSAL_HEAP_HEADER)) {
+        last = first + OSAL_HEAP_BLOCK_MAX + 2U * OSAL_HEAP_HEADER;
+    }
+
+    uint32_t primask = osal_heap_irq_save();
+    if (osal_heap_region_count >= OSAL_HEAP_MAX_REGIONS) {
+        osal_heap_irq_restore(primask);
+        return -3;
+    }
+    osal_heap_region_t *r = &osal_heap_regions[osal_heap_region_count];
+    memset(r, 0, sizeof(*r));
+    r->start = (uint8_t *)first;
+    r->end = (uint8_t *)(last - OSAL_HEAP_HEADER);
+    r->flags = flags;
+
+    // One free block over the whole region, then an allocated zero-size block that stops
+    // merging at the end
+    osal_heap_block_t *b = (osal_heap_block_t *)first;
+    b->prev_phys = NULL;
+    b->size = (uint32_t)(last - first - 2U * OSAL_HEAP_HEADER) | OSAL_HEAP_BLOCK_FREE;
+    osal_heap_block_t *end = (osal_heap_block_t *)r->end;
+    end->prev_phys = b;
+    end->size = 0U;
+    osal_heap_list_insert(r, b);
+
+    osal_heap_region_count++;
+    osal_heap_irq_restore(primask);
+    return 0;
+}
+
+void osal_heap_init(void)
+{
+    uint32_t primask = osal_heap_irq_save();
+    bool done = osal_heap_ready;
+    osal_heap_ready = true;
+    osal_heap_irq_restore(primask);
+    if (done) {
+        return;
+    }
+#ifndef __linux__
+    void *start;
+    size_t size;
+    uint8_t *heap_start = _heap_start;
+    size_t heap_size = (size_t)(_heap_end - _heap_start);
+
+    // The spare SRAM directly follows .heap in the flash layout: make it one region
+    if (osal_ram_pool_get(OSAL_RAM_POOL_SRAM, &start, &size) == 0) {
+        uint8_t *heap_end = (uint8_t *)(((uintptr_t)_heap_end + 7U) & ~(uintptr_t)7U);
+        if ((uint8_t *)start == heap_end) {
+            heap_size = (size_t)(heap_end - heap_start) + size;
+        } else {
+            (void)osal_heap_add_region(start, size, OSAL_HEAP_SRAM);
+        }
+    }
+    (void)osal_heap_add_region(heap_start, heap_size, OSAL_HEAP_SRAM);
+    if (osal_ram_pool_get(OSAL_RAM_POOL_DTCM, &start, &size) == 0) {
+        (void)osal_heap_add_region(start, size, OSAL_HEAP_DTCM);
+    }
+    if (osal_ram_pool_get(OSAL_RAM_POOL_SRAM_NC, &start, &size) == 0) {
+        (void)osal_heap_add_region(start, size, OSAL_HEAP_NC);
+    }
+#endif
+}
+
+static void *osal_heap_alloc_from(osal_heap_region_t *r, uint32_t size)
+{
+    uint32_t fl, sl;
+    osal_heap_mapping_search(size, &fl, &sl);
+
+    osal_heap_block_t *b = osal_heap_find(r, fl, sl);
+    if (b == NULL) {
+        r->failures++;
+        return NULL;
+    }
+    osal_heap_list_remove(r, b);
+    osal_heap_split(r, b, size);
+    b->size &= ~OSAL_HEAP_BLOCK_FREE;
+    osal_heap_account(r, (int32_t)(osal_heap_block_size(b) + OSAL_HEAP_HEADER), 1);
+    return osal_heap_block_ptr(b);
+}
+
+void *osal_heap_alloc(size_t size, uint32_t flags)
+{
+    if (!osal_heap_ready) {
+        osal_heap_init();
+    }
+    uint32_t adjusted = osal_heap_adjust(size);
+    if (adjusted == 0U) {
+        return NULL;
+    }
+
+    void *ptr = NULL;
+    uint32_t primask = osal_heap_irq_save();
+    for (uint32_t i = 0U; (i < osal_heap_region_count) && (ptr == NULL); i++) {
+        if ((osal_heap_regions[i].flags & flags) != 0U) {
+            ptr = osal_heap_alloc_from(&osal_heap_regions[i], adjusted);
+        }
+    }
+    osal_heap_irq_restore(primask);
+    return ptr;
+}
+
+void osal_heap_free(void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    osal_heap_region_t *r = osal_heap_region_of(ptr);
+    if (r == NULL) {
+        return;
+    }
+
+    uint32_t primask = osal_heap_irq_save();
+    osal_heap_block_t *b = osal_heap_ptr_block(ptr);
+    osal_heap_account(r, -(int32_t)(osal_heap_block_size(b) + OSAL_HEAP_HEADER), -1);
+    b->size |= OSAL_HEAP_BLOCK_FREE;
+
+    osal_heap_block_t *prev = b->prev_phys;
+    if ((prev != NULL) && osal_heap_block_is_free(prev)) {
+        osal_heap_list_remove(r, prev);
+        prev->size += OSAL_HEAP_HEADER + osal_heap_block_size(b);
+        b = prev;
+    }
+    osal_heap_block_t *next = osal_heap_block_next(b);
+    if (osal_heap_block_is_free(next)) {
+        osal_heap_list_remove(r, next);
+        b->size += OSAL_HEAP_HEADER + osal_heap_block_size(next);
+        next = osal_heap_block_next(b);
+    }
+    next->prev_phys = b;
+    osal_heap_list_insert(r, b);
+    osal_heap_irq_restore(primask);
+}
+
+void *osal_heap_realloc(void *ptr, size_t size)
+{
+    if (ptr == NULL) {
+        return osal_heap_alloc(size, OSAL_HEAP_DEFAULT);
+    }
+    if (size == 0U) {
+        osal_heap_free(ptr);
+        return NULL;
+    }
+    osal_heap_region_t *r = osal_heap_region_of(ptr);
+    uint32_t adjusted = osal_heap_adjust(size);
+    if ((r == NULL) || (adjusted == 0U)) {
+        return NULL;
+    }
+
+    uint32_t primask = osal_heap_irq_save();
+    osal_heap_block_t *b = osal_heap_ptr_block(ptr);
+    uint32_t old = osal_heap_block_size(b);
+    osal_heap_block_t *next = osal_heap_block_next(b);
+
+    if ((adjusted > old) && osal_heap_block_is_free(next) &&
+        ((old + OSAL_HEAP_HEADER + osal_heap_block_size(next)) >= adjusted)) {
+        // Grow into the free neighbour
+        osal_heap_list_remove(r, next);
+        b->size += OSAL_HEAP_HEADER + osal_heap_block_size(next);
+        osal_heap_block_next(b)->prev_phys = b;
+    }
+    if (adjusted <= osal_heap_block_size(b)) {
+        osal_heap_split(r, b, adjusted);
+        osal_heap_account(r, (int32_t)osal_heap_block_size(b) - (int32_t)old, 0);
+        osal_heap_irq_restore(primask);
+        return ptr;
+    }
+    osal_heap_irq_restore(primask);
+
+    void *moved = osal_heap_alloc(size, r->flags);
+    if (moved != NULL) {
+        memcpy(moved, ptr, old);
+        osal_heap_free(ptr);
+    }
+    return moved;
+}
+
+size_t osal_heap_usable_size(const void *ptr)
+{
+    return (ptr != NULL) ? osal_heap_block_size(osal_heap_ptr_block(ptr)) : 0U;
+}
+
+// Smallest block size of a class: every request up to it maps to this class or below
+static uint32_t osal_heap_class_floor(uint32_t fl, uint32_t sl)
+{
+    if (fl == 0U) {
+        return sl * (OSAL_HEAP_SMALL / OSAL_HEAP_SL_COUNT);
+    }
+    uint32_t msb = fl + OSAL_HEAP_FL_SHIFT - 1U;
+    return (1UL << msb) + (sl << (msb - OSAL_HEAP_SL_LOG2));
+}
+
+int32_t osal_heap_get_stats(uint32_t region, osal_heap_stats_t *stats)
+{
+    if (region >= osal_heap_region_count) {
+        return -1;
+    }
+    const osal_heap_region_t *r = &osal_heap_regions[region];
+
+    uint32_t primask = osal_heap_irq_save();
+    memset(stats, 0, sizeof(*stats));
+    stats->start = (uint32_t)(uintptr_t)r->start;
+    stats->size = (uint32_t)(r->end - r->start) + OSAL_HEAP_HEADER;
+    stats->flags = r->flags;
+    stats->used = r->used;
+    stats->used_peak = r->used_peak;
+    stats->alloc_count = r->alloc_count;
+    stats->free = r->free;
+    stats->free_count = r->free_count;
+    stats->failures = r->failures;
+    if (r->fl_bitmap != 0U) {
+        uint32_t fl = osal_heap_fls(r->fl_bitmap);
+        stats->largest_free = osal_heap_class_floor(fl, osal_heap_fls(r->sl_bitmap[fl]));
+    }
+    osal_heap_irq_restore(primask);
+
+    if (stats->free != 0U) {
+        stats->fragmentation = 100U - (uint32_t)(((uint64_t)(stats->largest_free + OSAL_HEAP_HEADER) * 100U) /
+                                                  stats->free);
+    }
+    return 0;
+}
+
+void osal_heap_log(void)
+{
+    char log_buffer[LOG_BUFFER_SIZE];
+    osal_heap_stats_t stats;
+
+    if (!osal_heap_ready) {
+        osal_heap_init();
+    }
+    for (uint32_t i = 0U; osal_heap_get_stats(i, &stats) == 0; i++) {
+        const char *kind = (stats.flags == OSAL_HEAP_SRAM) ? "sram" : ((stats.flags == OSAL_HEAP_DTCM) ? "dtcm" : "nc");
+        snprintf(log_buffer, LOG_BUFFER_SIZE,
+                 "Heap %-4s 0x%08lx %6lu bytes: used %lu (peak %lu) in %lu, free %lu in %lu, largest %lu, frag %lu%%, failed %lu\r\n",
+                 kind, (unsigned long)stats.start, (unsigned long)stats.size, (unsigned long)stats.used,
+                 (unsigned long)stats.used_peak, (unsigned long)stats.alloc_count, (unsigned long)stats.free,
+                 (unsigned long)stats.free_count, (unsigned long)stats.largest_free,
+                 (unsigned long)stats.fragmentation, (unsigned long)stats.failures);
+        osal_log_info(log_buffer);
+    }
+}
+
+#if !defined(OSAL_HEAP_NO_LIBC) && !defined(__linux__)
+// Replace the newlib allocator (and its _sbrk growth of .heap) for the application, newlib
+// internals (stdio buffers) and mbedtls alike. Both the plain and the reentrant entry points
+// are defined so no object of the newlib malloc is pulled from libc.a.
+struct _reent;
+
+void *malloc(size_t size)
+{
+    return osal_heap_alloc(size, OSAL_HEAP_DEFAULT);
+}
+
+void free(void *ptr)
+{
+    osal_heap_free(ptr);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    if ((size != 0U) && (count > (SIZE_MAX / size))) {
+        return NULL;
+    }
+    void *ptr = osal_heap_alloc(count * size, OSAL_HEAP_DEFAULT);
+    if (ptr != NULL) {
+        memset(ptr, 0, count * size);
+    }
+    return ptr;
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    return osal_heap_realloc(ptr, size);
+}
+
+void *_malloc_r(struct _reent *reent, size_t size)
+{
+    (void)reent;
+    return malloc(size);
+}
+
+void _free_r(struct _reent *reent, void *ptr)
+{
+    (void)reent;
+    free(ptr);
+}
+
+void *_calloc_r(struct _reent *reent, size_t count, size_t size)
+{
+    (void)reent;
+    return calloc(count, size);
+}
+
+void *_realloc_r(struct _reent *reent, void *ptr, size_t size)
+{
+    (void)reent;
+    return realloc(ptr, size);
+}
+#endif /* !OSAL_HEAP_NO_LIBC && !__linux__ */
@@ -0,0 +1,63 @@
+#include "osal_image.h"
+#include "osal_crc32.h"
+#include "osal_log.h"
+#include "osal_utils.h"
+#include <stdio.h>
+
+int32_t osal_image_verify(const app_metadata_t *meta, osal_image_check_t *check)
+{
+    osal_image_check_t result = { 0 };
+
+    if (meta->magic != APP_METADATA_MAGIC) {
+        result.status = -1;
+    } else if ((meta->image_size == 0U) || (meta->flash_start_addr < OSAL_IMAGE_PFLASH_START) ||
+               (meta->image_size > (OSAL_IMAGE_PFLASH_END - meta->flash_start_addr))) {
+        result.status = -2;
+    } else if (meta->crc32 == 0U) {
+        result.status = -3;
+    } else {
+        uintptr_t start = meta->flash_start_addr;
+        uintptr_t end = start + meta->image_size;
+        uintptr_t meta_start = (uintptr_t)meta;
+        uintptr_t meta_end = meta_start + sizeof(*meta);
+
+        osal_utils_cycles_init();
+        uint32_t enter = osal_utils_cycles();
+        uint32_t crc = 0U;
+        if ((meta_end <= start) || (meta_start >= end)) {
+            crc = osal_crc32_update(crc, (const void *)start, end - start);
+        } else {
+            // Metadata inside the range: CRC the parts before and after it
+            if (meta_start > start) {
+                crc = osal_crc32_update(crc, (const void *)start, meta_start - start);
+            }
+            if (meta_end < end) {
+                crc = osal_crc32_update(crc, (const void *)meta_end, end - meta_end);
+            }
+        }
+        result.cycles = osal_utils_cycles() - enter;
+        result.crc = crc;
+        result.bytes = meta->image_size;
+        result.status = (crc == meta->crc32) ? 0 : -4;
+    }
+
+    if (check != NULL) {
+        *check = result;
+    }
+    return result.status;
+}
+
+void osal_image_log(const app_metadata_t *meta, const osal_image_check_t *check)
+{
+    static const char *const results[] = { "ok", "bad magic", "bad range", "not stamped", "CRC mismatch" };
+    char log_buffer[LOG_BUFFER_SIZE];
+    uint32_t index = (check->status < 0) ? (uint32_t)(-check->status) : 0U;
+
+    snprintf(log_buffer, LOG_BUFFER_SIZE,
+             "Image %.16s %.12s 0x%08lx+%lu: %s, CRC 0x%08lx (stamped 0x%08lx) in %lu us\r\n",
+             meta->app_name, meta->version, (unsigned long)meta->flash_start_addr,
+             (unsigned long)meta->image_size, (index < 5U) ? results[index] : "?",
+             (unsigned long)check->crc, (unsigned long)meta->crc32,
+             (unsigned long)osal_utils_cycles_to_us(check->cycles));
+    osal_log_info(log_buffer);
+}
@@ -0,0 +1,157 @@
+#include "osal_irq_lat.h"
+#include "osal_log.h"
+#include "osal_utils.h"
+#include "led_pwm.h"
+#include "IntCtrl_Ip.h"
+#include "S32K312_PIT.h"
+#include <stdio.h>
+#include <string.h>
+
+// NVIC software trigger interrupt register and instruction cache invalidate-all
+#define NVIC_STIR    (*(volatile uint32_t *)0xE000EF00UL)
+#define SCB_ICIALLU  (*(volatile uint32_t *)0xE000EF50UL)
+
+#define OSAL_IRQ_LAT_PIT_CYCLES_PER_TICK (CORE_CLOCK_HZ / OSAL_IRQ_LAT_PIT_CLOCK_HZ)
+// Give up on a round if the interrupt is disabled or masked
+#define OSAL_IRQ_LAT_TIMEOUT 100000UL
+
+static const IRQn_Type osal_irq_lat_irqs[OSAL_IRQ_LAT_COUNT] = { PIT0_IRQn, LPUART6_IRQn };
+
+static IntCtrl_Ip_IrqHandlerType osal_irq_lat_next[OSAL_IRQ_LAT_COUNT];
+static osal_irq_lat_report_t osal_irq_lat_reports[OSAL_IRQ_LAT_COUNT];
+static volatile bool osal_irq_lat_armed; // A software trigger is in flight
+static volatile uint32_t osal_irq_lat_trigger;
+static volatile uint32_t osal_irq_lat_entry;
+
+static void osal_irq_lat_add(osal_irq_lat_stats_t *s, uint32_t cycles)
+{
+    if ((s->count == 0U) || (cycles < s->min)) {
+        s->min = cycles;
+    }
+    if (cycles > s->max) {
+        s->max = cycles;
+    }
+    s->sum += cycles;
+    s->count++;
+}
+
+// Entry stubs: the timestamp is the first thing they do. They live in .text.osal_irq_lat_*
+// so the TCM option (osal_fast_isr.ld) places them together with the driver handlers.
+static void osal_irq_lat_pit0_entry(void)
+{
+    uint32_t now = osal_utils_cycles();
+
+    if (osal_irq_lat_armed) {
+        osal_irq_lat_entry = now;
+    } else if ((IP_PIT_0->TIMER[0].TFLG & PIT_TFLG_TIF_MASK) == 0U) {
+        // Not a channel 0 expiry
+    } else if ((IP_PIT_0->TIMER[LED_PWM_PIT_CHANNEL].TCTRL & PIT_TCTRL_TIE_MASK) != 0U) {
+        // The PWM channel raises the same interrupt: the expiry may have waited for its handler
+        osal_irq_lat_reports[OSAL_IRQ_LAT_PIT0].hw_shared++;
+    } else {
+        // The counter reloaded when the request was raised: its progress since is the latency
+        uint32_t ticks = IP_PIT_0->TIMER[0].LDVAL - IP_PIT_0->TIMER[0].CVAL;
+        osal_irq_lat_add(&osal_irq_lat_reports[OSAL_IRQ_LAT_PIT0].hw, ticks * OSAL_IRQ_LAT_PIT_CYCLES_PER_TICK);
+    }
+    osal_irq_lat_next[OSAL_IRQ_LAT_PIT0]();
+}
+
+static void osal_irq_lat_lpuart6_entry(void)
+{
+    uint32_t now = osal_utils_cycles();
+
+    if (osal_irq_lat_armed) {
+        osal_irq_lat_entry = now;
+    }
+    osal_irq_lat_next[OSAL_IRQ_LAT_LPUART6]();
+}
+
+void osal_irq_lat_init(void)
+{
+    static const IntCtrl_Ip_IrqHandlerType entries[OSAL_IRQ_LAT_COUNT] = {
+        osal_irq_lat_pit0_entry, osal_irq_lat_lpuart6_entry
+    };
+
+    memset(osal_irq_lat_reports, 0, sizeof(osal_irq_lat_reports));
+    for (uint32_t i = 0U; i < (uint32_t)OSAL_IRQ_LAT_COUNT; i++) {
+        IntCtrl_Ip_InstallHandler(osal_irq_lat_irqs[i], entries[i], &osal_irq_lat_next[i]);
+        osal_irq_lat_reports[i].handler = (uint32_t)entries[i] & ~1UL;
+    }
+}
+
+static void osal_irq_lat_run(osal_irq_lat_source_t source, osal_irq_lat_stats_t *stats, bool cold)
+{
+    for (uint32_t i = 0U; i < OSAL_IRQ_LAT_ROUNDS; i++) {
+        osal_irq_lat_entry = 0U;
+        osal_irq_lat_armed = true;
+        if (cold) {
+            SCB_ICIALLU = 0U;
+            __asm volatile ("dsb\n isb" ::: "memory");
+        }
+        osal_irq_lat_trigger = osal_utils_cycles();
+        NVIC_STIR = (uint32_t)osal_irq_lat_irqs[source];
+        __asm volatile ("dsb\n isb" ::: "memory");
+        // Taken within a few cycles unless a higher priority interrupt is running
+        while ((osal_irq_lat_entry == 0U) && ((osal_utils_cycles() - osal_irq_lat_trigger) < OSAL_IRQ_LAT_TIMEOUT)) {
+        }
+        osal_irq_lat_armed = false;
+        if (osal_irq_lat_entry != 0U) {
+            osal_irq_lat_add(stats, osal_irq_lat_entry - osal_irq_lat_trigger);
+        }
+    }
+}
+
+void osal_irq_lat_measure(void)
+{
+    // Keep the PWM slices out of the PIT0 rounds; a slice that ends meanwhile is taken on restore
+    volatile uint32_t *pwm_tctrl = &IP_PIT_0->TIMER[LED_PWM_PIT_CHANNEL].TCTRL;
+    uint32_t pwm_tie = *pwm_tctrl & PIT_TCTRL_TIE_MASK;
+
+    *pwm_tctrl &= ~PIT_TCTRL_TIE_MASK;
+    for (uint32_t i = 0U; i < (uint32_t)OSAL_IRQ_LAT_COUNT; i++) {
+        osal_irq_lat_report_t *r = &osal_irq_lat_reports[i];
+        memset(&r->warm, 0, sizeof(r->warm));
+        memset(&r->cold, 0, sizeof(r->cold));
+        osal_irq_lat_run((osal_irq_lat_source_t)i, &r->warm, false);
+        osal_irq_lat_run((osal_irq_lat_source_t)i, &r->cold, true);
+    }
+    *pwm_tctrl |= pwm_tie;
+}
+
+void osal_irq_lat_get(osal_irq_lat_source_t source, osal_irq_lat_report_t *report)
+{
+    if ((uint32_t)source < (uint32_t)OSAL_IRQ_LAT_COUNT) {
+        *report = osal_irq_lat_reports[source];
+    }
+}
+
+static int osal_irq_lat_format(char *buf, size_t size, const char *what, const osal_irq_lat_stats_t *s)
+{
+    if (s->count == 0U) {
+        return snprintf(buf, size, " %s -", what);
+    }
+    return snprintf(buf, size, " %s %lu/%lu/%lu", what, (unsigned long)s->min,
+                    (unsigned long)(s->sum / s->count), (unsigned long)s->max);
+}
+
+void osal_irq_lat_log(void)
+{
+    static const char *const names[OSAL_IRQ_LAT_COUNT] = { "PIT0", "LPUART6" };
+    char log_buffer[LOG_BUFFER_SIZE];
+
+    osal_log_info("IRQ entry latency in cycles, min/avg/max:\r\n");
+    for (uint32_t i = 0U; i < (uint32_t)OSAL_IRQ_LAT_COUNT; i++) {
+        const osal_irq_lat_report_t *r = &osal_irq_lat_reports[i];
+        int n = snprintf(log_buffer, LOG_BUFFER_SIZE, "IRQ %-7s %-5s", names[i],
+                         (r->handler < 0x8000UL) ? "ITCM" : "flash");
+        n += osal_irq_lat_format(&log_buffer[n], LOG_BUFFER_SIZE - (size_t)n, "warm", &r->warm);
+        n += osal_irq_lat_format(&log_buffer[n], LOG_BUFFER_SIZE - (size_t)n, "cold", &r->cold);
+        if (i == (uint32_t)OSAL_IRQ_LAT_PIT0) {
+            n += osal_irq_lat_format(&log_buffer[n], LOG_BUFFER_SIZE - (size_t)n, "timer", &r->hw);
+            n += snprintf(&log_buffer[n], LOG_BUFFER_SIZE - (size_t)n, " (%lu shared with PWM)",
+                          (unsigned long)r->hw_shared);
+        }
+        snprintf(&log_buffer[n], LOG_BUFFER_SIZE - (size_t)n, "\r\n");
+        osal_log_info(log_buffer);
+    }
+}
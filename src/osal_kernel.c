@@ -0,0 +1,440 @@
+#include "osal_kernel.h"
+#include "osal_log.h"
+#include "osal_stack.h"
+#include "osal_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+// Cortex-M7 system control registers
+#define SCB_ICSR          (*(volatile uint32_t *)0xE000ED04UL)
+#define SCB_SHPR3         (*(volatile uint32_t *)0xE000ED20UL)
+#define FPU_FPCCR         (*(volatile uint32_t *)0xE000EF34UL)
+#define SYST_CSR          (*(volatile uint32_t *)0xE000E010UL)
+#define SYST_RVR          (*(volatile uint32_t *)0xE000E014UL)
+#define SYST_CVR          (*(volatile uint32_t *)0xE000E018UL)
+
+#define SCB_ICSR_PENDSVSET   (1UL << 28)
+#define FPU_FPCCR_ASPEN      (1UL << 31)
+#define FPU_FPCCR_LSPEN      (1UL << 30)
+#define SYST_CSR_ENABLE      (1UL << 0)
+#define SYST_CSR_TICKINT     (1UL << 1)
+#define SYST_CSR_CLKSOURCE   (1UL << 2)
+
+// S32K3 implements 4 priority bits: PendSV lowest, SysTick just above it
+#define PENDSV_PRIORITY   0xF0UL
+#define SYSTICK_PRIORITY  0xE0UL
+
+// Initial frame: software-saved r4-r11 + EXC_RETURN, then the hardware frame
+#define TASK_SW_FRAME_WORDS 9U
+#define TASK_HW_FRAME_WORDS 8U
+#define TASK_EXC_RETURN     0xFFFFFFFDUL  // Thread mode, PSP, no FP context
+#define TASK_INITIAL_XPSR   0x01000000UL  // Thumb bit
+
+// PendSV needs somewhere to save the boot context when the first task starts
+#define BOOT_FRAME_WORDS 32U
+
+// Task stacks live in int_dtcm (.bss_tcm_data, not zeroed by the startup code)
+static uint64_t osal_kernel_stack_pool[OSAL_KERNEL_STACK_POOL_SIZE / 8U]
+    __attribute__((section(".dtcm_bss"), aligned(OSAL_STACK_GUARD_SIZE)));
+static size_t osal_kernel_stack_used;
+
+static uint32_t osal_kernel_boot_frame[BOOT_FRAME_WORDS];
+
+static osal_task_t *osal_kernel_ready_table[OSAL_KERNEL_PRIO_COUNT] OSAL_FAST_DATA;
+static volatile uint32_t osal_kernel_ready_bitmap OSAL_FAST_DATA;
+static volatile uint32_t osal_kernel_delayed_bitmap OSAL_FAST_DATA;
+static osal_task_t * volatile osal_kernel_current_task OSAL_FAST_DATA;
+static volatile uint32_t osal_kernel_tick OSAL_FAST_DATA;
+static osal_task_t osal_kernel_idle_task;
+
+static osal_kernel_stats_t osal_kernel_stats;
+static uint32_t osal_kernel_switch_entry_cycles;
+static uint8_t osal_kernel_switch_timed;
+
+// Shared with the PendSV assembly, hence not static
+uint32_t *osal_kernel_switch(uint32_t *sp, uint32_t entry_cycles);
+volatile uint32_t osal_kernel_switch_exit_cycles;
+
+static inline uint32_t osal_kernel_irq_save(void)
+{
+    uint32_t primask;
+    __asm volatile ("mrs %0, primask \n cpsid i" : "=r" (primask) :: "memory");
+    return primask;
+}
+
+static inline void osal_kernel_irq_restore(uint32_t primask)
+{
+    __asm volatile ("msr primask, %0" :: "r" (primask) : "memory");
+}
+
+static inline void osal_kernel_pend_switch(void)
+{
+    SCB_ICSR = SCB_ICSR_PENDSVSET;
+}
+
+// O(1) selection: the highest set bit of the ready bitmap is the highest ready priority
+static inline uint8_t osal_kernel_highest_ready(void)
+{
+    // The idle task is always ready, so the bitmap is never zero
+    return (uint8_t)(31U - (uint32_t)__builtin_clz(osal_kernel_ready_bitmap));
+}
+
+OSAL_FAST_CODE static void osal_kernel_update_minmax(uint32_t value, uint32_t *min, uint32_t *max, uint32_t count)
+{
+    if ((count == 0U) || (value < *min)) {
+        *min = value;
+    }
+    if (value > *max) {
+        *max = value;
+    }
+}
+
+// Caller holds the interrupt lock
+OSAL_FAST_CODE static void osal_kernel_make_ready(osal_task_t *task)
+{
+    uint32_t bit = 1UL << task->prio;
+
+    if (task->state == (uint8_t)OSAL_TASK_READY) {
+        return;
+    }
+    task->state = (uint8_t)OSAL_TASK_READY;
+    osal_kernel_delayed_bitmap &= ~bit;
+    osal_kernel_ready_bitmap |= bit;
+
+    osal_task_t *current = osal_kernel_current_task;
+    if ((current != NULL) && (task->prio > current->prio)) {
+        osal_kernel_pend_switch();
+    }
+}
+
+static void osal_kernel_task_exit(void)
+{
+    uint32_t primask = osal_kernel_irq_save();
+    osal_task_t *task = osal_kernel_current_task;
+    task->state = (uint8_t)OSAL_TASK_DORMANT;
+    osal_kernel_ready_bitmap &= ~(1UL << task->prio);
+    osal_kernel_pend_switch();
+    osal_kernel_irq_restore(primask);
+
+    while (1) {
+        ; // Not reached: the task is never scheduled again
+    }
+}
+
+static void osal_kernel_idle(void *arg)
+{
+    (void)arg;
+    while (1) {
+        __asm volatile ("wfi");
+    }
+}
+
+/**
+ * Called from PendSV with the outgoing task's stack pointer (r4-r11, EXC_RETURN and,
+ * if used, s16-s31 already pushed). Returns the stack pointer of the task to resume.
+ */
+OSAL_FAST_CODE uint32_t *osal_kernel_switch(uint32_t *sp, uint32_t entry_cycles)
+{
+    // The exit timestamp of the previous switch is known now
+    if (osal_kernel_switch_timed != 0U) {
+        uint32_t cycles = osal_kernel_switch_exit_cycles - osal_kernel_switch_entry_cycles;
+        osal_kernel_update_minmax(cycles, &osal_kernel_stats.switch_cycles_min,
+                                  &osal_kernel_stats.switch_cycles_max, osal_kernel_stats.switch_count);
+        osal_kernel_stats.switch_cycles_last = cycles;
+        osal_kernel_stats.switch_count++;
+    }
+    osal_kernel_switch_entry_cycles = entry_cycles;
+    osal_kernel_switch_timed = 1U;
+
+    if (osal_kernel_current_task != NULL) {
+        osal_kernel_current_task->sp = sp;
+    }
+    osal_kernel_current_task = osal_kernel_ready_table[osal_kernel_highest_ready()];
+    osal_mpu_load_task_region(osal_kernel_current_task->mpu_region);
+    return osal_kernel_current_task->sp;
+}
+
+/**
+ * PendSV context switch. Runs at the lowest priority, so it always tail-chains after the
+ * interrupt that requested it. The FPU callee-saved registers are only stacked when the
+ * outgoing task has an active FP context (EXC_RETURN bit 4 clear); with LSPEN set the
+ * hardware defers s0-s15 until the vstmdb actually touches the FPU.
+ */
+OSAL_FAST_CODE __attribute__((naked)) void PendSV_Handler(void)
+{
+    __asm volatile (
+        "ldr     r3, =0xE0001004          \n" // DWT_CYCCNT
+        "ldr     r1, [r3]                 \n" // r1 = entry timestamp
+        "mrs     r0, psp                  \n"
+        "tst     lr, #0x10                \n"
+        "it      eq                       \n"
+        "vstmdbeq r0!, {s16-s31}          \n"
+        "stmdb   r0!, {r4-r11, lr}        \n"
+        "bl      osal_kernel_switch       \n" // r0 = stack pointer of the next task
+        "ldmia   r0!, {r4-r11, lr}        \n"
+        "tst     lr, #0x10                \n"
+        "it      eq                       \n"
+        "vldmiaeq r0!, {s16-s31}          \n"
+        "msr     psp, r0                  \n"
+        "ldr     r3, =0xE0001004          \n"
+        "ldr     r2, [r3]                 \n"
+        "ldr     r3, =osal_kernel_switch_exit_cycles \n"
+        "str     r2, [r3]                 \n"
+        "bx      lr                       \n"
+        ".ltorg                           \n"
+    );
+}
+
+OSAL_FAST_CODE void SysTick_Handler(void)
+{
+    uint32_t primask = osal_kernel_irq_save();
+    uint32_t tick = ++osal_kernel_tick;
+    uint32_t pending = osal_kernel_delayed_bitmap;
+
+    while (pending != 0U) {
+        uint8_t prio = (uint8_t)(31U - (uint32_t)__builtin_clz(pending));
+        osal_task_t *task = osal_kernel_ready_table[prio];
+        if ((int32_t)(tick - task->wake_tick) >= 0) {
+            osal_kernel_make_ready(task);
+        }
+        pending &= ~(1UL << prio);
+    }
+    osal_kernel_irq_restore(primask);
+
+    osal_kernel_tick_hook();
+}
+
+__attribute__((weak)) void osal_kernel_tick_hook(void)
+{
+}
+
+void osal_kernel_init(void)
+{
+    osal_utils_cycles_init();
+
+    // Lazy FPU state preservation (reset default, made explicit since PendSV relies on it)
+    FPU_FPCCR |= (FPU_FPCCR_ASPEN | FPU_FPCCR_LSPEN);
+
+    SCB_SHPR3 = (SCB_SHPR3 & 0x0000FFFFUL) | (SYSTICK_PRIORITY << 24) | (PENDSV_PRIORITY << 16);
+
+    (void)osal_kernel_task_create(&osal_kernel_idle_task, "idle", osal_kernel_idle, NULL,
+                                  OSAL_KERNEL_PRIO_IDLE, OSAL_KERNEL_IDLE_STACK_SIZE);
+
+    SYST_RVR = (uint32_t)(CORE_CLOCK_HZ / OSAL_KERNEL_TICK_HZ) - 1U;
+    SYST_CVR = 0U;
+    SYST_CSR = SYST_CSR_CLKSOURCE | SYST_CSR_TICKINT | SYST_CSR_ENABLE;
+}
+
+int32_t osal_kernel_task_create(osal_task_t *task, const char *name, osal_task_fn_t fn, void *arg,
+                                uint8_t prio, size_t stack_size)
+{
+    if ((task == NULL) || (fn == NULL) || (prio >= OSAL_KERNEL_PRIO_COUNT) ||
+        ((prio == OSAL_KERNEL_PRIO_IDLE) && (fn != osal_kernel_idle))) {
+        return -1;
+    }
+    if (osal_kernel_ready_table[prio] != NULL) {
+        return -2;
+    }
+
+    stack_size = (stack_size < OSAL_KERNEL_MIN_STACK_SIZE) ? OSAL_KERNEL_MIN_STACK_SIZE : stack_size;
+    stack_size = (stack_size + (OSAL_STACK_GUARD_SIZE - 1U)) & ~(size_t)(OSAL_STACK_GUARD_SIZE - 1U);
+
+    uint32_t primask = osal_kernel_irq_save();
+    if ((osal_kernel_stack_used + stack_size) > sizeof(osal_kernel_stack_pool)) {
+        osal_kernel_irq_restore(primask);
+        return -3;
+    }
+    uint8_t *base = (uint8_t *)osal_kernel_stack_pool + osal_kernel_stack_used;
+    osal_kernel_stack_used += stack_size;
+
+    osal_stack_paint((uint32_t *)base, stack_size);
+    (void)osal_mpu_region_init(&task->stack_guard, (uint32_t)base, OSAL_STACK_GUARD_SIZE, OSAL_MPU_ATTR_NO_ACCESS);
+
+    // Build the initial exception frame so the first PendSV "returns" into fn(arg)
+    uint32_t *sp = (uint32_t *)(base + stack_size);
+    sp -= TASK_HW_FRAME_WORDS;
+    sp[0] = (uint32_t)arg;                    // r0
+    sp[1] = 0U;                               // r1
+    sp[2] = 0U;                               // r2
+    sp[3] = 0U;                               // r3
+    sp[4] = 0U;                               // r12
+    sp[5] = (uint32_t)osal_kernel_task_exit;  // lr
+    sp[6] = (uint32_t)fn & ~1UL;              // pc
+    sp[7] = TASK_INITIAL_XPSR;                // xPSR
+    sp -= TASK_SW_FRAME_WORDS;
+    memset(sp, 0, (TASK_SW_FRAME_WORDS - 1U) * sizeof(uint32_t)); // r4-r11
+    sp[TASK_SW_FRAME_WORDS - 1U] = TASK_EXC_RETURN;
+
+    task->sp = sp;
+    task->stack_base = (uint32_t *)base;
+    task->stack_size = stack_size;
+    task->name = name;
+    task->wake_tick = 0U;
+    task->notify_cycles = 0U;
+    task->mpu_region = &task->stack_guard;
+    task->notified = 0U;
+    task->notify_timed = 0U;
+    task->prio = prio;
+    task->state = (uint8_t)OSAL_TASK_READY;
+
+    osal_kernel_ready_table[prio] = task;
+    osal_kernel_ready_bitmap |= (1UL << prio);
+    osal_kernel_irq_restore(primask);
+
+    return 0;
+}
+
+void osal_kernel_task_set_mpu_region(osal_task_t *task, const osal_mpu_region_t *region)
+{
+    task->mpu_region = (region != NULL) ? region : &task->stack_guard;
+}
+
+void osal_kernel_start(void)
+{
+    (void)osal_kernel_irq_save();
+
+    // PendSV saves the boot context here; it is never resumed
+    uint32_t *boot_sp = &osal_kernel_boot_frame[BOOT_FRAME_WORDS];
+    __asm volatile ("msr psp, %0" :: "r" (boot_sp) : "memory");
+
+    osal_kernel_pend_switch();
+    __asm volatile ("cpsie i \n isb" ::: "memory");
+
+    while (1) {
+        ; // Not reached: PendSV switches to the first task
+    }
+}
+
+void osal_kernel_delay(uint32_t ticks)
+{
+    uint32_t primask = osal_kernel_irq_save();
+    osal_task_t *task = osal_kernel_current_task;
+
+    if (ticks != 0U) {
+        uint32_t bit = 1UL << task->prio;
+        task->wake_tick = osal_kernel_tick + ticks;
+        task->state = (uint8_t)OSAL_TASK_DELAYED;
+        osal_kernel_ready_bitmap &= ~bit;
+        osal_kernel_delayed_bitmap |= bit;
+    }
+    osal_kernel_pend_switch();
+    osal_kernel_irq_restore(primask);
+}
+
+void osal_kernel_wait(void)
+{
+    uint32_t primask = osal_kernel_irq_save();
+    osal_task_t *task = osal_kernel_current_task;
+
+    if (task->notified == 0U) {
+        task->state = (uint8_t)OSAL_TASK_WAITING;
+        osal_kernel_ready_bitmap &= ~(1UL << task->prio);
+        osal_kernel_pend_switch();
+        osal_kernel_irq_restore(primask);  // Switched out here until notified
+        primask = osal_kernel_irq_save();
+    }
+    task->notified--;
+
+    uint8_t timed = task->notify_timed;
+    uint32_t stamp = task->notify_cycles;
+    task->notify_timed = 0U;
+    osal_kernel_irq_restore(primask);
+
+    if (timed != 0U) {
+        uint32_t cycles = osal_utils_cycles() - stamp;
+        primask = osal_kernel_irq_save();
+        osal_kernel_update_minmax(cycles, &osal_kernel_stats.latency_cycles_min,
+                                  &osal_kernel_stats.latency_cycles_max, osal_kernel_stats.latency_count);
+        osal_kernel_stats.latency_cycles_last = cycles;
+        osal_kernel_stats.latency_count++;
+        osal_kernel_irq_restore(primask);
+    }
+}
+
+void osal_kernel_notify(osal_task_t *task)
+{
+    uint32_t primask = osal_kernel_irq_save();
+    task->notified++;
+    if (task->state == (uint8_t)OSAL_TASK_WAITING) {
+        osal_kernel_make_ready(task);
+    }
+    osal_kernel_irq_restore(primask);
+}
+
+OSAL_FAST_CODE void osal_kernel_notify_from_isr(osal_task_t *task)
+{
+    uint32_t stamp = osal_utils_cycles();
+    uint32_t primask = osal_kernel_irq_save(); // ISRs at other priorities may notify concurrently
+
+    if (task->notify_timed == 0U) {
+        task->notify_cycles = stamp;
+        task->notify_timed = 1U;
+    }
+    task->notified++;
+    if (task->state == (uint8_t)OSAL_TASK_WAITING) {
+        osal_kernel_make_ready(task);
+    }
+    osal_kernel_irq_restore(primask);
+}
+
+uint32_t osal_kernel_get_tick(void)
+{
+    return osal_kernel_tick;
+}
+
+osal_task_t *osal_kernel_current(void)
+{
+    return osal_kernel_current_task;
+}
+
+void osal_kernel_get_stats(osal_kernel_stats_t *stats)
+{
+    uint32_t primask = osal_kernel_irq_save();
+    *stats = osal_kernel_stats;
+    osal_kernel_irq_restore(primask);
+}
+
+void osal_kernel_log_stats(void)
+{
+    osal_kernel_stats_t stats;
+    char log_buffer[LOG_BUFFER_SIZE];
+
+    osal_kernel_get_stats(&stats);
+    snprintf(log_buffer, LOG_BUFFER_SIZE,
+             "Kernel: %lu switches, switch cycles last/min/max %lu/%lu/%lu\r\n",
+             (unsigned long)stats.switch_count, (unsigned long)stats.switch_cycles_last,
+             (unsigned long)stats.switch_cycles_min, (unsigned long)stats.switch_cycles_max);
+    osal_log_info(log_buffer);
+    snprintf(log_buffer, LOG_BUFFER_SIZE,
+             "Kernel: %lu ISR wakeups, latency cycles last/min/max %lu/%lu/%lu\r\n",
+             (unsigned long)stats.latency_count, (unsigned long)stats.latency_cycles_last,
+             (unsigned long)stats.latency_cycles_min, (unsigned long)stats.latency_cycles_max);
+    osal_log_info(log_buffer);
+}
+
+size_t osal_kernel_task_stack_used(const osal_task_t *task)
+{
+    return osal_stack_used(&task->stack_base[OSAL_STACK_GUARD_SIZE / sizeof(uint32_t)],
+                           task->stack_size - OSAL_STACK_GUARD_SIZE);
+}
+
+void osal_kernel_log_stacks(void)
+{
+    char log_buffer[LOG_BUFFER_SIZE];
+
+    for (int32_t prio = (int32_t)OSAL_KERNEL_PRIO_COUNT - 1; prio >= 0; prio--) {
+        const osal_task_t *task = osal_kernel_ready_table[prio];
+        if (task == NULL) {
+            continue;
+        }
+        size_t size = task->stack_size - OSAL_STACK_GUARD_SIZE;
+        size_t used = osal_kernel_task_stack_used(task);
+        snprintf(log_buffer, LOG_BUFFER_SIZE, "Stack %s: %lu of %lu bytes used at peak, %lu free\r\n",
+                 (task->name != NULL) ? task->name : "?", (unsigned long)used, (unsigned long)size,
+                 (unsigned long)(size - used));
+        osal_log_info(log_buffer);
+    }
+    snprintf(log_buffer, LOG_BUFFER_SIZE, "Stack pool: %lu of %lu bytes allocated\r\n",
+             (unsigned long)osal_kernel_stack_used, (unsigned long)sizeof(osal_kernel_stack_pool));
+    osal_log_info(log_buffer);
+}
@@ -0,0 +1,583 @@
+#include "osal_kv.h"
+#include "osal_crc32.h"
+#include <stdbool.h>
+#include <string.h>
+#ifndef __linux__
+#include "osal_log.h"
+#include "osal_utils.h"
+#include <stdio.h>
+#endif
+
+_Static_assert((OSAL_KV_INDEX_SIZE & (OSAL_KV_INDEX_SIZE - 1U)) == 0U, "index size must be a power of 2");
+_Static_assert(OSAL_KV_MAX_KEYS < OSAL_KV_INDEX_SIZE, "index needs free slots");
+_Static_assert((OSAL_KV_SECTORS * OSAL_KV_SECTOR_SIZE) == (OSAL_FLASH_DFLASH_END - OSAL_FLASH_DFLASH_START), "store spans int_dflash");
+_Static_assert((OSAL_KV_MAX_KEYS * (OSAL_KV_RECORD_HEADER + OSAL_KV_VALUE_MAX)) <=
+               ((OSAL_KV_SECTORS - OSAL_KV_GC_THRESHOLD) * (OSAL_KV_SECTOR_SIZE - OSAL_KV_SECTOR_HEADER)),
+               "live data must leave room to reclaim");
+
+typedef enum {
+    KV_SECTOR_ERASED,
+    KV_SECTOR_USED,
+    KV_SECTOR_DIRTY
+} osal_kv_sector_state_t;
+
+typedef enum {
+    KV_GC_IDLE,
+    KV_GC_COPY,       // Moving the live records of the victim to the head
+    KV_GC_ERASE,      // Marking the victim obsolete and starting its erase
+    KV_GC_ERASING
+} osal_kv_gc_state_t;
+
+typedef struct {
+    uint16_t key;
+    uint16_t len;
+    uint32_t crc;
+} osal_kv_record_t;
+
+// Index slot; key 0 is an empty slot
+typedef struct {
+    uint16_t key;
+    uint16_t len;
+    uint32_t addr;                // Record header
+} osal_kv_entry_t;
+
+#define KV_NONE OSAL_KV_SECTORS
+
+static struct {
+    osal_kv_entry_t index[OSAL_KV_INDEX_SIZE];
+    uint32_t seq[OSAL_KV_SECTORS];
+    uint8_t state[OSAL_KV_SECTORS];
+    uint32_t active;              // Sector appended to, KV_NONE if none is open
+    uint32_t newest;              // Sector opened last, where the ring continues
+    uint32_t head;                // Address of the next record in the active sector
+    uint32_t next_seq;
+    osal_kv_gc_state_t gc;
+    uint32_t victim;              // Sector being reclaimed or erased
+    uint32_t gc_addr;             // Next record of the victim to look at
+    uint64_t record[(OSAL_KV_RECORD_HEADER + OSAL_KV_VALUE_MAX) / 8U];
+    osal_kv_stats_t stats;
+} osal_kv;
+
+static uint32_t osal_kv_sector_addr(uint32_t s)
+{
+    return OSAL_KV_BASE + (s * OSAL_KV_SECTOR_SIZE);
+}
+
+static uint32_t osal_kv_record_size(uint16_t len)
+{
+    return OSAL_KV_RECORD_HEADER + ((((uint32_t)len & ~OSAL_KV_TOMBSTONE) + 7U) & ~7U);
+}
+
+// Sequence numbers compare modulo 2^32
+static bool osal_kv_older(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) < 0;
+}
+
+static uint32_t osal_kv_slot(uint16_t key)
+{
+    return (((uint32_t)key * 40503U) >> 8) & (OSAL_KV_INDEX_SIZE - 1U);
+}
+
+static osal_kv_entry_t *osal_kv_find(uint16_t key)
+{
+    uint32_t i = osal_kv_slot(key);
+
+    while (osal_kv.index[i].key != 0U) {
+        if (osal_kv.index[i].key == key) {
+            return &osal_kv.index[i];
+        }
+        i = (i + 1U) & (OSAL_KV_INDEX_SIZE - 1U);
+    }
+    return NULL;
+}
+
+static int32_t osal_kv_index_put(uint16_t key, uint16_t len, uint32_t addr)
+{
+    uint32_t i = osal_kv_slot(key);
+
+    while (osal_kv.index[i].key != 0U) {
+        if (osal_kv.index[i].key == key) {
+            osal_kv.index[i].len = len;
+            osal_kv.index[i].addr = addr;
+            return 0;
+        }
+        i = (i + 1U) & (OSAL_KV_INDEX_SIZE - 1U);
+    }
+    if (osal_kv.stats.keys >= OSAL_KV_MAX_KEYS) {
+        return -2;
+    }
+    osal_kv.index[i].key = key;
+    osal_kv.index[i].len = len;
+    osal_kv.index[i].addr = addr;
+    osal_kv.stats.keys++;
+    return 0;
+}
+
+// Linear probing delete: shift later entries of the cluster back over the hole
+static void osal_kv_index_remove(osal_kv_entry_t *e)
+{
+    uint32_t hole = (uint32_t)(e - osal_kv.index);
+    uint32_t i = hole;
+
+    for (;;) {
+        i = (i + 1U) & (OSAL_KV_INDEX_SIZE - 1U);
+        if (osal_kv.index[i].key == 0U) {
+            break;
+        }
+        uint32_t home = osal_kv_slot(osal_kv.index[i].key);
+        // Move the entry unless its home lies cyclically in (hole, i]
+        if (((i - home) & (OSAL_KV_INDEX_SIZE - 1U)) >= ((i - hole) & (OSAL_KV_INDEX_SIZE - 1U))) {
+            osal_kv.index[hole] = osal_kv.index[i];
+            hole = i;
+        }
+    }
+    osal_kv.index[hole].key = 0U;
+    osal_kv.stats.keys--;
+}
+
+// Check the record at addr; returns its size, 0 at the end of the log, -1 if it is corrupt.
+// Reads are checked: a double word torn by a reset fails its ECC, which marks a torn record
+// as surely as a CRC mismatch.
+static int32_t osal_kv_check(uint32_t addr, uint32_t limit, osal_kv_record_t *rec)
+{
+    uint8_t buf[64];
+    uint32_t left;
+    uint32_t size;
+    uint32_t crc;
+
+    if ((limit - addr) < OSAL_KV_RECORD_HEADER) {
+        return 0;
+    }
+    if (osal_flash_read_checked(addr, rec, sizeof(*rec)) != 0) {
+        return -1;
+    }
+    if ((rec->key == OSAL_KV_KEY_ERASED) && (rec->len == 0xFFFFU) && (rec->crc == 0xFFFFFFFFUL)) {
+        return 0;
+    }
+    left = (uint32_t)rec->len & ~OSAL_KV_TOMBSTONE;
+    size = osal_kv_record_size(rec->len);
+    if ((rec->key == 0U) || (rec->key == OSAL_KV_KEY_ERASED) || (left > OSAL_KV_VALUE_MAX) ||
+        (((rec->len & OSAL_KV_TOMBSTONE) != 0U) && (left != 0U)) || (size > (limit - addr))) {
+        return -1;
+    }
+    crc = osal_crc32_update(0U, rec, 4U);
+    addr += OSAL_KV_RECORD_HEADER;
+    while (left > 0U) {
+        uint32_t n = (left < sizeof(buf)) ? left : (uint32_t)sizeof(buf);
+        if (osal_flash_read_checked(addr, buf, n) != 0) {
+            return -1;
+        }
+        crc = osal_crc32_update(crc, buf, n);
+        addr += n;
+        left -= n;
+    }
+    return (crc == rec->crc) ? (int32_t)size : -1;
+}
+
+static uint32_t osal_kv_count(osal_kv_sector_state_t state)
+{
+    uint32_t n = 0U;
+
+    for (uint32_t s = 0U; s < OSAL_KV_SECTORS; s++) {
+        n += (osal_kv.state[s] == (uint8_t)state) ? 1U : 0U;
+    }
+    return n;
+}
+
+// Oldest sector holding records, other than the active one
+static uint32_t osal_kv_oldest(void)
+{
+    uint32_t oldest = KV_NONE;
+
+    for (uint32_t s = 0U; s < OSAL_KV_SECTORS; s++) {
+        if ((osal_kv.state[s] == KV_SECTOR_USED) && (s != osal_kv.active) &&
+            ((oldest == KV_NONE) || osal_kv_older(osal_kv.seq[s], osal_kv.seq[oldest]))) {
+            oldest = s;
+        }
+    }
+    return oldest;
+}
+
+// Finish a background erase before the flash is used again (this also makes data flash
+// readable: the C40 cannot read a block while it erases it)
+static int32_t osal_kv_flash_idle(void)
+{
+    int32_t ret = osal_flash_wait();
+
+    if (osal_kv.gc == KV_GC_ERASING) {
+        osal_kv.state[osal_kv.victim] = (ret == 0) ? (uint8_t)KV_SECTOR_ERASED : (uint8_t)KV_SECTOR_DIRTY;
+        osal_kv.gc = KV_GC_IDLE;
+    }
+    return (ret == 0) ? 0 : -4;
+}
+
+// Take the next erased sector in ring order and write its header
+static int32_t osal_kv_open_sector(void)
+{
+    uint32_t start = (osal_kv.newest == KV_NONE) ? 0U : (osal_kv.newest + 1U);
+    uint32_t header[2];
+
+    for (uint32_t i = 0U; i < OSAL_KV_SECTORS; i++) {
+        uint32_t s = (start + i) % OSAL_KV_SECTORS;
+        if (osal_kv.state[s] != KV_SECTOR_ERASED) {
+            continue;
+        }
+        header[0] = OSAL_KV_MAGIC;
+        header[1] = osal_kv.next_seq;
+        if (osal_flash_program(osal_kv_sector_addr(s), header, sizeof(header)) != 0) {
+            osal_kv.state[s] = KV_SECTOR_DIRTY;
+            return -4;
+        }
+        osal_kv.state[s] = KV_SECTOR_USED;
+        osal_kv.seq[s] = osal_kv.next_seq++;
+        osal_kv.active = s;
+        osal_kv.newest = s;
+        osal_kv.head = osal_kv_sector_addr(s) + OSAL_KV_SECTOR_HEADER;
+        osal_kv.stats.sequence = osal_kv.next_seq;
+        return 0;
+    }
+    return -3;
+}
+
+static int32_t osal_kv_gc_step(void);
+
+// Append a record (header first, so a torn one fails its CRC); reclaiming is for the caller
+// to arrange, except that the copy of a live record may take the last erased sector
+static int32_t osal_kv_append(uint16_t key, uint16_t len, const void *data, bool gc)
+{
+    osal_kv_record_t *rec = (osal_kv_record_t *)osal_kv.record;
+    uint32_t n = (uint32_t)len & ~OSAL_KV_TOMBSTONE;
+    uint32_t size = osal_kv_record_size(len);
+    int32_t ret = osal_kv_flash_idle();
+
+    while ((ret == 0) && ((osal_kv.active == KV_NONE) ||
+                          ((osal_kv.head + size) > (osal_kv_sector_addr(osal_kv.active) + OSAL_KV_SECTOR_SIZE)))) {
+        if (!gc && (osal_kv_count(KV_SECTOR_ERASED) < 2U)) {
+            // Log full: reclaim in the foreground until a spare sector is left for the next one
+            if ((osal_kv.gc == KV_GC_IDLE) && (osal_kv_oldest() == KV_NONE) &&
+                (osal_kv_count(KV_SECTOR_DIRTY) == 0U)) {
+                ret = (osal_kv_count(KV_SECTOR_ERASED) > 0U) ? osal_kv_open_sector() : -3;
+                break;
+            }
+            ret = osal_kv_gc_step();
+            if (ret == 0) {
+                ret = osal_kv_flash_idle();
+            }
+            continue;
+        }
+        ret = osal_kv_open_sector();
+    }
+    if (ret != 0) {
+        return ret;
+    }
+
+    memset(osal_kv.record, 0xFF, size);
+    rec->key = key;
+    rec->len = len;
+    rec->crc = osal_crc32_update(0U, rec, 4U);
+    if (n > 0U) {
+        memcpy(&((uint8_t *)osal_kv.record)[OSAL_KV_RECORD_HEADER], data, n);
+        rec->crc = osal_crc32_update(rec->crc, data, n);
+    }
+    if (osal_flash_program(osal_kv.head, osal_kv.record, size) != 0) {
+        // Whatever reached the flash fails its CRC; leave the sector for the next one
+        osal_kv.active = KV_NONE;
+        return -4;
+    }
+    ret = 0;
+    if ((len & OSAL_KV_TOMBSTONE) == 0U) {
+        ret = osal_kv_index_put(key, len, osal_kv.head);
+    } else {
+        osal_kv_entry_t *e = osal_kv_find(key);
+        if (e != NULL) {
+            osal_kv_index_remove(e);
+        }
+    }
+    osal_kv.head += size;
+    osal_kv.stats.writes++;
+    return ret;
+}
+
+// One reclaim step: pick a victim, copy one live record, or mark and start erasing a sector.
+// Returns the error of a copy that found no space
+static int32_t osal_kv_gc_step(void)
+{
+    osal_kv_record_t rec;
+    int32_t size;
+    int32_t ret = 0;
+
+    switch (osal_kv.gc) {
+    case KV_GC_IDLE:
+        for (uint32_t s = 0U; s < OSAL_KV_SECTORS; s++) {
+            if (osal_kv.state[s] == KV_SECTOR_DIRTY) {
+                osal_kv.victim = s;
+                osal_kv.gc = KV_GC_ERASE;
+                return 0;
+            }
+        }
+        if (osal_kv_count(KV_SECTOR_ERASED) < OSAL_KV_GC_THRESHOLD) {
+            osal_kv.victim = osal_kv_oldest();
+            if (osal_kv.victim != KV_NONE) {
+                osal_kv.gc_addr = osal_kv_sector_addr(osal_kv.victim) + OSAL_KV_SECTOR_HEADER;
+                osal_kv.gc = KV_GC_COPY;
+                osal_kv.stats.reclaims++;
+            }
+        }
+        break;
+    case KV_GC_COPY:
+        // Records superseded or deleted are skipped; the victim is the oldest sector, so a
+        // tombstone in it has nothing older left to hide and is dropped too
+        for (;;) {
+            uint32_t addr = osal_kv.gc_addr;
+            osal_kv_entry_t *e;
+            size = osal_kv_check(addr, osal_kv_sector_addr(osal_kv.victim) + OSAL_KV_SECTOR_SIZE, &rec);
+            if (size <= 0) {
+                osal_kv.gc = KV_GC_ERASE;
+                break;
+            }
+            osal_kv.gc_addr += (uint32_t)size;
+            e = osal_kv_find(rec.key);
+            if ((e != NULL) && (e->addr == addr)) {
+                uint8_t value[OSAL_KV_VALUE_MAX];
+                osal_flash_read(addr + OSAL_KV_RECORD_HEADER, value, rec.len);
+                ret = osal_kv_append(rec.key, rec.len, value, true);
+                if (ret != 0) {
+                    // Keep the victim; retry from this record
+                    osal_kv.gc_addr = addr;
+                } else {
+                    osal_kv.stats.copied++;
+                }
+                break;
+            }
+        }
+        break;
+    case KV_GC_ERASE:
+        if (osal_flash_poll() != 0) {
+            break;
+        }
+        if (osal_kv.state[osal_kv.victim] == KV_SECTOR_USED) {
+            static const uint32_t obsolete[2] = { 0U, 0U };
+            (void)osal_flash_program(osal_kv_sector_addr(osal_kv.victim) + 8U, obsolete, sizeof(obsolete));
+            osal_kv.state[osal_kv.victim] = KV_SECTOR_DIRTY;
+        }
+        if (osal_flash_erase_start(osal_kv_sector_addr(osal_kv.victim)) == 0) {
+            osal_kv.gc = KV_GC_ERASING;
+            osal_kv.stats.erases++;
+        }
+        break;
+    case KV_GC_ERASING:
+        ret = osal_flash_poll();
+        if (ret <= 0) {
+            osal_kv.state[osal_kv.victim] = (ret == 0) ? (uint8_t)KV_SECTOR_ERASED : (uint8_t)KV_SECTOR_DIRTY;
+            osal_kv.gc = KV_GC_IDLE;
+        }
+        ret = 0;
+        break;
+    default:
+        osal_kv.gc = KV_GC_IDLE;
+        break;
+    }
+    return ret;
+}
+
+int32_t osal_kv_init(void)
+{
+    uint32_t order[OSAL_KV_SECTORS];
+    uint32_t used = 0U;
+#ifndef __linux__
+    uint32_t enter;
+
+    osal_utils_cycles_init();
+    enter = osal_utils_cycles();
+#endif
+
+    if (osal_flash_wait() != 0) {
+        return -4;
+    }
+    memset(osal_kv.index, 0, sizeof(osal_kv.index));
+    osal_kv.active = KV_NONE;
+    osal_kv.newest = KV_NONE;
+    osal_kv.gc = KV_GC_IDLE;
+    osal_kv.next_seq = 0U;
+    osal_kv.stats.keys = 0U;
+    osal_kv.stats.records_scanned = 0U;
+    osal_kv.stats.bytes_scanned = 0U;
+    osal_kv.stats.torn = 0U;
+
+    // Sector headers, then the used sectors oldest first
+    for (uint32_t s = 0U; s < OSAL_KV_SECTORS; s++) {
+        uint32_t header[4];
+        uint32_t addr = osal_kv_sector_addr(s);
+
+        if (osal_flash_read_checked(addr, header, sizeof(header)) != 0) {
+            // Header or obsolete mark torn: the sector is erased again
+            osal_kv.state[s] = KV_SECTOR_DIRTY;
+        } else if ((header[0] == OSAL_KV_MAGIC) && (header[2] == 0xFFFFFFFFUL) && (header[3] == 0xFFFFFFFFUL)) {
+            uint32_t i = used++;
+            osal_kv.state[s] = KV_SECTOR_USED;
+            osal_kv.seq[s] = header[1];
+            while ((i > 0U) && osal_kv_older(header[1], osal_kv.seq[order[i - 1U]])) {
+                order[i] = order[i - 1U];
+                i--;
+            }
+            order[i] = s;
+        } else {
+            // An erased header over records means an interrupted erase or header write
+            osal_kv.state[s] = osal_flash_is_erased(addr, OSAL_KV_SECTOR_SIZE) ? (uint8_t)KV_SECTOR_ERASED
+                                                                                : (uint8_t)KV_SECTOR_DIRTY;
+        }
+    }
+    for (uint32_t i = 0U; i < used; i++) {
+        uint32_t s = order[i];
+        uint32_t addr = osal_kv_sector_addr(s) + OSAL_KV_SECTOR_HEADER;
+        uint32_t limit = osal_kv_sector_addr(s) + OSAL_KV_SECTOR_SIZE;
+        osal_kv_record_t rec;
+        int32_t size;
+
+        while ((size = osal_kv_check(addr, limit, &rec)) > 0) {
+            osal_kv.stats.records_scanned++;
+            if ((rec.len & OSAL_KV_TOMBSTONE) == 0U) {
+                (void)osal_kv_index_put(rec.key, rec.len, addr);
+            } else {
+                osal_kv_entry_t *e = osal_kv_find(rec.key);
+                if (e != NULL) {
+                    osal_kv_index_remove(e);
+                }
+            }
+            addr += (uint32_t)size;
+        }
+        osal_kv.stats.bytes_scanned += addr - osal_kv_sector_addr(s);
+        if (size < 0) {
+            // Cut short by a reset: the sector takes no more appends
+            osal_kv.stats.torn++;
+        } else if (i == (used - 1U)) {
+            osal_kv.active = s;
+            osal_kv.head = addr;
+        }
+        osal_kv.newest = s;
+        osal_kv.next_seq = osal_kv.seq[s] + 1U;
+    }
+    osal_kv.stats.sequence = osal_kv.next_seq;
+#ifndef __linux__
+    osal_kv.stats.scan_cycles = osal_utils_cycles() - enter;
+#endif
+    return (int32_t)osal_kv.stats.keys;
+}
+
+int32_t osal_kv_get(uint16_t key, void *buf, uint32_t size, uint32_t *len)
+{
+    osal_kv_entry_t *e = osal_kv_find(key);
+
+    if ((key == 0U) || (e == NULL)) {
+        return -1;
+    }
+    *len = e->len;
+    if (e->len > size) {
+        return -2;
+    }
+    (void)osal_kv_flash_idle();
+    osal_flash_read(e->addr + OSAL_KV_RECORD_HEADER, buf, e->len);
+    return 0;
+}
+
+int32_t osal_kv_set(uint16_t key, const void *data, uint32_t len)
+{
+    if ((key == 0U) || (key == OSAL_KV_KEY_ERASED) || (len > OSAL_KV_VALUE_MAX) || ((data == NULL) && (len > 0U))) {
+        return -1;
+    }
+    if ((osal_kv_find(key) == NULL) && (osal_kv.stats.keys >= OSAL_KV_MAX_KEYS)) {
+        return -2;
+    }
+    return osal_kv_append(key, (uint16_t)len, data, false);
+}
+
+int32_t osal_kv_delete(uint16_t key)
+{
+    if ((key == 0U) || (osal_kv_find(key) == NULL)) {
+        return -1;
+    }
+    return osal_kv_append(key, (uint16_t)OSAL_KV_TOMBSTONE, NULL, false);
+}
+
+void osal_kv_poll(void)
+{
+    (void)osal_kv_gc_step();
+}
+
+void osal_kv_get_stats(osal_kv_stats_t *stats)
+{
+    *stats = osal_kv.stats;
+    stats->sectors_used = osal_kv_count(KV_SECTOR_USED);
+    stats->sectors_free = osal_kv_count(KV_SECTOR_ERASED);
+    stats->sectors_dirty = osal_kv_count(KV_SECTOR_DIRTY);
+}
+
+#ifndef __linux__
+void osal_kv_log(void)
+{
+    osal_kv_stats_t s;
+    char log_buffer[LOG_BUFFER_SIZE];
+
+    osal_kv_get_stats(&s);
+    snprintf(log_buffer, LOG_BUFFER_SIZE,
+             "KV: %lu keys, sectors %lu used / %lu free / %lu dirty, sequence %lu\r\n",
+             (unsigned long)s.keys, (unsigned long)s.sectors_used, (unsigned long)s.sectors_free,
+             (unsigned long)s.sectors_dirty, (unsigned long)s.sequence);
+    osal_log_info(log_buffer);
+    snprintf(log_buffer, LOG_BUFFER_SIZE,
+             "  mount: %lu records, %lu bytes in %lu us, %lu torn\r\n",
+             (unsigned long)s.records_scanned, (unsigned long)s.bytes_scanned,
+             (unsigned long)osal_utils_cycles_to_us(s.scan_cycles), (unsigned long)s.torn);
+    osal_log_info(log_buffer);
+    snprintf(log_buffer, LOG_BUFFER_SIZE,
+             "  writes %lu, reclaims %lu (%lu records copied), erases %lu\r\n",
+             (unsigned long)s.writes, (unsigned long)s.reclaims, (unsigned long)s.copied,
+             (unsigned long)s.erases);
+    osal_log_info(log_buffer);
+}
+
+#ifdef OSAL_KV_BENCHMARK_ENABLE
+// Keys used by the benchmark; the values are of a typical calibration record size
+#define KV_BENCH_KEY 0xFF00U
+#define KV_BENCH_KEYS 16U
+#define KV_BENCH_LEN 24U
+
+void osal_kv_benchmark(void)
+{
+    uint8_t value[KV_BENCH_LEN];
+    char log_buffer[LOG_BUFFER_SIZE];
+    uint32_t size = osal_kv_record_size(KV_BENCH_LEN);
+    uint32_t n = 0U;
+    uint32_t enter;
+    uint32_t write_cycles;
+
+    // Fill until the next record would need the last spare sector, so that nothing is reclaimed
+    osal_utils_cycles_init();
+    enter = osal_utils_cycles();
+    while ((osal_kv_count(KV_SECTOR_ERASED) >= 2U) ||
+           ((osal_kv.active != KV_NONE) &&
+            ((osal_kv.head + size) <= (osal_kv_sector_addr(osal_kv.active) + OSAL_KV_SECTOR_SIZE)))) {
+        memset(value, (int)n, sizeof(value));
+        if (osal_kv_set((uint16_t)(KV_BENCH_KEY + (n % KV_BENCH_KEYS)), value, sizeof(value)) != 0) {
+            break;
+        }
+        n++;
+    }
+    write_cycles = osal_utils_cycles() - enter;
+    (void)osal_kv_init();
+
+    snprintf(log_buffer, LOG_BUFFER_SIZE, "KV benchmark: %lu records written, %lu us each\r\n",
+             (unsigned long)n, (unsigned long)((n > 0U) ? (osal_utils_cycles_to_us(write_cycles) / n) : 0U));
+    osal_log_info(log_buffer);
+    snprintf(log_buffer, LOG_BUFFER_SIZE, "  full mount: %lu records, %lu bytes in %lu us\r\n",
+             (unsigned long)osal_kv.stats.records_scanned, (unsigned long)osal_kv.stats.bytes_scanned,
+             (unsigned long)osal_utils_cycles_to_us(osal_kv.stats.scan_cycles));
+    osal_log_info(log_buffer);
+
+    for (uint32_t i = 0U; i < KV_BENCH_KEYS; i++) {
+        (void)osal_kv_delete((uint16_t)(KV_BENCH_KEY + i));
+    }
+}
+#endif /* OSAL_KV_BENCHMARK_ENABLE */
+#endif
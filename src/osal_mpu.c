@@ -0,0 +1,170 @@
+#include "osal_mpu.h"
+#include "osal_cache.h"
+#include "osal_log.h"
+#include "osal_utils.h"
+#include <stdio.h>
+
+// Cortex-M7 MPU registers
+#define MPU_TYPE  (*(volatile uint32_t *)0xE000ED90UL)
+#define MPU_RNR   (*(volatile uint32_t *)0xE000ED98UL)
+#define MPU_RBAR  (*(volatile uint32_t *)0xE000ED9CUL)
+#define MPU_RASR  (*(volatile uint32_t *)0xE000EDA0UL)
+
+#define MPU_RBAR_ADDR_MASK  0xFFFFFFE0UL
+#define MPU_RASR_SIZE_SHIFT 1U
+#define MPU_RASR_SIZE_MASK  0x3EUL
+#define MPU_RASR_TYPE_MASK  0x003B0000UL  // TEX, C, B
+
+static const osal_mpu_region_t *osal_mpu_task_region;
+
+static inline uint32_t osal_mpu_irq_save(void)
+{
+    uint32_t primask;
+    __asm volatile ("mrs %0, primask\n cpsid i" : "=r" (primask) :: "memory");
+    return primask;
+}
+
+static inline void osal_mpu_irq_restore(uint32_t primask)
+{
+    __asm volatile ("msr primask, %0" :: "r" (primask) : "memory");
+}
+
+static inline void osal_mpu_sync(void)
+{
+    __asm volatile ("dsb\n isb" ::: "memory");
+}
+
+int32_t osal_mpu_region_init(osal_mpu_region_t *region, uint32_t base, uint32_t size, uint32_t attr)
+{
+    if (!OSAL_MPU_SIZE_VALID(size)) {
+        return -1;
+    }
+    if (!OSAL_MPU_BASE_VALID(base, size)) {
+        return -2;
+    }
+    region->rbar = base;
+    region->rasr = (attr & ~(MPU_RASR_SIZE_MASK | OSAL_MPU_RASR_ENABLE)) | OSAL_MPU_RASR_SIZE(size) | OSAL_MPU_RASR_ENABLE;
+    return 0;
+}
+
+static uint32_t osal_mpu_region_size(uint32_t rasr)
+{
+    uint32_t field = (rasr & MPU_RASR_SIZE_MASK) >> MPU_RASR_SIZE_SHIFT;
+    return (field >= 31U) ? 0xFFFFFFFFUL : (2UL << field);
+}
+
+static void osal_mpu_write(uint8_t num, uint32_t rbar, uint32_t rasr)
+{
+    uint32_t primask = osal_mpu_irq_save();
+
+    // Drop cached copies of the old region so they cannot be written back under the new policy.
+    // A region larger than the D-cache is flushed by set/way: bounded, and shorter with IRQs off.
+    uint32_t old;
+    uint32_t old_size = 0U;
+    uint32_t new_size = 0U;
+    MPU_RNR = num;
+    old = MPU_RASR;
+    if ((old & OSAL_MPU_RASR_ENABLE) != 0U) {
+        old_size = osal_mpu_region_size(old);
+    }
+    if ((rasr & OSAL_MPU_RASR_ENABLE) != 0U) {
+        new_size = osal_mpu_region_size(rasr);
+    }
+    if ((old_size > OSAL_CACHE_DCACHE_SIZE) || (new_size > OSAL_CACHE_DCACHE_SIZE)) {
+        osal_cache_flush_all();
+    } else {
+        osal_cache_flush_range((const void *)(MPU_RBAR & MPU_RBAR_ADDR_MASK), old_size);
+        osal_cache_flush_range((const void *)(rbar & MPU_RBAR_ADDR_MASK), new_size);
+    }
+
+    __asm volatile ("dmb" ::: "memory");
+    MPU_RASR = 0U; // Disable while the base changes
+    MPU_RBAR = rbar & MPU_RBAR_ADDR_MASK;
+    MPU_RASR = rasr;
+    osal_mpu_sync();
+
+    osal_mpu_irq_restore(primask);
+}
+
+int32_t osal_mpu_set_region(uint8_t num, const osal_mpu_region_t *region)
+{
+    if ((num >= OSAL_MPU_REGION_COUNT) || (region == NULL)) {
+        return -1;
+    }
+    osal_mpu_write(num, region->rbar, region->rasr);
+    return 0;
+}
+
+int32_t osal_mpu_clear_region(uint8_t num)
+{
+    if (num >= OSAL_MPU_REGION_COUNT) {
+        return -1;
+    }
+    osal_mpu_write(num, 0U, 0U);
+    return 0;
+}
+
+int32_t osal_mpu_get_region(uint8_t num, osal_mpu_region_t *region)
+{
+    if (num >= OSAL_MPU_REGION_COUNT) {
+        return -1;
+    }
+    uint32_t primask = osal_mpu_irq_save();
+    MPU_RNR = num;
+    region->rbar = MPU_RBAR & MPU_RBAR_ADDR_MASK;
+    region->rasr = MPU_RASR;
+    osal_mpu_irq_restore(primask);
+    return 0;
+}
+
+// Called from PendSV (lowest priority, interrupts may nest): RNR/RBAR/RASR are written as one
+// sequence with interrupts masked. No cache maintenance: task regions must not change the cache
+// policy of memory that another task writes through the cache.
+OSAL_FAST_CODE void osal_mpu_load_task_region(const osal_mpu_region_t *region)
+{
+    if (region == osal_mpu_task_region) {
+        return;
+    }
+    osal_mpu_task_region = region;
+
+    uint32_t primask = osal_mpu_irq_save();
+    MPU_RNR = OSAL_MPU_REGION_TASK;
+    MPU_RASR = 0U;
+    if (region != NULL) {
+        MPU_RBAR = region->rbar;
+        MPU_RASR = region->rasr;
+    }
+    osal_mpu_sync();
+    osal_mpu_irq_restore(primask);
+}
+
+void osal_mpu_log(void)
+{
+    static const char *const ap_names[8] = { "none", "priv rw", "rw/user ro", "rw", "?", "priv ro", "ro", "ro" };
+    char log_buffer[LOG_BUFFER_SIZE];
+    uint32_t count = (MPU_TYPE >> 8) & 0xFFU;
+
+    for (uint8_t i = 0U; (i < count) && (i < OSAL_MPU_REGION_COUNT); i++) {
+        osal_mpu_region_t r;
+        (void)osal_mpu_get_region(i, &r);
+        if ((r.rasr & OSAL_MPU_RASR_ENABLE) == 0U) {
+            continue;
+        }
+
+        const char *type;
+        switch (r.rasr & MPU_RASR_TYPE_MASK) {
+        case OSAL_MPU_MEM_STRONGLY_ORDERED: type = "strongly ordered"; break;
+        case OSAL_MPU_MEM_DEVICE:           type = "device"; break;
+        case OSAL_MPU_MEM_NORMAL_NC:        type = "non-cacheable"; break;
+        case OSAL_MPU_MEM_WT_NOALLOC:       type = "write-through"; break;
+        case OSAL_MPU_MEM_WB_NOALLOC:       type = "write-back no-alloc"; break;
+        case OSAL_MPU_MEM_WB_ALLOC:         type = "write-back alloc"; break;
+        default:                            type = "other"; break;
+        }
+        snprintf(log_buffer, LOG_BUFFER_SIZE, "MPU %2u 0x%08lx size 0x%08lx %s %s%s%s srd 0x%02lx\r\n",
+                 (unsigned)i, (unsigned long)r.rbar, (unsigned long)osal_mpu_region_size(r.rasr), type,
+                 ap_names[(r.rasr >> 24) & 0x7U], ((r.rasr & OSAL_MPU_RASR_XN) != 0U) ? " xn" : "",
+                 ((r.rasr & OSAL_MPU_RASR_S) != 0U) ? " shared" : "", (unsigned long)((r.rasr >> 8) & 0xFFU));
+        osal_log_info(log_buffer);
+    }
+}
@@ -0,0 +1,156 @@
+#include "osal_ram.h"
+#include "osal_cache.h"
+#include "osal_log.h"
+#include "osal_reset.h"
+#include "osal_utils.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+// Linker symbols: only their addresses are meaningful
+extern uint8_t __RAM_INIT_PARTIAL[];
+extern uint8_t __RAM_INIT[];
+extern uint8_t __DTCM_INIT[];
+extern uint8_t __ITCM_INIT[];
+extern uint8_t __INT_SRAM_START[], __SRAM_USED_END[], __SRAM_SPARE_END[];
+extern uint8_t __SRAM_NC_START[], __SRAM_NC_USED_END[], __SRAM_NC_SPARE_END[];
+extern uint8_t __SRAM_SH_START[], __SRAM_SH_USED_END[], __SRAM_SH_SPARE_END[];
+extern uint8_t __INT_DTCM_START[], __DTCM_USED_END[], __DTCM_SPARE_END[];
+extern uint8_t __INT_ITCM_START[], __ITCM_USED_END[], __ITCM_SPARE_END[];
+
+// Cortex-M7 configuration and control register, data cache enable
+#define OSAL_RAM_SCB_CCR     (*(volatile uint32_t *)0xE000ED14UL)
+#define OSAL_RAM_CCR_DC      (1UL << 16)
+
+typedef struct {
+    uint8_t *start;
+    uint8_t *used_end;
+    uint8_t *spare_end;
+    uint8_t *boot_init;           // Linker flag telling whether RamInit covers this memory
+    bool cacheable;
+} osal_ram_region_t;
+
+static const osal_ram_region_t osal_ram_regions[OSAL_RAM_POOL_COUNT] = {
+    [OSAL_RAM_POOL_SRAM]    = { __INT_SRAM_START, __SRAM_USED_END, __SRAM_SPARE_END, __RAM_INIT, true },
+    [OSAL_RAM_POOL_SRAM_NC] = { __SRAM_NC_START, __SRAM_NC_USED_END, __SRAM_NC_SPARE_END, __RAM_INIT, false },
+    [OSAL_RAM_POOL_SRAM_SH] = { __SRAM_SH_START, __SRAM_SH_USED_END, __SRAM_SH_SPARE_END, __RAM_INIT, false },
+    [OSAL_RAM_POOL_DTCM]    = { __INT_DTCM_START, __DTCM_USED_END, __DTCM_SPARE_END, __DTCM_INIT, false },
+    [OSAL_RAM_POOL_ITCM]    = { __INT_ITCM_START, __ITCM_USED_END, __ITCM_SPARE_END, __ITCM_INIT, false },
+};
+
+static osal_ram_pool_info_t osal_ram_pools[OSAL_RAM_POOL_COUNT];
+
+static bool osal_ram_partial(void)
+{
+    return (uint32_t)__RAM_INIT_PARTIAL != 0U;
+}
+
+// The spare part still needs ECC initialization if startup skipped it. After a warm reset
+// startup skips RamInit altogether: ECC is intact but the pool holds the previous boot's
+// data, so zero it to keep the reads-as-zero contract.
+static bool osal_ram_needs_init(const osal_ram_region_t *r)
+{
+    return osal_ram_partial() || ((uint32_t)r->boot_init == 0U) || osal_reset_is_warm();
+}
+
+// Write zeros with 64-bit stores so every ECC granule is written whole
+static void osal_ram_ecc_fill(uint8_t *start, uint8_t *end)
+{
+    for (volatile uint64_t *p = (volatile uint64_t *)start; p < (volatile uint64_t *)end; p++) {
+        *p = 0U;
+    }
+}
+
+static void osal_ram_init_pool(const osal_ram_region_t *r, osal_ram_pool_info_t *info)
+{
+    uint32_t primask;
+    __asm volatile ("mrs %0, primask\n cpsid i" : "=r" (primask) :: "memory");
+
+    uint32_t enter = osal_utils_cycles();
+    bool dcache = r->cacheable && (osal_cache_dcache_enabled() != 0U);
+    if (dcache) {
+        // A write miss may allocate a line and read the not yet initialized memory, which
+        // raises an ECC error: fill with the D-cache off
+        osal_cache_flush_all();
+        OSAL_RAM_SCB_CCR &= ~OSAL_RAM_CCR_DC;
+        __asm volatile ("dsb\n isb" ::: "memory");
+    }
+
+    osal_ram_ecc_fill(r->used_end, r->spare_end);
+
+    if (dcache) {
+        osal_cache_invalidate_all();
+        OSAL_RAM_SCB_CCR |= OSAL_RAM_CCR_DC;
+        __asm volatile ("dsb\n isb" ::: "memory");
+    }
+    info->init_cycles = osal_utils_cycles() - enter;
+    info->ready = 1U;
+
+    __asm volatile ("msr primask, %0" :: "r" (primask) : "memory");
+}
+
+static void osal_ram_fill_info(osal_ram_pool_t pool, osal_ram_pool_info_t *info)
+{
+    const osal_ram_region_t *r = &osal_ram_regions[pool];
+
+    info->start = (uint32_t)r->used_end;
+    info->size = (r->spare_end > r->used_end) ? (uint32_t)(r->spare_end - r->used_end) : 0U;
+    if (!osal_ram_needs_init(r)) {
+        info->ready = 1U;
+    }
+}
+
+int32_t osal_ram_pool_get(osal_ram_pool_t pool, void **start, size_t *size)
+{
+    if ((uint32_t)pool >= (uint32_t)OSAL_RAM_POOL_COUNT) {
+        return -1;
+    }
+
+    osal_ram_pool_info_t *info = &osal_ram_pools[pool];
+    osal_ram_fill_info(pool, info);
+    if (info->size == 0U) {
+        return -2;
+    }
+    if (info->ready == 0U) {
+        osal_ram_init_pool(&osal_ram_regions[pool], info);
+    }
+
+    *start = (void *)info->start;
+    *size = info->size;
+    return 0;
+}
+
+void osal_ram_pool_info(osal_ram_pool_t pool, osal_ram_pool_info_t *info)
+{
+    if ((uint32_t)pool < (uint32_t)OSAL_RAM_POOL_COUNT) {
+        osal_ram_fill_info(pool, &osal_ram_pools[pool]);
+        *info = osal_ram_pools[pool];
+    }
+}
+
+void osal_ram_log(void)
+{
+    static const char *const names[OSAL_RAM_POOL_COUNT] = { "sram", "sram nc", "sram sh", "dtcm", "itcm" };
+    char log_buffer[LOG_BUFFER_SIZE];
+    uint32_t boot_bytes = 0U;
+
+    for (uint32_t i = 0U; (i < (uint32_t)OSAL_RAM_POOL_COUNT) && !osal_reset_is_warm(); i++) {
+        const osal_ram_region_t *r = &osal_ram_regions[i];
+        if ((uint32_t)r->boot_init == 0U) {
+            continue;
+        }
+        boot_bytes += osal_ram_partial() ? (uint32_t)(r->used_end - r->start) : (uint32_t)(r->spare_end - r->start);
+    }
+    snprintf(log_buffer, LOG_BUFFER_SIZE, "RAM ECC init: %s, %lu bytes at boot (plus fixed areas and stack)\r\n",
+             osal_reset_is_warm() ? "skipped (warm reset)" : (osal_ram_partial() ? "partial" : "full"),
+             (unsigned long)boot_bytes);
+    osal_log_info(log_buffer);
+
+    for (uint32_t i = 0U; i < (uint32_t)OSAL_RAM_POOL_COUNT; i++) {
+        osal_ram_pool_info_t info;
+        osal_ram_pool_info((osal_ram_pool_t)i, &info);
+        snprintf(log_buffer, LOG_BUFFER_SIZE, "RAM pool %-7s 0x%08lx %6lu bytes: %s, init %lu cycles\r\n",
+                 names[i], (unsigned long)info.start, (unsigned long)info.size,
+                 (info.ready != 0U) ? "ready" : "not initialized", (unsigned long)info.init_cycles);
+        osal_log_info(log_buffer);
+    }
+}
@@ -0,0 +1,196 @@
+#include "osal_reset.h"
+#include "osal_fault.h"
+#include "osal_log.h"
+#include "osal_utils.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "S32K312_MC_CGM.h"
+#include "S32K312_MC_ME.h"
+#include "S32K312_MC_RGM.h"
+#include "S32K312_PLL.h"
+
+#define MC_ME_KEY       0x5AF0UL
+#define MC_ME_INV_KEY   0xA50FUL
+// MC_CGM_0 MUX_0 source: PLL_PHI0
+#define MC_CGM_SRC_PLL_PHI0 8UL
+
+static osal_reset_info_t osal_reset;
+
+osal_reset_times_t osal_reset_times __attribute__((section(".noinit")));
+osal_reset_clocks_t osal_reset_clocks __attribute__((section(".noinit")));
+
+// Inverted XOR of the words before the check word
+static uint32_t osal_reset_sum(const void *record, size_t check_offset)
+{
+    const uint32_t *words = (const uint32_t *)record;
+    uint32_t sum = 0U;
+
+    for (size_t i = 0; i < (check_offset / sizeof(uint32_t)); i++) {
+        sum ^= words[i];
+    }
+    return ~sum;
+}
+
+static uint32_t osal_reset_times_sum(const osal_reset_times_t *t)
+{
+    return osal_reset_sum(t, offsetof(osal_reset_times_t, check));
+}
+
+// Clock tree registers set by Clock_Ip_Init() and relied on by the drivers initialized after it
+static void osal_reset_clocks_read(osal_reset_clocks_t *c)
+{
+    c->mux0_css = IP_MC_CGM->MUX_0_CSS;
+    c->mux0_dc[0] = IP_MC_CGM->MUX_0_DC_0;
+    c->mux0_dc[1] = IP_MC_CGM->MUX_0_DC_1;
+    c->mux0_dc[2] = IP_MC_CGM->MUX_0_DC_2;
+    c->mux0_dc[3] = IP_MC_CGM->MUX_0_DC_3;
+    c->mux0_dc[4] = IP_MC_CGM->MUX_0_DC_4;
+    c->mux0_dc[5] = IP_MC_CGM->MUX_0_DC_5;
+    c->mux0_dc[6] = IP_MC_CGM->MUX_0_DC_6;
+    c->cofb_stat[0] = IP_MC_ME->PRTN1_COFB0_STAT;
+    c->cofb_stat[1] = IP_MC_ME->PRTN1_COFB1_STAT;
+    c->cofb_stat[2] = IP_MC_ME->PRTN1_COFB2_STAT;
+    c->cofb_stat[3] = IP_MC_ME->PRTN1_COFB3_STAT;
+    c->cofb_stat[4] = IP_MC_ME->PRTN2_COFB0_STAT;
+    c->cofb_stat[5] = IP_MC_ME->PRTN2_COFB1_STAT;
+}
+
+void osal_reset_init(void)
+{
+    osal_reset.des = IP_MC_RGM->DES;
+    osal_reset.fes = IP_MC_RGM->FES;
+    osal_reset.warm = (osal_reset.des == 0U);
+    IP_MC_RGM->DES = osal_reset.des;
+    IP_MC_RGM->FES = osal_reset.fes;
+}
+
+bool osal_reset_is_warm(void)
+{
+    return osal_reset.warm;
+}
+
+bool osal_reset_clock_kept(void)
+{
+    const osal_reset_clocks_t *saved = &osal_reset_clocks;
+    osal_reset_clocks_t now;
+
+    osal_reset.clock_kept = false;
+    // A pending fault record may come from a boot that kept the clocks: take the full path
+    // rather than risk faulting in the same place again
+    if (!osal_reset.warm || osal_fault_pending() || ((IP_PLL->PLLSR & PLL_PLLSR_LOCK_MASK) == 0U) ||
+        (saved->magic != OSAL_RESET_CLOCKS_MAGIC) ||
+        (saved->check != osal_reset_sum(saved, offsetof(osal_reset_clocks_t, check)))) {
+        return false;
+    }
+    osal_reset_clocks_read(&now);
+    osal_reset.clock_kept =
+        (((now.mux0_css & MC_CGM_MUX_0_CSS_SELSTAT_MASK) >> MC_CGM_MUX_0_CSS_SELSTAT_SHIFT) == MC_CGM_SRC_PLL_PHI0) &&
+        (now.mux0_css == saved->mux0_css) && (memcmp(now.mux0_dc, saved->mux0_dc, sizeof(now.mux0_dc)) == 0) &&
+        (memcmp(now.cofb_stat, saved->cofb_stat, sizeof(now.cofb_stat)) == 0);
+    return osal_reset.clock_kept;
+}
+
+void osal_reset_mark_clock(void)
+{
+    osal_reset_clocks_t *c = &osal_reset_clocks;
+
+    osal_reset.clock_cycles = osal_utils_cycles();
+    if (!osal_reset.clock_kept) {
+        // Reference for the next warm boot: the state Clock_Ip_Init() just left
+        osal_reset_clocks_read(c);
+        c->magic = OSAL_RESET_CLOCKS_MAGIC;
+        c->check = osal_reset_sum(c, offsetof(osal_reset_clocks_t, check));
+    }
+}
+
+void osal_reset_mark_operational(void)
+{
+    osal_reset_times_t *t = &osal_reset_times;
+    uint32_t now = osal_utils_cycles();
+
+    // DWT counts from Reset_Handler entry; before the clock switch it ran on FIRC, unless
+    // the clocks were kept from the last boot
+    if (osal_reset.clock_kept) {
+        osal_reset.operational_us = osal_utils_cycles_to_us(now);
+    } else {
+        osal_reset.operational_us = (osal_reset.clock_cycles / OSAL_RESET_FIRC_MHZ) +
+                                    osal_utils_cycles_to_us(now - osal_reset.clock_cycles);
+    }
+
+    if ((t->magic != OSAL_RESET_TIMES_MAGIC) || (t->check != osal_reset_times_sum(t))) {
+        t->magic = OSAL_RESET_TIMES_MAGIC;
+        t->cold_us = 0U;
+        t->warm_us = 0U;
+        t->cold_boots = 0U;
+        t->warm_boots = 0U;
+    }
+    if (osal_reset.warm) {
+        t->warm_us = osal_reset.operational_us;
+        t->warm_boots++;
+    } else {
+        t->cold_us = osal_reset.operational_us;
+        t->cold_boots++;
+    }
+    t->check = osal_reset_times_sum(t);
+}
+
+void osal_reset_get_info(osal_reset_info_t *info)
+{
+    *info = osal_reset;
+}
+
+// Names of the bits set in a status register, comma separated
+static void osal_reset_names(uint32_t value, const char *const names[32], char *buf, size_t size)
+{
+    size_t len = 0U;
+
+    buf[0] = '\0';
+    for (uint32_t i = 0U; (i < 32U) && (len < size); i++) {
+        if ((value & (1UL << i)) != 0U) {
+            len += (size_t)snprintf(&buf[len], size - len, "%s%s", (len > 0U) ? "," : "",
+                                    (names[i] != NULL) ? names[i] : "?");
+        }
+    }
+}
+
+void osal_reset_log(void)
+{
+    static const char *const des_names[32] = {
+        [0] = "POR", [3] = "FCCU_FTR", [4] = "STCU_URF", [6] = "MC_RGM_FRE", [8] = "FXOSC_FAIL",
+        [9] = "PLL_LOL", [10] = "CORE_CLK_FAIL", [12] = "AIPS_PLAT_CLK_FAIL", [14] = "HSE_CLK_FAIL",
+        [15] = "SYS_DIV_FAIL", [16] = "CM7_CORE_CLK_FAIL", [17] = "HSE_TMPR_RST", [18] = "HSE_SNVS_RST",
+        [29] = "SW_DEST", [30] = "DEBUG_DEST",
+    };
+    static const char *const fes_names[32] = {
+        [0] = "EXR", [3] = "FCCU_RST", [4] = "ST_DONE", [6] = "SWT0", [7] = "JTAG", [16] = "HSE_SWT",
+        [20] = "HSE_BOOT", [29] = "SW_FUNC", [30] = "DEBUG_FUNC",
+    };
+    const osal_reset_times_t *t = &osal_reset_times;
+    char log_buffer[LOG_BUFFER_SIZE];
+    char des[64];
+    char fes[64];
+
+    osal_reset_names(osal_reset.des, des_names, des, sizeof(des));
+    osal_reset_names(osal_reset.fes, fes_names, fes, sizeof(fes));
+    snprintf(log_buffer, LOG_BUFFER_SIZE, "Reset %s: DES 0x%08lx [%s] FES 0x%08lx [%s], clocks %s\r\n",
+             osal_reset.warm ? "warm" : "cold", (unsigned long)osal_reset.des, des,
+             (unsigned long)osal_reset.fes, fes, osal_reset.clock_kept ? "kept" : "initialized");
+    osal_log_info(log_buffer);
+    snprintf(log_buffer, LOG_BUFFER_SIZE,
+             "  operational in %lu us; last cold %lu us, last warm %lu us (%lu cold, %lu warm boots)\r\n",
+             (unsigned long)osal_reset.operational_us, (unsigned long)t->cold_us, (unsigned long)t->warm_us,
+             (unsigned long)t->cold_boots, (unsigned long)t->warm_boots);
+    osal_log_info(log_buffer);
+}
+
+OSAL_FAST_CODE __attribute__((noreturn)) void osal_reset_functional(void)
+{
+    IP_MC_ME->MODE_CONF = MC_ME_MODE_CONF_FUNC_RST_MASK;
+    IP_MC_ME->MODE_UPD = MC_ME_MODE_UPD_MODE_UPD_MASK;
+    IP_MC_ME->CTL_KEY = MC_ME_KEY;
+    IP_MC_ME->CTL_KEY = MC_ME_INV_KEY;
+    for (;;) {
+    }
+}
@@ -0,0 +1,159 @@
+#include "osal_secboot.h"
+#include "osal_log.h"
+#include "osal_secboot_key.h"
+#include "osal_utils.h"
+#include "mbedtls/ecdsa.h"
+#include "mbedtls/ecp.h"
+#include "mbedtls/sha256.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+// Curve and public key, set up once. With MBEDTLS_ECP_FIXED_POINT_OPTIM the group caches
+// the comb table of the generator on the first verification, so later checks (update
+// candidates) skip that precomputation as well as the key decoding and validation.
+static mbedtls_ecp_group osal_secboot_grp;
+static mbedtls_ecp_point osal_secboot_q;
+static bool osal_secboot_key_ready;
+
+static int32_t osal_secboot_key_setup(void)
+{
+    if (osal_secboot_key_ready) {
+        return 0;
+    }
+    mbedtls_ecp_group_init(&osal_secboot_grp);
+    mbedtls_ecp_point_init(&osal_secboot_q);
+    if ((mbedtls_ecp_group_load(&osal_secboot_grp, MBEDTLS_ECP_DP_SECP256R1) != 0) ||
+        (mbedtls_ecp_point_read_binary(&osal_secboot_grp, &osal_secboot_q, osal_secboot_pubkey,
+                                       sizeof(osal_secboot_pubkey)) != 0) ||
+        (mbedtls_ecp_check_pubkey(&osal_secboot_grp, &osal_secboot_q) != 0)) {
+        mbedtls_ecp_point_free(&osal_secboot_q);
+        mbedtls_ecp_group_free(&osal_secboot_grp);
+        return -5;
+    }
+    osal_secboot_key_ready = true;
+    return 0;
+}
+
+static int32_t osal_secboot_hash_range(mbedtls_sha256_context *sha, uintptr_t start, uintptr_t end)
+{
+    while (start < end) {
+        size_t n = ((end - start) > OSAL_SECBOOT_HASH_CHUNK) ? OSAL_SECBOOT_HASH_CHUNK : (size_t)(end - start);
+        if (mbedtls_sha256_update(sha, (const unsigned char *)start, n) != 0) {
+            return -5;
+        }
+        start += n;
+    }
+    return 0;
+}
+
+// SHA-256 over the image range, the metadata block cut out (same range as the CRC)
+static int32_t osal_secboot_hash_image(const app_metadata_t *meta, uint8_t digest[APP_DIGEST_LEN])
+{
+    uintptr_t start = meta->flash_start_addr;
+    uintptr_t end = start + meta->image_size;
+    uintptr_t meta_start = (uintptr_t)meta;
+    uintptr_t meta_end = meta_start + sizeof(*meta);
+    mbedtls_sha256_context sha;
+    int32_t ret;
+
+    mbedtls_sha256_init(&sha);
+    ret = (mbedtls_sha256_starts(&sha, 0) == 0) ? 0 : -5;
+    if ((meta_end <= start) || (meta_start >= end)) {
+        ret = (ret == 0) ? osal_secboot_hash_range(&sha, start, end) : ret;
+    } else {
+        if ((ret == 0) && (meta_start > start)) {
+            ret = osal_secboot_hash_range(&sha, start, meta_start);
+        }
+        if ((ret == 0) && (meta_end < end)) {
+            ret = osal_secboot_hash_range(&sha, meta_end, end);
+        }
+    }
+    if ((ret == 0) && (mbedtls_sha256_finish(&sha, digest) != 0)) {
+        ret = -5;
+    }
+    mbedtls_sha256_free(&sha);
+    return ret;
+}
+
+static int32_t osal_secboot_check_signature(const app_metadata_t *meta)
+{
+    uint8_t hash[APP_DIGEST_LEN];
+    mbedtls_mpi r, s;
+    int32_t ret = -3;
+
+    if (mbedtls_sha256((const unsigned char *)meta, APP_METADATA_SIGNED_LEN, hash, 0) != 0) {
+        return -5;
+    }
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+    if ((mbedtls_mpi_read_binary(&r, meta->signature, APP_SIGNATURE_LEN / 2U) == 0) &&
+        (mbedtls_mpi_read_binary(&s, &meta->signature[APP_SIGNATURE_LEN / 2U], APP_SIGNATURE_LEN / 2U) == 0)) {
+        int err = mbedtls_ecdsa_verify(&osal_secboot_grp, hash, sizeof(hash), &osal_secboot_q, &r, &s);
+        if (err == 0) {
+            ret = 0;
+        } else if (err == MBEDTLS_ERR_ECP_ALLOC_FAILED) {
+            ret = -5;
+        }
+    }
+    mbedtls_mpi_free(&r);
+    mbedtls_mpi_free(&s);
+    return ret;
+}
+
+int32_t osal_secboot_verify(const app_metadata_t *meta, osal_secboot_report_t *report)
+{
+    osal_secboot_report_t result = { 0 };
+    uint8_t digest[APP_DIGEST_LEN];
+    uint32_t enter;
+
+    osal_utils_cycles_init();
+    if ((meta->magic != APP_METADATA_MAGIC) || (meta->image_size == 0U) ||
+        (meta->flash_start_addr < OSAL_IMAGE_PFLASH_START) ||
+        (meta->image_size > (OSAL_IMAGE_PFLASH_END - meta->flash_start_addr))) {
+        result.status = -1;
+    } else if (OSAL_SECBOOT_KEY_PROVISIONED == 0) {
+        result.status = -4;
+    } else {
+        enter = osal_utils_cycles();
+        result.status = osal_secboot_hash_image(meta, digest);
+        result.hash_cycles = osal_utils_cycles() - enter;
+        result.bytes = meta->image_size;
+        if ((result.status == 0) && (memcmp(digest, meta->sha256, APP_DIGEST_LEN) != 0)) {
+            result.status = -2;
+        }
+
+        if (result.status == 0) {
+            enter = osal_utils_cycles();
+            result.status = osal_secboot_key_setup();
+            result.key_cycles = osal_utils_cycles() - enter;
+        }
+        if (result.status == 0) {
+            enter = osal_utils_cycles();
+            result.status = osal_secboot_check_signature(meta);
+            result.verify_cycles = osal_utils_cycles() - enter;
+        }
+    }
+
+    if (report != NULL) {
+        *report = result;
+    }
+    return result.status;
+}
+
+void osal_secboot_log(const osal_secboot_report_t *report)
+{
+    static const char *const results[] = {
+        "ok", "bad metadata", "digest mismatch", "bad signature", "no key provisioned", "crypto error"
+    };
+    char log_buffer[LOG_BUFFER_SIZE];
+    uint32_t index = (report->status < 0) ? (uint32_t)(-report->status) : 0U;
+
+    snprintf(log_buffer, LOG_BUFFER_SIZE,
+             "Secure boot: %s, SHA-256 %lu bytes %lu us, key setup %lu us, ECDSA verify %lu us\r\n",
+             (index < 6U) ? results[index] : "?", (unsigned long)report->bytes,
+             (unsigned long)osal_utils_cycles_to_us(report->hash_cycles),
+             (unsigned long)osal_utils_cycles_to_us(report->key_cycles),
+             (unsigned long)osal_utils_cycles_to_us(report->verify_cycles));
+    osal_log_info(log_buffer);
+}
@@ -0,0 +1,344 @@
+#include "osal_slot.h"
+#include "osal_crc32.h"
+#include <stddef.h>
+#include <string.h>
+#ifndef __linux__
+#include "osal_cache.h"
+#include "osal_log.h"
+#include "osal_secboot.h"
+#include "osal_utils.h"
+#include <stdio.h>
+#endif
+
+// app_metadata_t field offsets; decoded by offset because the struct holds a pointer and
+// is only laid out like flash on the 32-bit target
+#define SLOT_OFF_MAGIC 0x00U
+#define SLOT_OFF_FLASH_START 0x24U
+#define SLOT_OFF_IMAGE_SIZE 0x28U
+#define SLOT_OFF_CRC32 0x2CU
+#define SLOT_OFF_SEQUENCE 0x30U
+#define SLOT_OFF_VERSION_CODE 0x34U
+#define SLOT_HEADER_LEN 0x38U
+
+#ifndef __linux__
+_Static_assert(offsetof(app_metadata_t, flash_start_addr) == SLOT_OFF_FLASH_START, "app_metadata_t layout");
+_Static_assert(offsetof(app_metadata_t, crc32) == SLOT_OFF_CRC32, "app_metadata_t layout");
+_Static_assert(offsetof(app_metadata_t, version_code) == SLOT_OFF_VERSION_CODE, "app_metadata_t layout");
+_Static_assert(sizeof(app_metadata_t) == APP_METADATA_SIZE, "app_metadata_t layout");
+#endif
+
+// Bytes of flash CRC'd per read through the dump backend
+#define SLOT_CRC_CHUNK 256U
+
+const osal_slot_layout_t osal_slot_layout[OSAL_SLOT_COUNT] = {
+    { OSAL_SLOT_A_BASE, OSAL_SLOT_A_METADATA },
+    { OSAL_SLOT_B_BASE, OSAL_SLOT_B_METADATA },
+};
+
+static uint32_t osal_slot_get32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// True if sequence a is newer than b, across the 32-bit wrap
+static int osal_slot_newer(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) > 0;
+}
+
+static uint32_t osal_slot_cache_sum(const osal_slot_cache_t *cache)
+{
+    const uint32_t *words = (const uint32_t *)cache;
+    uint32_t sum = 0U;
+
+    for (size_t i = 0; i < (offsetof(osal_slot_cache_t, check) / sizeof(uint32_t)); i++) {
+        sum ^= words[i];
+    }
+    return ~sum;
+}
+
+static void osal_slot_cache_validate(osal_slot_cache_t *cache)
+{
+    if ((cache->magic != OSAL_SLOT_CACHE_MAGIC) || (cache->check != osal_slot_cache_sum(cache))) {
+        memset(cache, 0, sizeof(*cache));
+        cache->magic = OSAL_SLOT_CACHE_MAGIC;
+        cache->check = osal_slot_cache_sum(cache);
+    }
+}
+
+// Cached verdict for the image described by hdr, or OSAL_SLOT_UNCHECKED
+static int32_t osal_slot_cache_lookup(const osal_slot_cache_t *cache, uint32_t slot, const osal_slot_header_t *hdr)
+{
+    const osal_slot_verdict_t *v = &cache->slot[slot];
+
+    if ((v->sequence == hdr->sequence) && (v->crc32 == hdr->crc32) && (v->image_size == hdr->image_size) &&
+        ((v->status == OSAL_SLOT_VALID) || (v->status == OSAL_SLOT_BAD_IMAGE))) {
+        return v->status;
+    }
+    return OSAL_SLOT_UNCHECKED;
+}
+
+void osal_slot_cache_store(osal_slot_cache_t *cache, uint32_t slot, const osal_slot_header_t *hdr, int32_t status)
+{
+    osal_slot_cache_validate(cache);
+    cache->slot[slot].sequence = hdr->sequence;
+    cache->slot[slot].crc32 = hdr->crc32;
+    cache->slot[slot].image_size = hdr->image_size;
+    cache->slot[slot].status = status;
+    cache->check = osal_slot_cache_sum(cache);
+}
+
+int32_t osal_slot_read_header(const osal_slot_flash_t *flash, uint32_t slot, osal_slot_header_t *hdr)
+{
+    uint8_t raw[SLOT_HEADER_LEN];
+    uint32_t base = osal_slot_layout[slot].base;
+
+    memset(hdr, 0, sizeof(*hdr));
+    if (flash->read(flash->ctx, osal_slot_layout[slot].metadata, raw, SLOT_HEADER_LEN) != 0) {
+        return OSAL_SLOT_EMPTY;
+    }
+    hdr->magic = osal_slot_get32(&raw[SLOT_OFF_MAGIC]);
+    hdr->flash_start_addr = osal_slot_get32(&raw[SLOT_OFF_FLASH_START]);
+    hdr->image_size = osal_slot_get32(&raw[SLOT_OFF_IMAGE_SIZE]);
+    hdr->crc32 = osal_slot_get32(&raw[SLOT_OFF_CRC32]);
+    hdr->sequence = osal_slot_get32(&raw[SLOT_OFF_SEQUENCE]);
+    hdr->version_code = osal_slot_get32(&raw[SLOT_OFF_VERSION_CODE]);
+
+    if (hdr->magic != APP_METADATA_MAGIC) {
+        return OSAL_SLOT_EMPTY;
+    }
+    // An image linked for the other slot cannot run here
+    if ((hdr->flash_start_addr != base) || (hdr->image_size == 0U) || (hdr->image_size > OSAL_SLOT_SIZE) ||
+        (hdr->crc32 == 0U)) {
+        return OSAL_SLOT_BAD_HEADER;
+    }
+    return OSAL_SLOT_UNCHECKED;
+}
+
+int32_t osal_slot_select(const osal_slot_flash_t *flash, osal_slot_cache_t *cache, osal_slot_selection_t *sel)
+{
+    uint32_t order[OSAL_SLOT_COUNT];
+
+    memset(sel, 0, sizeof(*sel));
+    sel->selected = -1;
+    if (cache != NULL) {
+        osal_slot_cache_validate(cache);
+    }
+    for (uint32_t slot = 0U; slot < OSAL_SLOT_COUNT; slot++) {
+        sel->status[slot] = osal_slot_read_header(flash, slot, &sel->hdr[slot]);
+        order[slot] = slot;
+    }
+    // Newest first; on equal sequence numbers slot A wins
+    if ((sel->status[1] == OSAL_SLOT_UNCHECKED) &&
+        ((sel->status[0] != OSAL_SLOT_UNCHECKED) || osal_slot_newer(sel->hdr[1].sequence, sel->hdr[0].sequence))) {
+        order[0] = 1U;
+        order[1] = 0U;
+    }
+
+    for (uint32_t i = 0U; i < OSAL_SLOT_COUNT; i++) {
+        uint32_t slot = order[i];
+        int32_t status;
+
+        if (sel->status[slot] != OSAL_SLOT_UNCHECKED) {
+            continue;
+        }
+        status = (cache != NULL) ? osal_slot_cache_lookup(cache, slot, &sel->hdr[slot]) : OSAL_SLOT_UNCHECKED;
+        if (status != OSAL_SLOT_UNCHECKED) {
+            sel->cached |= 1UL << slot;
+        } else {
+            status = (flash->verify(flash->ctx, slot, &sel->hdr[slot]) == 0) ? OSAL_SLOT_VALID : OSAL_SLOT_BAD_IMAGE;
+            sel->verified++;
+            if (cache != NULL) {
+                osal_slot_cache_store(cache, slot, &sel->hdr[slot], status);
+            }
+        }
+        sel->status[slot] = status;
+        if (status == OSAL_SLOT_VALID) {
+            sel->selected = (int32_t)slot;
+            break;
+        }
+    }
+    return sel->selected;
+}
+
+int32_t osal_slot_of(uint32_t addr)
+{
+    for (uint32_t slot = 0U; slot < OSAL_SLOT_COUNT; slot++) {
+        if (((addr - osal_slot_layout[slot].base) < OSAL_SLOT_SIZE) ||
+            ((addr - osal_slot_layout[slot].metadata) < OSAL_SLOT_METADATA_SECTOR)) {
+            return (int32_t)slot;
+        }
+    }
+    return -1;
+}
+
+static int32_t osal_slot_image_read(void *ctx, uint32_t addr, void *buf, uint32_t len)
+{
+    const osal_slot_image_t *image = (const osal_slot_image_t *)ctx;
+
+    if ((addr < image->base) || ((addr - image->base) > image->size) || (len > (image->size - (addr - image->base)))) {
+        return -1;
+    }
+    memcpy(buf, &image->data[addr - image->base], len);
+    return 0;
+}
+
+// CRC-32 over the slot's image as osal_image_verify() computes it; bytes beyond the end
+// of the dump read as erased flash
+static int32_t osal_slot_image_verify(void *ctx, uint32_t slot, const osal_slot_header_t *hdr)
+{
+    const osal_slot_image_t *image = (const osal_slot_image_t *)ctx;
+    uint8_t chunk[SLOT_CRC_CHUNK];
+    uint32_t addr = hdr->flash_start_addr;
+    uint32_t end = addr + hdr->image_size;
+    uint32_t crc = 0U;
+
+    (void)slot;
+    while (addr < end) {
+        uint32_t n = ((end - addr) > SLOT_CRC_CHUNK) ? SLOT_CRC_CHUNK : (end - addr);
+        uint32_t lo = (addr > image->base) ? addr : image->base;
+        uint32_t hi = ((addr + n) < (image->base + image->size)) ? (addr + n) : (image->base + image->size);
+
+        memset(chunk, 0xFF, n);
+        if (lo < hi) {
+            memcpy(&chunk[lo - addr], &image->data[lo - image->base], hi - lo);
+        }
+        crc = osal_crc32_update(crc, chunk, n);
+        addr += n;
+    }
+    return (crc == hdr->crc32) ? 0 : -1;
+}
+
+void osal_slot_flash_image(osal_slot_flash_t *flash, osal_slot_image_t *image)
+{
+    flash->read = osal_slot_image_read;
+    flash->verify = osal_slot_image_verify;
+    flash->ctx = image;
+}
+
+#ifndef __linux__
+// Core registers the slot jump puts back to their reset state
+#define SCB_VTOR     (*(volatile uint32_t *)0xE000ED08UL)
+#define SYST_CSR     (*(volatile uint32_t *)0xE000E010UL)
+#define MPU_CTRL     (*(volatile uint32_t *)0xE000ED94UL)
+#define NVIC_ICER(n) (*(volatile uint32_t *)(0xE000E180UL + ((n) * 4UL)))
+#define NVIC_ICPR(n) (*(volatile uint32_t *)(0xE000E280UL + ((n) * 4UL)))
+#define NVIC_WORDS   8U
+// Where an initial stack pointer may point: DTCM or SRAM
+#define SLOT_RAM_START 0x20000000UL
+#define SLOT_RAM_END   0x20418000UL
+
+// Survives warm resets; validated by magic and check word on first use
+osal_slot_cache_t osal_slot_cache __attribute__((section(".noinit")));
+
+static int32_t osal_slot_mem_read(void *ctx, uint32_t addr, void *buf, uint32_t len)
+{
+    (void)ctx;
+    if ((addr < OSAL_IMAGE_PFLASH_START) || (len > (OSAL_IMAGE_PFLASH_END - addr))) {
+        return -1;
+    }
+    memcpy(buf, (const void *)(uintptr_t)addr, len);
+    return 0;
+}
+
+static int32_t osal_slot_mem_verify(void *ctx, uint32_t slot, const osal_slot_header_t *hdr)
+{
+    const app_metadata_t *meta = (const app_metadata_t *)(uintptr_t)osal_slot_layout[slot].metadata;
+
+    (void)ctx;
+    (void)hdr;
+    if (osal_image_verify(meta, NULL) != 0) {
+        return -1;
+    }
+    // -4: no key provisioned, the CRC is all there is to check
+    int32_t ret = osal_secboot_verify(meta, NULL);
+    return ((ret == 0) || (ret == -4)) ? 0 : -1;
+}
+
+const osal_slot_flash_t osal_slot_flash = { osal_slot_mem_read, osal_slot_mem_verify, NULL };
+
+void osal_slot_note_running(int32_t status)
+{
+    osal_slot_header_t hdr;
+    int32_t slot = osal_slot_of((uint32_t)(uintptr_t)&app_metadata);
+
+    if ((slot >= 0) && (osal_slot_read_header(&osal_slot_flash, (uint32_t)slot, &hdr) == OSAL_SLOT_UNCHECKED)) {
+        osal_slot_cache_store(&osal_slot_cache, (uint32_t)slot, &hdr,
+                              (status == 0) ? OSAL_SLOT_VALID : OSAL_SLOT_BAD_IMAGE);
+    }
+}
+
+int32_t osal_slot_boot_select(void)
+{
+    static const char *const states[] = { "valid", "empty", "bad header", "bad image" };
+    char log_buffer[LOG_BUFFER_SIZE];
+    osal_slot_selection_t sel;
+    int32_t running = osal_slot_of((uint32_t)(uintptr_t)&app_metadata);
+
+    osal_utils_cycles_init();
+    uint32_t enter = osal_utils_cycles();
+    (void)osal_slot_select(&osal_slot_flash, &osal_slot_cache, &sel);
+    sel.cycles = osal_utils_cycles() - enter;
+
+    for (uint32_t slot = 0U; slot < OSAL_SLOT_COUNT; slot++) {
+        int32_t status = sel.status[slot];
+        uint32_t version = sel.hdr[slot].version_code;
+
+        snprintf(log_buffer, LOG_BUFFER_SIZE,
+                 "Slot %c @0x%08lx: %s, seq %lu, v%lu.%lu.%lu%s\r\n", (int)('A' + slot),
+                 (unsigned long)osal_slot_layout[slot].base,
+                 (status == OSAL_SLOT_UNCHECKED) ? "not checked" :
+                 ((status <= 0) && (status >= OSAL_SLOT_BAD_IMAGE)) ? states[-status] : "?",
+                 (unsigned long)sel.hdr[slot].sequence, (unsigned long)(version >> 16),
+                 (unsigned long)((version >> 8) & 0xFFU), (unsigned long)(version & 0xFFU),
+                 ((sel.cached & (1UL << slot)) != 0U) ? " (cached)" : "");
+        osal_log_info(log_buffer);
+    }
+    snprintf(log_buffer, LOG_BUFFER_SIZE,
+             "Slot select: %c, running %c, %lu image(s) hashed in %lu us\r\n",
+             (sel.selected >= 0) ? (int)('A' + sel.selected) : '-',
+             (running >= 0) ? (int)('A' + running) : '-',
+             (unsigned long)sel.verified, (unsigned long)osal_utils_cycles_to_us(sel.cycles));
+    osal_log_info(log_buffer);
+    return sel.selected;
+}
+int32_t osal_slot_jump(uint32_t slot)
+{
+    if (slot >= OSAL_SLOT_COUNT) {
+        return -1;
+    }
+    const osal_slot_layout_t *layout = &osal_slot_layout[slot];
+    const uint32_t *ivt = (const uint32_t *)(uintptr_t)layout->base;
+    uint32_t vtor = ivt[OSAL_SLOT_IVT_CM7_0_VTOR / sizeof(uint32_t)];
+
+    if ((ivt[0] != OSAL_SLOT_IVT_MARKER) || ((vtor - layout->base) >= OSAL_SLOT_SIZE) || ((vtor & 0x7FUL) != 0U)) {
+        return -1;
+    }
+    const uint32_t *vectors = (const uint32_t *)(uintptr_t)vtor;
+    uint32_t msp = vectors[0];
+    uint32_t entry = vectors[1];
+    if ((msp <= SLOT_RAM_START) || (msp > SLOT_RAM_END) || ((entry & 1U) == 0U) ||
+        (((entry & ~1UL) - layout->base) >= OSAL_SLOT_SIZE)) {
+        return -1;
+    }
+
+    __asm volatile ("cpsid i" ::: "memory");
+    SYST_CSR = 0U;
+    for (uint32_t i = 0U; i < NVIC_WORDS; i++) {
+        NVIC_ICER(i) = 0xFFFFFFFFUL;
+        NVIC_ICPR(i) = 0xFFFFFFFFUL;
+    }
+    osal_cache_flush_all();
+    MPU_CTRL = 0U;
+    SCB_VTOR = vtor;
+    __asm volatile ("dsb\n isb" ::: "memory");
+    // Privileged thread mode on MSP with no FP context, interrupts enabled: the reset state
+    __asm volatile ("msr msp, %0\n"
+                    "msr control, %2\n"
+                    "isb\n"
+                    "cpsie i\n"
+                    "bx %1" :: "r" (msp), "r" (entry), "r" (0U) : "memory");
+    for (;;) {
+    }
+}
+#endif
@@ -0,0 +1,65 @@
+#include "osal_stack.h"
+#include "osal_log.h"
+#include "osal_mpu.h"
+#include <stdio.h>
+
+// Main stack (int_stack_dtcm): grows down from __Stack_dtcm_start to __Stack_dtcm_end
+extern uint32_t __Stack_dtcm_end[];
+extern uint32_t __Stack_dtcm_start[];
+
+void osal_stack_paint(uint32_t *base, size_t size)
+{
+    for (size_t i = 0U; i < (size / sizeof(uint32_t)); i++) {
+        base[i] = OSAL_STACK_PAINT;
+    }
+}
+
+size_t osal_stack_used(const uint32_t *base, size_t size)
+{
+    size_t words = size / sizeof(uint32_t);
+    size_t i = 0U;
+
+    while ((i < words) && (base[i] == OSAL_STACK_PAINT)) {
+        i++;
+    }
+    return (words - i) * sizeof(uint32_t);
+}
+
+void osal_stack_init(void)
+{
+    uint32_t *base = __Stack_dtcm_end;
+    uint32_t *sp;
+
+    __asm volatile ("mov %0, sp" : "=r" (sp));
+    // Everything below this function's frame is free, except what osal_stack_paint() itself
+    // uses: stop a margin short of it. The guard itself is never read.
+    base += OSAL_STACK_GUARD_SIZE / sizeof(uint32_t);
+    osal_stack_paint(base, (size_t)((uint8_t *)sp - (uint8_t *)base) - OSAL_STACK_PAINT_MARGIN);
+
+    osal_mpu_region_t guard;
+    if (osal_mpu_region_init(&guard, (uint32_t)__Stack_dtcm_end, OSAL_STACK_GUARD_SIZE, OSAL_MPU_ATTR_NO_ACCESS) == 0) {
+        (void)osal_mpu_set_region(OSAL_MPU_REGION_STACK_GUARD, &guard);
+    }
+}
+
+size_t osal_stack_main_size(void)
+{
+    return (size_t)((uint8_t *)__Stack_dtcm_start - (uint8_t *)__Stack_dtcm_end);
+}
+
+size_t osal_stack_main_used(void)
+{
+    return osal_stack_used(&__Stack_dtcm_end[OSAL_STACK_GUARD_SIZE / sizeof(uint32_t)],
+                           osal_stack_main_size() - OSAL_STACK_GUARD_SIZE);
+}
+
+void osal_stack_log(void)
+{
+    char log_buffer[LOG_BUFFER_SIZE];
+    size_t size = osal_stack_main_size() - OSAL_STACK_GUARD_SIZE;
+    size_t used = osal_stack_main_used();
+
+    snprintf(log_buffer, LOG_BUFFER_SIZE, "Stack main: %lu of %lu bytes used at peak, %lu free\r\n",
+             (unsigned long)used, (unsigned long)size, (unsigned long)((used < size) ? (size - used) : 0U));
+    osal_log_info(log_buffer);
+}
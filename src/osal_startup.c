@@ -0,0 +1,43 @@
+#include "osal_startup.h"
+#include "osal_log.h"
+#include <stdio.h>
+
+static void osal_startup_log_sections(const char *what, const osal_startup_section_t *sec, uint32_t count)
+{
+    char log_buffer[LOG_BUFFER_SIZE];
+
+    for (uint32_t i = 0U; (i < count) && (i < OSAL_STARTUP_MAX_SECTIONS); i++) {
+        if (sec[i].size == 0U) {
+            continue;
+        }
+        // Bytes per cycle in hundredths
+        uint32_t rate = (sec[i].cycles != 0U) ? ((sec[i].size * 100U) / sec[i].cycles) : 0U;
+        int len = snprintf(log_buffer, LOG_BUFFER_SIZE, "Startup %s 0x%08lx %lu bytes: %lu cycles (%lu.%02lu B/cycle)",
+                           what, (unsigned long)sec[i].addr, (unsigned long)sec[i].size,
+                           (unsigned long)sec[i].cycles, (unsigned long)(rate / 100U), (unsigned long)(rate % 100U));
+        if ((len > 0) && ((size_t)len < LOG_BUFFER_SIZE)) {
+            if ((sec[i].rom_size != 0U) && (sec[i].rom_size != sec[i].size)) {
+                snprintf(&log_buffer[len], LOG_BUFFER_SIZE - (size_t)len, ", LZ4 from %lu flash bytes\r\n",
+                         (unsigned long)sec[i].rom_size);
+            } else {
+                snprintf(&log_buffer[len], LOG_BUFFER_SIZE - (size_t)len, "\r\n");
+            }
+        }
+        osal_log_info(log_buffer);
+    }
+}
+
+void osal_startup_log_stats(void)
+{
+    char log_buffer[LOG_BUFFER_SIZE];
+    const osal_startup_stats_t *s = &osal_startup_stats;
+
+    if (s->magic != OSAL_STARTUP_STATS_MAGIC) {
+        osal_log_info("Startup stats not available\r\n");
+        return;
+    }
+    osal_startup_log_sections("copy", s->copy, s->copy_count);
+    osal_startup_log_sections("zero", s->zero, s->zero_count);
+    snprintf(log_buffer, LOG_BUFFER_SIZE, "Startup init_data_bss %lu cycles\r\n", (unsigned long)s->init_cycles);
+    osal_log_info(log_buffer);
+}
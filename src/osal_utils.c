@@ -21,10 +21,6 @@ size_t osal_utils_uint8_array_to_hex(const uint8_t *data, size_t length, char *o
     return pos;
 }
 
-// Define core clock frequency (Hz)
-// Adjust based on your S32K312 clock configuration (e.g., 120000000 for 120 MHz, 30000000 for 30 MHz)
-#define CORE_CLOCK_HZ 120000000UL // Default: 120 MHz, change to 30000000UL if confirmed 30 MHz
-
 /**
  * Delay for a specified number of microseconds using a loop.
  * Tuned for S32K312 with a configurable core clock (default 120 MHz).
@@ -66,3 +62,14 @@ void osal_utils_delay_ms(size_t ms)
         osal_utils_delay_us(1000); // 1 ms = 1000 µs
     }
 }
+
+void osal_utils_cycles_init(void)
+{
+    if ((OSAL_UTILS_DWT_CTRL & OSAL_UTILS_DWT_CTRL_CYCCNTENA) != 0U) {
+        return; // Already running (e.g. enabled by the startup code)
+    }
+    OSAL_UTILS_DEMCR |= OSAL_UTILS_DEMCR_TRCENA;
+    OSAL_UTILS_DWT_LAR = 0xC5ACCE55UL; // Unlock DWT in case the debug lock is set
+    OSAL_UTILS_DWT_CYCCNT = 0U;
+    OSAL_UTILS_DWT_CTRL |= OSAL_UTILS_DWT_CTRL_CYCCNTENA;
+}
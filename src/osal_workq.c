@@ -0,0 +1,210 @@
+#include "osal_workq.h"
+#include "osal_log.h"
+#include "osal_utils.h"
+#include "IntCtrl_Ip.h"
+#include <stdio.h>
+#include <string.h>
+
+// NVIC software trigger interrupt register
+#define NVIC_STIR (*(volatile uint32_t *)0xE000EF00UL)
+
+#define OSAL_WORKQ_MASK (OSAL_WORKQ_DEPTH - 1U)
+
+// Bounded multi-producer/single-consumer ring. Each cell carries a sequence number so
+// producers claim slots with a single compare-and-swap (LDREX/STREX) and publish them
+// independently; an ISR preempting another producer never blocks.
+typedef struct {
+    volatile uint32_t seq;
+    osal_work_fn_t fn;
+    void *arg;
+    uint32_t stamp;
+} osal_workq_cell_t;
+
+typedef struct {
+    osal_workq_cell_t cells[OSAL_WORKQ_DEPTH];
+    volatile uint32_t enqueue_pos;
+    uint32_t dequeue_pos;            // Only touched by the drain interrupt
+    osal_workq_queue_stats_t stats;
+} osal_workq_t;
+
+static osal_workq_t osal_workq_queues[OSAL_WORKQ_PRIO_COUNT] OSAL_FAST_DATA;
+static osal_workq_source_stats_t osal_workq_sources[OSAL_WORKQ_MAX_SOURCES];
+
+static void osal_workq_irq_handler(void);
+
+void osal_workq_init(void)
+{
+    memset(osal_workq_queues, 0, sizeof(osal_workq_queues));
+    for (uint32_t p = 0U; p < (uint32_t)OSAL_WORKQ_PRIO_COUNT; p++) {
+        for (uint32_t i = 0U; i < OSAL_WORKQ_DEPTH; i++) {
+            osal_workq_queues[p].cells[i].seq = i;
+        }
+    }
+
+    osal_utils_cycles_init();
+    IntCtrl_Ip_InstallHandler(OSAL_WORKQ_IRQ, osal_workq_irq_handler, NULL_PTR);
+    IntCtrl_Ip_SetPriority(OSAL_WORKQ_IRQ, OSAL_WORKQ_IRQ_PRIORITY);
+    IntCtrl_Ip_EnableIrq(OSAL_WORKQ_IRQ);
+}
+
+OSAL_FAST_CODE int32_t osal_workq_post(osal_workq_prio_t prio, osal_work_fn_t fn, void *arg)
+{
+    if ((fn == NULL) || ((uint32_t)prio >= (uint32_t)OSAL_WORKQ_PRIO_COUNT)) {
+        return -1;
+    }
+
+    osal_workq_t *q = &osal_workq_queues[prio];
+    uint32_t pos = __atomic_load_n(&q->enqueue_pos, __ATOMIC_RELAXED);
+    osal_workq_cell_t *cell;
+
+    while (1) {
+        cell = &q->cells[pos & OSAL_WORKQ_MASK];
+        int32_t diff = (int32_t)(__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&q->enqueue_pos, &pos, pos + 1U, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break; // Slot claimed
+            }
+            // pos was reloaded by the failed CAS
+        } else if (diff < 0) {
+            __atomic_fetch_add(&q->stats.dropped, 1U, __ATOMIC_RELAXED);
+            return -2; // Full
+        } else {
+            pos = __atomic_load_n(&q->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    cell->fn = fn;
+    cell->arg = arg;
+    cell->stamp = osal_utils_cycles();
+    __atomic_store_n(&cell->seq, pos + 1U, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&q->stats.posted, 1U, __ATOMIC_RELAXED);
+
+    // Tail-chains once the posting ISR (and anything above the drain priority) returns
+    NVIC_STIR = (uint32_t)OSAL_WORKQ_IRQ;
+    return 0;
+}
+
+// Run the oldest item of one queue. Returns true if an item was run.
+static bool osal_workq_drain_one(osal_workq_t *q)
+{
+    uint32_t pos = q->dequeue_pos;
+    osal_workq_cell_t *cell = &q->cells[pos & OSAL_WORKQ_MASK];
+
+    if (__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) != (pos + 1U)) {
+        return false; // Empty, or the producer has not published yet (it will re-pend us)
+    }
+
+    uint32_t depth = __atomic_load_n(&q->enqueue_pos, __ATOMIC_RELAXED) - pos;
+    if (depth > q->stats.depth_max) {
+        q->stats.depth_max = depth;
+    }
+
+    osal_work_fn_t fn = cell->fn;
+    void *arg = cell->arg;
+    uint32_t latency = osal_utils_cycles() - cell->stamp;
+    if (latency > q->stats.latency_max) {
+        q->stats.latency_max = latency;
+    }
+
+    __atomic_store_n(&cell->seq, pos + OSAL_WORKQ_DEPTH, __ATOMIC_RELEASE);
+    q->dequeue_pos = pos + 1U;
+
+    fn(arg);
+    q->stats.executed++;
+    return true;
+}
+
+// Run everything pending, high priority queue first
+OSAL_FAST_CODE static void osal_workq_irq_handler(void)
+{
+    bool ran;
+
+    do {
+        ran = false;
+        for (int32_t p = (int32_t)OSAL_WORKQ_PRIO_COUNT - 1; p >= 0; p--) {
+            if (osal_workq_drain_one(&osal_workq_queues[p])) {
+                ran = true;
+                break; // Re-check higher priorities after every item
+            }
+        }
+    } while (ran);
+}
+
+void osal_workq_set_source_name(uint8_t source, const char *name)
+{
+    if (source < OSAL_WORKQ_MAX_SOURCES) {
+        osal_workq_sources[source].name = name;
+    }
+}
+
+uint32_t osal_workq_isr_enter(void)
+{
+    return osal_utils_cycles();
+}
+
+void osal_workq_isr_exit(uint8_t source, uint32_t enter_cycles)
+{
+    uint32_t cycles = osal_utils_cycles() - enter_cycles;
+
+    if (source >= OSAL_WORKQ_MAX_SOURCES) {
+        return;
+    }
+    // Each source is a single ISR, which cannot preempt itself
+    osal_workq_source_stats_t *s = &osal_workq_sources[source];
+    s->count++;
+    s->cycles_last = cycles;
+    if (cycles > s->cycles_max) {
+        s->cycles_max = cycles;
+    }
+}
+
+uint32_t osal_workq_depth(osal_workq_prio_t prio)
+{
+    if ((uint32_t)prio >= (uint32_t)OSAL_WORKQ_PRIO_COUNT) {
+        return 0U;
+    }
+    osal_workq_t *q = &osal_workq_queues[prio];
+    return __atomic_load_n(&q->enqueue_pos, __ATOMIC_RELAXED) - q->dequeue_pos;
+}
+
+void osal_workq_get_queue_stats(osal_workq_prio_t prio, osal_workq_queue_stats_t *stats)
+{
+    if ((uint32_t)prio < (uint32_t)OSAL_WORKQ_PRIO_COUNT) {
+        *stats = osal_workq_queues[prio].stats;
+    }
+}
+
+void osal_workq_get_source_stats(uint8_t source, osal_workq_source_stats_t *stats)
+{
+    if (source < OSAL_WORKQ_MAX_SOURCES) {
+        *stats = osal_workq_sources[source];
+    }
+}
+
+void osal_workq_log_stats(void)
+{
+    static const char *const prio_names[OSAL_WORKQ_PRIO_COUNT] = { "low", "high" };
+    char log_buffer[LOG_BUFFER_SIZE];
+
+    for (uint32_t p = 0U; p < (uint32_t)OSAL_WORKQ_PRIO_COUNT; p++) {
+        osal_workq_queue_stats_t stats;
+        osal_workq_get_queue_stats((osal_workq_prio_t)p, &stats);
+        snprintf(log_buffer, LOG_BUFFER_SIZE,
+                 "Workq %s: posted %lu run %lu dropped %lu depth max %lu latency max %lu cycles\r\n",
+                 prio_names[p], (unsigned long)stats.posted, (unsigned long)stats.executed,
+                 (unsigned long)stats.dropped, (unsigned long)stats.depth_max,
+                 (unsigned long)stats.latency_max);
+        osal_log_info(log_buffer);
+    }
+    for (uint8_t i = 0U; i < OSAL_WORKQ_MAX_SOURCES; i++) {
+        const osal_workq_source_stats_t *s = &osal_workq_sources[i];
+        if (s->count == 0U) {
+            continue;
+        }
+        snprintf(log_buffer, LOG_BUFFER_SIZE, "ISR %s: %lu runs, cycles last %lu max %lu\r\n",
+                 (s->name != NULL) ? s->name : "?", (unsigned long)s->count,
+                 (unsigned long)s->cycles_last, (unsigned long)s->cycles_max);
+        osal_log_info(log_buffer);
+    }
+}
@@ -1,233 +1,343 @@
 #include <stdint.h>
-#include <stdlib.h> // For rand()
+#include <stdbool.h>
+#include <string.h>
 #include "Siul2_Port_Ip.h"
 #include "Siul2_Dio_Ip.h"
 #include "osal_utils.h"
+#include "osal_workq.h"
 #include "test_led.h"
 
 // Configuration macros
-#define LED_CYCLES 20       // Number of pattern cycles
+#define LED_CYCLES 20       // Number of patterns queued per demo run
 #define FAST_DELAY_MS 150   // Delay for fast patterns (ms)
 #define SLOW_DELAY_MS 400   // Delay for slow patterns (ms)
 #define STROBE_DELAY_MS 50  // Delay for strobe and random toggle (ms)
+#define PATTERN_PAUSE_MS 200 // Pause between patterns (ms)
+#define LED_QUEUE_SIZE 32U  // Pattern queue entries (power of two, >= LED_CYCLES)
 
-// Pattern types
-typedef enum {
-    PATTERN_ALTERNATE,
-    PATTERN_SIMULTANEOUS,
-    PATTERN_CHASE,
-    PATTERN_TOGGLE_WAVE,
-    PATTERN_BINARY_COUNTER,
-    PATTERN_RANDOM_TOGGLE,
-    PATTERN_ROTATING_PAIR,
-    PATTERN_STROBE,
-    PATTERN_PING_PONG,
-    PATTERN_COUNT
-} LedPattern;
+// Logical LED bits used by the pattern tables
+#define LED_G 0x01U
+#define LED_B 0x02U
+#define LED_R 0x04U
+#define LED_ALL (LED_G | LED_B | LED_R)
+
+/*
+ * Pattern step, 4 bytes:
+ *  - op_mask: bits 0-2 = LED mask (LED_G/LED_B/LED_R), bits 6-7 = opcode
+ *  - value:   LED levels for LED_OP_SET (only bits in the mask are used)
+ *  - hold_ms: time to hold the step
+ * The same layout is used for patterns loaded over UART (hold_ms little-endian).
+ */
+#define LED_OP_SET     0x00U  // Drive the masked LEDs to value
+#define LED_OP_TOGGLE  0x40U  // Invert the masked LEDs
+#define LED_OP_RANDOM  0x80U  // Invert 1 or 2 random LEDs out of the mask
+#define LED_OP_MASK    0xC0U
+
+#define SET(m, v, ms)  { (uint8_t)(LED_OP_SET | (m)), (uint8_t)(v), (uint16_t)(ms) }
+#define TGL(m, ms)     { (uint8_t)(LED_OP_TOGGLE | (m)), 0U, (uint16_t)(ms) }
+#define RND(m, ms)     { (uint8_t)(LED_OP_RANDOM | (m)), 0U, (uint16_t)(ms) }
+
+typedef struct {
+    uint8_t op_mask;
+    uint8_t value;
+    uint16_t hold_ms;
+} LedStep;
+
+typedef struct {
+    const LedStep *steps;
+    uint8_t count;
+} LedProgram;
 
 // Pattern 1: Alternate (green, blue, red in sequence)
-static void led_pattern_alternate(void)
+static const LedStep led_pattern_alternate[] = {
+    SET(LED_ALL, LED_G, FAST_DELAY_MS), SET(LED_ALL, LED_B, FAST_DELAY_MS), SET(LED_ALL, LED_R, FAST_DELAY_MS),
+};
+// Pattern 2: Simultaneous (all LEDs blink together)
+static const LedStep led_pattern_simultaneous[] = {
+    TGL(LED_ALL, SLOW_DELAY_MS), TGL(LED_ALL, SLOW_DELAY_MS),
+};
+// Pattern 3: Chase (green → blue → red)
+#define led_pattern_chase led_pattern_alternate
+// Pattern 4: Toggle Wave (all off, then toggles each LED in sequence)
+static const LedStep led_pattern_toggle_wave[] = {
+    SET(LED_ALL, LED_G, FAST_DELAY_MS), TGL(LED_B, FAST_DELAY_MS), TGL(LED_R, FAST_DELAY_MS),
+    TGL(LED_G, FAST_DELAY_MS), TGL(LED_B, FAST_DELAY_MS), TGL(LED_R, FAST_DELAY_MS),
+};
+// Pattern 5: Binary Counter (3-bit counter: 000 to 111)
+static const LedStep led_pattern_binary_counter[] = {
+    SET(LED_ALL, 0U, FAST_DELAY_MS), SET(LED_ALL, 1U, FAST_DELAY_MS), SET(LED_ALL, 2U, FAST_DELAY_MS),
+    SET(LED_ALL, 3U, FAST_DELAY_MS), SET(LED_ALL, 4U, FAST_DELAY_MS), SET(LED_ALL, 5U, FAST_DELAY_MS),
+    SET(LED_ALL, 6U, FAST_DELAY_MS), SET(LED_ALL, 7U, FAST_DELAY_MS),
+};
+// Pattern 6: Random Toggle (toggles 1 or 2 LEDs randomly)
+static const LedStep led_pattern_random_toggle[] = {
+    RND(LED_ALL, STROBE_DELAY_MS), RND(LED_ALL, STROBE_DELAY_MS), RND(LED_ALL, STROBE_DELAY_MS),
+    RND(LED_ALL, STROBE_DELAY_MS), RND(LED_ALL, STROBE_DELAY_MS), RND(LED_ALL, STROBE_DELAY_MS),
+    RND(LED_ALL, STROBE_DELAY_MS), RND(LED_ALL, STROBE_DELAY_MS),
+};
+// Pattern 7: Rotating Pair (two LEDs on: GB, BR, RG)
+static const LedStep led_pattern_rotating_pair[] = {
+    SET(LED_ALL, LED_G | LED_B, SLOW_DELAY_MS), SET(LED_ALL, LED_B | LED_R, SLOW_DELAY_MS),
+    SET(LED_ALL, LED_G | LED_R, SLOW_DELAY_MS),
+};
+// Pattern 8: Strobe (rapid on/off for all LEDs)
+static const LedStep led_pattern_strobe[] = {
+    TGL(LED_ALL, STROBE_DELAY_MS), TGL(LED_ALL, STROBE_DELAY_MS), TGL(LED_ALL, STROBE_DELAY_MS),
+    TGL(LED_ALL, STROBE_DELAY_MS), TGL(LED_ALL, STROBE_DELAY_MS), TGL(LED_ALL, STROBE_DELAY_MS),
+    TGL(LED_ALL, STROBE_DELAY_MS), TGL(LED_ALL, STROBE_DELAY_MS), TGL(LED_ALL, STROBE_DELAY_MS),
+    TGL(LED_ALL, STROBE_DELAY_MS),
+};
+// Pattern 9: Ping-Pong (green ↔ blue ↔ red)
+static const LedStep led_pattern_ping_pong[] = {
+    SET(LED_ALL, LED_G, FAST_DELAY_MS), TGL(LED_G | LED_B, FAST_DELAY_MS), TGL(LED_B | LED_R, FAST_DELAY_MS),
+    TGL(LED_B | LED_R, FAST_DELAY_MS), TGL(LED_G | LED_B, FAST_DELAY_MS),
+};
+
+#define LED_PROGRAM(p) { (p), (uint8_t)(sizeof(p) / sizeof((p)[0])) }
+
+static const LedProgram led_flash_programs[] = {
+    LED_PROGRAM(led_pattern_alternate),
+    LED_PROGRAM(led_pattern_simultaneous),
+    LED_PROGRAM(led_pattern_chase),
+    LED_PROGRAM(led_pattern_toggle_wave),
+    LED_PROGRAM(led_pattern_binary_counter),
+    LED_PROGRAM(led_pattern_random_toggle),
+    LED_PROGRAM(led_pattern_rotating_pair),
+    LED_PROGRAM(led_pattern_strobe),
+    LED_PROGRAM(led_pattern_ping_pong),
+};
+
+#define PATTERN_COUNT ((uint8_t)(sizeof(led_flash_programs) / sizeof(led_flash_programs[0])))
+#define PATTERN_NONE 0xFFU
+
+// Patterns loaded at runtime; count == 0 marks an empty slot
+static LedStep led_ram_steps[TEST_LED_RAM_SLOTS][TEST_LED_RAM_MAX_STEPS];
+static volatile uint8_t led_ram_count[TEST_LED_RAM_SLOTS];
+
+// Port bits for every combination of logical LEDs, so a step is a single masked write
+#define PORT_BITS(l) (uint16_t)((((l) & LED_G) ? (1U << LED_GREEN_PIN) : 0U) | \
+                                (((l) & LED_B) ? (1U << LED_BLUE_PIN) : 0U) | \
+                                (((l) & LED_R) ? (1U << LED_RED_PIN) : 0U))
+static const uint16_t led_port_bits[8] = {
+    PORT_BITS(0U), PORT_BITS(1U), PORT_BITS(2U), PORT_BITS(3U),
+    PORT_BITS(4U), PORT_BITS(5U), PORT_BITS(6U), PORT_BITS(7U),
+};
+
+// Engine state. The queue is filled by test_led() (thread) and drained by the step work item.
+static volatile uint8_t led_queue[LED_QUEUE_SIZE];
+static volatile uint32_t led_queue_head; // Written by the producer only
+static volatile uint32_t led_queue_tail; // Written by the consumer only
+static uint8_t led_current = PATTERN_NONE;
+static uint8_t led_step;
+static uint8_t led_state;                // Shadow of the logical LED levels
+static volatile uint16_t led_remaining_ms;
+static volatile bool led_step_pending;
+static uint32_t led_rand_state = 1U;
+
+// Small xorshift generator: rand() is not safe to share between thread and interrupt context
+static uint32_t led_rand(void)
 {
-    Siul2_Dio_Ip_WritePin(LED_GREEN_PORT, LED_GREEN_PIN, 1U);
-    Siul2_Dio_Ip_WritePin(LED_BLUE_PORT, LED_BLUE_PIN, 0U);
-    Siul2_Dio_Ip_WritePin(LED_RED_PORT, LED_RED_PIN, 0U);
-    osal_utils_delay_ms(FAST_DELAY_MS);
-    Siul2_Dio_Ip_WritePin(LED_GREEN_PORT, LED_GREEN_PIN, 0U);
-    Siul2_Dio_Ip_WritePin(LED_BLUE_PORT, LED_BLUE_PIN, 1U);
-    Siul2_Dio_Ip_WritePin(LED_RED_PORT, LED_RED_PIN, 0U);
-    osal_utils_delay_ms(FAST_DELAY_MS);
-    Siul2_Dio_Ip_WritePin(LED_GREEN_PORT, LED_GREEN_PIN, 0U);
-    Siul2_Dio_Ip_WritePin(LED_BLUE_PORT, LED_BLUE_PIN, 0U);
-    Siul2_Dio_Ip_WritePin(LED_RED_PORT, LED_RED_PIN, 1U);
-    osal_utils_delay_ms(FAST_DELAY_MS);
+    led_rand_state ^= led_rand_state << 13;
+    led_rand_state ^= led_rand_state >> 17;
+    led_rand_state ^= led_rand_state << 5;
+    return led_rand_state;
 }
 
-// Pattern 2: Simultaneous (all LEDs blink together using TogglePins)
-static void led_pattern_simultaneous(void)
+// All three LEDs share one SIUL2 port: one masked parallel write, no intermediate states
+static void led_apply(uint8_t mask, uint8_t value)
 {
-    uint32_t all_pins = (1U << LED_GREEN_PIN) | (1U << LED_BLUE_PIN) | (1U << LED_RED_PIN);
-    Siul2_Dio_Ip_TogglePins(LED_GREEN_PORT, all_pins); // Toggle all on
-    osal_utils_delay_ms(SLOW_DELAY_MS);
-    Siul2_Dio_Ip_TogglePins(LED_GREEN_PORT, all_pins); // Toggle all off
-    osal_utils_delay_ms(SLOW_DELAY_MS);
+    led_state = (uint8_t)((led_state & ~mask) | (value & mask)) & LED_ALL;
+    Siul2_Dio_Ip_MaskedWritePins(LED_GREEN_PORT, led_port_bits[led_state], led_port_bits[mask & LED_ALL]);
 }
 
-// Pattern 3: Chase (green → blue → red)
-static void led_pattern_chase(void)
+// Apply one step, return its hold time (0 when the program is finished)
+static uint16_t led_run_step(const LedStep *steps, uint8_t count, uint8_t step)
+{
+    if (step >= count) {
+        return 0U;
+    }
+
+    const LedStep *s = &steps[step];
+    uint8_t mask = s->op_mask & LED_ALL;
+
+    switch (s->op_mask & LED_OP_MASK) {
+        case LED_OP_SET:
+            led_apply(mask, s->value);
+            break;
+        case LED_OP_TOGGLE:
+            led_apply(mask, (uint8_t)~led_state);
+            break;
+        case LED_OP_RANDOM: {
+            uint8_t leds = 0U;
+            uint8_t num_leds = (uint8_t)((led_rand() % 2U) + 1U); // 1 or 2 LEDs
+            for (uint8_t j = 0; j < num_leds; j++) {
+                leds |= (uint8_t)(1U << (led_rand() % 3U));
+            }
+            leds &= mask;
+            led_apply(leds, (uint8_t)~led_state);
+            break;
+        }
+        default:
+            break;
+    }
+
+    // A zero hold would end the program early; treat it as the shortest step
+    return (s->hold_ms != 0U) ? s->hold_ms : 1U;
+}
+
+static uint16_t led_run_program_step(uint8_t program, uint8_t step)
 {
-    Siul2_Dio_Ip_WritePin(LED_GREEN_PORT, LED_GREEN_PIN, 1U);
-    Siul2_Dio_Ip_WritePin(LED_BLUE_PORT, LED_BLUE_PIN, 0U);
-    Siul2_Dio_Ip_WritePin(LED_RED_PORT, LED_RED_PIN, 0U);
-    osal_utils_delay_ms(FAST_DELAY_MS);
-    Siul2_Dio_Ip_WritePin(LED_GREEN_PORT, LED_GREEN_PIN, 0U);
-    Siul2_Dio_Ip_WritePin(LED_BLUE_PORT, LED_BLUE_PIN, 1U);
-    Siul2_Dio_Ip_WritePin(LED_RED_PORT, LED_RED_PIN, 0U);
-    osal_utils_delay_ms(FAST_DELAY_MS);
-    Siul2_Dio_Ip_WritePin(LED_GREEN_PORT, LED_GREEN_PIN, 0U);
-    Siul2_Dio_Ip_WritePin(LED_BLUE_PORT, LED_BLUE_PIN, 0U);
-    Siul2_Dio_Ip_WritePin(LED_RED_PORT, LED_RED_PIN, 1U);
-    osal_utils_delay_ms(FAST_DELAY_MS);
+    if (program < PATTERN_COUNT) {
+        return led_run_step(led_flash_programs[program].steps, led_flash_programs[program].count, step);
+    }
+    uint8_t slot = (uint8_t)(program - PATTERN_COUNT);
+    return led_run_step(led_ram_steps[slot], led_ram_count[slot], step);
 }
 
-// Pattern 4: Toggle Wave (toggles each LED in sequence)
-static void led_pattern_toggle_wave(void)
+static bool led_queue_empty(void)
 {
-    // Start with all off
-    Siul2_Dio_Ip_WritePin(LED_GREEN_PORT, LED_GREEN_PIN, 0U);
-    Siul2_Dio_Ip_WritePin(LED_BLUE_PORT, LED_BLUE_PIN, 0U);
-    Siul2_Dio_Ip_WritePin(LED_RED_PORT, LED_RED_PIN, 0U);
-    // Toggle in sequence
-    Siul2_Dio_Ip_TogglePins(LED_GREEN_PORT, 1U << LED_GREEN_PIN); // Green on
-    osal_utils_delay_ms(FAST_DELAY_MS);
-    Siul2_Dio_Ip_TogglePins(LED_BLUE_PORT, 1U << LED_BLUE_PIN); // Blue on
-    osal_utils_delay_ms(FAST_DELAY_MS);
-    Siul2_Dio_Ip_TogglePins(LED_RED_PORT, 1U << LED_RED_PIN); // Red on
-    osal_utils_delay_ms(FAST_DELAY_MS);
-    Siul2_Dio_Ip_TogglePins(LED_GREEN_PORT, 1U << LED_GREEN_PIN); // Green off
-    osal_utils_delay_ms(FAST_DELAY_MS);
-    Siul2_Dio_Ip_TogglePins(LED_BLUE_PORT, 1U << LED_BLUE_PIN); // Blue off
-    osal_utils_delay_ms(FAST_DELAY_MS);
-    Siul2_Dio_Ip_TogglePins(LED_RED_PORT, 1U << LED_RED_PIN); // Red off
-    osal_utils_delay_ms(FAST_DELAY_MS);
+    return led_queue_head == led_queue_tail;
 }
 
-// Pattern 5: Binary Counter (3-bit counter: 000 to 111)
-static void led_pattern_binary_counter(void)
+// Work item: apply one step, then arm the countdown for the next timer event
+static void led_step_work(void *arg)
 {
-    for (uint8_t count = 0; count < 8; count++) {
-        Siul2_Dio_Ip_WritePin(LED_GREEN_PORT, LED_GREEN_PIN, (count & 0x01) ? 1U : 0U);
-        Siul2_Dio_Ip_WritePin(LED_BLUE_PORT, LED_BLUE_PIN, (count & 0x02) ? 1U : 0U);
-        Siul2_Dio_Ip_WritePin(LED_RED_PORT, LED_RED_PIN, (count & 0x04) ? 1U : 0U);
-        osal_utils_delay_ms(FAST_DELAY_MS);
+    (void)arg;
+    uint16_t hold_ms = 0U;
+
+    if ((led_current == PATTERN_NONE) && !led_queue_empty()) {
+        led_current = led_queue[led_queue_tail & (LED_QUEUE_SIZE - 1U)];
+        led_queue_tail = led_queue_tail + 1U;
+        led_step = 0U;
     }
+
+    if (led_current != PATTERN_NONE) {
+        hold_ms = led_run_program_step(led_current, led_step++);
+        if (hold_ms == 0U) {
+            // Pattern finished: short pause before the next one
+            led_current = PATTERN_NONE;
+            hold_ms = PATTERN_PAUSE_MS;
+            if (led_queue_empty()) {
+                led_apply(LED_ALL, 0U); // Last one: LEDs off (no step is posted after it)
+            }
+        }
+    }
+
+    led_remaining_ms = hold_ms;
+    led_step_pending = false;
 }
 
-// Pattern 6: Random Toggle (toggles 1 or 2 LEDs randomly)
-static void led_pattern_random_toggle(void)
+void test_led_tick(void)
 {
-    for (uint8_t i = 0; i < 8; i++) {
-        // Randomly select 1 or 2 LEDs
-        uint32_t pins = 0;
-        uint8_t num_leds = (rand() % 2) + 1; // 1 or 2 LEDs
-        for (uint8_t j = 0; j < num_leds; j++) {
-            uint8_t led = rand() % 3;
-            if (led == 0) pins |= (1U << LED_GREEN_PIN);
-            else if (led == 1) pins |= (1U << LED_BLUE_PIN);
-            else pins |= (1U << LED_RED_PIN);
+    if (led_step_pending) {
+        return;
+    }
+    if (led_remaining_ms > 0U) {
+        led_remaining_ms--;
+    }
+    if ((led_remaining_ms == 0U) && ((led_current != PATTERN_NONE) || !led_queue_empty())) {
+        led_step_pending = true;
+        if (osal_workq_post(OSAL_WORKQ_PRIO_LOW, led_step_work, NULL) != 0) {
+            led_step_pending = false; // Queue full: retry on the next tick
         }
-        Siul2_Dio_Ip_TogglePins(LED_GREEN_PORT, pins);
-        osal_utils_delay_ms(STROBE_DELAY_MS);
     }
 }
 
-// Pattern 7: Rotating Pair (two LEDs on: GB, BR, RG)
-static void led_pattern_rotating_pair(void)
+bool test_led_busy(void)
 {
-    Siul2_Dio_Ip_WritePin(LED_GREEN_PORT, LED_GREEN_PIN, 1U);
-    Siul2_Dio_Ip_WritePin(LED_BLUE_PORT, LED_BLUE_PIN, 1U);
-    Siul2_Dio_Ip_WritePin(LED_RED_PORT, LED_RED_PIN, 0U);
-    osal_utils_delay_ms(SLOW_DELAY_MS);
-    Siul2_Dio_Ip_WritePin(LED_GREEN_PORT, LED_GREEN_PIN, 0U);
-    Siul2_Dio_Ip_WritePin(LED_BLUE_PORT, LED_BLUE_PIN, 1U);
-    Siul2_Dio_Ip_WritePin(LED_RED_PORT, LED_RED_PIN, 1U);
-    osal_utils_delay_ms(SLOW_DELAY_MS);
-    Siul2_Dio_Ip_WritePin(LED_GREEN_PORT, LED_GREEN_PIN, 1U);
-    Siul2_Dio_Ip_WritePin(LED_BLUE_PORT, LED_BLUE_PIN, 0U);
-    Siul2_Dio_Ip_WritePin(LED_RED_PORT, LED_RED_PIN, 1U);
-    osal_utils_delay_ms(SLOW_DELAY_MS);
+    return (led_current != PATTERN_NONE) || !led_queue_empty() || led_step_pending ||
+           (led_remaining_ms != 0U);
 }
 
-// Pattern 8: Strobe (rapid on/off for all LEDs)
-static void led_pattern_strobe(void)
+// Check packed steps: whole steps, known opcodes
+static int32_t led_check_steps(const uint8_t *data, uint32_t len)
 {
-    uint32_t all_pins = (1U << LED_GREEN_PIN) | (1U << LED_BLUE_PIN) | (1U << LED_RED_PIN);
-    for (uint8_t i = 0; i < 10; i++) {
-        Siul2_Dio_Ip_TogglePins(LED_GREEN_PORT, all_pins);
-        osal_utils_delay_ms(STROBE_DELAY_MS);
+    if ((data == NULL) || (len == 0U) || ((len % 4U) != 0U) || ((len / 4U) > TEST_LED_RAM_MAX_STEPS)) {
+        return -1;
+    }
+    for (uint32_t i = 0U; i < (len / 4U); i++) {
+        uint8_t op = data[(4U * i) + 0U] & LED_OP_MASK;
+        if ((op != LED_OP_SET) && (op != LED_OP_TOGGLE) && (op != LED_OP_RANDOM)) {
+            return -2;
+        }
     }
+    return 0;
 }
 
-// Pattern 9: Ping-Pong (toggles back and forth: green ↔ blue ↔ red)
-static void led_pattern_ping_pong(void)
+static void led_store_steps(uint8_t slot, uint8_t first, const uint8_t *data, uint8_t count)
 {
-    // Start with green on
-    Siul2_Dio_Ip_WritePin(LED_GREEN_PORT, LED_GREEN_PIN, 1U);
-    Siul2_Dio_Ip_WritePin(LED_BLUE_PORT, LED_BLUE_PIN, 0U);
-    Siul2_Dio_Ip_WritePin(LED_RED_PORT, LED_RED_PIN, 0U);
-    osal_utils_delay_ms(FAST_DELAY_MS);
-    // Toggle green off, blue on
-    Siul2_Dio_Ip_TogglePins(LED_GREEN_PORT, (1U << LED_GREEN_PIN) | (1U << LED_BLUE_PIN));
-    osal_utils_delay_ms(FAST_DELAY_MS);
-    // Toggle blue off, red on
-    Siul2_Dio_Ip_TogglePins(LED_GREEN_PORT, (1U << LED_BLUE_PIN) | (1U << LED_RED_PIN));
-    osal_utils_delay_ms(FAST_DELAY_MS);
-    // Toggle red off, blue on
-    Siul2_Dio_Ip_TogglePins(LED_GREEN_PORT, (1U << LED_BLUE_PIN) | (1U << LED_RED_PIN));
-    osal_utils_delay_ms(FAST_DELAY_MS);
-    // Toggle blue off, green on
-    Siul2_Dio_Ip_TogglePins(LED_GREEN_PORT, (1U << LED_GREEN_PIN) | (1U << LED_BLUE_PIN));
-    osal_utils_delay_ms(FAST_DELAY_MS);
+    for (uint8_t i = 0; i < count; i++) {
+        const uint8_t *p = &data[4U * i];
+        led_ram_steps[slot][first + i].op_mask = p[0];
+        led_ram_steps[slot][first + i].value = p[1];
+        led_ram_steps[slot][first + i].hold_ms = (uint16_t)(p[2] | ((uint16_t)p[3] << 8));
+    }
+}
+
+int32_t test_led_load_pattern(uint8_t slot, const uint8_t *data, uint32_t len)
+{
+    if (slot >= TEST_LED_RAM_SLOTS) {
+        return -1;
+    }
+    int32_t ret = led_check_steps(data, len);
+    if (ret != 0) {
+        return ret;
+    }
+
+    // Hide the slot while it is rewritten; the engine reads count before every step
+    led_ram_count[slot] = 0U;
+    led_store_steps(slot, 0U, data, (uint8_t)(len / 4U));
+    led_ram_count[slot] = (uint8_t)(len / 4U);
+
+    return 0;
+}
+
+int32_t test_led_append_pattern(uint8_t slot, const uint8_t *data, uint32_t len)
+{
+    if ((slot >= TEST_LED_RAM_SLOTS) || (led_ram_count[slot] == 0U)) {
+        return -1;
+    }
+    int32_t ret = led_check_steps(data, len);
+    if (ret != 0) {
+        return ret;
+    }
+    uint8_t count = led_ram_count[slot];
+    if ((count + (len / 4U)) > TEST_LED_RAM_MAX_STEPS) {
+        return -1;
+    }
+
+    // Steps past count are not read, so a playing slot only sees the new steps once complete
+    led_store_steps(slot, count, data, (uint8_t)(len / 4U));
+    led_ram_count[slot] = (uint8_t)(count + (len / 4U));
+
+    return 0;
 }
 
 /**
  * Enhanced LED test function with three LEDs and multiple patterns.
- * Randomly selects from nine patterns, emphasizing Siul2_Dio_Ip_TogglePins.
+ * Queues LED_CYCLES randomly selected patterns (built-in and loaded) when the engine is idle and
+ * returns immediately; the patterns are played back one step per timer event by test_led_tick().
  */
 void test_led(void)
 {
-    uint8_t count = 0;
-
-    // Seed random number generator (replace with tick for true randomness)
-    srand(0); // Static seed for reproducibility
-
-    // Ensure LEDs are off initially
-    Siul2_Dio_Ip_WritePin(LED_GREEN_PORT, LED_GREEN_PIN, 0U);
-    Siul2_Dio_Ip_WritePin(LED_BLUE_PORT, LED_BLUE_PIN, 0U);
-    Siul2_Dio_Ip_WritePin(LED_RED_PORT, LED_RED_PIN, 0U);
-
-    while (count++ < LED_CYCLES)
-    {
-        // Randomly select a pattern
-        LedPattern pattern = (LedPattern)(rand() % PATTERN_COUNT);
-
-        switch (pattern) {
-            case PATTERN_ALTERNATE:
-                led_pattern_alternate();
-                break;
-            case PATTERN_SIMULTANEOUS:
-                led_pattern_simultaneous();
-                break;
-            case PATTERN_CHASE:
-                led_pattern_chase();
-                break;
-            case PATTERN_TOGGLE_WAVE:
-                led_pattern_toggle_wave();
-                break;
-            case PATTERN_BINARY_COUNTER:
-                led_pattern_binary_counter();
-                break;
-            case PATTERN_RANDOM_TOGGLE:
-                led_pattern_random_toggle();
-                break;
-            case PATTERN_ROTATING_PAIR:
-                led_pattern_rotating_pair();
-                break;
-            case PATTERN_STROBE:
-                led_pattern_strobe();
-                break;
-            case PATTERN_PING_PONG:
-                led_pattern_ping_pong();
-                break;
-            default:
-                break;
-        }
+    uint8_t choices[PATTERN_COUNT + TEST_LED_RAM_SLOTS];
+    uint8_t num_choices = 0U;
 
-        // Short pause between patterns
-        osal_utils_delay_ms(200);
+    if (test_led_busy()) {
+        return;
     }
 
-    // Ensure LEDs are off at the end
-    Siul2_Dio_Ip_WritePin(LED_GREEN_PORT, LED_GREEN_PIN, 0U);
-    Siul2_Dio_Ip_WritePin(LED_BLUE_PORT, LED_BLUE_PIN, 0U);
-    Siul2_Dio_Ip_WritePin(LED_RED_PORT, LED_RED_PIN, 0U);
+    for (uint8_t i = 0; i < PATTERN_COUNT; i++) {
+        choices[num_choices++] = i;
+    }
+    for (uint8_t i = 0; i < TEST_LED_RAM_SLOTS; i++) {
+        if (led_ram_count[i] != 0U) {
+            choices[num_choices++] = (uint8_t)(PATTERN_COUNT + i);
+        }
+    }
+
+    for (uint8_t count = 0; count < LED_CYCLES; count++) {
+        led_queue[led_queue_head & (LED_QUEUE_SIZE - 1U)] = choices[led_rand() % num_choices];
+        led_queue_head = led_queue_head + 1U;
+    }
 }
@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""Stamp the image CRC-32 into app_metadata of a linked S32K312 application.
+
+Post-link step, run after lz4_init.py and anything else that changes flash
+content, and before sign_image.py (the signature covers the CRC field). The
+metadata block (.app_metadata, in the metadata sector of the slot the image is
+linked for: 0x004FE000 for slot A, 0x005BE000 for slot B) gives the covered
+range:
+
+    0x00 magic              0xAABBCCDD
+    0x24 flash_start_addr   first byte covered
+    0x28 image_size         bytes covered (__app_image_size from the linker script)
+    0x2C crc32              written here
+    0x30 sequence           written here with --sequence (newer images get higher numbers)
+    0x38 sha256, signature  left to sign_image.py
+
+The CRC is the zlib/Ethernet CRC-32 over the range as it reads from flash:
+gaps between load images count as erased bytes (0xFF) and the metadata block
+itself is skipped if it lies inside the range. osal_image_verify() computes
+the same value on target.
+
+Input is the ELF (patched in place or to -o) or a flat binary with --base;
+a flat dump holding both slots needs --slot. With --check nothing is
+written; the exit status tells whether the stamp matches.
+
+Usage: crc_stamp.py app.elf [-o out.elf] [--bin out.bin] [--sequence N] [--check]
+       crc_stamp.py app.bin --base 0x440000 [--slot 0|1] [-o out.bin] [--check]
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+
+from elfimage import ElfImage, ElfError, PT_LOAD
+
+SLOT_BASE = (0x00440000, 0x00500000)       # Slot A, slot B (osal_slot.h)
+SLOT_METADATA = (0x004FE000, 0x005BE000)
+METADATA_SIZE = 0x98
+METADATA_MAGIC = 0xAABBCCDD
+OFF_FLASH_START = 0x24
+OFF_IMAGE_SIZE = 0x28
+OFF_CRC = 0x2C
+OFF_SEQUENCE = 0x30
+
+PFLASH_START = 0x00400000
+PFLASH_END = 0x00600000
+ERASED = 0xFF
+
+
+class FlatImage:
+    """A raw flash dump with the same read/write interface as ElfImage."""
+
+    def __init__(self, path, base):
+        self.path = path
+        self.base = base
+        with open(path, "rb") as f:
+            self.data = bytearray(f.read())
+
+    def _offset(self, lma, size):
+        off = lma - self.base
+        if off < 0 or off + size > len(self.data):
+            raise ElfError("0x%08x+%u is outside %s" % (lma, size, self.path))
+        return off
+
+    def read(self, lma, size):
+        off = self._offset(lma, size)
+        return bytes(self.data[off:off + size])
+
+    def write(self, lma, payload):
+        off = self._offset(lma, len(payload))
+        self.data[off:off + len(payload)] = payload
+
+    def flash_bytes(self, lo, hi):
+        image = bytearray([ERASED]) * (hi - lo)
+        start = max(lo, self.base)
+        end = min(hi, self.base + len(self.data))
+        if start < end:
+            image[start - lo:end - lo] = self.data[start - self.base:end - self.base]
+        return bytes(image)
+
+    def save(self, path=None):
+        with open(path or self.path, "wb") as f:
+            f.write(self.data)
+
+
+def elf_flash_bytes(elf, lo, hi):
+    """[lo, hi) as programmed: load images over an erased background."""
+    image = bytearray([ERASED]) * (hi - lo)
+    for seg in elf.segments:
+        if seg.type != PT_LOAD or seg.filesz == 0:
+            continue
+        start = max(lo, seg.paddr)
+        end = min(hi, seg.paddr + seg.filesz)
+        if start < end:
+            off = seg.offset + (start - seg.paddr)
+            image[start - lo:end - lo] = elf.data[off:off + (end - start)]
+    return bytes(image)
+
+
+def find_metadata(img, slot=None):
+    """Address of the app_metadata block in the image, optionally only looking at one slot."""
+    found = []
+    for index, addr in enumerate(SLOT_METADATA):
+        if slot is not None and index != slot:
+            continue
+        try:
+            magic, = struct.unpack("<I", img.read(addr, 4))
+        except ElfError:
+            continue
+        if magic == METADATA_MAGIC:
+            found.append(addr)
+    if not found:
+        raise ElfError("no app_metadata at %s" % ", ".join("0x%08x" % a for a in SLOT_METADATA))
+    if len(found) > 1:
+        raise ElfError("app_metadata in both slots, select one with --slot")
+    return found[0]
+
+
+def load_slot_image(path, base=None, slot=None):
+    """(slot, flash start, image bytes, metadata block) of a stamped image for one slot."""
+    if base is not None:
+        img = FlatImage(path, base)
+        flash = img.flash_bytes
+    else:
+        img = ElfImage(path)
+        flash = lambda lo, hi: elf_flash_bytes(img, lo, hi)
+    meta = find_metadata(img, slot)
+    index = SLOT_METADATA.index(meta)
+    start, size, crc = struct.unpack("<III", img.read(meta + OFF_FLASH_START, 12))
+    if start != SLOT_BASE[index] or size == 0 or size > SLOT_METADATA[index] - SLOT_BASE[index]:
+        raise ElfError("metadata range 0x%08x+0x%x does not fit slot %s" % (start, size, "AB"[index]))
+    if crc == 0:
+        raise ElfError("%s is not stamped, run crc_stamp.py or sign_image.py first" % path)
+    return index, start, flash(start, start + size), img.read(meta, METADATA_SIZE)
+
+
+def image_crc(flash, start, size, meta):
+    """CRC of [start, start + size) with the metadata block at meta cut out."""
+    end = start + size
+    meta_end = meta + METADATA_SIZE
+    if meta_end <= start or meta >= end:
+        return zlib.crc32(flash(start, end))
+    crc = 0
+    if meta > start:
+        crc = zlib.crc32(flash(start, meta), crc)
+    if meta_end < end:
+        crc = zlib.crc32(flash(meta_end, end), crc)
+    return crc
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("image", help="linked ELF, or flat binary with --base")
+    parser.add_argument("--base", type=lambda v: int(v, 0), help="load address of a flat binary")
+    parser.add_argument("--slot", type=int, choices=(0, 1), help="slot whose metadata to use (flat binaries)")
+    parser.add_argument("--sequence", type=lambda v: int(v, 0), help="stamp this sequence number")
+    parser.add_argument("-o", "--output", help="output file (default: in place)")
+    parser.add_argument("--bin", help="also write the flat flash image (ELF input only)")
+    parser.add_argument("--check", action="store_true", help="verify the stamp, write nothing")
+    args = parser.parse_args()
+    if args.bin and args.base is not None:
+        parser.error("--bin needs an ELF input")
+
+    try:
+        if args.base is not None:
+            img = FlatImage(args.image, args.base)
+            flash = img.flash_bytes
+        else:
+            img = ElfImage(args.image)
+            flash = lambda lo, hi: elf_flash_bytes(img, lo, hi)
+
+        meta = find_metadata(img, args.slot)
+        start, size, stamped = struct.unpack("<III", img.read(meta + OFF_FLASH_START, 12))
+        if size == 0 or start < PFLASH_START or start + size > PFLASH_END:
+            sys.exit("crc_stamp: range 0x%08x+0x%x is outside program flash" % (start, size))
+
+        crc = image_crc(flash, start, size, meta)
+        print("image 0x%08x..0x%08x (%u bytes): CRC-32 0x%08x" % (start, start + size, size, crc))
+
+        if args.check:
+            if stamped != crc:
+                sys.exit("crc_stamp: stamped 0x%08x does not match" % stamped)
+            print("stamp matches")
+            return
+        if crc == 0:
+            # 0 means "not stamped" on target; vanishingly unlikely but not representable
+            sys.exit("crc_stamp: the image CRC is 0, change the image (e.g. the version string)")
+
+        img.write(meta + OFF_CRC, struct.pack("<I", crc))
+        if args.sequence is not None:
+            img.write(meta + OFF_SEQUENCE, struct.pack("<I", args.sequence & 0xFFFFFFFF))
+        img.save(args.output)
+        if args.bin:
+            with open(args.bin, "wb") as f:
+                f.write(img.flat_image(PFLASH_START, PFLASH_END)[1])
+    except ElfError as e:
+        sys.exit("crc_stamp: %s" % e)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,244 @@
+#!/usr/bin/env python3
+"""Make a delta patch that turns the running image into a new one.
+
+The patch format is the one osal_delta_apply() decodes on target
+(include/osal_delta.h): bsdiff-style records of
+
+    varint diff_len, varint extra_len, zigzag varint seek,
+    diff bytes (new - old, mod 256; 0x00 + varint n = n + 1 zero bytes),
+    extra bytes (literal)
+
+after which the old position moves by diff_len + seek. The target reads the
+old image from the running slot, so it needs no buffer for it.
+
+Matching is greedy: 8-byte seeds index the old image, matches are extended
+exactly, and neighbouring matches with the same alignment are merged into
+one diff region so that the bytes between them (typically addresses that
+moved with the slot or with changed code) cost a few bytes each.
+
+Both images are stamped ELFs or flat binaries (as for fw_send.py); they
+normally are for different slots. The patch is checked by applying it
+before it is written. fw_send.py --delta sends it.
+
+Usage: delta_patch.py old.elf new.elf [-o patch.bin]
+"""
+
+import argparse
+import re
+import sys
+import zlib
+
+from crc_stamp import load_slot_image
+from elfimage import ElfError
+
+SEED = 8                        # Bytes hashed per index entry
+INDEX_STEP = 4                  # Old positions indexed
+CANDIDATES = 8                  # Old positions kept per seed
+MIN_MATCH = 16                  # Shortest match that starts a new alignment
+MERGE_GAP = 64                  # Longest gap diffed instead of sent as extra bytes
+
+
+class PatchError(Exception):
+    pass
+
+
+def _varint(out, value):
+    while value >= 0x80:
+        out.append((value & 0x7F) | 0x80)
+        value >>= 7
+    out.append(value)
+
+
+def _zigzag(value):
+    return (value << 1) if value >= 0 else ((-value << 1) - 1)
+
+
+def _match_len(old, o, new, n, limit):
+    length = 0
+    for step in (256, 32, 4, 1):
+        while length + step <= limit and old[o + length:o + length + step] == new[n + length:n + length + step]:
+            length += step
+    return length
+
+
+def _index(old):
+    index = {}
+    for i in range(0, len(old) - SEED + 1, INDEX_STEP):
+        entry = index.setdefault(old[i:i + SEED], [])
+        if len(entry) < CANDIDATES:
+            entry.append(i)
+    return index
+
+
+def find_matches(old, new):
+    """Exact matches (new start, old start, length), in order and not overlapping in new."""
+    index = _index(old)
+    matches = []
+    p = 0
+    done = 0                    # End of the last match in new
+    off = None                  # Alignment (old - new) of the last match
+    while p <= len(new) - SEED:
+        best_len, best_old = 0, None
+        if off is not None and 0 <= p + off <= len(old) - SEED:
+            best_len = _match_len(old, p + off, new, p, min(len(old) - p - off, len(new) - p))
+            best_old = p + off
+        if best_len < MIN_MATCH:
+            for c in index.get(new[p:p + SEED], ()):
+                length = _match_len(old, c, new, p, min(len(old) - c, len(new) - p))
+                if length > best_len:
+                    best_len, best_old = length, c
+        if best_len < (SEED if best_old is not None and best_old - p == off else MIN_MATCH):
+            p += 1
+            continue
+        # Extend backwards into the bytes not matched yet
+        back = 0
+        while p - back > done and best_old - back > 0 and old[best_old - back - 1] == new[p - back - 1]:
+            back += 1
+        matches.append((p - back, best_old - back, best_len + back))
+        off = best_old - p
+        p += best_len
+        done = p
+    return matches
+
+
+def regions(matches):
+    """Merge matches with the same alignment and short gaps into diff regions."""
+    merged = []
+    for n, o, length in matches:
+        if merged:
+            pn, po, plen = merged[-1]
+            if o - n == po - pn and n - (pn + plen) <= MERGE_GAP:
+                merged[-1] = (pn, po, n + length - pn)
+                continue
+        merged.append((n, o, length))
+    return merged
+
+
+def _diff_bytes(out, old, new):
+    delta = bytes((a - b) & 0xFF for a, b in zip(new, old))
+    for run in re.finditer(rb"\x00+|[^\x00]+", delta):
+        data = run.group()
+        if data[0] == 0:
+            out.append(0)
+            _varint(out, len(data) - 1)
+        else:
+            out += data
+
+
+def make_patch(old, new):
+    merged = regions(find_matches(old, new))
+    if not merged or merged[0][:2] != (0, 0):
+        # Start with an empty diff: leading extra bytes, then seek to the first region
+        merged.insert(0, (0, 0, 0))
+    patch = bytearray()
+    for i, (n, o, length) in enumerate(merged):
+        end_new = merged[i + 1][0] if i + 1 < len(merged) else len(new)
+        next_old = merged[i + 1][1] if i + 1 < len(merged) else o + length
+        _varint(patch, length)
+        _varint(patch, end_new - n - length)
+        _varint(patch, _zigzag(next_old - (o + length)))
+        _diff_bytes(patch, old[o:o + length], new[n:n + length])
+        patch += new[n + length:end_new]
+    return bytes(patch)
+
+
+class _Reader:
+    def __init__(self, data, chunk, produced):
+        self.data = data
+        self.pos = 0
+        self.chunk = chunk
+        self.produced = produced
+        self.marks = []
+
+    def byte(self):
+        if self.pos >= len(self.data):
+            raise PatchError("patch truncated")
+        if self.chunk and self.pos and self.pos % self.chunk == 0:
+            self.marks.append(len(self.produced))
+        b = self.data[self.pos]
+        self.pos += 1
+        return b
+
+    def varint(self):
+        value, shift = 0, 0
+        while True:
+            b = self.byte()
+            # Same limit as osal_delta_varint(): the value must fit 32 bits
+            if shift > 28 or (shift == 28 and b & 0x70):
+                raise PatchError("varint too long")
+            value |= (b & 0x7F) << shift
+            if not b & 0x80:
+                return value
+            shift += 7
+
+
+def apply_patch(old, patch, new_size, chunk=None):
+    """Apply a patch as the target does. With chunk, also return the new image size produced
+    once each chunk of the patch is consumed (the receiver's output per DATA frame)."""
+    new = bytearray()
+    r = _Reader(patch, chunk, new)
+    old_pos = 0
+    while r.pos < len(patch):
+        diff_len = r.varint()
+        extra_len = r.varint()
+        z = r.varint()
+        seek = (z >> 1) ^ -(z & 1)
+        if old_pos + diff_len > len(old) or len(new) + diff_len + extra_len > new_size:
+            raise PatchError("record outside the images")
+        left = diff_len
+        while left:
+            b = r.byte()
+            if b == 0:
+                run = r.varint() + 1
+                if run > left:
+                    raise PatchError("zero run longer than the diff")
+                new += old[old_pos:old_pos + run]
+                old_pos += run
+                left -= run
+            else:
+                new.append((old[old_pos] + b) & 0xFF)
+                old_pos += 1
+                left -= 1
+        for _ in range(extra_len):
+            new.append(r.byte())
+        old_pos += seek
+        if not 0 <= old_pos <= len(old):
+            raise PatchError("seek outside the old image")
+    if len(new) != new_size:
+        raise PatchError("patch produced %u of %u bytes" % (len(new), new_size))
+    if chunk:
+        r.marks.append(len(new))
+        return bytes(new), r.marks
+    return bytes(new)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("old", help="running image: stamped ELF, or flat binary with --old-base")
+    parser.add_argument("new", help="new image: stamped ELF, or flat binary with --new-base")
+    parser.add_argument("--old-base", type=lambda v: int(v, 0), help="load address of a flat old image")
+    parser.add_argument("--new-base", type=lambda v: int(v, 0), help="load address of a flat new image")
+    parser.add_argument("-o", "--output", help="write the patch here")
+    args = parser.parse_args()
+
+    try:
+        old_slot, _, old, _ = load_slot_image(args.old, args.old_base)
+        new_slot, _, new, _ = load_slot_image(args.new, args.new_base)
+        if old_slot == new_slot:
+            print("note: both images are for slot %s" % "AB"[new_slot])
+        patch = make_patch(old, new)
+        if apply_patch(old, patch, len(new)) != new:
+            sys.exit("delta_patch: the patch does not reproduce the new image")
+    except (ElfError, PatchError) as e:
+        sys.exit("delta_patch: %s" % e)
+
+    print("old %u bytes (CRC-32 0x%08x), new %u bytes (CRC-32 0x%08x)"
+          % (len(old), zlib.crc32(old), len(new), zlib.crc32(new)))
+    print("patch %u bytes, %.1f%% of the new image" % (len(patch), 100.0 * len(patch) / len(new)))
+    if args.output:
+        with open(args.output, "wb") as f:
+            f.write(patch)
+
+
+if __name__ == "__main__":
+    main()
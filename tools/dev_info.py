@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""Query the device info of one or more targets over LPUART6.
+
+The target answers the 'D' command with a single osal_fwupd-style frame of
+type 0x84 (include/osal_devinfo.h): application metadata, the boot-time CRC
+and signature checks, the mbedTLS version, feature bits, reset reason, stack,
+heap and key-value store usage. One round-trip per device, no text parsing.
+
+Prints a summary per device, or one JSON object per line with --json.
+
+Usage: dev_info.py --port /dev/ttyUSB0 [--port /dev/ttyUSB1 ...] [--baud 115200] [--json]
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+from fw_send import COMMAND_LEN, Parser, SerialTransport
+
+DEVINFO = 0x84
+FORMAT = 1
+FIXED = struct.Struct("<BBbb16s12s24sIIIIII32sIIIIIIIHBBI")
+REGION = struct.Struct("<IIII")
+
+FEATURES = ("boot_profile", "secboot_key", "warm_boot", "clocks_kept", "ram_init_partial",
+            "fwupd", "fwupd_delta", "kv", "fault_log")
+HEAP_FLAGS = {1: "sram", 2: "dtcm", 4: "nc"}
+IMAGE_RESULTS = {0: "ok", -1: "bad magic", -2: "bad range", -3: "not stamped", -4: "CRC mismatch"}
+SECBOOT_RESULTS = {0: "ok", -1: "bad magic or range", -2: "digest mismatch", -3: "bad signature",
+                   -4: "no key", -5: "crypto error"}
+
+
+class DevInfoError(Exception):
+    pass
+
+
+def text(raw):
+    return raw.split(b"\0", 1)[0].decode("ascii", "replace")
+
+
+def decode(payload):
+    """Decode a device info payload into a dict."""
+    if len(payload) < FIXED.size or payload[0] != FORMAT:
+        raise DevInfoError("unsupported payload (%u bytes, format %u)" % (len(payload), payload[0] if payload else 0))
+    (_, slot, image, secboot, name, version, build, version_code, sequence, flash_start, image_size,
+     crc, crc_computed, sha256, mbedtls, features, des, fes, operational_us, stack_used, stack_size,
+     kv_keys, kv_free, regions, faults) = FIXED.unpack_from(payload)
+    if len(payload) < FIXED.size + regions * REGION.size:
+        raise DevInfoError("truncated region list")
+    heap = []
+    for i in range(regions):
+        flags, size, used, peak = REGION.unpack_from(payload, FIXED.size + i * REGION.size)
+        heap.append({"type": HEAP_FLAGS.get(flags, hex(flags)), "size": size, "used": used, "used_peak": peak})
+    return {
+        "app_name": text(name),
+        "version": text(version),
+        "build": text(build),
+        "version_code": version_code,
+        "sequence": sequence,
+        "slot": None if slot == 0xFF else "AB"[slot] if slot < 2 else slot,
+        "flash_start": flash_start,
+        "image_size": image_size,
+        "crc32": crc,
+        "crc32_computed": crc_computed,
+        "image_check": IMAGE_RESULTS.get(image, image),
+        "secboot_check": SECBOOT_RESULTS.get(secboot, secboot),
+        "sha256": sha256.hex(),
+        "mbedtls": "%u.%u.%u" % (mbedtls >> 24, (mbedtls >> 16) & 0xFF, (mbedtls >> 8) & 0xFF),
+        "features": [n for i, n in enumerate(FEATURES) if features & (1 << i)],
+        "reset_des": des,
+        "reset_fes": fes,
+        "operational_us": operational_us,
+        "stack_used": stack_used,
+        "stack_size": stack_size,
+        "kv_keys": kv_keys,
+        "kv_free_sectors": kv_free,
+        "faults": faults,
+        "heap": heap,
+    }
+
+
+def query(transport, timeout):
+    """Send 'D' and return the decoded reply; other output on the port is skipped."""
+    parser = Parser()
+    transport.write(b"D".ljust(COMMAND_LEN, b"\0"))
+    deadline = transport.now() + timeout
+    while transport.now() < deadline:
+        for ftype, _, payload in parser.feed(transport.read(0.05)):
+            if ftype == DEVINFO:
+                return decode(payload)
+    raise DevInfoError("no reply")
+
+
+def summary(info):
+    lines = [
+        "%s %s (0x%06x) seq %u, slot %s, built %s" % (info["app_name"], info["version"], info["version_code"],
+                                                     info["sequence"], info["slot"] or "-", info["build"]),
+        "  image 0x%08x + %u, CRC 0x%08x (computed 0x%08x): %s, signature: %s"
+        % (info["flash_start"], info["image_size"], info["crc32"], info["crc32_computed"],
+           info["image_check"], info["secboot_check"]),
+        "  mbedTLS %s, features %s" % (info["mbedtls"], ",".join(info["features"]) or "-"),
+        "  reset DES 0x%08x FES 0x%08x, operational in %u us"
+        % (info["reset_des"], info["reset_fes"], info["operational_us"]),
+        "  main stack %u / %u, kv %u keys %u free sectors, faults %u"
+        % (info["stack_used"], info["stack_size"], info["kv_keys"], info["kv_free_sectors"], info["faults"]),
+    ]
+    for r in info["heap"]:
+        lines.append("  heap %-4s %7u bytes, used %u, peak %u" % (r["type"], r["size"], r["used"], r["used_peak"]))
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--port", action="append", required=True, help="serial port of a target (repeatable)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--timeout", type=float, default=1.0, help="seconds to wait for each reply")
+    parser.add_argument("--json", action="store_true", help="one JSON object per line")
+    args = parser.parse_args()
+
+    failed = 0
+    for port in args.port:
+        try:
+            info = query(SerialTransport(port, args.baud), args.timeout)
+        except DevInfoError as e:
+            print("%s: %s" % (port, e), file=sys.stderr)
+            failed += 1
+            continue
+        info["port"] = port
+        print(json.dumps(info) if args.json else "%s: %s" % (port, summary(info)))
+    if failed:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,187 @@
+"""Minimal ELF32 little-endian reader/patcher for post-link steps.
+
+Only what the image tools need: sections, program headers (for load
+addresses), symbols, and reading/writing bytes by load address. The file is
+kept in memory and written back with save().
+"""
+
+import struct
+
+SHT_SYMTAB = 2
+SHT_NOBITS = 8
+SHF_ALLOC = 0x2
+PT_LOAD = 1
+STT_OBJECT = 1
+STT_FUNC = 2
+
+
+class ElfError(Exception):
+    pass
+
+
+class Section:
+    def __init__(self, name, sh_type, flags, addr, offset, size):
+        self.name = name
+        self.type = sh_type
+        self.flags = flags
+        self.addr = addr
+        self.offset = offset
+        self.size = size
+        self.lma = addr
+
+
+class Symbol:
+    def __init__(self, name, value, size, sym_type, shndx):
+        self.name = name
+        self.value = value
+        self.size = size
+        self.type = sym_type
+        self.shndx = shndx
+
+
+class Segment:
+    def __init__(self, p_type, offset, vaddr, paddr, filesz, memsz):
+        self.type = p_type
+        self.offset = offset
+        self.vaddr = vaddr
+        self.paddr = paddr
+        self.filesz = filesz
+        self.memsz = memsz
+
+
+class ElfImage:
+    def __init__(self, path):
+        self.path = path
+        with open(path, "rb") as f:
+            self.data = bytearray(f.read())
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1 or self.data[5] != 1:
+            raise ElfError("%s: not a 32-bit little-endian ELF file" % path)
+        self._parse()
+
+    def _parse(self):
+        (e_phoff, e_shoff, _flags, _ehsize, e_phentsize, e_phnum,
+         e_shentsize, e_shnum, e_shstrndx) = struct.unpack_from("<IIIHHHHHH", self.data, 0x1C)
+
+        self.segments = []
+        for i in range(e_phnum):
+            p_type, p_offset, p_vaddr, p_paddr, p_filesz, p_memsz = struct.unpack_from(
+                "<IIIIII", self.data, e_phoff + i * e_phentsize)
+            self.segments.append(Segment(p_type, p_offset, p_vaddr, p_paddr, p_filesz, p_memsz))
+
+        raw = []
+        for i in range(e_shnum):
+            raw.append(struct.unpack_from("<IIIIIIIIII", self.data, e_shoff + i * e_shentsize))
+        strtab = raw[e_shstrndx][4]
+
+        self.sections = []
+        for (name, sh_type, flags, addr, offset, size, link, _info, _align, _entsize) in raw:
+            sec = Section(self._cstr(strtab + name), sh_type, flags, addr, offset, size)
+            sec.link = link
+            self.sections.append(sec)
+
+        # Load address: from the segment whose file range holds the section
+        for sec in self.sections:
+            if not (sec.flags & SHF_ALLOC) or sec.type == SHT_NOBITS:
+                continue
+            for seg in self.segments:
+                if seg.type == PT_LOAD and seg.offset <= sec.offset < seg.offset + seg.filesz:
+                    sec.lma = seg.paddr + (sec.offset - seg.offset)
+                    break
+
+        self.symbols = {}
+        self.symtab = []
+        for sec in self.sections:
+            if sec.type != SHT_SYMTAB:
+                continue
+            names = self.sections[sec.link].offset
+            for off in range(sec.offset, sec.offset + sec.size, 16):
+                st_name, st_value, st_size, st_info, _st_other, st_shndx = struct.unpack_from(
+                    "<IIIBBH", self.data, off)
+                if st_name:
+                    name = self._cstr(names + st_name)
+                    self.symbols[name] = st_value
+                    self.symtab.append(Symbol(name, st_value, st_size, st_info & 0xF, st_shndx))
+
+    def _cstr(self, off):
+        end = self.data.index(b"\0", off)
+        return self.data[off:end].decode("ascii", "replace")
+
+    def symbol(self, name):
+        if name not in self.symbols:
+            raise ElfError("symbol %s not found" % name)
+        return self.symbols[name]
+
+    def section(self, name):
+        for sec in self.sections:
+            if sec.name == name:
+                return sec
+        return None
+
+    def _chunks(self, lma, size):
+        """Split [lma, lma + size) into (file offset, length) pieces; None if a byte is not in the file.
+        Load images of consecutive output sections sit in separate but adjacent segments."""
+        pieces = []
+        while size > 0:
+            for seg in self.segments:
+                if seg.type == PT_LOAD and seg.paddr <= lma < seg.paddr + seg.filesz:
+                    n = min(size, seg.paddr + seg.filesz - lma)
+                    pieces.append((seg.offset + (lma - seg.paddr), n))
+                    lma += n
+                    size -= n
+                    break
+            else:
+                return None
+        return pieces
+
+    def is_loaded(self, lma, size):
+        """True if every byte of [lma, lma + size) is programmed from the file."""
+        return self._chunks(lma, size) is not None
+
+    def read(self, lma, size):
+        pieces = self._chunks(lma, size)
+        if pieces is None:
+            raise ElfError("0x%08x+%u is not backed by the file" % (lma, size))
+        return b"".join(bytes(self.data[off:off + n]) for off, n in pieces)
+
+    def write(self, lma, payload):
+        pieces = self._chunks(lma, len(payload))
+        if pieces is None:
+            raise ElfError("0x%08x+%u is not backed by the file" % (lma, len(payload)))
+        pos = 0
+        for off, n in pieces:
+            self.data[off:off + n] = payload[pos:pos + n]
+            pos += n
+
+    def read_u32(self, lma):
+        return struct.unpack("<I", self.read(lma, 4))[0]
+
+    def write_u32(self, lma, value):
+        self.write(lma, struct.pack("<I", value))
+
+    def load_ranges(self, lo, hi):
+        """Loadable (lma, bytes) chunks that fall inside [lo, hi), in address order."""
+        chunks = []
+        for seg in self.segments:
+            if seg.type != PT_LOAD or seg.filesz == 0:
+                continue
+            if seg.paddr < lo or seg.paddr >= hi:
+                continue
+            chunks.append((seg.paddr, bytes(self.data[seg.offset:seg.offset + seg.filesz])))
+        return sorted(chunks)
+
+    def flat_image(self, lo, hi, fill=0xFF):
+        """Raw image of the loadable bytes in [lo, hi) as programmed, from the lowest loaded
+        address, trailing erased bytes trimmed. Returns (start address, bytes)."""
+        chunks = self.load_ranges(lo, hi)
+        if not chunks:
+            return lo, b""
+        start = chunks[0][0]
+        end = max(addr + len(body) for addr, body in chunks)
+        image = bytearray([fill]) * (end - start)
+        for addr, body in chunks:
+            image[addr - start:addr - start + len(body)] = body
+        return start, bytes(image).rstrip(bytes([fill]))
+
+    def save(self, path=None):
+        with open(path or self.path, "wb") as f:
+            f.write(self.data)
@@ -0,0 +1,269 @@
+#!/usr/bin/env python3
+"""Pick the hottest functions for ITCM and their data for DTCM from a PC sample profile.
+
+Input is the linked ELF plus one or more sample dumps, either:
+  - a raw SWO/ITM capture with DWT periodic PC sample packets (enable
+    DWT_CTRL.PCSAMPLENA and the SWO output from the probe, e.g. J-Link SWO
+    or OpenOCD "tpiu config" + "itm port"), or
+  - a text file with one program counter per line (first hex number on the
+    line), as exported by most probe/IDE PC sampling views.
+
+Functions are ranked by sample count and taken while they fit the ITCM
+budget. For each chosen function the literal pool is scanned for addresses of
+cacheable SRAM objects (.data/.bss); those are ranked by the samples of the
+functions that use them and taken while they fit the DTCM budget.
+
+The result is written as two linker script fragments, INCLUDEd by the
+.itcm_text and .data_tcm_data output sections:
+
+    osal_fast_text.ld   *(.text.<function>)
+    osal_fast_data.ld   *(.data.<object>) / *(.bss.<object>)
+
+Both need -ffunction-sections / -fdata-sections. Pass the linker map (-Map)
+to use the real input section names and skip functions that do not have a
+section of their own (RTD .mcal_text, assembly). Code that runs before the
+init table is copied (Reset_Handler, SystemInit, init_data_bss...) is never
+moved. Review the data list for buffers that a DMA master must reach.
+
+Usage: fast_sections.py app.elf samples... [--map app.map] [-o dir]
+"""
+
+import argparse
+import bisect
+import os
+import re
+import struct
+import sys
+from collections import defaultdict
+
+from elfimage import ElfImage, ElfError, STT_FUNC, STT_OBJECT, SHT_NOBITS
+
+ITCM_START, ITCM_END = 0x00000000, 0x00008000
+PFLASH_START, PFLASH_END = 0x00400000, 0x00600000
+# Cacheable SRAM (int_sram); the non-cacheable and shareable regions are left alone
+SRAM_START, SRAM_END = 0x20400000, 0x20407F00
+
+# Runs before the init table is copied, or from the init table copy itself
+NEVER_MOVE = r"^(Reset_Handler|SystemInit|RamInit.*|init_data_bss.*|Sys_.*|startup_.*|_start)$"
+
+# ITM: hardware source packet, discriminator 2 = periodic PC sample
+ITM_PC_SAMPLE = (2 << 3) | 0x4
+
+
+def parse_itm(data):
+    """PC values of the 4-byte periodic PC sample packets (1-byte ones are sleep samples)."""
+    pcs = []
+    i = 0
+    while i < len(data):
+        header = data[i]
+        size = header & 0x3
+        if size == 0:
+            # Sync, overflow, timestamps, extension: skip continuation bytes
+            i += 1
+            if header & 0x80 and header != 0x80:
+                while i < len(data) and data[i] & 0x80:
+                    i += 1
+                i += 1
+            continue
+        n = 4 if size == 3 else size
+        if (header & ~0x3) == ITM_PC_SAMPLE and n == 4 and i + 5 <= len(data):
+            pcs.append(struct.unpack_from("<I", data, i + 1)[0])
+        i += 1 + n
+    return pcs
+
+
+def load_samples(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    try:
+        text = data.decode("ascii")
+    except UnicodeDecodeError:
+        return parse_itm(data)
+    pcs = []
+    for line in text.splitlines():
+        m = re.search(r"\b(?:0x)?([0-9a-fA-F]{6,8})\b", line)
+        if m:
+            pcs.append(int(m.group(1), 16))
+    return pcs
+
+
+def parse_map(path):
+    """Input sections from a GNU ld map: list of (addr, size, name, object), sorted."""
+    sections = []
+    pending = None
+    entry = re.compile(r"^ (\.\S+)?\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S.*)$")
+    with open(path) as f:
+        for line in f:
+            line = line.rstrip("\n")
+            name_only = re.match(r"^ (\.\S+)$", line)
+            if name_only:
+                pending = name_only.group(1)  # Long names wrap onto the next line
+                continue
+            m = entry.match(line)
+            if m and (m.group(1) or pending):
+                size = int(m.group(3), 16)
+                if size:
+                    sections.append((int(m.group(2), 16), size, m.group(1) or pending, m.group(4)))
+            pending = None
+    sections.sort()
+    return sections
+
+
+def find_section(sections, addr):
+    i = bisect.bisect_right(sections, (addr, 0xFFFFFFFF)) - 1
+    if i >= 0 and sections[i][0] <= addr < sections[i][0] + sections[i][1]:
+        return sections[i]
+    return None
+
+
+class Profile:
+    def __init__(self, elf):
+        self.elf = elf
+        self.funcs = sorted((s.value & ~1, s.size, s.name) for s in elf.symtab
+                            if s.type == STT_FUNC and s.size)
+        self.starts = [f[0] for f in self.funcs]
+        nobits = {i for i, sec in enumerate(elf.sections) if sec.type == SHT_NOBITS}
+        self.objects = sorted((s.value, s.size, s.name, s.shndx in nobits) for s in elf.symtab
+                              if s.type == STT_OBJECT and s.size and SRAM_START <= s.value < SRAM_END)
+        self.obj_starts = [o[0] for o in self.objects]
+
+    def function_at(self, pc):
+        i = bisect.bisect_right(self.starts, pc & ~1) - 1
+        if i >= 0 and pc < self.funcs[i][0] + self.funcs[i][1]:
+            return self.funcs[i]
+        return None
+
+    def object_at(self, addr):
+        i = bisect.bisect_right(self.obj_starts, addr) - 1
+        if i >= 0 and addr < self.objects[i][0] + self.objects[i][1]:
+            return self.objects[i]
+        return None
+
+    def data_of(self, func):
+        """Objects whose address appears in the function body (literal pool)."""
+        addr, size, _name = func
+        body = self.elf.read(addr, size)
+        found = set()
+        for off in range(0, len(body) - 3, 2):
+            obj = self.object_at(struct.unpack_from("<I", body, off)[0])
+            if obj is not None:
+                found.add(obj)
+        return found
+
+
+def align4(n):
+    return (n + 3) & ~3
+
+
+def write_fragment(path, header, lines):
+    with open(path, "w") as f:
+        f.write("/* %s\n * Generated by tools/fast_sections.py; do not edit. */\n" % header)
+        for line in lines:
+            f.write("%s\n" % line)
+
+
+def main():
+    default_dir = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "Project_Settings", "Linker_Files")
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf")
+    parser.add_argument("samples", nargs="+", help="SWO/ITM capture or text PC list")
+    parser.add_argument("--map", help="linker map of the same build")
+    parser.add_argument("--itcm-budget", type=lambda v: int(v, 0), default=0x6000,
+                        help="bytes of ITCM for moved functions (default 24 KB)")
+    parser.add_argument("--dtcm-budget", type=lambda v: int(v, 0), default=0x2000,
+                        help="bytes of DTCM for moved data (default 8 KB)")
+    parser.add_argument("--min-share", type=float, default=0.5,
+                        help="ignore functions below this percentage of the samples")
+    parser.add_argument("--exclude", action="append", default=[], help="regex of symbols to keep in place")
+    parser.add_argument("-o", "--output-dir", default=default_dir)
+    args = parser.parse_args()
+
+    try:
+        elf = ElfImage(args.elf)
+        profile = Profile(elf)
+    except ElfError as e:
+        sys.exit("fast_sections: %s" % e)
+
+    pcs = []
+    for path in args.samples:
+        pcs.extend(load_samples(path))
+    if not pcs:
+        sys.exit("fast_sections: no PC samples found")
+
+    hits = defaultdict(int)
+    unknown = 0
+    for pc in pcs:
+        func = profile.function_at(pc)
+        if func is None:
+            unknown += 1
+        else:
+            hits[func] += 1
+
+    map_sections = parse_map(args.map) if args.map else None
+    exclude = [re.compile(NEVER_MOVE)] + [re.compile(x) for x in args.exclude]
+
+    print("%u samples, %u outside known functions" % (len(pcs), unknown))
+    print("%-36s %8s %6s %6s  %s" % ("function", "samples", "share", "size", "placement"))
+
+    text, chosen = [], []
+    used = 0
+    for func, count in sorted(hits.items(), key=lambda kv: -kv[1]):
+        addr, size, name = func
+        share = 100.0 * count / len(pcs)
+        if share < args.min_share:
+            break
+        if ITCM_START <= addr < ITCM_END:
+            note = "already in ITCM"
+        elif not PFLASH_START <= addr < PFLASH_END:
+            note = "not in flash"
+        elif any(x.match(name) for x in exclude):
+            note = "excluded"
+        elif used + align4(size) > args.itcm_budget:
+            note = "over budget"
+        else:
+            section = ".text." + name
+            if map_sections is not None:
+                input_section = find_section(map_sections, addr)
+                if input_section is None or not input_section[2].startswith(".text."):
+                    note = "shares %s" % (input_section[2] if input_section else "an unnamed section")
+                    print("%-36s %8u %5.1f%% %6u  %s" % (name, count, share, size, note))
+                    continue
+                section = input_section[2]
+            text.append("*(%s)" % section)
+            chosen.append((func, count))
+            used += align4(size)
+            note = "-> ITCM"
+        print("%-36s %8u %5.1f%% %6u  %s" % (name, count, share, size, note))
+
+    # Data referenced by the moved functions, weighted by their samples
+    weight = defaultdict(int)
+    for func, count in chosen:
+        for obj in profile.data_of(func):
+            weight[obj] += count
+
+    data = []
+    data_used = 0
+    for obj, count in sorted(weight.items(), key=lambda kv: -kv[1]):
+        addr, size, name, is_bss = obj
+        if any(x.match(name) for x in exclude) or data_used + align4(size) > args.dtcm_budget:
+            continue
+        section = (".bss." if is_bss else ".data.") + name
+        if map_sections is not None:
+            input_section = find_section(map_sections, addr)
+            if input_section is None or not re.match(r"^\.(s?bss|s?data)\.", input_section[2]):
+                continue
+            section = input_section[2]
+        data.append("*(%s)" % section)
+        data_used += align4(size)
+        print("%-36s %8u %6s %6u  -> DTCM" % (name, count, "", size))
+
+    write_fragment(os.path.join(args.output_dir, "osal_fast_text.ld"),
+                   "Hot functions placed in ITCM (%u bytes), included by .itcm_text." % used, text)
+    write_fragment(os.path.join(args.output_dir, "osal_fast_data.ld"),
+                   "Data of the hot functions placed in DTCM (%u bytes), included by .data_tcm_data." % data_used,
+                   data)
+    print("ITCM %u / %u bytes, DTCM %u / %u bytes" % (used, args.itcm_budget, data_used, args.dtcm_budget))
+
+
+if __name__ == "__main__":
+    main()
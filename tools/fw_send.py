@@ -0,0 +1,434 @@
+#!/usr/bin/env python3
+"""Send a firmware image to the inactive slot over the LPUART6 update protocol.
+
+The image is a stamped (crc_stamp.py) or signed (sign_image.py) application
+linked for the slot that is not running. The target enters the receiver on
+the 'U' command and answers with osal_fwupd frames (include/osal_fwupd.h):
+
+    SOF 0xA5, type, seq (u16), len (u16), payload, CRC-32 over type..payload
+
+This tool sends START, then the image in 256-byte DATA chunks with up to
+--window chunks unacknowledged (go-back-N on a NAK or a timeout), then END
+with the metadata block, and waits for DONE.
+
+--simulate runs the same sender against a timing model of the link and of
+the receiver's erase/program pipeline instead of a serial port, and prints the
+effective throughput. It estimates time only: the receiver itself
+(src/osal_fwupd.c) is run on the host flash model, full and delta updates
+checked byte for byte, by tools/host_test (test_fwupd). Flash timings default to typical C40 figures; pass the
+data sheet values to be pessimistic. --no-pipeline models a receiver that
+erases each sector only when the first chunk for it arrives.
+
+With --delta the image is sent as a patch (delta_patch.py) against the
+image running in the other slot, which the target checks by its CRC-32. The
+simulation then reports the full and the delta transfer.
+
+Usage: fw_send.py app.elf --port /dev/ttyUSB0 [--baud 115200] [--window 8]
+       fw_send.py app.bin --base 0x500000 --port /dev/ttyUSB0
+       fw_send.py app.elf --delta running.elf --port /dev/ttyUSB0
+       fw_send.py app.elf --simulate [--delta running.elf] [--baud 921600] [--erase-ms 8] [--program-us 60]
+                  [--window 8] [--no-pipeline] [--error-rate 0.001]
+"""
+
+import argparse
+import heapq
+import random
+import struct
+import sys
+import time
+import zlib
+
+from crc_stamp import load_slot_image
+from delta_patch import apply_patch, make_patch, PatchError
+from elfimage import ElfError
+
+SOF = 0xA5
+START, DATA, END, ABORT = 0x01, 0x02, 0x03, 0x04
+ACK, NAK, DONE = 0x81, 0x82, 0x83
+CHUNK = 256
+WINDOW = 8
+FRAME_OVERHEAD = 10             # SOF, type, seq, len, CRC
+COMMAND_LEN = 50                # main.c reads fixed 50-byte commands
+SECTOR = 0x2000
+PAGE = 128
+
+RESULTS = {0: "ok", -1: "aborted", -2: "bad START", -3: "flash error", -4: "image CRC mismatch",
+           -5: "verification failed", -6: "timeout", -7: "bad patch"}
+
+
+def frame(ftype, seq, payload=b""):
+    body = struct.pack("<BHH", ftype, seq & 0xFFFF, len(payload)) + payload
+    return bytes([SOF]) + body + struct.pack("<I", zlib.crc32(body))
+
+
+class Parser:
+    """Incremental parser for the target's replies."""
+
+    def __init__(self):
+        self.buf = bytearray()
+
+    def feed(self, data):
+        self.buf += data
+        frames = []
+        while True:
+            start = self.buf.find(bytes([SOF]))
+            if start < 0:
+                self.buf.clear()
+                return frames
+            del self.buf[:start]
+            if len(self.buf) < 6:
+                return frames
+            ftype, seq, length = struct.unpack("<BHH", self.buf[1:6])
+            if length > CHUNK:
+                del self.buf[:1]
+                continue
+            if len(self.buf) < 6 + length + 4:
+                return frames
+            body = bytes(self.buf[1:6 + length])
+            crc, = struct.unpack("<I", self.buf[6 + length:10 + length])
+            if crc == zlib.crc32(body):
+                frames.append((ftype, seq, body[5:]))
+                del self.buf[:10 + length]
+            else:
+                del self.buf[:1]
+
+
+class Sender:
+    """Go-back-N sender; the transport supplies write(), read(timeout) and now()."""
+
+    def __init__(self, transport, base, image, metadata, window, ack_timeout, patch=None, old_crc=None):
+        self.t = transport
+        self.base = base
+        self.image = image
+        self.metadata = metadata
+        self.window = window
+        self.ack_timeout = ack_timeout
+        self.patch = patch
+        self.old_crc = old_crc
+        self.stream = image if patch is None else patch
+        self.chunks = (len(self.stream) + CHUNK - 1) // CHUNK
+        self.parser = Parser()
+        self.retransmits = 0
+        self.timeouts = 0
+
+    def _replies(self, timeout):
+        return self.parser.feed(self.t.read(timeout))
+
+    def _chunk(self, seq):
+        return frame(DATA, seq, self.stream[seq * CHUNK:(seq + 1) * CHUNK])
+
+    def run(self):
+        header = struct.pack("<III", self.base, len(self.image), zlib.crc32(self.image))
+        if self.patch is not None:
+            header += struct.pack("<II", len(self.patch), self.old_crc)
+        start = frame(START, 0, header)
+        acked = None
+        while acked is None:
+            self.t.write(start)
+            deadline = self.t.now() + max(self.ack_timeout, 1.0)
+            while acked is None and self.t.now() < deadline:
+                for ftype, seq, payload in self._replies(deadline - self.t.now()):
+                    if ftype == ACK:
+                        acked = seq
+                    elif ftype == DONE:
+                        return struct.unpack("<b", payload[:1])[0]
+
+        acked = 0
+        sent = 0
+        last_progress = self.t.now()
+        end_sent = None
+        while True:
+            if sent < self.chunks and sent < acked + self.window:
+                self.t.write(self._chunk(sent))
+                sent += 1
+                replies = self._replies(0)
+            elif acked == self.chunks:
+                if end_sent is None or self.t.now() - end_sent > self.ack_timeout * 4:
+                    self.t.write(frame(END, self.chunks, self.metadata))
+                    end_sent = self.t.now()
+                replies = self._replies(self.ack_timeout)
+            else:
+                replies = self._replies(self.ack_timeout)
+
+            for ftype, seq, payload in replies:
+                # The 16-bit seq of a reply is the low half of a chunk index within the window
+                full = acked + ((seq - acked) & 0xFFFF)
+                if ftype == ACK and acked < full <= self.chunks:
+                    acked = full
+                    last_progress = self.t.now()
+                elif ftype == NAK and acked <= full <= self.chunks:
+                    acked = full
+                    self.retransmits += sent - acked
+                    sent = acked
+                    last_progress = self.t.now()
+                elif ftype == DONE:
+                    return struct.unpack("<b", payload[:1])[0]
+            if acked < self.chunks and self.t.now() - last_progress > self.ack_timeout:
+                self.timeouts += 1
+                self.retransmits += sent - acked
+                sent = acked
+                last_progress = self.t.now()
+
+
+class SerialTransport:
+    def __init__(self, port, baud):
+        try:
+            import serial
+        except ImportError:
+            sys.exit("fw_send: pyserial is required for --port (pip install pyserial)")
+        self.port = serial.Serial(port, baud, timeout=0)
+
+    def write(self, data):
+        self.port.write(data)
+
+    def read(self, timeout):
+        deadline = time.monotonic() + timeout
+        while True:
+            data = self.port.read(4096)
+            if data or time.monotonic() >= deadline:
+                return data
+            time.sleep(0.001)
+
+    def now(self):
+        return time.monotonic()
+
+
+class SimulatedTarget:
+    """Timing model (no image is written) of the link and of osal_fwupd_poll(): frames arrive
+    after their wire time, the receiver writes the output of one chunk at a time once its
+    sectors are erased, erases ahead while chunks are on the wire, and ACKs each chunk when it
+    is consumed. marks[k] is
+    the image size produced after chunk k (a patch chunk may produce any amount)."""
+
+    def __init__(self, base, size, baud, erase_s, program_s, pipeline, error_rate, rng, marks=None):
+        self.byte_s = 10.0 / baud
+        self.erase_s = erase_s
+        self.program_s = program_s
+        self.pipeline = pipeline
+        self.error_rate = error_rate
+        self.rng = rng
+        self.base = base
+        self.end = base + ((size + SECTOR - 1) & ~(SECTOR - 1))
+        if marks is None:
+            marks = [min(size, (k + 1) * CHUNK) for k in range((size + CHUNK - 1) // CHUNK)]
+        self.marks = marks
+        self.clock = 0.0
+        self.tx_free = 0.0              # host -> target wire
+        self.rx_free = 0.0              # target -> host wire
+        self.events = []                # (time, order, kind, data)
+        self.order = 0
+        self.inbox = []                 # frames in the receive ring
+        self.replies = []               # (arrival time, bytes)
+        self.flash_busy = False
+        self.pending = None             # frame being written
+        self.erased_end = base
+        self.next_seq = 0
+        self.state = "start"
+        self.nak_sent = False
+        self.erases = 0
+        self.overlapped = 0
+        self.flash_time = 0.0
+
+    def _at(self, when, kind, data=None):
+        heapq.heappush(self.events, (when, self.order, kind, data))
+        self.order += 1
+
+    def _reply(self, data):
+        start = max(self.clock, self.rx_free)
+        self.rx_free = start + len(data) * self.byte_s
+        self.replies.append((self.rx_free, data))
+
+    def _flash(self, duration, kind):
+        self.flash_busy = True
+        self.flash_time += duration
+        self._at(self.clock + duration, kind)
+
+    def _run_receiver(self):
+        while not self.flash_busy:
+            if self.pending is None and self.inbox:
+                f = self.inbox.pop(0)
+                if f is None:
+                    if not self.nak_sent:
+                        self.nak_sent = True
+                        self._reply(frame(NAK, self.next_seq, b"\x01"))
+                    continue
+                ftype, seq, payload = f
+                if ftype == START and self.state == "start":
+                    self.pending = f
+                    self.erases += 1
+                    self._flash(self.erase_s, "meta_erased")
+                    return
+                if ftype == START:
+                    self._reply(frame(ACK, self.next_seq))
+                    continue
+                if ftype == END and self.state == "data":
+                    self.pending = f
+                    self._flash(2 * self.program_s, "meta_programmed")
+                    return
+                if ftype != DATA or self.state != "data":
+                    continue
+                if seq != self.next_seq & 0xFFFF:
+                    if not self.nak_sent:
+                        self.nak_sent = True
+                        self._reply(frame(NAK, self.next_seq, b"\x02"))
+                    continue
+                self.nak_sent = False
+                self.pending = f
+            write = self.base + (self.marks[self.next_seq - 1] if self.next_seq > 0 else 0)
+            if self.pending is not None and self.pending[0] == DATA:
+                out_end = self.base + self.marks[self.next_seq]
+                if out_end <= self.erased_end:
+                    pages = (out_end - write + PAGE - 1) // PAGE
+                    self._flash(pages * self.program_s, "programmed")
+                    return
+                self.erases += 1
+                self._flash(self.erase_s, "erased")
+                return
+            ahead = (write & ~(SECTOR - 1)) + 2 * SECTOR if self.pipeline else self.base
+            if self.state == "data" and self.erased_end < self.end and self.erased_end < ahead:
+                self.erases += 1
+                if self.pending is None:
+                    self.overlapped += 1
+                self._flash(self.erase_s, "erased")
+                return
+            return
+
+    def _step(self):
+        when, _, kind, data = heapq.heappop(self.events)
+        self.clock = when
+        if kind == "frame":
+            self.inbox.append(data)
+        else:
+            self.flash_busy = False
+            if kind == "meta_erased":
+                self.pending = None
+                self.state = "data"
+                self._reply(frame(ACK, 0))
+            elif kind == "erased":
+                self.erased_end += SECTOR
+            elif kind == "programmed":
+                self.pending = None
+                self.next_seq += 1
+                self._reply(frame(ACK, self.next_seq))
+            elif kind == "meta_programmed":
+                self.pending = None
+                self.state = "done"
+                self._reply(frame(DONE, self.next_seq, b"\x00"))
+        self._run_receiver()
+
+    # Transport interface for Sender
+    def write(self, data):
+        start = max(self.clock, self.tx_free)
+        self.tx_free = start + len(data) * self.byte_s
+        body = data[1:-4]
+        ftype, seq, _ = struct.unpack("<BHH", body[:5])
+        corrupt = self.rng.random() < self.error_rate * len(data)
+        self._at(self.tx_free, "frame", None if corrupt else (ftype, seq, body[5:]))
+
+    def read(self, timeout):
+        # The host does not wait while it can still fill the wire
+        limit = self.clock + timeout if timeout > 0 else max(self.clock, self.tx_free - 2 * CHUNK * self.byte_s)
+        while True:
+            ready = [r for r in self.replies if r[0] <= self.clock]
+            if ready:
+                self.replies = [r for r in self.replies if r[0] > self.clock]
+                return b"".join(r[1] for r in ready)
+            upcoming = [r[0] for r in self.replies]
+            if self.events:
+                upcoming.append(self.events[0][0])
+            nxt = min(upcoming) if upcoming else None
+            if nxt is None or nxt > limit:
+                self.clock = max(self.clock, limit)
+                return b""
+            if self.events and self.events[0][0] <= nxt:
+                self._step()
+            else:
+                self.clock = nxt
+
+    def now(self):
+        return self.clock
+
+
+def simulate(args, base, image, metadata, patch=None, old_crc=None, marks=None):
+    target = SimulatedTarget(base, len(image), args.baud, args.erase_ms / 1000.0, args.program_us / 1e6,
+                             not args.no_pipeline, args.error_rate, random.Random(args.seed), marks)
+    sender = Sender(target, base, image, metadata, args.window, args.timeout, patch, old_crc)
+    result = sender.run()
+    elapsed = target.now()
+    sent = len(sender.stream)
+    wire = 10.0 / args.baud * (sent + ((sent + CHUNK - 1) // CHUNK) * FRAME_OVERHEAD)
+    print("%s: %u bytes sent, %.2f s, %.1f KB/s of image (wire limit %.1f KB/s)"
+          % ("full image" if patch is None else "delta", sent, elapsed, len(image) / elapsed / 1024,
+             len(image) / wire / 1024))
+    print("  erases %u (%u overlapped with reception), flash busy %.0f%%, retransmitted chunks %u, timeouts %u"
+          % (target.erases, target.overlapped, 100.0 * target.flash_time / elapsed,
+             sender.retransmits, sender.timeouts))
+    return result, elapsed
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("image", help="stamped or signed ELF, or flat binary with --base")
+    parser.add_argument("--base", type=lambda v: int(v, 0), help="load address of a flat binary")
+    parser.add_argument("--slot", type=int, choices=(0, 1), help="slot whose metadata to use (flat binaries)")
+    parser.add_argument("--delta", metavar="OLD", help="send a patch against this image (the running one)")
+    parser.add_argument("--port", help="serial port of the target")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--window", type=int, default=WINDOW, help="unacknowledged chunks (at most %d)" % WINDOW)
+    parser.add_argument("--timeout", type=float, default=0.5, help="seconds without an ACK before going back")
+    parser.add_argument("--simulate", action="store_true", help="model the link and receiver, no port")
+    parser.add_argument("--erase-ms", type=float, default=8.0, help="sector erase time (simulation)")
+    parser.add_argument("--program-us", type=float, default=60.0, help="128-byte page program time (simulation)")
+    parser.add_argument("--no-pipeline", action="store_true", help="erase on demand (simulation)")
+    parser.add_argument("--error-rate", type=float, default=0.0, help="per-byte error probability (simulation)")
+    parser.add_argument("--seed", type=int, default=1, help="random seed (simulation)")
+    args = parser.parse_args()
+
+    if not 1 <= args.window <= WINDOW:
+        sys.exit("fw_send: --window must be 1..%d" % WINDOW)
+    try:
+        slot, base, image, metadata = load_slot_image(args.image, args.base, args.slot)
+    except ElfError as e:
+        sys.exit("fw_send: %s" % e)
+    print("slot %s: %u bytes at 0x%08x" % ("AB"[slot], len(image), base))
+
+    patch = old_crc = marks = None
+    if args.delta:
+        try:
+            old_slot, _, old, _ = load_slot_image(args.delta)
+            if old_slot == slot:
+                sys.exit("fw_send: the old image must be the one in the other slot")
+            patch = make_patch(old, image)
+            marks = apply_patch(old, patch, len(image), CHUNK)[1]
+        except (ElfError, PatchError) as e:
+            sys.exit("fw_send: %s" % e)
+        old_crc = zlib.crc32(old)
+        print("patch against slot %s: %u bytes, %.1f%% of the image" % ("AB"[old_slot], len(patch),
+                                                                       100.0 * len(patch) / len(image)))
+
+    if args.simulate:
+        print("%s pipeline, %u baud, window %u" % ("no" if args.no_pipeline else "with", args.baud, args.window))
+        result, elapsed = simulate(args, base, image, metadata)
+        if patch is not None and result == 0:
+            full = elapsed
+            result, elapsed = simulate(args, base, image, metadata, patch, old_crc, marks)
+            print("delta update takes %.0f%% of the full image time" % (100.0 * elapsed / full))
+    else:
+        if args.port is None:
+            sys.exit("fw_send: give --port or --simulate")
+        transport = SerialTransport(args.port, args.baud)
+        transport.write(b"U".ljust(COMMAND_LEN, b"\0"))
+        t0 = time.monotonic()
+        sender = Sender(transport, base, image, metadata, args.window, args.timeout, patch, old_crc)
+        result = sender.run()
+        elapsed = time.monotonic() - t0
+        print("%.2f s, %.1f KB/s, retransmitted chunks %u, timeouts %u"
+              % (elapsed, len(image) / elapsed / 1024, sender.retransmits, sender.timeouts))
+
+    print("result: %s" % RESULTS.get(result, result))
+    if result != 0:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
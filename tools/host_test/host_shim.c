@@ -0,0 +1,18 @@
+#include "host_test.h"
+#include "osal_log.h"
+
+// Host side of the target services the modules under test call
+
+uint32_t host_test_failures;
+
+void osal_log_info(const char *msg)
+{
+    fputs(msg, stdout);
+}
+
+int host_test_exit(const char *name)
+{
+    printf("%s: %s (%lu failures)\n", name, (host_test_failures == 0U) ? "ok" : "FAILED",
+           (unsigned long)host_test_failures);
+    return (host_test_failures == 0U) ? 0 : 1;
+}
@@ -0,0 +1,39 @@
+#ifndef HOST_TEST_H_
+#define HOST_TEST_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Minimal checks for the host tests: report the failing expression and keep going, so one
+// run lists every failure; host_test_exit() turns the count into the exit status.
+
+extern uint32_t host_test_failures;
+
+#define HOST_CHECK(expr) \
+    do { \
+        if (!(expr)) { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); \
+            host_test_failures++; \
+        } \
+    } while (0)
+
+/**
+ * Print the result of a test program.
+ * @param name: Test name.
+ * @return: Exit status, 0 if every check passed.
+ */
+int host_test_exit(const char *name);
+
+/**
+ * Deterministic pseudo-random numbers (LCG), so failures reproduce.
+ * @param seed: State, updated.
+ * @return: Next value.
+ */
+static inline uint32_t host_test_rand(uint32_t *seed)
+{
+    *seed = (*seed * 1664525UL) + 1013904223UL;
+    return *seed >> 8;
+}
+
+#endif /* HOST_TEST_H_ */
@@ -0,0 +1,73 @@
+#include "host_test.h"
+#include "osal_crc32.h"
+#include "osal_devinfo.h"
+#include <string.h>
+
+// Info frame against the layout documented in osal_devinfo.h (and decoded by tools/dev_info.py)
+
+static uint32_t test_devinfo_get32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+int main(void)
+{
+    static uint8_t frame[OSAL_DEVINFO_FRAME_MAX + 8U];
+    osal_devinfo_t info;
+    const uint8_t *payload = &frame[OSAL_FWUPD_HDR_LEN];
+
+    memset(&info, 0, sizeof(info));
+    info.slot = 1U;
+    info.image_status = -4;
+    info.secboot_status = -3;
+    strcpy(info.app_name, "s32k_demo");
+    strcpy(info.version, "1.2.3");
+    info.version_code = 0x010203UL;
+    info.sequence = 7U;
+    info.crc32 = 0xCAFEF00DUL;
+    info.sha256[31] = 0x42U;
+    info.features = 0x1FFUL;
+    info.operational_us = 12345U;
+    info.kv_keys = 0x1234U;
+    info.kv_free_sectors = 3U;
+    info.faults = 9U;
+    info.regions = 2U;
+    info.region[1].used_peak = 0xA5A5A5A5UL;
+
+    memset(frame, 0xEE, sizeof(frame));
+    uint32_t len = osal_devinfo_encode(&info, frame);
+    uint32_t payload_len = OSAL_DEVINFO_FIXED_LEN + (2U * OSAL_DEVINFO_REGION_LEN);
+
+    HOST_CHECK(len == OSAL_FWUPD_HDR_LEN + payload_len + 4U);
+    HOST_CHECK(frame[0] == OSAL_FWUPD_SOF);
+    HOST_CHECK(frame[1] == OSAL_DEVINFO_FRAME);
+    HOST_CHECK((frame[4] | (frame[5] << 8)) == (int)payload_len);
+    HOST_CHECK(test_devinfo_get32(&frame[len - 4U]) == osal_crc32(&frame[1], len - 5U));
+    HOST_CHECK(frame[len] == 0xEEU);
+
+    HOST_CHECK(payload[0x00] == OSAL_DEVINFO_FORMAT);
+    HOST_CHECK(payload[0x01] == 1U);
+    HOST_CHECK((int8_t)payload[0x02] == -4);
+    HOST_CHECK((int8_t)payload[0x03] == -3);
+    HOST_CHECK(strcmp((const char *)&payload[0x04], "s32k_demo") == 0);
+    HOST_CHECK(strcmp((const char *)&payload[0x14], "1.2.3") == 0);
+    HOST_CHECK(test_devinfo_get32(&payload[0x38]) == 0x010203UL);
+    HOST_CHECK(test_devinfo_get32(&payload[0x3C]) == 7U);
+    HOST_CHECK(test_devinfo_get32(&payload[0x48]) == 0xCAFEF00DUL);
+    HOST_CHECK(payload[0x50 + 31] == 0x42U);
+    HOST_CHECK(test_devinfo_get32(&payload[0x74]) == 0x1FFUL);
+    HOST_CHECK(test_devinfo_get32(&payload[0x80]) == 12345U);
+    HOST_CHECK((payload[0x8C] | (payload[0x8D] << 8)) == 0x1234);
+    HOST_CHECK(payload[0x8E] == 3U);
+    HOST_CHECK(payload[0x8F] == 2U);
+    HOST_CHECK(test_devinfo_get32(&payload[0x90]) == 9U);
+    HOST_CHECK(test_devinfo_get32(&payload[OSAL_DEVINFO_FIXED_LEN + OSAL_DEVINFO_REGION_LEN + 12U]) == 0xA5A5A5A5UL);
+
+    // More regions than the target has are clamped
+    info.regions = 0xFFU;
+    len = osal_devinfo_encode(&info, frame);
+    HOST_CHECK(len == OSAL_FWUPD_HDR_LEN + OSAL_DEVINFO_PAYLOAD_MAX + 4U);
+    HOST_CHECK(len <= OSAL_DEVINFO_FRAME_MAX);
+
+    return host_test_exit("test_devinfo");
+}
@@ -0,0 +1,293 @@
+#include "host_test.h"
+#include "osal_crc32.h"
+#include "osal_flash.h"
+#include "osal_fwupd.h"
+#include "osal_slot.h"
+#include <string.h>
+
+// Update receiver end to end: a go-back-N sender as in tools/fw_send.py feeds frames in random
+// splits to osal_fwupd_receive(), interleaved with osal_fwupd_poll(), and the slot written
+// through the flash model must match the image byte for byte. Covers a full image, a delta
+// patch against slot A (encoded here in the record format of osal_delta.h), damaged frames,
+// a patch for the wrong running image and a corrupt patch.
+
+#define TEST_FWUPD_OLD_SIZE 0x9000U
+#define TEST_FWUPD_NEW_MAX (TEST_FWUPD_OLD_SIZE + 0x1000U)
+#define TEST_FWUPD_POLLS 100000U
+
+static uint8_t *test_fwupd_flash;          // Model of the application area from OSAL_SLOT_A_BASE
+static osal_slot_flash_t test_fwupd_backend;
+static uint32_t test_fwupd_seed = 11U;
+
+// Replies of the receiver
+static uint32_t test_fwupd_acked;
+static bool test_fwupd_nak;
+static uint32_t test_fwupd_nak_seq;
+static int32_t test_fwupd_done;
+static uint32_t test_fwupd_naks;
+
+static void test_fwupd_put32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint8_t *test_fwupd_at(uint32_t addr)
+{
+    return &test_fwupd_flash[addr - OSAL_SLOT_A_BASE];
+}
+
+static void test_fwupd_send(const uint8_t *data, uint32_t len)
+{
+    uint32_t seq = (uint32_t)data[2] | ((uint32_t)data[3] << 8);
+
+    HOST_CHECK(len >= (OSAL_FWUPD_HDR_LEN + 4U));
+    HOST_CHECK(osal_crc32(&data[1], len - 5U) ==
+               ((uint32_t)data[len - 4U] | ((uint32_t)data[len - 3U] << 8) |
+                ((uint32_t)data[len - 2U] << 16) | ((uint32_t)data[len - 1U] << 24)));
+    if (data[1] == OSAL_FWUPD_ACK) {
+        HOST_CHECK(seq >= test_fwupd_acked);
+        test_fwupd_acked = seq;
+    } else if (data[1] == OSAL_FWUPD_NAK) {
+        test_fwupd_nak = true;
+        test_fwupd_nak_seq = seq;
+        test_fwupd_naks++;
+    } else if (data[1] == OSAL_FWUPD_DONE) {
+        test_fwupd_done = (int8_t)data[OSAL_FWUPD_HDR_LEN];
+    }
+}
+
+// Feed a frame in random pieces, running the receiver in between; damage flips one byte
+static void test_fwupd_frame(uint8_t type, uint32_t seq, const uint8_t *payload, uint32_t len, bool damage)
+{
+    uint8_t f[OSAL_FWUPD_FRAME_MAX];
+    uint32_t total = OSAL_FWUPD_HDR_LEN + len + 4U;
+
+    f[0] = OSAL_FWUPD_SOF;
+    f[1] = type;
+    f[2] = (uint8_t)seq;
+    f[3] = (uint8_t)(seq >> 8);
+    f[4] = (uint8_t)len;
+    f[5] = (uint8_t)(len >> 8);
+    memcpy(&f[OSAL_FWUPD_HDR_LEN], payload, len);
+    test_fwupd_put32(&f[OSAL_FWUPD_HDR_LEN + len], osal_crc32(&f[1], OSAL_FWUPD_HDR_LEN - 1U + len));
+    if (damage) {
+        f[OSAL_FWUPD_HDR_LEN + (host_test_rand(&test_fwupd_seed) % len)] ^= 0x10U;
+    }
+    for (uint32_t off = 0U; off < total;) {
+        uint32_t n = 1U + (host_test_rand(&test_fwupd_seed) % 48U);
+        if (n > (total - off)) {
+            n = total - off;
+        }
+        osal_fwupd_receive(&f[off], n);
+        off += n;
+        (void)osal_fwupd_poll();
+    }
+}
+
+// Metadata block as tools/crc_stamp.py writes it
+static void test_fwupd_metadata(uint8_t *meta, uint32_t base, const uint8_t *image, uint32_t size, uint32_t seq)
+{
+    memset(meta, 0, APP_METADATA_SIZE);
+    test_fwupd_put32(&meta[0x00], APP_METADATA_MAGIC);
+    test_fwupd_put32(&meta[0x24], base);
+    test_fwupd_put32(&meta[0x28], size);
+    test_fwupd_put32(&meta[0x2C], osal_crc32(image, size));
+    test_fwupd_put32(&meta[0x30], seq);
+    test_fwupd_put32(&meta[0x34], 0x010000U + seq);
+}
+
+// Run a session into slot B; with damaged set, the first transmission of every damaged-th chunk
+// is corrupted.
+// stream is the image, or the patch when old_crc is given.
+static int32_t test_fwupd_session(const uint8_t *image, uint32_t size, const uint8_t *stream, uint32_t stream_size,
+                                  const uint32_t *old_crc, const uint8_t *meta, uint32_t damaged)
+{
+    uint8_t start[20];
+    uint32_t chunks = (stream_size + OSAL_FWUPD_CHUNK - 1U) / OSAL_FWUPD_CHUNK;
+    uint32_t next = 0U;
+    uint32_t first = 0U;          // Chunks below were sent at least once
+    int32_t status = 1;
+    osal_fwupd_stats_t stats;
+
+    test_fwupd_acked = 0U;
+    test_fwupd_nak = false;
+    test_fwupd_done = 1;
+    test_fwupd_naks = 0U;
+    osal_fwupd_begin(1U, &test_fwupd_backend, test_fwupd_send);
+
+    test_fwupd_put32(&start[0], OSAL_SLOT_B_BASE);
+    test_fwupd_put32(&start[4], size);
+    test_fwupd_put32(&start[8], osal_crc32(image, size));
+    test_fwupd_put32(&start[12], stream_size);
+    test_fwupd_put32(&start[16], (old_crc != NULL) ? *old_crc : 0U);
+    test_fwupd_frame(OSAL_FWUPD_START, 0U, start, (old_crc != NULL) ? 20U : 12U, false);
+
+    for (uint32_t i = 0U; (i < TEST_FWUPD_POLLS) && (test_fwupd_acked < chunks) && (test_fwupd_done == 1); i++) {
+        if (test_fwupd_nak) {
+            test_fwupd_nak = false;
+            next = test_fwupd_nak_seq;
+        }
+        if ((next < chunks) && (next < (test_fwupd_acked + OSAL_FWUPD_WINDOW))) {
+            uint32_t off = next * OSAL_FWUPD_CHUNK;
+            uint32_t len = ((stream_size - off) < OSAL_FWUPD_CHUNK) ? (stream_size - off) : OSAL_FWUPD_CHUNK;
+            bool damage = (damaged != 0U) && (next >= first) && ((next % damaged) == (damaged - 1U));
+
+            test_fwupd_frame(OSAL_FWUPD_DATA, next, &stream[off], len, damage);
+            next++;
+            first = (next > first) ? next : first;
+        } else {
+            status = osal_fwupd_poll();
+            if (status <= 0) {
+                break;
+            }
+        }
+    }
+    if ((status == 1) && (test_fwupd_done == 1)) {
+        test_fwupd_frame(OSAL_FWUPD_END, 0U, meta, APP_METADATA_SIZE, false);
+        for (uint32_t i = 0U; (i < TEST_FWUPD_POLLS) && (status == 1); i++) {
+            status = osal_fwupd_poll();
+        }
+    }
+    // The result may have come from a poll inside test_fwupd_frame()
+    osal_fwupd_get_stats(&stats);
+    HOST_CHECK(stats.status == test_fwupd_done);
+    return stats.status;
+}
+
+// Delta encoder for the test: records with sparse byte changes (zero runs), literal bytes and
+// a backwards seek; builds the new image and its patch together
+static void test_fwupd_varint(uint8_t *patch, uint32_t *len, uint32_t value)
+{
+    while (value >= 0x80U) {
+        patch[(*len)++] = (uint8_t)(value | 0x80U);
+        value >>= 7;
+    }
+    patch[(*len)++] = (uint8_t)value;
+}
+
+static void test_fwupd_record(const uint8_t *old, uint32_t *old_pos, uint8_t *new, uint32_t *new_pos,
+                              uint8_t *patch, uint32_t *patch_len, uint32_t diff_len, uint32_t extra_len,
+                              int32_t seek)
+{
+    uint32_t run = 0U;
+
+    test_fwupd_varint(patch, patch_len, diff_len);
+    test_fwupd_varint(patch, patch_len, extra_len);
+    test_fwupd_varint(patch, patch_len, (seek >= 0) ? ((uint32_t)seek << 1) : (((uint32_t)-seek << 1) - 1U));
+    for (uint32_t i = 0U; i < diff_len; i++) {
+        uint8_t d = 0U;
+
+        if ((host_test_rand(&test_fwupd_seed) % 64U) == 0U) {
+            d = (uint8_t)(1U + (host_test_rand(&test_fwupd_seed) % 255U));
+        }
+        new[(*new_pos)++] = (uint8_t)(old[(*old_pos)++] + d);
+        if (d == 0U) {
+            run++;
+            if ((i + 1U) < diff_len) {
+                continue;
+            }
+        }
+        if (run > 0U) {
+            patch[(*patch_len)++] = 0U;
+            test_fwupd_varint(patch, patch_len, run - 1U);
+            run = 0U;
+        }
+        if (d != 0U) {
+            patch[(*patch_len)++] = d;
+        }
+    }
+    for (uint32_t i = 0U; i < extra_len; i++) {
+        uint8_t b = (uint8_t)host_test_rand(&test_fwupd_seed);
+        new[(*new_pos)++] = b;
+        patch[(*patch_len)++] = b;
+    }
+    *old_pos = (uint32_t)((int32_t)*old_pos + seek);
+}
+
+int main(void)
+{
+    static uint8_t old[TEST_FWUPD_OLD_SIZE];
+    static uint8_t image[TEST_FWUPD_NEW_MAX];
+    static uint8_t patch[2U * TEST_FWUPD_NEW_MAX];
+    uint8_t meta[APP_METADATA_SIZE];
+    osal_slot_image_t dump;
+    osal_fwupd_stats_t stats;
+    osal_slot_header_t header;
+    uint32_t size;
+
+    test_fwupd_flash = osal_flash_model(OSAL_FLASH_PFLASH_START, &size);
+    HOST_CHECK(OSAL_SLOT_A_BASE == OSAL_FLASH_PFLASH_START);
+    dump.data = test_fwupd_flash;
+    dump.base = OSAL_SLOT_A_BASE;
+    dump.size = size;
+    osal_slot_flash_image(&test_fwupd_backend, &dump);
+
+    // Running image in slot A
+    for (uint32_t i = 0U; i < TEST_FWUPD_OLD_SIZE; i++) {
+        old[i] = (uint8_t)host_test_rand(&test_fwupd_seed);
+    }
+    memcpy(test_fwupd_at(OSAL_SLOT_A_BASE), old, TEST_FWUPD_OLD_SIZE);
+    test_fwupd_metadata(meta, OSAL_SLOT_A_BASE, old, TEST_FWUPD_OLD_SIZE, 1U);
+    memcpy(test_fwupd_at(OSAL_SLOT_A_METADATA), meta, APP_METADATA_SIZE);
+    uint32_t old_crc = osal_crc32(old, TEST_FWUPD_OLD_SIZE);
+
+    // Full image, clean link and with every 7th chunk damaged once
+    uint32_t new_size = 0x8F40U;
+    for (uint32_t i = 0U; i < new_size; i++) {
+        image[i] = (uint8_t)host_test_rand(&test_fwupd_seed);
+    }
+    test_fwupd_metadata(meta, OSAL_SLOT_B_BASE, image, new_size, 2U);
+    for (uint32_t damaged = 0U; damaged <= 7U; damaged += 7U) {
+        memset(test_fwupd_at(OSAL_SLOT_B_BASE), 0x5A, new_size);
+        HOST_CHECK(test_fwupd_session(image, new_size, image, new_size, NULL, meta, damaged) == 0);
+        HOST_CHECK(memcmp(test_fwupd_at(OSAL_SLOT_B_BASE), image, new_size) == 0);
+        HOST_CHECK(memcmp(test_fwupd_at(OSAL_SLOT_B_METADATA), meta, APP_METADATA_SIZE) == 0);
+        HOST_CHECK(osal_slot_read_header(&test_fwupd_backend, 1U, &header) == OSAL_SLOT_UNCHECKED);
+        osal_fwupd_get_stats(&stats);
+        HOST_CHECK(stats.bytes == new_size);
+        HOST_CHECK(stats.erases == (((new_size + OSAL_FLASH_SECTOR_SIZE - 1U) / OSAL_FLASH_SECTOR_SIZE) + 1U));
+        HOST_CHECK((damaged == 0U) ? (test_fwupd_naks == 0U) : (test_fwupd_naks > 0U));
+    }
+
+    // Delta: changed bytes, inserted literals, a backwards seek and a tail with no changes
+    uint32_t old_pos = 0U;
+    uint32_t new_pos = 0U;
+    uint32_t patch_len = 0U;
+    test_fwupd_record(old, &old_pos, image, &new_pos, patch, &patch_len, 0x3000U, 0x180U, -0x800);
+    test_fwupd_record(old, &old_pos, image, &new_pos, patch, &patch_len, 0x4000U, 0x40U, 0x100);
+    test_fwupd_record(old, &old_pos, image, &new_pos, patch, &patch_len,
+                      TEST_FWUPD_OLD_SIZE - old_pos, 0U, 0);
+    new_size = new_pos;
+    HOST_CHECK(new_size <= TEST_FWUPD_NEW_MAX);
+    HOST_CHECK(patch_len < (new_size / 4U));
+    test_fwupd_metadata(meta, OSAL_SLOT_B_BASE, image, new_size, 3U);
+    for (uint32_t damaged = 0U; damaged <= 3U; damaged += 3U) {
+        memset(test_fwupd_at(OSAL_SLOT_B_BASE), 0x5A, new_size);
+        HOST_CHECK(test_fwupd_session(image, new_size, patch, patch_len, &old_crc, meta, damaged) == 0);
+        HOST_CHECK(memcmp(test_fwupd_at(OSAL_SLOT_B_BASE), image, new_size) == 0);
+        HOST_CHECK(memcmp(test_fwupd_at(OSAL_SLOT_B_METADATA), meta, APP_METADATA_SIZE) == 0);
+        osal_fwupd_get_stats(&stats);
+        HOST_CHECK(stats.stream_size == patch_len);
+        HOST_CHECK(stats.bytes == new_size);
+    }
+
+    // Patch made against another image: refused at START, slot B left alone
+    uint32_t wrong_crc = old_crc ^ 1U;
+    HOST_CHECK(test_fwupd_session(image, new_size, patch, patch_len, &wrong_crc, meta, 0U) == -2);
+    HOST_CHECK(memcmp(test_fwupd_at(OSAL_SLOT_B_BASE), image, new_size) == 0);
+
+    // Corrupt patch: a record reaching past the old image; the metadata stays erased
+    patch_len = 0U;
+    test_fwupd_varint(patch, &patch_len, TEST_FWUPD_OLD_SIZE + 1U);
+    test_fwupd_varint(patch, &patch_len, 0U);
+    test_fwupd_varint(patch, &patch_len, 0U);
+    patch[patch_len++] = 0U;
+    test_fwupd_varint(patch, &patch_len, TEST_FWUPD_OLD_SIZE);
+    HOST_CHECK(test_fwupd_session(image, new_size, patch, patch_len, &old_crc, meta, 0U) == -7);
+    HOST_CHECK(osal_slot_read_header(&test_fwupd_backend, 1U, &header) == OSAL_SLOT_EMPTY);
+
+    return host_test_exit("test_fwupd");
+}
@@ -0,0 +1,172 @@
+#include "host_test.h"
+#include "osal_heap.h"
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+// Fuzzer: random alloc/realloc/free over three regions, checking the payload contents, the
+// alignment, the usable size and the running counters (used + free covers the region, the
+// reported largest block can be allocated and nothing above it can). --bench then times
+// alloc and free on a fragmented heap against the host libc.
+
+#define TEST_HEAP_SLOTS 500U
+#define TEST_HEAP_ROUNDS 1000000UL
+#define TEST_HEAP_BENCH_OPS 200000UL
+
+static uint8_t test_heap_sram[30000] __attribute__((aligned(8)));
+static uint8_t test_heap_dtcm[9000] __attribute__((aligned(8)));
+static uint8_t test_heap_nc[4000] __attribute__((aligned(8)));
+
+static void *test_heap_ptr[TEST_HEAP_SLOTS];
+static size_t test_heap_size[TEST_HEAP_SLOTS];
+static uint8_t test_heap_tag[TEST_HEAP_SLOTS];
+
+static bool test_heap_intact(uint32_t i, size_t len)
+{
+    const uint8_t *p = test_heap_ptr[i];
+
+    for (size_t k = 0U; k < len; k++) {
+        if (p[k] != test_heap_tag[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void test_heap_check_regions(void)
+{
+    osal_heap_stats_t s;
+
+    for (uint32_t i = 0U; osal_heap_get_stats(i, &s) == 0; i++) {
+        // Blocks tile the region up to the end marker header
+        HOST_CHECK((s.used + s.free) == (s.size - (uint32_t)(2U * sizeof(void *))));
+        HOST_CHECK(s.used <= s.used_peak);
+        if (s.free_count == 0U) {
+            continue;
+        }
+        void *p = osal_heap_alloc(s.largest_free, s.flags);
+        HOST_CHECK(p != NULL);
+        osal_heap_free(p);
+        p = osal_heap_alloc(s.largest_free + OSAL_HEAP_ALIGN, s.flags);
+        HOST_CHECK(p == NULL);
+        osal_heap_free(p);
+    }
+}
+
+static void test_heap_fuzz(uint32_t *seed)
+{
+    for (uint32_t it = 0U; it < TEST_HEAP_ROUNDS; it++) {
+        uint32_t i = host_test_rand(seed) % TEST_HEAP_SLOTS;
+
+        if (test_heap_ptr[i] != NULL) {
+            HOST_CHECK(test_heap_intact(i, test_heap_size[i]));
+            if ((host_test_rand(seed) % 3U) == 0U) {
+                size_t n = host_test_rand(seed) % 700U;
+                size_t keep = (n < test_heap_size[i]) ? n : test_heap_size[i];
+                void *q = osal_heap_realloc(test_heap_ptr[i], n);
+                if ((q != NULL) || (n == 0U)) {
+                    test_heap_ptr[i] = q;
+                    test_heap_size[i] = n;
+                    HOST_CHECK((q == NULL) || test_heap_intact(i, keep));
+                    if (q != NULL) {
+                        memset(q, test_heap_tag[i], n);
+                    }
+                }
+            } else {
+                osal_heap_free(test_heap_ptr[i]);
+                test_heap_ptr[i] = NULL;
+            }
+        } else {
+            size_t n = host_test_rand(seed) % (((host_test_rand(seed) % 10U) == 0U) ? 4000U : 200U);
+            uint32_t r = host_test_rand(seed) % 8U;
+            uint32_t flags = (r == 0U) ? OSAL_HEAP_DTCM : ((r == 1U) ? OSAL_HEAP_NC : OSAL_HEAP_DEFAULT);
+            void *p = osal_heap_alloc(n, flags);
+            if (p != NULL) {
+                HOST_CHECK(((uintptr_t)p % OSAL_HEAP_ALIGN) == 0U);
+                HOST_CHECK(osal_heap_usable_size(p) >= n);
+                test_heap_ptr[i] = p;
+                test_heap_size[i] = n;
+                test_heap_tag[i] = (uint8_t)host_test_rand(seed);
+                memset(p, test_heap_tag[i], n);
+            }
+        }
+        if ((it % 1000U) == 0U) {
+            test_heap_check_regions();
+        }
+    }
+}
+
+static uint64_t test_heap_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+// Replace a random slot TEST_HEAP_BENCH_OPS times; the heap stays about half full
+static void test_heap_bench(const char *name, void *(*alloc)(size_t), void (*release)(void *), uint32_t *seed)
+{
+    uint64_t alloc_ns = 0U, free_ns = 0U, alloc_max = 0U, free_max = 0U;
+
+    memset(test_heap_ptr, 0, sizeof(test_heap_ptr));
+    for (uint32_t n = 0U; n < TEST_HEAP_BENCH_OPS; n++) {
+        uint32_t i = host_test_rand(seed) % (TEST_HEAP_SLOTS / 4U);
+        uint64_t t;
+
+        if (test_heap_ptr[i] != NULL) {
+            t = test_heap_ns();
+            release(test_heap_ptr[i]);
+            t = test_heap_ns() - t;
+            free_ns += t;
+            free_max = (t > free_max) ? t : free_max;
+        }
+        size_t size = 8U + (host_test_rand(seed) % 120U);
+        t = test_heap_ns();
+        test_heap_ptr[i] = alloc(size);
+        t = test_heap_ns() - t;
+        alloc_ns += t;
+        alloc_max = (t > alloc_max) ? t : alloc_max;
+    }
+    for (uint32_t i = 0U; i < TEST_HEAP_SLOTS; i++) {
+        release(test_heap_ptr[i]);
+        test_heap_ptr[i] = NULL;
+    }
+    printf("%-10s alloc avg %lu ns max %lu ns, free avg %lu ns max %lu ns (host clock, max includes preemption)\n",
+           name, (unsigned long)(alloc_ns / TEST_HEAP_BENCH_OPS), (unsigned long)alloc_max,
+           (unsigned long)(free_ns / TEST_HEAP_BENCH_OPS), (unsigned long)free_max);
+}
+
+static void *test_heap_osal_alloc(size_t size)
+{
+    return osal_heap_alloc(size, OSAL_HEAP_DEFAULT);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t seed = 1U;
+
+    HOST_CHECK(osal_heap_add_region(test_heap_sram, sizeof(test_heap_sram), OSAL_HEAP_SRAM) == 0);
+    HOST_CHECK(osal_heap_add_region(test_heap_dtcm, sizeof(test_heap_dtcm), OSAL_HEAP_DTCM) == 0);
+    HOST_CHECK(osal_heap_add_region(&test_heap_nc[3], sizeof(test_heap_nc) - 3U, OSAL_HEAP_NC) == 0);
+    HOST_CHECK(osal_heap_add_region(test_heap_nc, sizeof(test_heap_nc), OSAL_HEAP_SRAM | OSAL_HEAP_NC) == -1);
+    HOST_CHECK(osal_heap_add_region(test_heap_nc, 8U, OSAL_HEAP_NC) == -2);
+    test_heap_check_regions();
+
+    test_heap_fuzz(&seed);
+    for (uint32_t i = 0U; i < TEST_HEAP_SLOTS; i++) {
+        osal_heap_free(test_heap_ptr[i]);
+        test_heap_ptr[i] = NULL;
+    }
+    // Everything released: each region is one free block again
+    osal_heap_stats_t s;
+    for (uint32_t i = 0U; osal_heap_get_stats(i, &s) == 0; i++) {
+        HOST_CHECK((s.used == 0U) && (s.alloc_count == 0U) && (s.free_count == 1U));
+    }
+    osal_heap_log();
+
+    if ((argc > 1) && (strcmp(argv[1], "--bench") == 0)) {
+        test_heap_bench("osal_heap", test_heap_osal_alloc, osal_heap_free, &seed);
+        test_heap_bench("libc", malloc, free, &seed);
+    }
+    return host_test_exit("test_heap");
+}
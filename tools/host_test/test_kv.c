@@ -0,0 +1,125 @@
+#include "host_test.h"
+#include "osal_flash.h"
+#include "osal_kv.h"
+#include <string.h>
+
+// Key-value store against a reference copy of its contents: random sets, deletes and
+// background reclaim steps, with programs cut short through the flash model (a reset in the
+// middle of a record, a sector header or an obsolete mark) and a remount after each cut. The
+// torn double word fails its ECC: the mount must take it for a torn record, keep every other
+// value and never read it unchecked (the model aborts on that, as the target would fault).
+
+#define TEST_KV_KEYS 48U
+#define TEST_KV_OPS 40000U
+
+static uint8_t test_kv_ref[TEST_KV_KEYS + 1U][OSAL_KV_VALUE_MAX];
+static int32_t test_kv_ref_len[TEST_KV_KEYS + 1U];   // -1: not set
+static uint32_t test_kv_seed = 7U;
+
+static void test_kv_compare(void)
+{
+    uint8_t buf[OSAL_KV_VALUE_MAX];
+
+    for (uint32_t k = 1U; k <= TEST_KV_KEYS; k++) {
+        uint32_t len = 0U;
+        int32_t ret = osal_kv_get((uint16_t)k, buf, sizeof(buf), &len);
+
+        if (test_kv_ref_len[k] < 0) {
+            HOST_CHECK(ret == -1);
+        } else {
+            HOST_CHECK((ret == 0) && (len == (uint32_t)test_kv_ref_len[k]) && (memcmp(buf, test_kv_ref[k], len) == 0));
+        }
+    }
+}
+
+static uint32_t test_kv_flash_errors(void)
+{
+    osal_flash_stats_t s;
+
+    osal_flash_get_stats(&s);
+    return s.errors;
+}
+
+int main(void)
+{
+    uint8_t value[OSAL_KV_VALUE_MAX];
+    uint8_t word[OSAL_FLASH_WRITE_UNIT];
+    osal_kv_stats_t stats;
+    uint32_t cuts = 0U;
+    uint32_t torn = 0U;
+
+    for (uint32_t k = 0U; k <= TEST_KV_KEYS; k++) {
+        test_kv_ref_len[k] = -1;
+    }
+    osal_flash_model_timing(3U, 0U);
+    HOST_CHECK(osal_kv_init() == 0);
+
+    // The model: a cut double word reads back as an error until its sector is erased
+    memset(word, 0, sizeof(word));
+    osal_flash_model_cut(0U);
+    HOST_CHECK(osal_flash_program(OSAL_FLASH_DFLASH_END - OSAL_FLASH_SECTOR_SIZE, word, sizeof(word)) != 0);
+    HOST_CHECK(osal_flash_read_checked(OSAL_FLASH_DFLASH_END - OSAL_FLASH_SECTOR_SIZE, value, 4U) == -1);
+    HOST_CHECK(!osal_flash_is_erased(OSAL_FLASH_DFLASH_END - OSAL_FLASH_SECTOR_SIZE, OSAL_FLASH_SECTOR_SIZE));
+    HOST_CHECK(osal_flash_erase(OSAL_FLASH_DFLASH_END - OSAL_FLASH_SECTOR_SIZE) == 0);
+    HOST_CHECK(osal_flash_read_checked(OSAL_FLASH_DFLASH_END - OSAL_FLASH_SECTOR_SIZE, value, 8U) == 0);
+
+    for (uint32_t i = 0U; i < TEST_KV_OPS; i++) {
+        uint32_t k = 1U + (host_test_rand(&test_kv_seed) % (((i % 4000U) < 2000U) ? 8U : TEST_KV_KEYS));
+        uint32_t op = host_test_rand(&test_kv_seed) % 100U;
+        bool cut = (host_test_rand(&test_kv_seed) % 32U) == 0U;
+        uint32_t errors = test_kv_flash_errors();
+        int32_t ret;
+
+        if (cut) {
+            osal_flash_model_cut(host_test_rand(&test_kv_seed) % 160U);
+        }
+        if (op < 10U) {
+            ret = osal_kv_delete((uint16_t)k);
+            if (ret == 0) {
+                test_kv_ref_len[k] = -1;
+            } else {
+                HOST_CHECK((ret == -1) ? (test_kv_ref_len[k] < 0) : (ret == -4));
+            }
+        } else if (op < 70U) {
+            uint32_t len = ((host_test_rand(&test_kv_seed) % 8U) == 0U) ?
+                           (host_test_rand(&test_kv_seed) % (OSAL_KV_VALUE_MAX + 1U)) :
+                           (host_test_rand(&test_kv_seed) % 24U);
+            for (uint32_t j = 0U; j < len; j++) {
+                value[j] = (uint8_t)host_test_rand(&test_kv_seed);
+            }
+            ret = osal_kv_set((uint16_t)k, value, len);
+            if (ret == 0) {
+                memcpy(test_kv_ref[k], value, len);
+                test_kv_ref_len[k] = (int32_t)len;
+            } else {
+                HOST_CHECK(ret == -4);
+            }
+        } else {
+            osal_kv_poll();
+        }
+        osal_flash_model_cut(UINT32_MAX);
+
+        if (test_kv_flash_errors() != errors) {
+            // Reset during the program: finish it off as the next boot would
+            HOST_CHECK(cut);
+            cuts++;
+            (void)osal_flash_wait();
+            HOST_CHECK(osal_kv_init() >= 0);
+            osal_kv_get_stats(&stats);
+            torn += stats.torn;
+            test_kv_compare();
+        } else if ((i % 1000U) == 999U) {
+            HOST_CHECK(osal_kv_init() >= 0);
+            test_kv_compare();
+        }
+    }
+    test_kv_compare();
+    osal_kv_get_stats(&stats);
+    HOST_CHECK(cuts > 100U);
+    HOST_CHECK(torn > 0U);
+    HOST_CHECK(stats.reclaims > 0U);
+    printf("kv: %u cuts (%u torn records at mount), %lu reclaims, %lu erases, %lu keys\n", cuts, torn,
+           (unsigned long)stats.reclaims, (unsigned long)stats.erases, (unsigned long)stats.keys);
+
+    return host_test_exit("test_kv");
+}
@@ -0,0 +1,193 @@
+#include "host_test.h"
+#include "osal_crc32.h"
+#include "osal_slot.h"
+#include <string.h>
+
+// A/B selection over flash dump files, through the osal_slot_flash_image() backend the
+// update tools use. Without arguments, synthetic dumps of both slots are written to a file,
+// loaded back and put through newest-first selection, fallback after a failed check, the
+// verdict cache, sequence wrap and bad headers. With a dump file (and its flash address,
+// default slot A), the selection on that dump is printed.
+
+#define TEST_SLOT_BASE OSAL_SLOT_A_BASE
+#define TEST_SLOT_DUMP_SIZE (OSAL_SLOT_B_METADATA + OSAL_SLOT_METADATA_SECTOR - TEST_SLOT_BASE)
+#define TEST_SLOT_IMAGE_SIZE 0x6000U
+
+static uint8_t *test_slot_dump;
+static uint32_t test_slot_dump_size;
+static char test_slot_file[256];   // Next to the test binary
+
+static void test_slot_put32(uint32_t addr, uint32_t value)
+{
+    uint8_t *p = &test_slot_dump[addr - TEST_SLOT_BASE];
+
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+// Image with random contents and stamped metadata, as tools/crc_stamp.py leaves it
+static void test_slot_make(uint32_t slot, uint32_t sequence, uint32_t *seed)
+{
+    uint32_t base = osal_slot_layout[slot].base;
+    uint32_t meta = osal_slot_layout[slot].metadata;
+    uint8_t *image = &test_slot_dump[base - TEST_SLOT_BASE];
+
+    for (uint32_t i = 0U; i < TEST_SLOT_IMAGE_SIZE; i++) {
+        image[i] = (uint8_t)host_test_rand(seed);
+    }
+    memset(&test_slot_dump[meta - TEST_SLOT_BASE], 0, APP_METADATA_SIZE);
+    test_slot_put32(meta, APP_METADATA_MAGIC);
+    test_slot_put32(meta + 0x24U, base);
+    test_slot_put32(meta + 0x28U, TEST_SLOT_IMAGE_SIZE);
+    test_slot_put32(meta + 0x2CU, osal_crc32(image, TEST_SLOT_IMAGE_SIZE));
+    test_slot_put32(meta + 0x30U, sequence);
+    test_slot_put32(meta + 0x34U, 0x010000U + sequence);
+}
+
+static int32_t test_slot_save(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    size_t n = 0U;
+
+    if (f != NULL) {
+        n = fwrite(test_slot_dump, 1U, test_slot_dump_size, f);
+        fclose(f);
+    }
+    return (n == test_slot_dump_size) ? 0 : -1;
+}
+
+static int32_t test_slot_load(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    long size;
+
+    free(test_slot_dump);
+    test_slot_dump = NULL;
+    if ((f == NULL) || (fseek(f, 0, SEEK_END) != 0) || ((size = ftell(f)) <= 0)) {
+        if (f != NULL) {
+            fclose(f);
+        }
+        return -1;
+    }
+    rewind(f);
+    test_slot_dump = malloc((size_t)size);
+    test_slot_dump_size = (uint32_t)size;
+    if ((test_slot_dump == NULL) || (fread(test_slot_dump, 1U, (size_t)size, f) != (size_t)size)) {
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+    return 0;
+}
+
+static int32_t test_slot_select(uint32_t base, osal_slot_cache_t *cache, osal_slot_selection_t *sel)
+{
+    osal_slot_image_t image = { test_slot_dump, base, test_slot_dump_size };
+    osal_slot_flash_t flash;
+
+    osal_slot_flash_image(&flash, &image);
+    return osal_slot_select(&flash, cache, sel);
+}
+
+// Save the dump, load it back and select from the file contents
+static int32_t test_slot_run(const char *what, osal_slot_cache_t *cache, osal_slot_selection_t *sel)
+{
+    int32_t selected;
+
+    HOST_CHECK(test_slot_save(test_slot_file) == 0);
+    HOST_CHECK(test_slot_load(test_slot_file) == 0);
+    selected = test_slot_select(TEST_SLOT_BASE, cache, sel);
+    printf("%-32s -> %c, status %ld/%ld, hashed %lu, cached 0x%lx\n", what,
+           (selected >= 0) ? (int)('A' + selected) : '-', (long)sel->status[0], (long)sel->status[1],
+           (unsigned long)sel->verified, (unsigned long)sel->cached);
+    return selected;
+}
+
+static void test_slot_cases(void)
+{
+    osal_slot_selection_t sel;
+    osal_slot_cache_t cache;
+    uint32_t seed = 7U;
+
+    test_slot_dump_size = TEST_SLOT_DUMP_SIZE;
+    test_slot_dump = malloc(test_slot_dump_size);
+    if (test_slot_dump == NULL) {
+        HOST_CHECK(test_slot_dump != NULL);
+        return;
+    }
+    memset(test_slot_dump, 0xFF, test_slot_dump_size);
+    memset(&cache, 0xA5, sizeof(cache));   // Garbage, as after a cold boot
+
+    HOST_CHECK(test_slot_run("both erased", &cache, &sel) == -1);
+    HOST_CHECK((sel.status[0] == OSAL_SLOT_EMPTY) && (sel.status[1] == OSAL_SLOT_EMPTY));
+
+    test_slot_make(0U, 1U, &seed);
+    HOST_CHECK(test_slot_run("A only", &cache, &sel) == 0);
+    HOST_CHECK(sel.verified == 1U);
+
+    test_slot_make(1U, 2U, &seed);
+    HOST_CHECK(test_slot_run("B newer", &cache, &sel) == 1);
+    HOST_CHECK((sel.verified == 1U) && (sel.status[0] == OSAL_SLOT_UNCHECKED));
+    HOST_CHECK(test_slot_run("B newer, warm (cached)", &cache, &sel) == 1);
+    HOST_CHECK((sel.verified == 0U) && (sel.cached == 2U));
+    HOST_CHECK(test_slot_run("B newer, no cache", NULL, &sel) == 1);
+    HOST_CHECK(sel.verified == 1U);
+
+    // A flipped bit in B: the cached verdict is keyed by the header, so a fresh cache is needed
+    test_slot_dump[OSAL_SLOT_B_BASE + 0x10U - TEST_SLOT_BASE] ^= 1U;
+    memset(&cache, 0, sizeof(cache));
+    HOST_CHECK(test_slot_run("B corrupt, falls back to A", &cache, &sel) == 0);
+    HOST_CHECK((sel.status[1] == OSAL_SLOT_BAD_IMAGE) && (sel.verified == 2U));
+    HOST_CHECK(test_slot_run("B corrupt, warm (cached)", &cache, &sel) == 0);
+    HOST_CHECK((sel.verified == 0U) && (sel.cached == 3U));
+    test_slot_dump[OSAL_SLOT_B_BASE + 0x10U - TEST_SLOT_BASE] ^= 1U;
+
+    // Sequence numbers compare across the wrap: 1 is newer than 0xFFFFFFFF
+    test_slot_put32(OSAL_SLOT_B_METADATA + 0x30U, 0xFFFFFFFFUL);
+    HOST_CHECK(test_slot_run("A=1 newer than B=0xFFFFFFFF", &cache, &sel) == 0);
+    HOST_CHECK(sel.status[1] == OSAL_SLOT_UNCHECKED);
+
+    // An image linked for the other slot cannot run
+    test_slot_put32(OSAL_SLOT_A_METADATA + 0x24U, OSAL_SLOT_B_BASE);
+    HOST_CHECK(test_slot_run("A linked for B", &cache, &sel) == 1);
+    HOST_CHECK(sel.status[0] == OSAL_SLOT_BAD_HEADER);
+    test_slot_put32(OSAL_SLOT_B_METADATA + 0x2CU, 0U);
+    HOST_CHECK(test_slot_run("and B not stamped", &cache, &sel) == -1);
+    HOST_CHECK(sel.status[1] == OSAL_SLOT_BAD_HEADER);
+
+    // A dump shorter than the layout: the missing metadata reads as empty
+    test_slot_dump_size = OSAL_SLOT_B_BASE - TEST_SLOT_BASE;
+    test_slot_make(0U, 3U, &seed);
+    HOST_CHECK(test_slot_run("slot A dump only", &cache, &sel) == 0);
+    HOST_CHECK(sel.status[1] == OSAL_SLOT_EMPTY);
+
+    HOST_CHECK(osal_slot_of(OSAL_SLOT_A_BASE) == 0);
+    HOST_CHECK(osal_slot_of(OSAL_SLOT_B_METADATA + 0x10U) == 1);
+    HOST_CHECK(osal_slot_of(0x00400000UL) == -1);
+    remove(test_slot_file);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1) {
+        osal_slot_selection_t sel;
+        uint32_t base = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : TEST_SLOT_BASE;
+
+        if (test_slot_load(argv[1]) != 0) {
+            printf("%s: cannot read\n", argv[1]);
+            return 1;
+        }
+        int32_t selected = test_slot_select(base, NULL, &sel);
+        for (uint32_t slot = 0U; slot < OSAL_SLOT_COUNT; slot++) {
+            printf("slot %c: status %ld, seq %lu, version 0x%06lx\n", (int)('A' + slot), (long)sel.status[slot],
+                   (unsigned long)sel.hdr[slot].sequence, (unsigned long)sel.hdr[slot].version_code);
+        }
+        printf("selected %c\n", (selected >= 0) ? (int)('A' + selected) : '-');
+        return (selected >= 0) ? 0 : 1;
+    }
+    snprintf(test_slot_file, sizeof(test_slot_file), "%s.dump", argv[0]);
+    test_slot_cases();
+    return host_test_exit("test_slot");
+}
@@ -0,0 +1,228 @@
+#!/usr/bin/env python3
+"""Compress the RAM initialisation images of a linked S32K312 ELF with LZ4.
+
+Post-link step (optional). Every __INIT_TABLE entry whose ROM image is a
+separate load image (.sram_data, .non_cacheable_data, .shareable_data,
+.data_tcm_data, .itcm_text) is replaced by an LZ4 block. The blocks are packed
+back to back from the first image, the freed flash is filled with 0xFF, and
+the table entry is rewritten as:
+
+    ram_start | 1    bit 0 set: the ROM range holds an LZ4 block
+    rom_start        start of the block
+    rom_end          end of the block
+
+init_data_bss() decodes flagged entries and copies the others as before.
+Entries whose source lives in .pflash itself (the vector table) and images
+that do not shrink are left alone. Run it before any step that checksums or
+signs the image.
+
+Usage: lz4_init.py app.elf [-o out.elf] [--bin out.bin]
+"""
+
+import argparse
+import sys
+
+from elfimage import ElfImage, ElfError
+
+PFLASH_START = 0x00400000
+PFLASH_END = 0x00600000
+ENTRY_COMPRESSED = 0x1
+
+MIN_MATCH = 4
+LAST_LITERALS = 5       # The last 5 bytes are always literals
+MF_LIMIT = 12           # No match may start in the last 12 bytes
+MAX_OFFSET = 0xFFFF
+HASH_BITS = 16
+
+
+def _put_length(out, value):
+    while value >= 255:
+        out.append(255)
+        value -= 255
+    out.append(value)
+
+
+def _emit(out, literals, match_len, offset):
+    lit_len = len(literals)
+    token = (min(lit_len, 15) << 4)
+    if match_len is not None:
+        token |= min(match_len - MIN_MATCH, 15)
+    out.append(token)
+    if lit_len >= 15:
+        _put_length(out, lit_len - 15)
+    out += literals
+    if match_len is not None:
+        out += bytes((offset & 0xFF, offset >> 8))
+        if match_len - MIN_MATCH >= 15:
+            _put_length(out, match_len - MIN_MATCH - 15)
+
+
+def lz4_compress(src):
+    """Greedy LZ4 block compressor (hash of 4 bytes, single candidate)."""
+    n = len(src)
+    out = bytearray()
+    table = {}
+    anchor = 0
+    pos = 0
+    limit = n - MF_LIMIT
+
+    while pos < limit:
+        key = src[pos:pos + 4]
+        cand = table.get(key)
+        table[key] = pos
+        if cand is None or pos - cand > MAX_OFFSET:
+            pos += 1
+            continue
+        # Extend backwards over pending literals, then forwards
+        while pos > anchor and cand > 0 and src[pos - 1] == src[cand - 1]:
+            pos -= 1
+            cand -= 1
+        length = MIN_MATCH
+        while pos + length < n - LAST_LITERALS and src[pos + length] == src[cand + length]:
+            length += 1
+        _emit(out, src[anchor:pos], length, pos - cand)
+        for i in range(pos + 1, min(pos + length, limit)):
+            table[src[i:i + 4]] = i
+        pos += length
+        anchor = pos
+
+    _emit(out, src[anchor:], None, 0)
+    return bytes(out)
+
+
+def lz4_decompress(src):
+    """Reference decoder, same algorithm as Sys_Lz4Decode() in startup.c."""
+    out = bytearray()
+    i = 0
+    while i < len(src):
+        token = src[i]
+        i += 1
+        lit = token >> 4
+        if lit == 15:
+            while True:
+                b = src[i]
+                i += 1
+                lit += b
+                if b != 255:
+                    break
+        out += src[i:i + lit]
+        i += lit
+        if i >= len(src):
+            break
+        offset = src[i] | (src[i + 1] << 8)
+        i += 2
+        mlen = (token & 15) + MIN_MATCH
+        if (token & 15) == 15:
+            while True:
+                b = src[i]
+                i += 1
+                mlen += b
+                if b != 255:
+                    break
+        start = len(out) - offset
+        for k in range(mlen):
+            out.append(out[start + k])
+    return bytes(out)
+
+
+def load_image_section(elf, lma, size):
+    """Section whose load image (LMA != VMA) holds [lma, lma + size)."""
+    for sec in elf.sections:
+        if sec.lma == sec.addr or sec.size == 0:
+            continue
+        if sec.lma <= lma and lma + size <= sec.lma + sec.size:
+            return sec
+    return None
+
+
+def pack(elf, candidates, region_start, region_end):
+    """Write the images back to back from region_start and update their table entries.
+    Returns the first free address."""
+    cursor = region_start
+    print("%-22s %10s %10s %7s" % ("section", "raw", "lz4", "ratio"))
+    for _rom_start, entry, sec, raw, packed in candidates:
+        if len(packed) >= len(raw):
+            # Keep the raw image, moved down if needed
+            elf.write(cursor, raw)
+            entry[2], entry[3] = cursor, cursor + len(raw)
+            cursor += (len(raw) + 3) & ~3
+            print("%-22s %10u %10s %7s" % (sec.name, len(raw), "-", "raw"))
+            continue
+        elf.write(cursor, packed)
+        entry[1] |= ENTRY_COMPRESSED
+        entry[2], entry[3] = cursor, cursor + len(packed)
+        cursor += (len(packed) + 3) & ~3
+        print("%-22s %10u %10u %6.1f%%" % (sec.name, len(raw), len(packed), 100.0 * len(packed) / len(raw)))
+
+    # Erase what the packed images no longer use
+    for addr in range(cursor, region_end, 4):
+        if elf.is_loaded(addr, 4):
+            elf.write(addr, b"\xff\xff\xff\xff")
+    return cursor
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf")
+    parser.add_argument("-o", "--output", help="output ELF (default: in place)")
+    parser.add_argument("--bin", help="also write the flat flash image")
+    args = parser.parse_args()
+
+    try:
+        elf = ElfImage(args.elf)
+        table = elf.symbol("__init_table")
+        count = elf.read_u32(table)
+        entries = []
+        for i in range(count):
+            base = table + 4 + i * 12
+            entries.append([base, elf.read_u32(base), elf.read_u32(base + 4), elf.read_u32(base + 8)])
+    except ElfError as e:
+        sys.exit("lz4_init: %s" % e)
+
+    size_before = len(elf.flat_image(PFLASH_START, PFLASH_END)[1])
+
+    candidates = []
+    for entry in entries:
+        _base, ram, rom_start, rom_end = entry
+        size = rom_end - rom_start
+        if ram & ENTRY_COMPRESSED:
+            sys.exit("lz4_init: %s is already compressed" % args.elf)
+        if size == 0:
+            continue
+        sec = load_image_section(elf, rom_start, size)
+        if sec is None:
+            continue
+        raw = elf.read(rom_start, size)
+        packed = lz4_compress(raw)
+        if lz4_decompress(packed) != raw:
+            sys.exit("lz4_init: round trip failed for %s" % sec.name)
+        candidates.append((rom_start, entry, sec, raw, packed))
+
+    if not candidates:
+        print("lz4_init: nothing to compress")
+        return
+
+    candidates.sort(key=lambda c: c[0])
+    region_start = candidates[0][0]
+    region_end = max(c[0] + len(c[3]) for c in candidates)
+    try:
+        cursor = pack(elf, candidates, region_start, region_end)
+        for base, ram, rom_start, rom_end in entries:
+            elf.write_u32(base, ram)
+            elf.write_u32(base + 4, rom_start)
+            elf.write_u32(base + 8, rom_end)
+    except ElfError as e:
+        sys.exit("lz4_init: %s" % e)
+
+    size_after = len(elf.flat_image(PFLASH_START, PFLASH_END)[1])
+    print("init images: %u -> %u bytes" % (region_end - region_start, cursor - region_start))
+    print("flash image: %u -> %u bytes" % (size_before, size_after))
+
+    elf.save(args.output)
+    if args.bin:
+        with open(args.bin, "wb") as f:
+            f.write(elf.flat_image(PFLASH_START, PFLASH_END)[1])
+
+
+if __name__ == "__main__":
+    main()
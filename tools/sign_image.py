@@ -0,0 +1,210 @@
+#!/usr/bin/env python3
+"""Sign app_metadata of a linked S32K312 application with ECDSA P-256.
+
+Post-link step, run last. It stamps the image CRC-32 (as crc_stamp.py), the
+SHA-256 of the same range, then signs the metadata:
+
+    0x2C crc32          CRC-32 over [flash_start_addr, +image_size), metadata skipped
+    0x30 sequence       with --sequence (slot selection, see osal_slot.h)
+    0x38 sha256         SHA-256 over the same range
+    0x58 signature      ECDSA P-256 r || s (big-endian) over SHA-256 of bytes 0x00..0x57
+
+The key handling and the ECDSA signature are done by the openssl command line
+tool; this script only packs the metadata. osal_secboot_verify() checks the
+result against the public key compiled into include/osal_secboot_key.h.
+
+Keys are PEM files as written by "openssl ecparam -name prime256v1 -genkey"
+(SEC1) or PKCS#8; --genkey writes one. Keep the private key out of the
+repository.
+
+Usage: sign_image.py --genkey key.pem [--export-pubkey include/osal_secboot_key.h]
+       sign_image.py --key key.pem --export-pubkey include/osal_secboot_key.h
+       sign_image.py --key key.pem app.elf [-o out.elf] [--bin out.bin] [--sequence N]
+       sign_image.py --key key.pem app.bin --base 0x440000 [--slot 0|1] [-o out.bin]
+       sign_image.py --key key.pem app.elf --check
+"""
+
+import argparse
+import hashlib
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+
+from crc_stamp import (FlatImage, elf_flash_bytes, find_metadata, image_crc, METADATA_SIZE,
+                       OFF_FLASH_START, OFF_CRC, OFF_SEQUENCE, PFLASH_START, PFLASH_END)
+from elfimage import ElfImage, ElfError
+
+OFF_SHA256 = 0x38
+OFF_SIGNATURE = 0x58
+SIGNED_LEN = 0x58
+
+# SubjectPublicKeyInfo of a P-256 key up to the uncompressed point (RFC 5480)
+SPKI_P256 = bytes.fromhex("3059301306072a8648ce3d020106082a8648ce3d030107034200")
+
+
+def openssl(*args, data=None):
+    """Run the openssl command line tool and return its output."""
+    try:
+        return subprocess.run(("openssl",) + args, input=data, stdout=subprocess.PIPE,
+                              stderr=subprocess.PIPE, check=True).stdout
+    except FileNotFoundError:
+        raise ValueError("openssl is not installed")
+    except subprocess.CalledProcessError as e:
+        raise ValueError("openssl %s: %s" % (args[0], e.stderr.decode("ascii", "replace").strip()))
+
+
+def public_point(key):
+    """Uncompressed SEC1 point of the public half of a PEM private key."""
+    spki = openssl("pkey", "-in", key, "-pubout", "-outform", "DER")
+    if len(spki) != len(SPKI_P256) + 65 or not spki.startswith(SPKI_P256):
+        raise ValueError("key is not on P-256")
+    return spki[len(SPKI_P256):]
+
+
+def sign(key, data):
+    """ECDSA P-256 over SHA-256 of data, as the integers (r, s)."""
+    sig = openssl("dgst", "-sha256", "-sign", key, data=data)
+    values = [line.rsplit(":", 1)[1] for line in openssl("asn1parse", "-inform", "DER", data=sig).decode().splitlines()
+              if "INTEGER" in line]
+    if len(values) != 2:
+        raise ValueError("unexpected signature encoding")
+    return int(values[0], 16), int(values[1], 16)
+
+
+def verify(key, data, r, s):
+    """Check an (r, s) signature of data against the public half of key."""
+    with tempfile.TemporaryDirectory() as tmp:
+        conf = os.path.join(tmp, "sig.cnf")
+        with open(conf, "w") as f:
+            f.write("asn1=SEQUENCE:sig\n[sig]\nr=INTEGER:0x%X\ns=INTEGER:0x%X\n" % (r, s))
+        sig = os.path.join(tmp, "sig.der")
+        pub = os.path.join(tmp, "pub.pem")
+        openssl("asn1parse", "-genconf", conf, "-out", sig, "-noout")
+        openssl("pkey", "-in", key, "-pubout", "-out", pub)
+        try:
+            openssl("dgst", "-sha256", "-verify", pub, "-signature", sig, data=data)
+        except ValueError:
+            return False
+    return True
+
+
+def genkey(path):
+    if os.path.exists(path):
+        raise ValueError("%s already exists" % path)
+    openssl("ecparam", "-name", "prime256v1", "-genkey", "-noout", "-out", path)
+    os.chmod(path, 0o600)
+
+
+def export_pubkey(path, public):
+    rows = []
+    for i in range(0, len(public), 12):
+        rows.append("    " + ", ".join("0x%02X" % b for b in public[i:i + 12]) + ",")
+    with open(path, "w") as f:
+        f.write("#ifndef OSAL_SECBOOT_KEY_H_\n#define OSAL_SECBOOT_KEY_H_\n\n#include <stdint.h>\n\n")
+        f.write("// Public key that app_metadata signatures are checked against (uncompressed SEC1 point).\n")
+        f.write("// Generated by tools/sign_image.py --export-pubkey; do not edit.\n")
+        f.write("#define OSAL_SECBOOT_KEY_PROVISIONED 1\n\n")
+        f.write("static const uint8_t osal_secboot_pubkey[65] = {\n%s\n};\n\n" % "\n".join(rows))
+        f.write("#endif /* OSAL_SECBOOT_KEY_H_ */\n")
+
+
+def image_sha256(flash, start, size, meta):
+    end = start + size
+    meta_end = meta + METADATA_SIZE
+    h = hashlib.sha256()
+    if meta_end <= start or meta >= end:
+        h.update(flash(start, end))
+    else:
+        if meta > start:
+            h.update(flash(start, meta))
+        if meta_end < end:
+            h.update(flash(meta_end, end))
+    return h.digest()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("image", nargs="?", help="linked ELF, or flat binary with --base")
+    parser.add_argument("--key", help="PEM private key")
+    parser.add_argument("--genkey", metavar="PEM", help="create a new private key")
+    parser.add_argument("--export-pubkey", metavar="HEADER", help="write the public key as a C header")
+    parser.add_argument("--base", type=lambda v: int(v, 0), help="load address of a flat binary")
+    parser.add_argument("--slot", type=int, choices=(0, 1), help="slot whose metadata to use (flat binaries)")
+    parser.add_argument("--sequence", type=lambda v: int(v, 0), help="stamp this sequence number")
+    parser.add_argument("-o", "--output", help="output file (default: in place)")
+    parser.add_argument("--bin", help="also write the flat flash image (ELF input only)")
+    parser.add_argument("--check", action="store_true", help="verify CRC, digest and signature, write nothing")
+    args = parser.parse_args()
+    if args.bin and args.base is not None:
+        parser.error("--bin needs an ELF input")
+
+    try:
+        if args.genkey:
+            genkey(args.genkey)
+            args.key = args.genkey
+        if not args.key:
+            sys.exit("sign_image: --key is required")
+        public = public_point(args.key)
+        if args.export_pubkey:
+            export_pubkey(args.export_pubkey, public)
+    except (OSError, ValueError) as e:
+        sys.exit("sign_image: %s" % e)
+    if not args.image:
+        return
+
+    try:
+        if args.base is not None:
+            img = FlatImage(args.image, args.base)
+            flash = img.flash_bytes
+        else:
+            img = ElfImage(args.image)
+            flash = lambda lo, hi: elf_flash_bytes(img, lo, hi)
+
+        meta_addr = find_metadata(img, args.slot)
+        start, size = struct.unpack("<II", img.read(meta_addr + OFF_FLASH_START, 8))
+        if size == 0 or start < PFLASH_START or start + size > PFLASH_END:
+            sys.exit("sign_image: range 0x%08x+0x%x is outside program flash" % (start, size))
+
+        crc = image_crc(flash, start, size, meta_addr)
+        digest = image_sha256(flash, start, size, meta_addr)
+        print("image 0x%08x..0x%08x (%u bytes): CRC-32 0x%08x SHA-256 %s" %
+              (start, start + size, size, crc, digest.hex()))
+
+        if args.check:
+            meta = img.read(meta_addr, METADATA_SIZE)
+            r = int.from_bytes(meta[OFF_SIGNATURE:OFF_SIGNATURE + 32], "big")
+            s = int.from_bytes(meta[OFF_SIGNATURE + 32:OFF_SIGNATURE + 64], "big")
+            if struct.unpack_from("<I", meta, OFF_CRC)[0] != crc:
+                sys.exit("sign_image: CRC-32 does not match")
+            if meta[OFF_SHA256:OFF_SHA256 + 32] != digest:
+                sys.exit("sign_image: SHA-256 does not match")
+            if not verify(args.key, meta[:SIGNED_LEN], r, s):
+                sys.exit("sign_image: signature does not verify with this key")
+            print("CRC, digest and signature match")
+            return
+        if crc == 0:
+            sys.exit("sign_image: the image CRC is 0, change the image (e.g. the version string)")
+
+        img.write(meta_addr + OFF_CRC, struct.pack("<I", crc))
+        if args.sequence is not None:
+            img.write(meta_addr + OFF_SEQUENCE, struct.pack("<I", args.sequence & 0xFFFFFFFF))
+        img.write(meta_addr + OFF_SHA256, digest)
+        signed = img.read(meta_addr, SIGNED_LEN)
+        r, s = sign(args.key, signed)
+        if not verify(args.key, signed, r, s):
+            sys.exit("sign_image: internal error, signature does not verify")
+        img.write(meta_addr + OFF_SIGNATURE, r.to_bytes(32, "big") + s.to_bytes(32, "big"))
+        print("signed, metadata SHA-256 %s" % hashlib.sha256(signed).hexdigest())
+
+        img.save(args.output)
+        if args.bin:
+            with open(args.bin, "wb") as f:
+                f.write(img.flat_image(PFLASH_START, PFLASH_END)[1])
+    except (ElfError, ValueError) as e:
+        sys.exit("sign_image: %s" % e)
+
+
+if __name__ == "__main__":
+    main()